@@ -22,7 +22,8 @@ namespace gestures {
 //
 // For additional documentation, see ../docs/accel_filter_interpreter.md.
 
-class AccelFilterInterpreter : public FilterInterpreter {
+class AccelFilterInterpreter : public FilterInterpreter,
+                               public PropertyDelegate {
   FRIEND_TEST(AccelFilterInterpreterTest, CurveSegmentInitializerTest);
   FRIEND_TEST(AccelFilterInterpreterTest, CustomAccelTest);
   FRIEND_TEST(AccelFilterInterpreterTest, SimpleTest);
@@ -39,15 +40,26 @@ class AccelFilterInterpreter : public FilterInterpreter {
   FRIEND_TEST(AccelFilterInterpreterTest, TouchpadPointAccelCurveTest);
   FRIEND_TEST(AccelFilterInterpreterTest, TouchpadScrollAccelCurveTest);
   FRIEND_TEST(AccelFilterInterpreterTest, AccelDebugDataTest);
+  FRIEND_TEST(AccelFilterInterpreterTest, CompiledCurveEquivalenceTest);
  public:
   // Takes ownership of |next|:
   AccelFilterInterpreter(PropRegistry* prop_reg, Interpreter* next,
                          Tracer* tracer);
   virtual ~AccelFilterInterpreter() {}
 
+  virtual void ArchiveState(StateArchive* archive);
+
   virtual void ConsumeGesture(const Gesture& gs);
 
+  virtual void DoubleArrayWasWritten(DoubleArrayProperty* prop);
+
  private:
+  static const size_t kMaxCurveSegs = 3;
+  static const size_t kMaxCustomCurveSegs = 20;
+  static const size_t kMaxUnaccelCurveSegs = 1;
+
+  static const size_t kMaxAccelCurves = 5;
+
   struct CurveSegment {
     CurveSegment() : x_(INFINITY), sqr_(0.0), mul_(1.0), int_(0.0) {}
     CurveSegment(float x, float s, float m, float b)
@@ -62,6 +74,18 @@ class AccelFilterInterpreter : public FilterInterpreter {
     double int_;  // Intercept of line
   };
 
+  // A curve prepared for RatioFromCompiledCurve(). bounds_[i] is the largest
+  // x_ of segs_[0..i], so bounds_ is sorted and the first segment whose x_
+  // is not less than a speed can be found with a binary search. Must be
+  // compiled again whenever the segments change.
+  struct CompiledCurve {
+    void Compile(const CurveSegment* segs, size_t num_segs);
+
+    const CurveSegment* segs_ = nullptr;
+    size_t num_segs_ = 0;
+    double bounds_[kMaxCustomCurveSegs];
+  };
+
   //**************************************************************************
   // Worker Funnctions that are used internal to this class as well
   // as giving internal information for testing/research purposes.
@@ -89,8 +113,7 @@ class AccelFilterInterpreter : public FilterInterpreter {
   //    out:    scale_out_y, address of Y value to adjust
   //    out:    scale_out_x_ordinal, address of X orginal value to adjust
   //    out:    scale_out_y_ordinal, address of Y orginal value to adjust
-  //    out:    segs, address of CurveSegment array to use
-  //    out:    max_segs, number of array entries of segs
+  //    out:    curve, address of CompiledCurve to use
   //    ret:    true, acceleration expected
   //            false, acceleration not expected
   bool get_accel_parameters(
@@ -99,7 +122,7 @@ class AccelFilterInterpreter : public FilterInterpreter {
       float& x_scale, float& y_scale,
       float*& scale_out_x, float*& scale_out_y,
       float*& scale_out_x_ordinal, float*& scale_out_y_ordinal,
-      CurveSegment*& segs, size_t& max_segs);
+      const CompiledCurve*& curve);
 
   // Given a dx/dy/dt (non-fling motion) or, if dx and dy are nullptr,
   // vx/vy (fling velocity) calculate the speed.
@@ -132,6 +155,13 @@ class AccelFilterInterpreter : public FilterInterpreter {
                             const size_t max_segs,
                             const float speed);
 
+  // Same as RatioFromAccelCurve on the curve's segments, but finds the
+  // segment with a binary search.
+  //    in:     curve, CompiledCurve being used
+  //    in:     speed, actual distance/delta time value
+  //    ret:    determined gain to apply
+  float RatioFromCompiledCurve(const CompiledCurve& curve, const float speed);
+
   template<typename T>
   void LogDebugData(const T& debug_data) {
     using EventDebug = ActivityLog::EventDebug;
@@ -141,12 +171,6 @@ class AccelFilterInterpreter : public FilterInterpreter {
 
   //**************************************************************************
 
-  static const size_t kMaxCurveSegs = 3;
-  static const size_t kMaxCustomCurveSegs = 20;
-  static const size_t kMaxUnaccelCurveSegs = 1;
-
-  static const size_t kMaxAccelCurves = 5;
-
   // curves for sensitivity 1..5
   CurveSegment point_curves_[kMaxAccelCurves][kMaxCurveSegs];
   CurveSegment old_mouse_point_curves_[kMaxAccelCurves][kMaxCurveSegs];
@@ -165,6 +189,18 @@ class AccelFilterInterpreter : public FilterInterpreter {
   // Note: there is no mouse_custom_scroll_ b/c mouse wheel accel is
   // handled in the MouseInterpreter class.
 
+  // All of the curves above, compiled. The custom ones are recompiled when
+  // their property is written.
+  CompiledCurve compiled_point_curves_[kMaxAccelCurves];
+  CompiledCurve compiled_old_mouse_point_curves_[kMaxAccelCurves];
+  CompiledCurve compiled_mouse_point_curves_[kMaxAccelCurves];
+  CompiledCurve compiled_scroll_curves_[kMaxAccelCurves];
+  CompiledCurve compiled_unaccel_point_curves_[kMaxAccelCurves];
+  CompiledCurve compiled_unaccel_mouse_curves_[kMaxAccelCurves];
+  CompiledCurve compiled_tp_custom_point_;
+  CompiledCurve compiled_tp_custom_scroll_;
+  CompiledCurve compiled_mouse_custom_point_;
+
   // See max* and min_reasonable_dt_ properties
   stime_t last_reasonable_dt_ = 0.05;
 
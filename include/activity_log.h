@@ -7,12 +7,16 @@
 
 #include "include/gestures.h"
 
+#include <memory>
 #include <string>
 #include <variant>
+#include <vector>
 
 #include <gtest/gtest.h>  // For FRIEND_TEST
 #include <json/value.h>
 
+#include "include/json_writer.h"
+
 // This should be set by build system:
 #ifndef VCSID
 #define VCSID "Unknown"
@@ -23,11 +27,22 @@
 
 namespace gestures {
 
+// Helper to std::visit an ActivityLog::Entry's details with lambdas.
+template <typename... V>
+struct Visitor : V... {
+  using V::operator()...;
+};
+// Explicit deduction guide (not needed as of C++20).
+template <typename... V>
+Visitor(V...) -> Visitor<V...>;
+
+class FlightRecorder;
 class PropRegistry;
 
 class ActivityLog {
   FRIEND_TEST(ActivityLogTest, SimpleTest);
   FRIEND_TEST(ActivityLogTest, WrapAroundTest);
+  FRIEND_TEST(ActivityLogTest, BinaryRoundTripTest);
   FRIEND_TEST(ActivityLogTest, VersionTest);
   FRIEND_TEST(ActivityLogTest, EncodePropChangeBoolTest);
   FRIEND_TEST(ActivityLogTest, EncodePropChangeDoubleTest);
@@ -118,6 +133,20 @@ class ActivityLog {
     stime_t skew;
     stime_t max_skew;
   };
+  // The state of the interpreter chain just before it handled the hardware
+  // state at |timestamp|, as saved by StateArchive::SaveCheckpoint()
+  struct CheckpointEntry {
+    stime_t timestamp;
+    std::string state;
+  };
+
+  // The parts of a binary log or a snapshot that aren't kept in an
+  // ActivityLog
+  struct BinaryInfo {
+    std::string interpreter_name;
+    std::string gestures_version;
+    Json::Value properties;
+  };
 
   struct Entry {
     std::variant<HardwareState,
@@ -133,7 +162,8 @@ class ActivityLog {
                  HandleTimerPost,
                  AccelGestureDebug,
                  TimestampGestureDebug,
-                 TimestampHardwareStateDebug> details;
+                 TimestampHardwareStateDebug,
+                 CheckpointEntry> details;
   };
 
   enum class EventDebug {
@@ -170,6 +200,7 @@ class ActivityLog {
   };
 
   explicit ActivityLog(PropRegistry* prop_reg);
+  ~ActivityLog();
   void SetHardwareProperties(const HardwareProperties& hwprops);
 
   // Log*() functions record an argument into the buffer
@@ -178,6 +209,7 @@ class ActivityLog {
   void LogCallbackRequest(stime_t when);
   void LogGesture(const Gesture& gesture);
   void LogPropChange(const PropChangeEntry& prop_change);
+  void LogCheckpoint(stime_t timestamp, const std::string& state);
 
   // Debug extensions for Log*()
   void LogGestureConsume(const std::string& name, const Gesture& gesture);
@@ -195,14 +227,60 @@ class ActivityLog {
   void LogDebugData(const T& debug_data) {
     Entry* entry = PushBack();
     entry->details = debug_data;
+    MaybeRecordTail();
   }
 
   // Dump allocates, and thus must not be called on a signal handler.
   void Dump(const char* filename);
+  // Writes the JSON that Encode() returns, with |interpreter_name| added
+  // unless it's nullptr, to |fd| or |filename|. Entries are streamed out one
+  // at a time, so no Json::Value tree of the whole log is built. Returns false
+  // on a write error.
+  bool WriteJson(int fd, const char* interpreter_name);
+  bool DumpJson(const char* filename, const char* interpreter_name);
   void Clear() { head_idx_ = size_ = 0; }
 
-  // Returns a JSON string representing all the state in the buffer
-  std::string Encode();
+  // Writes the buffer to |fd| in the binary format described in
+  // activity_log_binary.h. Records are streamed out through a small fixed
+  // buffer, so unlike Dump() this needs no memory proportional to the log.
+  // |interpreter_name| may be nullptr. Returns false on a write error.
+  bool WriteBinary(int fd, const char* interpreter_name);
+  bool DumpBinary(const char* filename, const char* interpreter_name);
+
+  // Replaces the hardware properties and entries with those of the binary log
+  // or flight recorder file in |data|, and stores the rest of it in |info|.
+  // Returns false if |data| isn't a valid binary log.
+  bool ReadBinary(const char* data, size_t size, BinaryInfo* info);
+
+  // Mirrors the entries other than checkpoints, from the ones already logged
+  // on, into a flight recorder file at |path| (see flight_recorder.h), which
+  // survives a crash of this process and can be read back with ReadBinary().
+  // Replaces any flight recorder already running. Returns false if the file
+  // can't be mapped.
+  bool StartFlightRecorder(const std::string& path,
+                           const char* interpreter_name);
+  void StopFlightRecorder();
+
+  // Encodes |entry| as a single binary record, without padding, into
+  // |buffer| and returns its size, or 0 if it doesn't fit. The record is
+  // named 0 if the entry has a name, which is stored in |name|, and kNoName
+  // otherwise.
+  static size_t EncodeRecord(const Entry& entry, char* buffer,
+                             size_t capacity, const std::string** name);
+
+  // Copies the entries, their fingers and the hardware properties into
+  // |snapshot|, and the library version and current property values into
+  // |info|. The snapshot doesn't refer to anything the log or its
+  // interpreters own, so snapshot->Encode(*info) may run on another thread
+  // while this log carries on. The snapshot reuses whatever memory it already
+  // has, so keeping one around makes this a copy of the live entries only.
+  void Snapshot(ActivityLog* snapshot, BinaryInfo* info);
+
+  // Returns a JSON string representing all the state in the buffer, with
+  // |interpreter_name| added unless it's nullptr
+  std::string Encode(const char* interpreter_name = nullptr);
+  // Same, with the metadata in |info| instead of this library's
+  std::string Encode(const BinaryInfo& info);
   void AddEncodeInfo(Json::Value* root);
   Json::Value EncodeCommonInfo();
   size_t size() const { return size_; }
@@ -347,6 +425,16 @@ class ActivityLog {
   static const char kKeyTimestampDebugSkew[];
   static const char kKeyTimestampDebugMaxSkew[];
 
+  // Checkpoints, and the index of where they are in the JSON, so that replay
+  // can start from the last one before a given time without parsing the
+  // entries before it
+  static const char kKeyCheckpoint[];
+  static const char kKeyCheckpointTimestamp[];
+  static const char kKeyCheckpointState[];
+  static const char kKeySeekIndex[];
+  static const char kKeySeekIndexOffset[];
+  static const char kKeySeekIndexTimestamp[];
+
  private:
   // Extends the tail of the buffer by one element and returns that new element.
   // This may cause an older element to be overwritten if the buffer is full.
@@ -354,6 +442,27 @@ class ActivityLog {
 
   size_t TailIdx() const { return (head_idx_ + size_ - 1) % kBufferSize; }
 
+  // Copies the newest entry to the flight recorder, if there is one.
+  void MaybeRecordTail() {
+    if (flight_recorder_)
+      RecordTail();
+  }
+  void RecordTail();
+
+  // Writes |entry| as a binary record with |writer|, one of the writers in
+  // activity_log_binary.cc.
+  template<typename Writer>
+  static void WriteRecord(Writer* writer, const Entry& entry);
+
+  // Points |hwstate|, which belongs to the newest entry, at that entry's slot
+  // in finger_states_, and copies its fingers there.
+  void CopyFingersToTail(HardwareState* hwstate);
+
+  static std::string GesturesVersion();
+  static void AddEncodeInfo(Json::Value* root,
+                            const std::string& gestures_version,
+                            const Json::Value& properties);
+
   // JSON-encoders for various types
   Json::Value EncodeHardwareProperties() const;
 
@@ -381,6 +490,41 @@ class ActivityLog {
   // Encode user-configurable properties
   Json::Value EncodePropRegistry();
 
+  // The time of a checkpoint entry, and the offset in the JSON from which
+  // ActivityReplay finds it as the next entry
+  struct SeekPoint {
+    stime_t timestamp;
+    size_t offset;
+  };
+
+  // Streaming versions of the encoders above, which write the same JSON
+  // straight to |writer|. |properties| replaces the values in prop_reg_ if
+  // it isn't nullptr.
+  void WriteJson(JsonWriter* writer, const char* interpreter_name,
+                 const std::string& gestures_version,
+                 const Json::Value* properties) const;
+  void StreamHardwareProperties(JsonWriter* writer) const;
+  // Also adds where each checkpoint entry starts to |seek_index|.
+  void StreamEntries(JsonWriter* writer,
+                     std::vector<SeekPoint>* seek_index) const;
+  static void StreamSeekIndex(JsonWriter* writer,
+                              const std::vector<SeekPoint>& seek_index);
+  void StreamPropRegistry(JsonWriter* writer) const;
+  static void StreamHardwareState(JsonWriter* writer,
+                                  const HardwareState& hwstate,
+                                  const char* type, const std::string* name);
+  static void StreamGesture(JsonWriter* writer, const Gesture& gesture,
+                            const char* type, const std::string* name);
+  static void StreamHandleTimer(JsonWriter* writer, const char* type,
+                                const std::string& name, stime_t now,
+                                const stime_t* timeout);
+  static void StreamPropChange(JsonWriter* writer,
+                               const PropChangeEntry& prop_change);
+  static void StreamGestureDebug(JsonWriter* writer,
+                                 const AccelGestureDebug& debug_data);
+  static void StreamHardwareStateDebug(
+      JsonWriter* writer, const TimestampHardwareStateDebug& debug_data);
+
 #ifdef GESTURES_LARGE_LOGGING_BUFFER
   static const size_t kBufferSize = 65536;
 #else
@@ -399,6 +543,12 @@ class ActivityLog {
 
   HardwareProperties hwprops_;
   PropRegistry* prop_reg_;
+
+  std::unique_ptr<FlightRecorder> flight_recorder_;
+  // What flight_recorder_ was started with, to start it again when the
+  // hardware properties change
+  std::string flight_recorder_path_;
+  std::string flight_recorder_interpreter_name_;
 };
 
 }  // namespace gestures
@@ -0,0 +1,265 @@
+// Copyright 2026 The ChromiumOS Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef GESTURES_ACTIVITY_LOG_BINARY_H_
+#define GESTURES_ACTIVITY_LOG_BINARY_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+// The binary ActivityLog format written by ActivityLog::WriteBinary(). It
+// holds the same information as the JSON that ActivityLog::Encode() returns,
+// but every entry is a fixed-size record, so it can be streamed straight out
+// of the ring buffer with no intermediate representation.
+//
+//   Header (16 bytes):
+//      8 bytes: Magic "GSACTLOG"
+//      4 bytes: Byte order mark, kByteOrderMark in the writer's byte order
+//      4 bytes: Integer format version (1)
+//   Records, each:
+//      8 bytes: RecordHeader
+//      RecordHeader::size bytes of payload, then zeros up to a multiple of 8
+//
+// Values are in the byte order of the host that wrote the file; readers
+// reject files whose byte order mark doesn't match their own.
+//
+// Strings (the interpreter names in debug entries and the names of changed
+// properties) are written once, as a kRecordName record that assigns them a
+// number, and referred to by that number in RecordHeader::name afterwards.
+// The log's metadata (hardware properties, interpreter name, library version
+// and property values) comes before the entries. Property values are written
+// as compact JSON, since they are few and only written once per log.
+//
+// Readers skip records of types they don't know, so new record types can be
+// added without bumping the version.
+
+namespace gestures {
+
+namespace activity_log_binary {
+
+static constexpr char kMagic[8] = { 'G', 'S', 'A', 'C', 'T', 'L', 'O', 'G' };
+static constexpr uint32_t kByteOrderMark = 0x01020304;
+static constexpr uint32_t kVersion = 1;
+
+// Value of RecordHeader::name for records without a name
+static constexpr uint16_t kNoName = 0xffff;
+
+enum RecordType : uint16_t {
+  // Metadata
+  kRecordHardwareProperties = 1,  // HardwarePropertiesRecord
+  kRecordInterpreterName,  // The string, not NUL-terminated
+  kRecordGesturesVersion,  // The string, not NUL-terminated
+  kRecordProperties,  // JSON object, as in the "properties" key
+  kRecordName,  // The string named by RecordHeader::name
+  // Entries
+  kRecordHardwareState = 16,  // HardwareStateRecord, FingerStateRecord[]
+  kRecordHardwareStatePre,  // Same, named
+  kRecordHardwareStatePost,  // Same, named
+  kRecordTimerCallback,  // TimeRecord
+  kRecordCallbackRequest,  // TimeRecord
+  kRecordGesture,  // GestureRecord
+  kRecordGestureConsume,  // GestureRecord, named
+  kRecordGestureProduce,  // GestureRecord, named
+  kRecordPropChange,  // PropChangeRecord, named
+  kRecordHandleTimerPre,  // HandleTimerRecord, named
+  kRecordHandleTimerPost,  // HandleTimerRecord, named
+  kRecordAccelGestureDebug,  // AccelGestureDebugRecord
+  kRecordTimestampGestureDebug,  // TimeRecord
+  kRecordTimestampHardwareStateDebug,  // TimestampHardwareStateDebugRecord
+  kRecordCheckpoint,  // TimeRecord, then the checkpoint's bytes
+};
+
+struct FileHeader {
+  char magic[8];
+  uint32_t byte_order_mark;
+  uint32_t version;
+};
+static_assert(sizeof(FileHeader) == 16);
+
+struct RecordHeader {
+  uint16_t type;  // RecordType
+  uint16_t name;  // Number of the name, or kNoName
+  uint32_t size;  // Payload bytes, not including padding
+};
+static_assert(sizeof(RecordHeader) == 8);
+
+enum HardwarePropertiesFlags : uint32_t {
+  kSupportsT5R2 = 1 << 0,
+  kSupportSemiMt = 1 << 1,
+  kIsButtonPad = 1 << 2,
+  kHasWheel = 1 << 3,
+  kWheelIsHiRes = 1 << 4,
+  kIsHapticPad = 1 << 5,
+  kReportsPressure = 1 << 6,
+};
+
+struct HardwarePropertiesRecord {
+  float left, top, right, bottom;
+  float res_x, res_y;
+  float orientation_minimum, orientation_maximum;
+  uint16_t max_finger_cnt, max_touch_cnt;
+  uint32_t flags;  // HardwarePropertiesFlags
+};
+static_assert(sizeof(HardwarePropertiesRecord) == 40);
+
+// Followed by finger_cnt FingerStateRecords
+struct HardwareStateRecord {
+  double timestamp;
+  double msc_timestamp;
+  int32_t buttons_down;
+  uint16_t finger_cnt;
+  uint16_t touch_cnt;
+  float rel_x, rel_y, rel_wheel, rel_wheel_hi_res, rel_hwheel;
+  uint32_t reserved;
+};
+static_assert(sizeof(HardwareStateRecord) == 48);
+
+struct FingerStateRecord {
+  float touch_major, touch_minor;
+  float width_major, width_minor;
+  float pressure;
+  float orientation;
+  float position_x, position_y;
+  int16_t tracking_id;
+  uint16_t tool_type;
+  uint32_t flags;
+};
+static_assert(sizeof(FingerStateRecord) == 40);
+
+struct TimeRecord {
+  double time;
+};
+static_assert(sizeof(TimeRecord) == 8);
+
+enum GestureFlags : uint32_t {
+  kScrollStopFling = 1 << 0,
+  kButtonsIsTap = 1 << 1,
+  kFlingState = 1 << 2,
+};
+
+// The details of every gesture type fit in a few floats and integers:
+//   Move, Scroll, Swipe, FourFingerSwipe: floats = dx, dy, ordinal_dx,
+//       ordinal_dy
+//   MouseWheel: floats = dx, dy; ints = tick_120ths_dx, tick_120ths_dy
+//   Pinch: floats = dz, ordinal_dz; ints = zoom_state
+//   ButtonsChange: ints = down, up
+//   Fling: floats = vx, vy, ordinal_vx, ordinal_vy
+//   Metrics: floats = data[0], data[1]; ints = type
+struct GestureRecord {
+  double start_time, end_time;
+  int32_t type;
+  uint32_t flags;  // GestureFlags
+  int32_t ints[2];
+  float floats[4];
+};
+static_assert(sizeof(GestureRecord) == 48);
+
+enum PropChangeType : uint32_t {
+  kPropChangeBool = 0,
+  kPropChangeDouble,
+  kPropChangeInt,
+  kPropChangeShort,
+};
+
+struct PropChangeRecord {
+  double value;
+  uint32_t type;  // PropChangeType
+  uint32_t reserved;
+};
+static_assert(sizeof(PropChangeRecord) == 16);
+
+struct HandleTimerRecord {
+  double now;
+  double timeout;
+  uint32_t timeout_is_present;
+  uint32_t reserved;
+};
+static_assert(sizeof(HandleTimerRecord) == 24);
+
+enum AccelGestureDebugFlags : uint32_t {
+  kNoAccelForGestureType = 1 << 0,
+  kNoAccelForSmallDt = 1 << 1,
+  kNoAccelForSmallSpeed = 1 << 2,
+  kNoAccelForBadGain = 1 << 3,
+  kDroppedGesture = 1 << 4,
+  kXYAreVelocity = 1 << 5,
+};
+
+struct AccelGestureDebugRecord {
+  uint32_t flags;  // AccelGestureDebugFlags
+  float x_scale, y_scale;
+  float dt;
+  float adjusted_dt;
+  float speed;
+  float smoothed_speed;
+  float gain_x, gain_y;
+  uint32_t reserved;
+};
+static_assert(sizeof(AccelGestureDebugRecord) == 40);
+
+enum TimestampHardwareStateDebugFlags : uint32_t {
+  kIsUsingFake = 1 << 0,
+  // was_first_or_backward if kIsUsingFake, else was_divergence_reset
+  kWasFirstOrBackwardOrDivergenceReset = 1 << 1,
+};
+
+// times[] holds prev_msc_timestamp_in and prev_msc_timestamp_out if
+// kIsUsingFake is set, and fake_timestamp_in, fake_timestamp_delta and
+// fake_timestamp_out otherwise.
+struct TimestampHardwareStateDebugRecord {
+  uint32_t flags;  // TimestampHardwareStateDebugFlags
+  uint32_t reserved;
+  double times[3];
+  double skew;
+  double max_skew;
+};
+static_assert(sizeof(TimestampHardwareStateDebugRecord) == 48);
+
+// Flight recorder files (see flight_recorder.h) hold the newest entries of
+// a log in a ring of fixed-size slots, each the size of the largest record
+// the log can have:
+//
+//   FlightRecorderHeader
+//   FlightRecorderHeader::slot_count slots of FlightRecorderHeader::slot_size
+//   bytes, each:
+//      FlightRecorderSlot
+//      FlightRecorderSlot::size bytes: RecordHeader and payload, unpadded
+//
+// Names are held in the slots rather than in kRecordName records, since the
+// record that defined a name could be overwritten: RecordHeader::name is 0
+// for a named record and kNoName otherwise. Slots are reused oldest first;
+// FlightRecorderSlot::sequence orders them. ActivityLog::ReadBinary() reads
+// flight recorder files too.
+
+static constexpr char kFlightRecorderMagic[8] =
+    { 'G', 'S', 'F', 'L', 'I', 'G', 'H', 'T' };
+static constexpr uint32_t kFlightRecorderVersion = 1;
+
+struct FlightRecorderHeader {
+  char magic[8];
+  uint32_t byte_order_mark;
+  uint32_t version;
+  uint32_t slot_size;  // Bytes, a multiple of 8
+  uint32_t slot_count;
+  HardwarePropertiesRecord hwprops;
+  char interpreter_name[32];  // NUL-padded
+  char gestures_version[64];  // NUL-padded
+};
+static_assert(sizeof(FlightRecorderHeader) == 160);
+
+struct FlightRecorderSlot {
+  // Position of the entry in the log, counting from 1. Zero while the slot
+  // is being written, so that entries cut short by a crash are dropped.
+  uint64_t sequence;
+  uint32_t size;  // Bytes of record that follow
+  uint32_t reserved;
+  char name[64];  // The record's name, if any, NUL-padded
+};
+static_assert(sizeof(FlightRecorderSlot) == 80);
+
+}  // namespace activity_log_binary
+
+}  // namespace gestures
+
+#endif  // GESTURES_ACTIVITY_LOG_BINARY_H_
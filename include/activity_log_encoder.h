@@ -0,0 +1,73 @@
+// Copyright 2026 The ChromiumOS Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef GESTURES_ACTIVITY_LOG_ENCODER_H_
+#define GESTURES_ACTIVITY_LOG_ENCODER_H_
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "include/activity_log.h"
+#include "include/gestures.h"
+#include "include/macros.h"
+
+namespace gestures {
+
+// Encodes ActivityLogs on a background thread, so that the thread feeding
+// the interpreters only pays for a snapshot of the log's entries and never
+// waits for the JSON to be produced.
+//
+// The worker thread is started by the first Encode(). Snapshots are recycled
+// once encoded, so after the first few requests a snapshot is a copy of the
+// live entries with no allocation beyond what the entries' strings need.
+class ActivityLogEncoder {
+ public:
+  ActivityLogEncoder();
+  // Encodes whatever is still queued, calling its callbacks, then stops the
+  // worker.
+  ~ActivityLogEncoder();
+
+  // Snapshots |log| and returns. The worker thread later calls |callback|
+  // with |client_data| and the JSON that log->Encode(interpreter_name) would
+  // have returned at the time of this call. Callbacks are called in the
+  // order of the requests.
+  void Encode(ActivityLog* log, const char* interpreter_name,
+              ActivityLogReadyFunction callback, void* client_data);
+
+  // Waits for every request made so far to finish. For tests.
+  void Wait();
+
+ private:
+  struct Request {
+    std::unique_ptr<ActivityLog> snapshot;
+    ActivityLog::BinaryInfo info;
+    ActivityLogReadyFunction callback;
+    void* client_data;
+  };
+
+  void Run();
+
+  std::mutex mutex_;
+  // Signalled when a request is queued or the worker should quit
+  std::condition_variable queued_;
+  // Signalled when the worker finishes a request
+  std::condition_variable done_;
+  std::deque<Request> requests_;
+  // Snapshots that have been encoded, ready to be reused
+  std::vector<std::unique_ptr<ActivityLog>> spare_snapshots_;
+  bool busy_;  // Whether the worker is encoding a request
+  bool quit_;
+  std::thread worker_;
+
+  DISALLOW_COPY_AND_ASSIGN(ActivityLogEncoder);
+};
+
+}  // namespace gestures
+
+#endif  // GESTURES_ACTIVITY_LOG_ENCODER_H_
@@ -9,7 +9,10 @@
 #include <string>
 #include <memory>
 #include <set>
+#include <utility>
+#include <vector>
 
+#include <json/reader.h>
 #include <json/value.h>
 
 #include "include/activity_log.h"
@@ -26,29 +29,73 @@ class PropRegistry;
 class ActivityReplay : public GestureConsumer {
  public:
   explicit ActivityReplay(PropRegistry* prop_reg);
+  ~ActivityReplay();
   // Returns true on success.
   bool Parse(const std::string& data);
   // An empty set means honor all properties
   bool Parse(const std::string& data, const std::set<std::string>& honor_props);
 
-  // If there is any unexpected behavior, replay continues, but EXPECT_*
-  // reports failure, otherwise no failure is reported.
+  // Maps the JSON log at |path| and applies its properties and hardware
+  // properties as Parse() does, but leaves its entries to be parsed one at a
+  // time by NextEntry() or Replay(). Nothing is kept of an entry once the
+  // next one is parsed, so logs of any length replay in full in bounded
+  // memory, unlike with Parse(), which keeps only as many entries as fit in
+  // log(). Returns true on success.
+  bool Open(const char* path, const std::set<std::string>& honor_props);
+  // Parses the next entry of the log opened by Open() into |entry|. The
+  // fingers of a hardware state stay valid until the next call. Returns false
+  // once there are no more entries, or if one can't be parsed, in which case
+  // stream_failed() returns true.
+  bool NextEntry(ActivityLog::Entry* entry);
+  bool stream_failed() const { return stream_failed_; }
+
+  // Makes the next Replay() start from the last checkpoint logged at or
+  // before |time|: the interpreter's state is restored from the checkpoint,
+  // and only the entries after it are replayed. A log opened by Open() is
+  // positioned through its seek index, without parsing the entries before
+  // the checkpoint. Returns false, leaving the position as it was, if there
+  // is no such checkpoint.
+  bool SeekToCheckpoint(stime_t time);
+
+  // Replays the entries of the log opened by Open() if there is one, and
+  // log() otherwise. If there is any unexpected behavior, replay continues,
+  // but EXPECT_* reports failure, otherwise no failure is reported.
   void Replay(Interpreter* interpreter, MetricsProperties* mprops);
+  // The number of failures the last Replay() reported
+  size_t failures() const { return failures_; }
 
   virtual void ConsumeGesture(const Gesture& gesture);
 
+  // The parsed log and hardware properties, for callers that drive an
+  // interpreter themselves rather than through Replay().
+  ActivityLog* log() { return &log_; }
+  const HardwareProperties& hwprops() const { return hwprops_; }
+  // The log's property values, by name, for callers that apply them to an
+  // interpreter other than through the PropRegistry passed in
+  const Json::Value& properties() const { return properties_; }
+
+  // Applies a logged property change to the registry. Returns true on
+  // success.
+  bool ReplayPropChange(const ActivityLog::PropChangeEntry& entry);
+
+  // Whether the logged value of the property |name| is left out when the
+  // log's properties are applied.
+  static bool IsIgnoredProperty(const char* name);
+
  private:
   // These return true on success
   bool ParseProperties(const Json::Value& dict,
                        const std::set<std::string>& honor_props);
   bool ParseHardwareProperties(const Json::Value& obj,
                                HardwareProperties* out_props);
-  bool ParseEntry(const Json::Value& entry);
-  bool ParseHardwareState(const Json::Value& entry);
+  // Parse*() functions for entries store the entry in |out|
+  bool ParseEntry(const Json::Value& entry, ActivityLog::Entry* out);
+  bool ParseHardwareState(const Json::Value& entry, ActivityLog::Entry* out);
   bool ParseFingerState(const Json::Value& entry, FingerState* out_fs);
-  bool ParseTimerCallback(const Json::Value& entry);
-  bool ParseCallbackRequest(const Json::Value& entry);
-  bool ParseGesture(const Json::Value& entry);
+  bool ParseTimerCallback(const Json::Value& entry, ActivityLog::Entry* out);
+  bool ParseCallbackRequest(const Json::Value& entry,
+                            ActivityLog::Entry* out);
+  bool ParseGesture(const Json::Value& entry, ActivityLog::Entry* out);
   bool ParseGestureMove(const Json::Value& entry, Gesture* out_gs);
   bool ParseGestureScroll(const Json::Value& entry, Gesture* out_gs);
   bool ParseGestureSwipe(const Json::Value& entry, Gesture* out_gs);
@@ -57,15 +104,53 @@ class ActivityReplay : public GestureConsumer {
   bool ParseGestureButtonsChange(const Json::Value& entry, Gesture* out_gs);
   bool ParseGestureFling(const Json::Value& entry, Gesture* out_gs);
   bool ParseGestureMetrics(const Json::Value& entry, Gesture* out_gs);
-  bool ParsePropChange(const Json::Value& entry);
+  bool ParsePropChange(const Json::Value& entry, ActivityLog::Entry* out);
+  bool ParseCheckpoint(const Json::Value& entry, ActivityLog::Entry* out);
+  bool ParseSeekIndex(const Json::Value& index);
+  // Applies the properties and hardware properties of a log
+  bool ParseHeader(const Json::Value& props_dict, bool has_props,
+                   const Json::Value& hwprops_dict,
+                   const std::set<std::string>& honor_props);
+  // Adds a parsed entry to log_
+  void AppendToLog(const ActivityLog::Entry& entry);
+  // Unmaps the log opened by Open(), if any
+  void Close();
 
-  bool ReplayPropChange(const ActivityLog::PropChangeEntry& entry);
+  void ReplayEntry(Interpreter* interpreter, const ActivityLog::Entry& entry,
+                   size_t idx, stime_t* last_timeout_req);
+
+  // Sanity check on the fingers of a logged hardware state
+  static const size_t kMaxFingers = 30;
 
   ActivityLog log_;
   HardwareProperties hwprops_;
+  Json::Value properties_;
   PropRegistry* prop_reg_;
   std::deque<Gesture> consumed_gestures_;
-  std::vector<std::shared_ptr<const std::string> > names_;
+  // Fingers of the hardware state parsed last
+  FingerState fingers_[kMaxFingers];
+
+  // The log opened by Open(), and the offset of its next entry
+  char* mapping_;
+  size_t mapping_size_;
+  size_t stream_pos_;
+  bool stream_failed_;
+  std::unique_ptr<Json::CharReader> entry_reader_;
+  Json::Value entry_json_;  // Reused for every entry
+  // The timestamps and offsets of the checkpoints in the log opened by
+  // Open(), from its seek index
+  std::vector<std::pair<stime_t, size_t>> seek_index_;
+
+  // Whether the log's properties were all applied, in which case the ones in
+  // a checkpoint are too
+  bool honor_all_props_;
+  // The checkpoint found by SeekToCheckpoint(), if any, and for a log parsed
+  // by Parse(), the index of the entry after it in log_
+  bool has_checkpoint_;
+  ActivityLog::CheckpointEntry checkpoint_;
+  size_t first_entry_;
+
+  size_t failures_;
 };
 
 }  // namespace gestures
@@ -0,0 +1,39 @@
+// Copyright 2026 The ChromiumOS Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef GESTURES_ALLOCATION_COUNTER_H_
+#define GESTURES_ALLOCATION_COUNTER_H_
+
+#include <stddef.h>
+
+// Counts heap allocations made through the global operator new/delete.
+// Counting only works in binaries that link src/allocation_counter.cc, which
+// replaces the global allocation functions; it is not part of libgestures.
+//
+// Usage:
+//   AllocationCounter counter;
+//   DoWork();
+//   EXPECT_EQ(0, counter.allocations());
+
+namespace gestures {
+
+class AllocationCounter {
+ public:
+  AllocationCounter() { Reset(); }
+
+  // Restarts counting from zero.
+  void Reset();
+
+  // Number of allocations/deallocations since construction or Reset().
+  size_t allocations() const;
+  size_t deallocations() const;
+
+ private:
+  size_t start_allocations_;
+  size_t start_deallocations_;
+};
+
+}  // namespace gestures
+
+#endif  // GESTURES_ALLOCATION_COUNTER_H_
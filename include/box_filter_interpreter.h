@@ -2,7 +2,6 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
-#include <map>
 #include <memory>
 #include <gtest/gtest.h>  // for FRIEND_TEST
 
@@ -11,6 +10,7 @@
 #include "include/gestures.h"
 #include "include/prop_registry.h"
 #include "include/tracer.h"
+#include "include/util.h"
 
 #ifndef GESTURES_BOX_FILTER_INTERPRETER_H_
 #define GESTURES_BOX_FILTER_INTERPRETER_H_
@@ -42,11 +42,13 @@ class BoxFilterInterpreter : public FilterInterpreter, public PropertyDelegate {
                        Tracer* tracer);
   virtual ~BoxFilterInterpreter() {}
 
+  virtual void ArchiveState(StateArchive* archive);
+
  protected:
   virtual void SyncInterpretImpl(HardwareState& hwstate, stime_t* timeout);
 
  private:
-  std::map<short, FingerState> previous_output_;
+  TrackingIdMap<FingerState> previous_output_;
 
   DoubleProperty box_width_;
   DoubleProperty box_height_;
@@ -2,7 +2,6 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
-#include <map>
 #include <memory>
 #include <gtest/gtest.h>  // for FRIEND_TEST
 
@@ -11,6 +10,7 @@
 #include "include/gestures.h"
 #include "include/prop_registry.h"
 #include "include/tracer.h"
+#include "include/util.h"
 
 #ifndef GESTURES_CLICK_WIGGLE_FILTER_INTERPRETER_H_
 #define GESTURES_CLICK_WIGGLE_FILTER_INTERPRETER_H_
@@ -46,6 +46,8 @@ class ClickWiggleFilterInterpreter : public FilterInterpreter {
                                Tracer* tracer);
   virtual ~ClickWiggleFilterInterpreter() {}
 
+  virtual void ArchiveState(StateArchive* archive);
+
  protected:
   virtual void SyncInterpretImpl(HardwareState& hwstate, stime_t* timeout);
 
@@ -53,7 +55,7 @@ class ClickWiggleFilterInterpreter : public FilterInterpreter {
   void UpdateClickWiggle(const HardwareState& hwstate);
   void SetWarpFlags(HardwareState& hwstate) const;
 
-  std::map<short, ClickWiggleRec> wiggle_recs_;
+  TrackingIdMap<ClickWiggleRec> wiggle_recs_;
 
   // last time a physical button up or down edge occurred
   stime_t button_edge_occurred_;
@@ -61,7 +63,7 @@ class ClickWiggleFilterInterpreter : public FilterInterpreter {
   // If there was just one finger on the pad when the button changed
   bool button_edge_with_one_finger_;
 
-  std::map<short, float> prev_pressure_;
+  TrackingIdMap<float> prev_pressure_;
 
   int prev_buttons_;
 
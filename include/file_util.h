@@ -17,6 +17,10 @@ namespace gestures {
 // components ('..').
 bool ReadFileToString(const char* path, std::string* contents);
 
+// Writes the given buffer to |fd|, retrying partial writes. Returns the number
+// of bytes written, or -1 on error.
+int WriteFileDescriptor(const int fd, const char* data, int size);
+
 // Writes the given buffer into the file, overwriting any data that was
 // previously there.  Returns the number of bytes written, or -1 on error.
 int WriteFile(const char* filename, const char* data, int size);
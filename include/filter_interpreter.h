@@ -25,12 +25,15 @@ class FilterInterpreter : public Interpreter, public GestureConsumer {
   FRIEND_TEST(FilterInterpreterTest, DeadlineSettingNextOnly);
   FRIEND_TEST(FilterInterpreterTest, DeadlineSettingLocalBeforeNext);
   FRIEND_TEST(FilterInterpreterTest, DeadlineSettingNextBeforeLocal);
+  FRIEND_TEST(FilterInterpreterTest, BypassInactiveFiltersTest);
  public:
   FilterInterpreter(PropRegistry* prop_reg,
                     Interpreter* next,
                     Tracer* tracer,
                     bool force_log_creation)
-      : Interpreter(prop_reg, tracer, force_log_creation) { next_.reset(next); }
+      : Interpreter(prop_reg, tracer, force_log_creation), route_(next) {
+    next_.reset(next);
+  }
   virtual ~FilterInterpreter() {}
 
   Json::Value EncodeCommonInfo();
@@ -42,6 +45,13 @@ class FilterInterpreter : public Interpreter, public GestureConsumer {
 
   virtual void ConsumeGesture(const Gesture& gesture);
 
+  virtual void ArchiveState(StateArchive* archive);
+
+  virtual Interpreter* ActiveInterpreter() {
+    return active_ || !route_ ? this : route_;
+  }
+  virtual void RouteChanged() { UpdateRoute(); }
+
  protected:
   virtual void SyncInterpretImpl(HardwareState& hwstate, stime_t* timeout);
   virtual void HandleTimerImpl(stime_t now, stime_t* timeout);
@@ -58,9 +68,49 @@ class FilterInterpreter : public Interpreter, public GestureConsumer {
   // interpreter or one further down the chain.
   bool ShouldCallNextTimer(stime_t local_deadline);
 
+  // Passes input and timer callbacks to next_, skipping over any filters
+  // after it that are inactive. These go through the virtual SyncInterpret()
+  // and HandleTimer(), unless a chain composed at compile time (see
+  // filter_pipeline.h) has bound direct calls to next_'s implementation.
+  void SyncInterpretNext(HardwareState& hwstate, stime_t* timeout) {
+    if (next_sync_interpret_)
+      next_sync_interpret_(next_.get(), hwstate, timeout);
+    else
+      route_->SyncInterpret(hwstate, timeout);
+  }
+  void HandleTimerNext(stime_t now, stime_t* timeout) {
+    if (next_handle_timer_)
+      next_handle_timer_(next_.get(), now, timeout);
+    else
+      route_->HandleTimer(now, timeout);
+  }
+
+  // Filters with settings in which they pass input and timer callbacks
+  // through unchanged, without updating any state, return false here when so
+  // configured. The filter before them then passes input straight to the
+  // filter after them. Such filters call UpdateRoute() when the settings
+  // change.
+  virtual bool IsActive() const { return true; }
+  // Finds the first active interpreter after this one, and tells the filter
+  // before this one if input for this one should now go somewhere else.
+  void UpdateRoute();
+
+  typedef void (*SyncInterpretFunction)(Interpreter* next,
+                                        HardwareState& hwstate,
+                                        stime_t* timeout);
+  typedef void (*HandleTimerFunction)(Interpreter* next, stime_t now,
+                                      stime_t* timeout);
+  SyncInterpretFunction next_sync_interpret_ = nullptr;
+  HandleTimerFunction next_handle_timer_ = nullptr;
+
   std::unique_ptr<Interpreter> next_;
 
  private:
+  // Where SyncInterpretNext() and HandleTimerNext() send input: the first
+  // active interpreter from next_ on
+  Interpreter* route_;
+  bool active_ = true;
+
   DISALLOW_COPY_AND_ASSIGN(FilterInterpreter);
 };
 }  // namespace gestures
@@ -0,0 +1,117 @@
+// Copyright 2026 The ChromiumOS Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef GESTURES_FILTER_PIPELINE_H_
+#define GESTURES_FILTER_PIPELINE_H_
+
+#include <type_traits>
+
+#include "include/filter_interpreter.h"
+#include "include/finger_metrics.h"
+#include "include/gestures.h"
+#include "include/interpreter.h"
+#include "include/prop_registry.h"
+#include "include/tracer.h"
+
+namespace gestures {
+
+// A chain of interpreters whose stages are fixed at compile time.
+//
+// PipelineStage<A, B, ..., Z>::Create() builds the same chain as creating Z,
+// then each filter up to A with new, each taking the one before it as next_.
+// Each stage is a final subclass of its interpreter, so a filter passes input
+// and timer callbacks to the next stage with a direct call to that stage's
+// SyncInterpretImpl() or HandleTimerImpl(), instead of through the virtual
+// SyncInterpret() and HandleTimer() of Interpreter.
+//
+// Inner stages skip the trace markers and event logging that those wrappers
+// add around each stage. Only the outermost stage, normally a
+// LoggingFilterInterpreter, has event logging enabled in a chain, and it is
+// called through the wrappers as usual.
+template<typename... Stages>
+class PipelineStage;
+
+namespace pipeline_internal {
+
+// Creates interpreter T, picking whichever of the constructor signatures used
+// by the interpreters T has.
+template<typename T>
+T* NewStage(PropRegistry* prop_reg, Interpreter* next, Tracer* tracer,
+            GestureInterpreterDeviceClass devclass) {
+  if constexpr (std::is_constructible_v<T, PropRegistry*, Interpreter*,
+                                        Tracer*,
+                                        GestureInterpreterDeviceClass>)
+    return new T(prop_reg, next, tracer, devclass);
+  else if constexpr (std::is_constructible_v<T, PropRegistry*, Interpreter*,
+                                             Tracer*>)
+    return new T(prop_reg, next, tracer);
+  else if constexpr (std::is_constructible_v<T, Interpreter*, Tracer*>)
+    return new T(next, tracer);
+  else
+    return new T(prop_reg, tracer);
+}
+
+}  // namespace pipeline_internal
+
+// The last stage of a chain, which produces gestures
+template<typename Stage>
+class PipelineStage<Stage> final : public Stage {
+ public:
+  using Stage::Stage;
+
+  static PipelineStage* Create(PropRegistry* prop_reg, Tracer* tracer,
+                               GestureInterpreterDeviceClass devclass) {
+    return pipeline_internal::NewStage<PipelineStage>(prop_reg, nullptr,
+                                                      tracer, devclass);
+  }
+
+  static void SyncInterpretStage(Interpreter* stage, HardwareState& hwstate,
+                                 stime_t* timeout) {
+    PipelineStage* self = static_cast<PipelineStage*>(stage);
+    if (self->own_metrics_)
+      self->own_metrics_->Update(hwstate);
+    self->Stage::SyncInterpretImpl(hwstate, timeout);
+  }
+
+  static void HandleTimerStage(Interpreter* stage, stime_t now,
+                               stime_t* timeout) {
+    static_cast<PipelineStage*>(stage)->Stage::HandleTimerImpl(now, timeout);
+  }
+};
+
+// A filter, followed by the rest of the chain
+template<typename Stage, typename... Rest>
+class PipelineStage<Stage, Rest...> final : public Stage {
+ public:
+  using Next = PipelineStage<Rest...>;
+
+  using Stage::Stage;
+
+  static PipelineStage* Create(PropRegistry* prop_reg, Tracer* tracer,
+                               GestureInterpreterDeviceClass devclass) {
+    Interpreter* next = Next::Create(prop_reg, tracer, devclass);
+    PipelineStage* stage = pipeline_internal::NewStage<PipelineStage>(
+        prop_reg, next, tracer, devclass);
+    stage->next_sync_interpret_ = &Next::SyncInterpretStage;
+    stage->next_handle_timer_ = &Next::HandleTimerStage;
+    return stage;
+  }
+
+  static void SyncInterpretStage(Interpreter* stage, HardwareState& hwstate,
+                                 stime_t* timeout) {
+    PipelineStage* self = static_cast<PipelineStage*>(stage);
+    if (self->own_metrics_)
+      self->own_metrics_->Update(hwstate);
+    self->Stage::SyncInterpretImpl(hwstate, timeout);
+  }
+
+  static void HandleTimerStage(Interpreter* stage, stime_t now,
+                               stime_t* timeout) {
+    static_cast<PipelineStage*>(stage)->Stage::HandleTimerImpl(now, timeout);
+  }
+};
+
+}  // namespace gestures
+
+#endif  // GESTURES_FILTER_PIPELINE_H_
@@ -0,0 +1,192 @@
+// Copyright 2026 The ChromiumOS Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef GESTURES_FINGER_MAP_H_
+#define GESTURES_FINGER_MAP_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <iterator>
+#include <utility>
+
+#include "include/macros.h"
+
+namespace gestures {
+
+class StateArchive;
+
+// Hands out small dense slot numbers for tracking ids, so that sets of
+// tracking ids that share a FingerSlots can be stored as bitmasks.
+// A slot stays assigned to its id until Retain() is called without it, so
+// the owner must make sure no FingerMap still has that slot's bit set.
+class FingerSlots {
+ public:
+  static constexpr size_t kMaxSlots = 64;
+
+  FingerSlots() : used_(0) {}
+
+  // Returns the slot for |id|, or kMaxSlots if it doesn't have one.
+  size_t Find(short id) const {
+    for (uint64_t bits = used_; bits; bits &= bits - 1) {
+      size_t slot = __builtin_ctzll(bits);
+      if (ids_[slot] == id)
+        return slot;
+    }
+    return kMaxSlots;
+  }
+
+  // Returns the slot for |id|, assigning a free one if needed. Returns
+  // kMaxSlots if all slots are taken.
+  size_t Assign(short id);
+
+  const short& IdAt(size_t slot) const { return ids_[slot]; }
+
+  // Frees every slot whose bit is not set in |in_use|.
+  void Retain(uint64_t in_use) { used_ &= in_use; }
+
+  void ArchiveState(StateArchive* archive);
+
+ private:
+  short ids_[kMaxSlots];
+  uint64_t used_;  // Bit n is set iff slot n is assigned
+  DISALLOW_COPY_AND_ASSIGN(FingerSlots);
+};
+
+// A set of tracking ids, stored as a bitmask of FingerSlots slots. The
+// interface mimicks the parts of std::set<short> ImmediateInterpreter uses,
+// and iteration visits ids in increasing order like std::set does.
+// When both operands share a FingerSlots, comparisons and set algebra are a
+// couple of word operations; otherwise they fall back to looking up ids one
+// at a time.
+class FingerMap {
+ public:
+  typedef short value_type;
+  typedef short key_type;
+
+  class const_iterator {
+   public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef short value_type;
+    typedef ptrdiff_t difference_type;
+    typedef const short* pointer;
+    typedef const short& reference;
+
+    const_iterator() : slots_(nullptr), remaining_(0), slot_(0) {}
+
+    reference operator*() const { return slots_->IdAt(slot_); }
+    pointer operator->() const { return &slots_->IdAt(slot_); }
+    const_iterator& operator++() {
+      remaining_ &= ~(1ULL << slot_);
+      slot_ = LowestIdSlot();
+      return *this;
+    }
+    const_iterator operator++(int) {
+      const_iterator ret = *this;
+      ++*this;
+      return ret;
+    }
+    bool operator==(const const_iterator& that) const {
+      return remaining_ == that.remaining_;
+    }
+    bool operator!=(const const_iterator& that) const {
+      return !(*this == that);
+    }
+
+   private:
+    friend class FingerMap;
+    // |remaining| is the bits of the ids not yet visited.
+    const_iterator(const FingerSlots* slots, uint64_t remaining)
+        : slots_(slots), remaining_(remaining), slot_(LowestIdSlot()) {}
+
+    size_t LowestIdSlot() const;
+
+    const FingerSlots* slots_;
+    uint64_t remaining_;
+    size_t slot_;  // Slot of the current id, if remaining_ != 0
+  };
+  typedef const_iterator iterator;
+
+  explicit FingerMap(FingerSlots* slots) : slots_(slots), bits_(0) {}
+
+  size_t size() const { return __builtin_popcountll(bits_); }
+  bool empty() const { return bits_ == 0; }
+
+  const_iterator begin() const { return const_iterator(slots_, bits_); }
+  const_iterator end() const { return const_iterator(slots_, 0); }
+
+  const_iterator find(short id) const;
+  size_t count(short id) const { return Bit(id) & bits_ ? 1 : 0; }
+
+  std::pair<iterator, bool> insert(short id);
+  template<typename InputIterator>
+  void insert(InputIterator first, InputIterator last) {
+    for (; first != last; ++first)
+      insert(*first);
+  }
+  // The hint is ignored; provided so std::inserter() works.
+  iterator insert(const_iterator hint, short id) {
+    return insert(id).first;
+  }
+
+  iterator erase(const_iterator it) {
+    uint64_t bit = 1ULL << it.slot_;
+    bits_ &= ~bit;
+    return const_iterator(slots_, it.remaining_ & ~bit);
+  }
+  size_t erase(short id) {
+    size_t ret = count(id);
+    bits_ &= ~Bit(id);
+    return ret;
+  }
+  void clear() { bits_ = 0; }
+
+  // The ids in either set.
+  FingerMap Union(const FingerMap& that) const {
+    if (that.slots_ != slots_)
+      return SlowUnion(that);
+    return FingerMap(slots_, bits_ | that.bits_);
+  }
+  // The ids in this set that aren't in |that|.
+  FingerMap Difference(const FingerMap& that) const {
+    if (that.slots_ != slots_)
+      return SlowDifference(that);
+    return FingerMap(slots_, bits_ & ~that.bits_);
+  }
+
+  bool operator==(const FingerMap& that) const {
+    if (that.slots_ != slots_)
+      return SlowEquals(that);
+    return bits_ == that.bits_;
+  }
+  bool operator!=(const FingerMap& that) const { return !(*this == that); }
+
+  FingerSlots* slots() const { return slots_; }
+  // One bit per slot of slots().
+  uint64_t bits() const { return bits_; }
+
+  // Saves or restores which ids are in the set. The slots are archived
+  // separately, by the owner of slots().
+  void ArchiveState(StateArchive* archive);
+
+ private:
+  FingerMap(FingerSlots* slots, uint64_t bits) : slots_(slots), bits_(bits) {}
+
+  // Returns the bit for |id|'s slot, or 0 if it has none.
+  uint64_t Bit(short id) const {
+    size_t slot = slots_->Find(id);
+    return slot == FingerSlots::kMaxSlots ? 0 : 1ULL << slot;
+  }
+
+  FingerMap SlowUnion(const FingerMap& that) const;
+  FingerMap SlowDifference(const FingerMap& that) const;
+  bool SlowEquals(const FingerMap& that) const;
+
+  FingerSlots* slots_;
+  uint64_t bits_;
+};
+
+}  // namespace gestures
+
+#endif  // GESTURES_FINGER_MAP_H_
@@ -31,6 +31,8 @@ class FingerMergeFilterInterpreter : public FilterInterpreter {
                                Tracer* tracer);
   virtual ~FingerMergeFilterInterpreter() {}
 
+  virtual void ArchiveState(StateArchive* archive);
+
  protected:
   virtual void SyncInterpretImpl(HardwareState& hwstate, stime_t* timeout);
 
@@ -13,6 +13,8 @@
 
 namespace gestures {
 
+class StateArchive;
+
 static const size_t kMaxFingers = 10;
 static const size_t kMaxGesturingFingers = 4;
 static const size_t kMaxTapFingers = 10;
@@ -46,6 +48,8 @@ struct Vector2 {
     return !(*this == that);
   }
 
+  void ArchiveState(StateArchive* archive);
+
   float x;
   float y;
 };
@@ -107,6 +111,8 @@ class FingerMetrics {
     return other.tracking_id() == tracking_id_;
   }
 
+  void ArchiveState(StateArchive* archive);
+
  private:
   short tracking_id_;
   Vector2 position_;
@@ -149,6 +155,8 @@ class Metrics {
   // Clear all finger information
   void Clear();
 
+  void ArchiveState(StateArchive* archive);
+
   // Set the origin timestamp for a particular finger for testing purposes.
   // Prefer calling Update with a whole HardwareState instead.
   // TODO(b/307933752): remove this method once its last usage (in
@@ -0,0 +1,58 @@
+// Copyright 2026 The ChromiumOS Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef GESTURES_FLIGHT_RECORDER_H_
+#define GESTURES_FLIGHT_RECORDER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+
+#include "include/activity_log.h"
+#include "include/activity_log_binary.h"
+#include "include/macros.h"
+
+namespace gestures {
+
+// Keeps a copy of the newest ActivityLog entries in a shared mapping of a
+// file, in the flight recorder format of activity_log_binary.h. Recording an
+// entry is a few stores into the mapping, with no system call, and the
+// kernel keeps the file up to date even if the process crashes or hangs, so
+// the moments before can be recovered offline with convert_activity_log.
+class FlightRecorder {
+ public:
+  // Creates |path|, replacing its contents, sized for |header|, which is
+  // written at its start, and maps it. Returns nullptr on failure.
+  static std::unique_ptr<FlightRecorder> Create(
+      const char* path,
+      const activity_log_binary::FlightRecorderHeader& header);
+  ~FlightRecorder();
+
+  // Copies |entry| over the oldest slot. Entries too big for a slot are
+  // dropped.
+  void Record(const ActivityLog::Entry& entry);
+
+  // Converts the flight recorder file in |data| to the binary log format,
+  // with its entries in order. Returns false if |data| isn't a valid flight
+  // recorder file.
+  static bool ToBinaryLog(const char* data, size_t size, std::string* out);
+
+ private:
+  FlightRecorder(char* mapping, size_t mapping_size, size_t slot_size,
+                 size_t slot_count);
+
+  char* mapping_;
+  size_t mapping_size_;
+  size_t slot_size_;
+  size_t slot_count_;
+  uint64_t sequence_;  // Of the last entry recorded
+
+  DISALLOW_COPY_AND_ASSIGN(FlightRecorder);
+};
+
+}  // namespace gestures
+
+#endif  // GESTURES_FLIGHT_RECORDER_H_
@@ -3,7 +3,6 @@
 // found in the LICENSE file.
 
 #include <memory>
-#include <set>
 #include <gtest/gtest.h>  // for FRIEND_TEST
 
 #include "include/filter_interpreter.h"
@@ -11,6 +10,7 @@
 #include "include/gestures.h"
 #include "include/prop_registry.h"
 #include "include/tracer.h"
+#include "include/util.h"
 
 #ifndef GESTURES_FLING_STOP_FILTER_INTERPRETER_H_
 #define GESTURES_FLING_STOP_FILTER_INTERPRETER_H_
@@ -32,6 +32,8 @@ class FlingStopFilterInterpreter : public FilterInterpreter {
                              GestureInterpreterDeviceClass devclass);
   virtual ~FlingStopFilterInterpreter() {}
 
+  virtual void ArchiveState(StateArchive* archive);
+
  protected:
   virtual void SyncInterpretImpl(HardwareState& hwstate, stime_t* timeout);
 
@@ -49,10 +51,10 @@ class FlingStopFilterInterpreter : public FilterInterpreter {
   bool already_extended_;
 
   // Which tracking id's were on the pad at the last fling
-  std::set<short> fingers_present_for_last_fling_;
+  TrackingIdSet fingers_present_for_last_fling_;
 
   // tracking id's of the last hardware state
-  std::set<short> fingers_of_last_hwstate_;
+  TrackingIdSet fingers_of_last_hwstate_;
 
   // touch_cnt from previously input HardwareState.
   short prev_touch_cnt_;
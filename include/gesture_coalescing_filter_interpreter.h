@@ -0,0 +1,66 @@
+// Copyright 2026 The ChromiumOS Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "include/filter_interpreter.h"
+#include "include/gestures.h"
+#include "include/prop_registry.h"
+#include "include/tracer.h"
+
+#ifndef GESTURES_GESTURE_COALESCING_FILTER_INTERPRETER_H_
+#define GESTURES_GESTURE_COALESCING_FILTER_INTERPRETER_H_
+
+namespace gestures {
+
+// This interpreter passes HardwareState unmodified to next_, and merges runs
+// of gestures that only report more motion into fewer, larger ones, so that
+// a client that only uses motion once per display frame doesn't have to take
+// a callback for each input frame.
+//
+// A move or scroll, or a pinch update, is held back. Following gestures of
+// the same type are merged into it: move and scroll deltas, including the
+// ordinal ones, are summed, and pinch scale factors are multiplied. The held
+// gesture is sent on when a gesture of any other type comes along (a button
+// change or a fling, for example, which is sent right after it), or once it
+// has been held for the maximum delay, measured from the end of the first
+// gesture merged into it.
+
+class GestureCoalescingFilterInterpreter : public FilterInterpreter,
+                                           public PropertyDelegate {
+ public:
+  // Takes ownership of |next|:
+  GestureCoalescingFilterInterpreter(PropRegistry* prop_reg, Interpreter* next,
+                                     Tracer* tracer);
+  virtual ~GestureCoalescingFilterInterpreter() {}
+
+  virtual void ConsumeGesture(const Gesture& gesture);
+
+  virtual void ArchiveState(StateArchive* archive);
+
+  virtual void BoolWasWritten(BoolProperty* prop);
+
+ protected:
+  virtual void SyncInterpretImpl(HardwareState& hwstate, stime_t* timeout);
+  virtual void HandleTimerImpl(stime_t now, stime_t* timeout);
+  virtual bool IsActive() const { return enabled_.val_; }
+
+ private:
+  // Merges |gesture| into held_ if they are compatible. Returns true if it
+  // did.
+  bool Merge(const Gesture& gesture);
+  // Sends on the held gesture, if any.
+  void Flush();
+
+  // The gesture being held back, or one of type kGestureTypeNull
+  Gesture held_;
+  // When held_ must be sent, or NO_DEADLINE if there is none
+  stime_t flush_deadline_;
+
+  BoolProperty enabled_;
+  // The longest a gesture may be held back, in seconds
+  DoubleProperty max_delay_;
+};
+
+}  // namespace gestures
+
+#endif  // GESTURES_GESTURE_COALESCING_FILTER_INTERPRETER_H_
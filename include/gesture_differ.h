@@ -0,0 +1,102 @@
+// Copyright 2026 The ChromiumOS Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef GESTURES_GESTURE_DIFFER_H_
+#define GESTURES_GESTURE_DIFFER_H_
+
+#include <stddef.h>
+
+#include <deque>
+#include <functional>
+#include <vector>
+
+#include "include/gestures.h"
+#include "include/macros.h"
+
+namespace gestures {
+
+// Aligns the gestures two pipelines produce for the same input, "a" being
+// the reference and "b" the one under test, and reports where they differ.
+//
+// Gestures are matched in the order they end: a gesture is paired with the
+// first not yet matched gesture of the same type from the other pipeline
+// that ends within the time tolerance of it. A gesture with no match is
+// missing (only a produced it) or extra (only b did). A matched pair whose
+// values differ by more than the tolerances is changed.
+//
+// Gestures are added as the pipelines produce them, and aligned once
+// Advance() says no gesture that could match them can still come, so only
+// a short window of each stream is kept however long the input is.
+class GestureDiffer {
+ public:
+  struct Tolerances {
+    // How far apart the end times of matched gestures may be
+    stime_t time = 0.01;
+    // For the dx/dy of moves, scrolls, wheels and swipes, and pinch dz
+    float motion = 0.01;
+    // For the vx/vy of flings
+    float fling = 1.0;
+  };
+
+  enum Kind { kMissing, kExtra, kChanged };
+
+  struct FieldDelta {
+    const char* field;
+    double a;
+    double b;
+  };
+
+  struct Diff {
+    Kind kind;
+    Gesture a;  // Null for kExtra
+    Gesture b;  // Null for kMissing
+    std::vector<FieldDelta> deltas;  // The fields out of tolerance
+  };
+
+  typedef std::function<void(const Diff& diff)> DiffCallback;
+
+  GestureDiffer(const Tolerances& tolerances, const DiffCallback& callback);
+
+  void AddA(const Gesture& gesture);
+  void AddB(const Gesture& gesture);
+  // Says that neither pipeline will produce a gesture ending before |time|,
+  // so gestures ending well before it can be aligned.
+  void Advance(stime_t time);
+  // Aligns every gesture still pending, once both pipelines are done.
+  void Finish();
+
+  size_t matched() const { return matched_; }
+  size_t missing() const { return missing_; }
+  size_t extra() const { return extra_; }
+  size_t changed() const { return changed_; }
+  // The largest differences seen between matched gestures
+  double max_motion_delta() const { return max_motion_delta_; }
+  double max_fling_delta() const { return max_fling_delta_; }
+
+ private:
+  // Aligns the earliest pending gesture if it ends before |limit|. Returns
+  // false if there was none.
+  bool AlignNext(stime_t limit);
+  void Compare(const Gesture& a, const Gesture& b);
+  void CompareField(const char* field, double a, double b, double tolerance,
+                    double* max_delta, Diff* diff);
+
+  Tolerances tolerances_;
+  DiffCallback callback_;
+  std::deque<Gesture> pending_a_;
+  std::deque<Gesture> pending_b_;
+
+  size_t matched_;
+  size_t missing_;
+  size_t extra_;
+  size_t changed_;
+  double max_motion_delta_;
+  double max_fling_delta_;
+
+  DISALLOW_COPY_AND_ASSIGN(GestureDiffer);
+};
+
+}  // namespace gestures
+
+#endif  // GESTURES_GESTURE_DIFFER_H_
@@ -660,6 +660,7 @@ typedef struct GesturesPropProvider {
 
 namespace gestures {
 
+class BoolProperty;
 class Interpreter;
 class IntProperty;
 class PropRegistry;
@@ -668,11 +669,19 @@ class Tracer;
 class GestureInterpreterConsumer;
 class MetricsProperties;
 
+// Called with the JSON-encoded activity log, on the thread that encoded it
+typedef void (*ActivityLogReadyFunction)(void* client_data,
+                                         const std::string& log);
+
 struct GestureInterpreter {
  public:
   explicit GestureInterpreter(int version);
   ~GestureInterpreter();
   void PushHardwareState(HardwareState* hwstate);
+  // Pushes |count| hardware states, in order. Timer callbacks that come due
+  // between them are made here, with the deadline as the time, and the timer
+  // is set once, after the last one.
+  void PushHardwareStates(HardwareState* hwstates, size_t count);
 
   void SetHardwareProperties(const HardwareProperties& hwprops);
 
@@ -694,7 +703,16 @@ struct GestureInterpreter {
   PropRegistry* prop_reg() const { return prop_reg_.get(); }
 
   std::string EncodeActivityLog();
+  // Same, but only a snapshot of the log is taken here. It is encoded on a
+  // background thread, which then calls |callback| with |client_data| and the
+  // log. Pending callbacks are called before the interpreter is deleted.
+  void EncodeActivityLogAsync(ActivityLogReadyFunction callback,
+                              void* client_data);
  private:
+  // Sets the timer to fire |timeout| after |now|, or cancels it if |timeout|
+  // is NO_DEADLINE.
+  void SetTimer(stime_t now, stime_t timeout);
+
   void InitializeTouchpad(void);
   void InitializeTouchpad2(void);
   void InitializeMouse(GestureInterpreterDeviceClass cls);
@@ -708,10 +726,15 @@ struct GestureInterpreter {
   std::unique_ptr<Interpreter> interpreter_;
   std::unique_ptr<MetricsProperties> mprops_;
   std::unique_ptr<IntProperty> stack_version_;
+  // Builds the touchpad chain from PipelineStage (see filter_pipeline.h)
+  // rather than one interpreter at a time.
+  std::unique_ptr<BoolProperty> static_pipeline_;
 
   GesturesTimerProvider* timer_provider_;
   void* timer_provider_data_;
   GesturesTimer* interpret_timer_;
+  // When the timer is set to fire, or NO_DEADLINE
+  stime_t timer_deadline_;
 
   LoggingFilterInterpreter* loggingFilter_;
   std::unique_ptr<GestureInterpreterConsumer> consumer_;
@@ -742,6 +765,14 @@ void GestureInterpreterSetHardwareProperties(GestureInterpreter*,
 void GestureInterpreterPushHardwareState(GestureInterpreter*,
                                          struct HardwareState*);
 
+// Pushes an array of hardware states that arrived together, for example
+// several evdev frames read at once. This is the same as pushing them one at
+// a time, with the timer firing between them whenever the interpreter asked
+// for it, except that the timer is only set once, after the last one.
+void GestureInterpreterPushHardwareStates(GestureInterpreter*,
+                                          struct HardwareState*,
+                                          size_t);
+
 void GestureInterpreterSetCallback(GestureInterpreter*,
                                    GestureReadyFunction,
                                    void*);
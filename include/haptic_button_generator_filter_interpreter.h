@@ -3,12 +3,12 @@
 // found in the LICENSE file.
 
 #include <gtest/gtest.h>  // for FRIEND_TEST
-#include <set>
 
 #include "include/filter_interpreter.h"
 #include "include/gestures.h"
 #include "include/prop_registry.h"
 #include "include/tracer.h"
+#include "include/util.h"
 
 #ifndef GESTURES_INCLUDE_HAPTIC_BUTTON_GENERATOR_FILTER_INTERPRETER_H_
 #define GESTURES_INCLUDE_HAPTIC_BUTTON_GENERATOR_FILTER_INTERPRETER_H_
@@ -35,17 +35,21 @@ class HapticButtonGeneratorFilterInterpreter : public FilterInterpreter {
                                                   Tracer* tracer);
   virtual ~HapticButtonGeneratorFilterInterpreter() {}
 
+  virtual void ArchiveState(StateArchive* archive);
+
   virtual void Initialize(const HardwareProperties* hwprops,
                           Metrics* metrics, MetricsProperties* mprops,
                           GestureConsumer* consumer) override;
  protected:
   virtual void SyncInterpretImpl(HardwareState& hwstate,
                                  stime_t* timeout) override;
+  virtual void HandleTimerImpl(stime_t now, stime_t *timeout) override;
+  // Only haptic touchpads need buttons generated.
+  virtual bool IsActive() const override { return is_haptic_pad_; }
 
  private:
   void ConsumeGesture(const Gesture& gesture) override;
   void HandleHardwareState(HardwareState& hwstate);
-  virtual void HandleTimerImpl(stime_t now, stime_t *timeout) override;
   void UpdatePalmState(const HardwareState& hwstate);
 
   static const size_t kMaxSensitivitySettings = 5;
@@ -56,7 +60,7 @@ class HapticButtonGeneratorFilterInterpreter : public FilterInterpreter {
   const double up_thresholds_[kMaxSensitivitySettings] =
       {80.0, 95.0, 105.0, 120.0, 135.0};
 
-  std::set<short> palms_;
+  TrackingIdSet palms_;
 
   // Scaling factor for release force [0.0-1.0]
   double release_suppress_factor_;
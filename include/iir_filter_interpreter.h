@@ -2,8 +2,6 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
-#include <map>
-
 #include <gtest/gtest.h>  // for FRIEND_TEST
 
 #include "include/filter_interpreter.h"
@@ -11,6 +9,7 @@
 #include "include/gestures.h"
 #include "include/prop_registry.h"
 #include "include/tracer.h"
+#include "include/util.h"
 
 #ifndef GESTURES_IIR_FILTER_INTERPRETER_H_
 #define GESTURES_IIR_FILTER_INTERPRETER_H_
@@ -72,6 +71,8 @@ class IirFilterInterpreter : public FilterInterpreter, public PropertyDelegate {
                        Tracer* tracer);
   virtual ~IirFilterInterpreter() {}
 
+  virtual void ArchiveState(StateArchive* archive);
+
  protected:
   virtual void SyncInterpretImpl(HardwareState& hwstate, stime_t* timeout);
 
@@ -84,7 +85,7 @@ class IirFilterInterpreter : public FilterInterpreter, public PropertyDelegate {
   bool using_iir_;
 
   // Sync state history information
-  std::map<short, IoHistory> histories_;
+  TrackingIdMap<IoHistory> histories_;
 
   // y[0] = b[0]*x[0] + b[1]*x[1] + b[2]*x[2] + b[3]*x[3]
   //        - (a[1]*y[1] + a[2]*y[2])
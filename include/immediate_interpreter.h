@@ -7,12 +7,14 @@
 
 #include <gtest/gtest.h>  // for FRIEND_TEST
 
+#include "include/finger_map.h"
 #include "include/finger_metrics.h"
 #include "include/gestures.h"
 #include "include/interpreter.h"
 #include "include/macros.h"
 #include "include/prop_registry.h"
 #include "include/tracer.h"
+#include "include/util.h"
 #include "include/vector.h"
 
 #ifndef GESTURES_IMMEDIATE_INTERPRETER_H_
@@ -20,8 +22,6 @@
 
 namespace gestures {
 
-typedef std::set<short> FingerMap;
-
 // This interpreter keeps some memory of the past and, for each incoming
 // frame of hardware state, immediately determines the gestures to the best
 // of its abilities.
@@ -40,9 +40,9 @@ class TapRecord {
         fingers_below_max_age_(true) {}
   void Update(const HardwareState& hwstate,
               const HardwareState& prev_hwstate,
-              const std::set<short>& added,
-              const std::set<short>& removed,
-              const std::set<short>& dead);
+              const FingerMap& added,
+              const FingerMap& removed,
+              const FingerMap& dead);
   void Clear();
 
   // if any gesturing fingers are moving
@@ -58,6 +58,8 @@ class TapRecord {
   // If any contact has met the minimum pressure threshold
   bool MinTapPressureMet() const;
   bool FingersBelowMaxAge() const;
+
+  void ArchiveState(StateArchive* archive);
  private:
   void NoteTouch(short the_id, const FingerState& fs);  // Adds to touched_
   void NoteRelease(short the_id);  // Adds to released_
@@ -104,6 +106,8 @@ class ScrollEventBuffer {
   // the buffer, from which speed can be computed.
   void GetSpeedSq(size_t num_events, float* dist_sq, float* dt) const;
 
+  void ArchiveState(StateArchive* archive);
+
  private:
   std::unique_ptr<ScrollEvent[]> buf_;
   size_t max_size_;
@@ -129,6 +133,10 @@ class HardwareStateBuffer {
   // Pops most recently pushed state
   void PopState();
 
+  // Saves or restores the states. Reset() must already have been called
+  // with the same finger count.
+  void ArchiveState(StateArchive* archive);
+
   const HardwareState& Get(size_t idx) const {
     return states_[(idx + newest_index_) % size_];
   }
@@ -202,6 +210,8 @@ class ScrollManager {
     stationary_start_positions_.clear();
   }
 
+  void ArchiveState(StateArchive* archive);
+
   // Set to true when a scroll or move is blocked b/c of high pressure
   // change or small movement. Cleared when a normal scroll or move
   // goes through.
@@ -383,6 +393,8 @@ class ImmediateInterpreter : public Interpreter, public PropertyDelegate {
   ImmediateInterpreter(PropRegistry* prop_reg, Tracer* tracer);
   virtual ~ImmediateInterpreter() {}
 
+  virtual void ArchiveState(StateArchive* archive);
+
  protected:
   virtual void SyncInterpretImpl(HardwareState& hwstate, stime_t* timeout);
 
@@ -613,8 +625,16 @@ class ImmediateInterpreter : public Interpreter, public PropertyDelegate {
 
   virtual void IntWasWritten(IntProperty* prop);
 
+  // Frees the slots of finger_slots_ that none of our FingerMap members use.
+  void ReleaseUnusedFingerSlots();
+
+  // Slot table shared by all of our FingerMaps, so that comparing and
+  // combining them is a matter of bitmask operations. Handing out a slot
+  // doesn't change the contents of any set, so const methods may do it.
+  mutable FingerSlots finger_slots_;
+
   // Fingers which are prohibited from ever tapping.
-  std::set<short> tap_dead_fingers_;
+  FingerMap tap_dead_fingers_;
 
   // Active gs fingers are the subset of gs_fingers that are actually performing
   // a gesture
@@ -631,7 +651,7 @@ class ImmediateInterpreter : public Interpreter, public PropertyDelegate {
   Gesture prev_result_;
 
   // Total distance travelled by a finger since its origin timestamp.
-  std::map<short, float> distance_walked_;
+  TrackingIdMap<float> distance_walked_;
 
   // Button data
   // Which button we are going to send/have sent for the physical btn press
@@ -651,7 +671,7 @@ class ImmediateInterpreter : public Interpreter, public PropertyDelegate {
   // When gesturing fingers move after change, we record the time.
   stime_t started_moving_time_;
   // Record which fingers have started moving already.
-  std::set<short> moving_;
+  FingerMap moving_;
 
   // When different fingers are gesturing, we record the time
   stime_t gs_changed_time_;
@@ -661,30 +681,30 @@ class ImmediateInterpreter : public Interpreter, public PropertyDelegate {
 
   // When fingers change, we keep track of where they started.
   // Map: Finger ID -> (x, y) coordinate
-  std::map<short, Point> start_positions_;
+  TrackingIdMap<Point> start_positions_;
 
   // Keep track of finger position from when three fingers began moving in the
   // same direction.
   // Map: Finger ID -> (x, y) coordinate
-  std::map<short, Point> three_finger_swipe_start_positions_;
+  TrackingIdMap<Point> three_finger_swipe_start_positions_;
 
   // Keep track of finger position from when four fingers began moving in the
   // same direction.
   // Map: Finger ID -> (x, y) coordinate
-  std::map<short, Point> four_finger_swipe_start_positions_;
+  TrackingIdMap<Point> four_finger_swipe_start_positions_;
 
   // We keep track of where each finger started when they touched.
   // Map: Finger ID -> (x, y) coordinate.
-  std::map<short, Point> origin_positions_;
+  TrackingIdMap<Point> origin_positions_;
 
   // tracking ids of known fingers that are not palms, nor thumbs.
-  std::set<short> pointing_;
+  FingerMap pointing_;
   // tracking ids of known non-palms. But might be thumbs.
-  std::set<short> fingers_;
+  FingerMap fingers_;
   // contacts believed to be thumbs, and when they were inserted into the map
-  std::map<short, stime_t> thumb_;
+  TrackingIdMap<stime_t> thumb_;
   // Timer of the evaluation period for contacts believed to be thumbs.
-  std::map<short, stime_t> thumb_eval_timer_;
+  TrackingIdMap<stime_t> thumb_eval_timer_;
 
   // once a moving finger is determined lock onto this one for cursor movement.
   short moving_finger_id_;
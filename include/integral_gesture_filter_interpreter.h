@@ -24,8 +24,13 @@ class IntegralGestureFilterInterpreter : public FilterInterpreter {
   explicit IntegralGestureFilterInterpreter(Interpreter* next, Tracer* tracer);
   virtual ~IntegralGestureFilterInterpreter() {}
 
- private:
+  virtual void ArchiveState(StateArchive* archive);
+
+ protected:
   virtual void SyncInterpretImpl(HardwareState& hwstate, stime_t* timeout);
+  virtual void HandleTimerImpl(stime_t now, stime_t *timeout);
+
+ private:
   virtual void ConsumeGesture(const Gesture& gesture);
 
  private:
@@ -36,7 +41,6 @@ class IntegralGestureFilterInterpreter : public FilterInterpreter {
   bool can_clear_remainders_;
 
   stime_t remainder_reset_deadline_;
-  virtual void HandleTimerImpl(stime_t now, stime_t *timeout);
 };
 
 }  // namespace gestures
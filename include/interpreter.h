@@ -25,10 +25,14 @@ class GestureConsumer {
  public:
   virtual ~GestureConsumer() {}
   virtual void ConsumeGesture(const Gesture& gesture) = 0;
+  // Called by the interpreter that produces gestures for this consumer when
+  // its ActiveInterpreter() changes.
+  virtual void RouteChanged() {}
 };
 
 class Metrics;
 class MetricsProperties;
+class StateArchive;
 
 // Interface for all interpreters. Interpreters currently are synchronous.
 // A synchronous interpreter will return  0 or 1 Gestures for each passed in
@@ -79,6 +83,16 @@ class Interpreter {
   virtual void ProduceGesture(const Gesture& gesture);
   const char* name() const { return name_; }
 
+  // Saves or restores the state this interpreter builds up from its inputs,
+  // and that of the rest of the chain. Overrides archive their parent class
+  // first. See StateArchive.
+  virtual void ArchiveState(StateArchive* archive);
+
+  // Returns the interpreter that input for this one should be passed to:
+  // this one, unless it's a filter that currently passes input through
+  // unchanged. See FilterInterpreter::IsActive().
+  virtual Interpreter* ActiveInterpreter() { return this; }
+
  protected:
   std::unique_ptr<ActivityLog> log_;
   GestureConsumer* consumer_;
@@ -104,15 +118,15 @@ class Interpreter {
   void EventDebugLoggingDisable(ActivityLog::EventDebug event);
   void EventDebugLoggingEnable(ActivityLog::EventDebug event);
 
-  void LogGestureConsume(const std::string& name, const Gesture& gesture);
-  void LogGestureProduce(const std::string& name, const Gesture& gesture);
-  void LogHardwareStatePre(const std::string& name,
-                           const HardwareState& hwstate);
-  void LogHardwareStatePost(const std::string& name,
-                            const HardwareState& hwstate);
-  void LogHandleTimerPre(const std::string& name,
+  // |name| is only turned into a std::string when debug logging is enabled,
+  // so these are free to call on every frame.
+  void LogGestureConsume(const char* name, const Gesture& gesture);
+  void LogGestureProduce(const char* name, const Gesture& gesture);
+  void LogHardwareStatePre(const char* name, const HardwareState& hwstate);
+  void LogHardwareStatePost(const char* name, const HardwareState& hwstate);
+  void LogHandleTimerPre(const char* name,
                          stime_t now, const stime_t* timeout);
-  void LogHandleTimerPost(const std::string& name,
+  void LogHandleTimerPost(const char* name,
                           stime_t now, const stime_t* timeout);
 
  private:
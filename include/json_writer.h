@@ -0,0 +1,153 @@
+// Copyright 2026 The ChromiumOS Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef GESTURES_JSON_WRITER_H_
+#define GESTURES_JSON_WRITER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+
+#include <json/value.h>
+
+#include "include/macros.h"
+
+namespace gestures {
+
+// Writes JSON a value at a time, without building a Json::Value first. The
+// output is byte for byte what Json::Value::toStyledString() returns for the
+// same document: tab indentation, " : " after keys, every non-empty array and
+// object spread over several lines, and numbers formatted like jsoncpp does.
+//
+// jsoncpp writes object members sorted by key. Object does that sorting;
+// callers of the lower-level BeginObject()/Key() must pass keys in order.
+class JsonWriter {
+ public:
+  // Collects the members of an object, and writes them sorted by key when
+  // End() is called. Keys and string values aren't copied, so they must stay
+  // valid until then.
+  class Object {
+   public:
+    typedef void (*WriteFunction)(JsonWriter* writer, const void* arg);
+
+    explicit Object(JsonWriter* writer) : writer_(writer), size_(0) {}
+
+    void Add(const char* key, bool value);
+    void Add(const char* key, int value);
+    void Add(const char* key, double value);
+    void Add(const char* key, const char* value);
+    void Add(const char* key, const std::string& value);
+    // |write| is called with |arg| to write the value, which may be an array
+    // or object, when its turn comes.
+    void Add(const char* key, WriteFunction write, const void* arg);
+
+    void End();
+
+   private:
+    static constexpr size_t kMaxMembers = 24;
+
+    enum class Type { kBool, kInt, kDouble, kString, kFunction };
+    struct Member {
+      const char* key;
+      Type type;
+      union {
+        bool bool_value;
+        int int_value;
+        double double_value;
+        struct {
+          const char* str;
+          size_t len;
+        } string_value;
+        struct {
+          WriteFunction write;
+          const void* arg;
+        } function_value;
+      };
+    };
+    Member* Push(const char* key, Type type);
+
+    JsonWriter* writer_;
+    Member members_[kMaxMembers];
+    size_t size_;
+  };
+
+  // Appends the JSON to |out|. Like the file descriptor version, output is
+  // buffered until Flush() or destruction.
+  explicit JsonWriter(std::string* out);
+  // Writes the JSON to |fd| through a fixed buffer.
+  explicit JsonWriter(int fd);
+  ~JsonWriter() { Flush(); }
+
+  // Writes out anything buffered. Returns false if any write to the file
+  // failed.
+  bool Flush();
+
+  // The number of bytes written so far, buffered or not. A value written
+  // next starts after this offset and any separator and indentation.
+  size_t offset() const { return flushed_ + used_; }
+
+  void Null();
+  void Bool(bool value);
+  void Int(int64_t value);
+  void UInt(uint64_t value);
+  void Double(double value);
+  void String(const char* str, size_t len);
+  void String(const std::string& str) { String(str.data(), str.size()); }
+  // Any value, e.g. a property value from Property::NewValue().
+  void Value(const Json::Value& value);
+
+  void BeginArray();
+  void EndArray();
+
+  void BeginObject();
+  // Must be called before each member's value, in sorted order
+  void Key(const char* key, size_t len);
+  void EndObject();
+
+  // Ends the document the way toStyledString() does.
+  void EndDocument() { Append("\n", 1); }
+
+ private:
+  static constexpr size_t kMaxDepth = 32;
+
+  // An array or object being written. Its opening bracket is only written
+  // with its first element or member, since empty ones are written as []
+  // or {} instead.
+  struct Scope {
+    bool is_array;
+    bool opened;
+  };
+
+  // Handle the separators and indentation before and after every value.
+  void BeginValue();
+  void EndValue() { indented_ = false; }
+  // Start the next element or member of the innermost scope
+  void NextItem();
+  void Push(bool is_array);
+  void Pop(char open, char close);
+  void NewLine();
+  void Append(const char* data, size_t len);
+  void AppendQuoted(const char* str, size_t len);
+
+  std::string* out_;
+  int fd_;
+  char buffer_[16384];
+  size_t used_;
+  size_t flushed_;
+  bool ok_;
+
+  Scope scopes_[kMaxDepth];
+  size_t depth_;
+  size_t indent_;  // Number of opened scopes
+  // Mirrors jsoncpp's indented_: whether the line was already started for
+  // the next value, so an opening bracket shouldn't start another.
+  bool indented_;
+
+  DISALLOW_COPY_AND_ASSIGN(JsonWriter);
+};
+
+}  // namespace gestures
+
+#endif  // GESTURES_JSON_WRITER_H_
@@ -3,9 +3,11 @@
 // found in the LICENSE file.
 
 #include <gtest/gtest.h>
+#include <memory>
 #include <string>
 
 #include "include/activity_log.h"
+#include "include/activity_log_encoder.h"
 #include "include/gestures.h"
 #include "include/filter_interpreter.h"
 #include "include/prop_registry.h"
@@ -21,6 +23,8 @@ namespace gestures {
 class LoggingFilterInterpreter : public FilterInterpreter,
                                  public PropertyDelegate {
   FRIEND_TEST(ActivityReplayTest, DISABLED_SimpleTest);
+  FRIEND_TEST(LoggingFilterInterpreterTest, BinaryDumpTest);
+  FRIEND_TEST(LoggingFilterInterpreterTest, EncodeAsyncTest);
   FRIEND_TEST(LoggingFilterInterpreterTest, LogResetHandlerTest);
  public:
   // Takes ownership of |next|:
@@ -28,10 +32,25 @@ class LoggingFilterInterpreter : public FilterInterpreter,
                            Tracer* tracer);
   virtual ~LoggingFilterInterpreter() {}
 
+  // Logs a checkpoint of the chain before |hwstate| when one is due, see
+  // checkpoint_interval_.
+  virtual void SyncInterpret(HardwareState& hwstate, stime_t* timeout);
+
   virtual void BoolWasWritten(BoolProperty* prop);
   virtual void IntWasWritten(IntProperty* prop);
+  virtual void StringWasWritten(StringProperty* prop);
 
   std::string EncodeActivityLog();
+  // Encodes the log on a background thread, see
+  // GestureInterpreter::EncodeActivityLogAsync().
+  void EncodeActivityLogAsync(ActivityLogReadyFunction callback,
+                              void* client_data);
+
+  // Whether |name| is one of the properties that control logging rather
+  // than gesture detection. Applying a recorded or checkpointed value of one
+  // would start or stop logging, dump or clear the log, or move the log
+  // files, so replay and checkpoint restore leave them alone.
+  static bool IsLoggingProperty(const char* name);
 
  private:
   void Dump(const char* filename);
@@ -42,11 +61,29 @@ class LoggingFilterInterpreter : public FilterInterpreter,
   // Reset the log by setting the property value.
   IntProperty logging_reset_;
   StringProperty log_location_;
+  // If true, logs are written in the binary format of activity_log_binary.h,
+  // which is much cheaper to produce. The convert_activity_log tool turns
+  // them back into JSON.
+  BoolProperty log_binary_;
+  // If not empty, the log's newest entries are kept in this file as they
+  // happen, so they outlive a crash. See flight_recorder.h.
+  StringProperty flight_recorder_path_;
+  // If positive, a checkpoint of the whole chain's state is logged before
+  // the first hardware state this many seconds after the last one, so that
+  // replay can start from the middle of the log. See state_archive.h.
+  DoubleProperty checkpoint_interval_;
 
   // This property is unused by this library, but we need a place to stick it.
   // If true, this device is an integrated touchpad, as opposed to an external
   // device.
   BoolProperty integrated_touchpad_;
+
+  PropRegistry* prop_reg_;
+  // When the last checkpoint was logged, or -1 if none has been
+  stime_t last_checkpoint_time_;
+
+  // Created by the first EncodeActivityLogAsync()
+  std::unique_ptr<ActivityLogEncoder> encoder_;
 };
 }  // namespace gestures
 
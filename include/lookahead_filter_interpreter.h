@@ -3,7 +3,6 @@
 // found in the LICENSE file.
 
 #include <algorithm>
-#include <map>
 #include <memory>
 
 #include <gtest/gtest.h>  // For FRIEND_TEST
@@ -12,6 +11,7 @@
 #include "include/finger_metrics.h"
 #include "include/gestures.h"
 #include "include/prop_registry.h"
+#include "include/ring_buffer.h"
 #include "include/tracer.h"
 #include "include/util.h"
 
@@ -41,6 +41,8 @@ class LookaheadFilterInterpreter : public FilterInterpreter {
                              Tracer* tracer);
   virtual ~LookaheadFilterInterpreter() {}
 
+  virtual void ArchiveState(StateArchive* archive);
+
  protected:
   virtual void SyncInterpretImpl(HardwareState& hwstate,
                                  stime_t* timeout);
@@ -54,15 +56,11 @@ class LookaheadFilterInterpreter : public FilterInterpreter {
  private:
   struct QState {
     QState();
-    explicit QState(unsigned short max_fingers);
-
-    // Deep copy of new_state to state_
-    void set_state(const HardwareState& new_state);
 
     HardwareState state_;
     unsigned short max_fingers_;
     std::unique_ptr<FingerState[]> fs_;
-    std::map<short, short> output_ids_;  // input tracking ids -> output
+    TrackingIdMap<short> output_ids_;  // input tracking ids -> output
 
     stime_t due_;
     bool completed_ = false;
@@ -108,7 +106,21 @@ class LookaheadFilterInterpreter : public FilterInterpreter {
 
   stime_t ExtraVariableDelay() const;
 
-  List<QState> queue_;
+  // Number of queue_ slots to preallocate: enough for the frames that can
+  // be waiting out the longest delay at a high report rate.
+  size_t QueueCapacity() const;
+
+  // Appends a node to queue_, growing it if it's full, and returns it with
+  // an empty state_. The node's output_ids_ may hold stale entries from the
+  // slot's previous use; callers must overwrite it.
+  QState& PushNode();
+
+  // Pending and recently completed frames. The slots, and the finger storage
+  // they own, are reused from frame to frame.
+  RingBuffer<QState> queue_;
+
+  // Scratch finger storage for handing a queued state to next_.
+  std::unique_ptr<FingerState[]> fs_copy_;
 
   // The last id assigned to a contact (part of drumroll suppression)
   short last_id_;
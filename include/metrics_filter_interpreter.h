@@ -9,6 +9,7 @@
 #include "include/finger_metrics.h"
 #include "include/gestures.h"
 #include "include/prop_registry.h"
+#include "include/ring_buffer.h"
 #include "include/tracer.h"
 #include "include/util.h"
 
@@ -35,6 +36,8 @@ class MetricsFilterInterpreter : public FilterInterpreter {
                            GestureInterpreterDeviceClass devclass);
   virtual ~MetricsFilterInterpreter() {}
 
+  virtual void ArchiveState(StateArchive* archive);
+
  protected:
   virtual void SyncInterpretImpl(HardwareState& hwstate, stime_t* timeout);
 
@@ -53,7 +56,7 @@ class MetricsFilterInterpreter : public FilterInterpreter {
 
   // struct for one finger's data of one frame.
   typedef State<FingerState, 3> MState;
-  typedef List<MState> FingerHistory;
+  typedef RingBuffer<MState> FingerHistory;
 
   // Push the new data into the buffer.
   void AddNewStateToBuffer(FingerHistory& history,
@@ -26,6 +26,8 @@ class MouseInterpreter : public Interpreter, public PropertyDelegate {
   MouseInterpreter(PropRegistry* prop_reg, Tracer* tracer);
   virtual ~MouseInterpreter() {};
 
+  virtual void ArchiveState(StateArchive* archive);
+
  protected:
   virtual void SyncInterpretImpl(HardwareState& hwstate, stime_t* timeout);
   // These functions interpret mouse events, which include button clicking and
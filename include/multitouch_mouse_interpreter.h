@@ -36,6 +36,8 @@ class MultitouchMouseInterpreter : public MouseInterpreter {
   MultitouchMouseInterpreter(PropRegistry* prop_reg, Tracer* tracer);
   virtual ~MultitouchMouseInterpreter() {}
 
+  virtual void ArchiveState(StateArchive* archive);
+
  protected:
   virtual void SyncInterpretImpl(HardwareState& hwstate, stime_t* timeout);
   virtual void Initialize(const HardwareProperties* hw_props,
@@ -52,6 +54,8 @@ class MultitouchMouseInterpreter : public MouseInterpreter {
   HardwareState prev_state_;
   ScrollEventBuffer scroll_buffer_;
 
+  // Slot table for prev_gs_fingers_ and gs_fingers_.
+  FingerSlots finger_slots_;
   FingerMap prev_gs_fingers_;
   FingerMap gs_fingers_;
 
@@ -0,0 +1,152 @@
+// Copyright 2026 The ChromiumOS Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef GESTURES_NON_LINEARITY_DATA_H_
+#define GESTURES_NON_LINEARITY_DATA_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <memory>
+
+#include "include/gestures.h"
+#include "include/macros.h"
+
+namespace gestures {
+
+// Non-linearity calibration data for NonLinearityFilterInterpreter: the
+// errors sampled over the cross product of three range arrays, and an index
+// over each range array for finding the cell around a finger.
+//
+// Instances are immutable. Load() keeps a process-wide cache of the files it
+// has loaded, so every interpreter that opens the same file shares a single
+// instance for as long as one of them holds it.
+//
+// Two file formats are accepted. The legacy format is described in
+// non_linearity_filter_interpreter.h. Its lengths are interleaved with the
+// doubles, so it is copied out of the file. Version 2 holds the same data
+// aligned so it can be used in place from a read-only mapping of the file:
+//
+//   Header (32 bytes):
+//      8 bytes: Magic "GSNLDAT\0"
+//      4 bytes: Integer format version (2)
+//      4 bytes: Integer header size, a multiple of 8 and at least 32
+//      4 bytes x 3: Integer lengths of the X, Y and P range arrays
+//      4 bytes: Reserved, 0
+//   Range arrays, X then Y then P (8 bytes per double)
+//   Error matrix, in the same layout as the legacy format
+//
+// All values are little endian. tools/convert_non_linearity_data.py
+// converts legacy files to version 2.
+class NonLinearityData {
+ public:
+  struct Error {
+    double x_error;
+    double y_error;
+  };
+
+  static constexpr char kMagic[8] = { 'G', 'S', 'N', 'L', 'D', 'A', 'T', 0 };
+  static constexpr uint32_t kVersion = 2;
+
+  // Most buckets the index over a range array may use
+  static constexpr size_t kMaxIndexBuckets = 256;
+
+  // Returns the data in the file at |path|, or nullptr if it can't be read or
+  // isn't valid.
+  static std::shared_ptr<const NonLinearityData> Load(const char* path);
+
+  ~NonLinearityData();
+
+  // Given a point (x, y, p) calculate the non-linearity error that needs to be
+  // compensated for at that point, by interpolating over the range arrays.
+  Error GetError(float finger_x, float finger_y, float finger_p) const;
+
+  // Correct the positions of |count| fingers, interpolating the same way as
+  // GetError()
+  void CorrectFingers(FingerState* fingers, size_t count) const;
+
+  // Whether the data was mapped and is used in place
+  bool mapped() const { return mapping_ != nullptr; }
+
+ private:
+  struct Bounds {
+    ssize_t lo;
+    ssize_t hi;
+  };
+  // Finds cells of a range array with arithmetic instead of a search. The
+  // range is cut into equal buckets, each knowing the cell its start is in,
+  // so a value is at most a few samples away from its cell.
+  struct RangeIndex {
+    // Finds the cell of the range array containing |value|, as FindBounds()
+    // does: the index of its lower sample point and how far |value| is along
+    // the cell, in [0, 1). Returns false if |value| is outside [origin, end),
+    // where no correction is made.
+    bool Locate(float value, size_t* index, float* frac) const;
+
+    const double* range;
+    size_t len;  // At least 2
+    double origin;  // First sample point
+    double end;  // Last sample point
+    double inv_width;  // 1 / width of a bucket
+    size_t buckets;
+    // The cell containing the start of each bucket
+    std::unique_ptr<uint32_t[]> first_cell;
+  };
+
+  NonLinearityData();
+
+  // Parse the file mapped at |bytes|
+  bool Parse(const char* bytes, size_t size);
+  bool ParseVersion2(const char* bytes, size_t size);
+  bool ParseLegacy(const char* bytes, size_t size);
+  // Point the range arrays and error matrix at |values|, which holds them
+  // back to back
+  void SetArrays(const double* values);
+
+  // The error readings are stored in a flattened matrix, this finds the 1d
+  // index corresponding to the point (x_index, y_index, p_index)
+  size_t ErrorIndex(size_t x_index, size_t y_index, size_t p_index) const;
+  // Find the two values in the range on either side of "value" to interpolate
+  static Bounds FindBounds(float value, const double* range, size_t len);
+  // Interpolate the sampled errors over the given cell of the range arrays
+  Error InterpolateError(float finger_x, float finger_y, float finger_p,
+                         const Bounds& x_bounds, const Bounds& y_bounds,
+                         const Bounds& p_bounds) const;
+  // Interpolate linearly between p1 and p2, according to percent_p1
+  static Error LinearInterpolate(const Error& p1, const Error& p2,
+                                 float percent_p1);
+  // Build the indexes over the range arrays
+  void BuildIndexes();
+  // Build the index over one range array. Returns false if the range isn't
+  // sorted or spans nothing.
+  static bool BuildIndex(const double* range, size_t len, RangeIndex* index);
+
+  // These three arrays define the points where the error was sampled.
+  // There is a reading in err_ for each point formed by the cross product
+  // of these arrays. They point into mapping_ or storage_.
+  const double* x_range_;
+  const double* y_range_;
+  const double* p_range_;
+  size_t x_range_len_, y_range_len_, p_range_len_;
+  // A flattened 3-d array holding the actual sampled error values
+  const Error* err_;
+
+  // The mapped file, if the data is used in place
+  void* mapping_;
+  size_t mapping_size_;
+  // The data copied out of the file, otherwise
+  std::unique_ptr<double[]> storage_;
+
+  // Indexes over the range arrays, valid if indexed_ is set. Otherwise
+  // CorrectFingers() uses GetError().
+  RangeIndex x_index_, y_index_, p_index_;
+  bool indexed_;
+
+  DISALLOW_COPY_AND_ASSIGN(NonLinearityData);
+};
+
+}  // namespace gestures
+
+#endif  // GESTURES_NON_LINEARITY_DATA_H_
@@ -6,6 +6,7 @@
 
 #include "include/filter_interpreter.h"
 #include "include/gestures.h"
+#include "include/non_linearity_data.h"
 #include "include/prop_registry.h"
 #include "include/tracer.h"
 
@@ -28,9 +29,10 @@ namespace gestures {
 // The data file consists of three "range" arrays which define which points
 // the error was sampled at, followed by a 3 dimensional array of those errors.
 // The error matrix will have an entry for each value in the cross product of
-// the three range arrays.
+// the three range arrays. The data is loaded by NonLinearityData, which also
+// accepts a version 2 format that can be mapped and used in place.
 //
-// File format:
+// Legacy file format:
 //      X Range Array
 //      Y Range Array
 //      P Range Array
@@ -47,59 +49,44 @@ namespace gestures {
 //          8 bytes: Double x error
 //          8 bytes: Double y error
 //
-// Currently, this only handles the situation where exactly 1 finger is on the
+// At load time each range array is indexed, so finding the cell around a
+// finger is mostly arithmetic instead of a search of the ranges.
+// Interpreters that load the same file share the data and the indexes.
+//
+// By default, this only handles the situation where exactly 1 finger is on the
 // touchpad at a time.  There may be interactions between multiple contacts
 // that this doesn't take into consideration, so it simply skips hwstates with
-// more than 1 finger.
+// more than 1 finger unless the multi-finger property is set.
 
-class NonLinearityFilterInterpreter : public FilterInterpreter {
+class NonLinearityFilterInterpreter : public FilterInterpreter,
+                                      public PropertyDelegate {
   FRIEND_TEST(NonLinearityFilterInterpreterTest, DisablingTest);
   FRIEND_TEST(NonLinearityFilterInterpreterTest, HWstateModificationTest);
   FRIEND_TEST(NonLinearityFilterInterpreterTest, HWstateNoChangesNeededTest);
+  FRIEND_TEST(NonLinearityFilterInterpreterTest, MultiFingerTest);
+  FRIEND_TEST(NonLinearityFilterInterpreterTest, SharedDataTest);
  public:
   NonLinearityFilterInterpreter(PropRegistry* prop_reg, Interpreter* next,
                            Tracer* tracer);
 
+  virtual void BoolWasWritten(BoolProperty* prop);
+  virtual void StringWasWritten(StringProperty* prop);
+
  protected:
   virtual void SyncInterpretImpl(HardwareState& hwstate, stime_t* timeout);
+  virtual bool IsActive() const { return enabled_.val_ && data_; }
 
  private:
-  struct Error {
-    double x_error;
-    double y_error;
-  };
-  struct Bounds {
-    ssize_t lo;
-    ssize_t hi;
-  };
-
-  // The error readings are stored in a flattened matrix, this finds the 1d
-  // index corresponding to the point (x_index, y_index, p_index)
-  unsigned int ErrorIndex(size_t x_index, size_t y_index, size_t p_index) const;
-  // Find the two values in the range on either side of "value" to interpolate
-  Bounds FindBounds(float value, const std::unique_ptr<double[]>& range,
-                           size_t len) const;
-  // Given a point (x, y, p) calculate the non-linearity error that needs to be
-  // compensated for at that point.
-  Error GetError(float finger_x, float finger_y, float finger_p) const;
-  // Interpolate linearly between p1 and p2, according to percent_p1
-  Error LinearInterpolate(const Error& p1, const Error& p2,
-                          float percent_p1) const;
-  // Load nonlinearity data from disk and parse it
+  // Load nonlinearity data from disk, or share it with other interpreters
+  // that already loaded it
   void LoadData();
-  // Parse only a range array from the binary data
-  bool LoadRange(std::unique_ptr<double[]>& arr, size_t& len, FILE* fd);
-  int ReadObject(void* buf, size_t object_size, FILE* fd);
 
-  // These three arrays define the points where the error was sampled.
-  // There is a reading in err_ for each point formed by the cross product
-  // of these arrays.
-  std::unique_ptr<double[]> x_range_, y_range_, p_range_;
-  size_t x_range_len_, y_range_len_, p_range_len_;
-  // A flattened 3-d array holding the actual sampled error values
-  std::unique_ptr<Error[]> err_;
+  // The loaded data, or nullptr if there is none
+  std::shared_ptr<const NonLinearityData> data_;
 
   BoolProperty enabled_;
+  // Also correct hwstates with more than 1 finger
+  BoolProperty multi_finger_enabled_;
   StringProperty data_location_;
 };
 
@@ -2,9 +2,6 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
-#include <map>
-#include <set>
-
 #include <gtest/gtest.h>  // for FRIEND_TEST
 
 #include "include/filter_interpreter.h"
@@ -12,6 +9,7 @@
 #include "include/gestures.h"
 #include "include/macros.h"
 #include "include/tracer.h"
+#include "include/util.h"
 
 #ifndef GESTURES_PALM_CLASSIFYING_FILTER_INTERPRETER_H_
 #define GESTURES_PALM_CLASSIFYING_FILTER_INTERPRETER_H_
@@ -36,13 +34,16 @@ class PalmClassifyingFilterInterpreter : public FilterInterpreter {
                                    Tracer* tracer);
   virtual ~PalmClassifyingFilterInterpreter() {}
 
+  virtual void ArchiveState(StateArchive* archive);
+
  protected:
   virtual void SyncInterpretImpl(HardwareState& hwstate, stime_t* timeout);
 
  private:
-  void FillOriginInfo(const HardwareState& hwstate);
+  // Prunes the records of departed contacts, adds records for new ones and
+  // updates the max pressure/width and distance travelled of the others.
+  void UpdateFingerRecords(const HardwareState& hwstate);
   void FillPrevInfo(const HardwareState& hwstate);
-  void FillMaxPressureWidthInfo(const HardwareState& hwstate);
 
   // Part of palm detection. Returns true if the finger indicated by
   // |finger_idx| is near another finger, which must not be a palm, in the
@@ -59,65 +60,72 @@ class PalmClassifyingFilterInterpreter : public FilterInterpreter {
   // Returns true iff fs represents a contact that is in the bottom area.
   bool FingerInBottomArea(const FingerState& fs);
 
-  // Updates *palm_, pointing_ below.
+  // Updates the palm and pointing bits of the records.
   void UpdatePalmState(const HardwareState& hwstate);
 
   // Updates the hwstate based on the local state.
   void UpdatePalmFlags(HardwareState& hwstate);
 
-  // Updates the distance travelled for each finger along +- x/y direction.
-  void UpdateDistanceInfo(const HardwareState& hwstate);
-
-  // Returns the length of time the contact has been on the pad. Returns -1
-  // on error.
-  stime_t FingerAge(short finger_id, stime_t now) const;
-
-  // Time when a contact arrived. Persists even when fingers change.
-  std::map<short, stime_t> origin_timestamps_;
-  // FingerStates from when a contact first arrived. Persists even when fingers
-  // change.
-  std::map<short, FingerState> origin_fingerstates_;
-
-  // FingerStates from the previous HardwareState.
-  std::map<short, FingerState> prev_fingerstates_;
-
-  // Max reported pressure for present fingers.
-  std::map<short, float> max_pressure_;
-
-  // Max reported width for present fingers.
-  std::map<short, float> max_width_;
-
-  // Accumulated distance travelled by each finger.
-  // _positive[0]  -->  positive direction along x axis
-  // _positive[1]  -->  positive direction along y axis
-  // _negative[0]  -->  negative direction along x axis
-  // _negative[1]  -->  negative direction along y axis
-  std::map<short, float> distance_positive_[2];
-  std::map<short, float> distance_negative_[2];
-
-  // Same fingers state. This state is accumulated as fingers remain the same
-  // and it's reset when fingers change.
-  std::set<short> palm_;  // tracking ids of known palms
-  // These contacts are a subset of palms_ which are marked as palms because
-  // they have a large contact size.
-  std::set<short> large_palm_;
-  // These contacts have moved significantly and shouldn't be considered
-  // stationary palms:
-  std::set<short> non_stationary_palm_;
-
   static const unsigned kPointCloseToFinger = 1;
   static const unsigned kPointNotInEdge = 2;
   static const unsigned kPointMoving = 4;
-  // tracking ids of known fingers that are not palms, along with the reason(s)
-  std::map<short, unsigned> pointing_;
-
-
-  // tracking ids that were ever close to other fingers.
-  std::set<short> was_near_other_fingers_;
-
-  // tracking ids that have ever travelled out of the palm envelope or bottom
-  // area.
-  std::set<short> fingers_not_in_edge_;
+  // A contact is pointing iff it has at least one of the reasons above.
+  static const unsigned kPointingMask =
+      kPointCloseToFinger | kPointNotInEdge | kPointMoving;
+  // Known palm.
+  static const unsigned kPalm = 8;
+  // Subset of kPalm which is marked as palm because of a large contact size.
+  static const unsigned kLargePalm = 16;
+  // Moved significantly and shouldn't be considered a stationary palm.
+  static const unsigned kNonStationaryPalm = 32;
+  // Was ever close to other fingers.
+  static const unsigned kWasNearOtherFingers = 64;
+  // Has ever travelled out of the palm envelope or bottom area.
+  static const unsigned kNotInEdge = 128;
+  // Was present in the previous HardwareState, so prev_fs is valid.
+  static const unsigned kHasPrev = 256;
+
+  // Everything we know about one present contact.
+  struct FingerRecord {
+    // Time when the contact arrived, and its FingerState at that time.
+    stime_t origin_timestamp;
+    FingerState origin_fs;
+    // FingerState from the previous HardwareState.
+    FingerState prev_fs;
+    // Max reported pressure and width.
+    float max_pressure;
+    float max_width;
+    // Accumulated distance travelled.
+    // distance_positive[0]  -->  positive direction along x axis
+    // distance_positive[1]  -->  positive direction along y axis
+    // distance_negative[0]  -->  negative direction along x axis
+    // distance_negative[1]  -->  negative direction along y axis
+    float distance_positive[2];
+    float distance_negative[2];
+    // The k* bits above. The palm and pointing bits are same fingers state:
+    // they accumulate as fingers remain the same.
+    unsigned flags;
+  };
+
+  // Returns the length of time the contact has been on the pad.
+  stime_t FingerAge(const FingerRecord& record, stime_t now) const {
+    return now - record.origin_timestamp;
+  }
+
+  bool FingerHasFlags(short finger_id, unsigned flags) const;
+  bool FingerIsPalm(short finger_id) const {
+    return FingerHasFlags(finger_id, kPalm);
+  }
+  bool FingerIsPointing(short finger_id) const {
+    return FingerHasFlags(finger_id, kPointingMask);
+  }
+
+  // One record per present contact, so each frame needs a single lookup per
+  // finger and the records are pruned in one pass.
+  TrackingIdMap<FingerRecord> records_;
+
+  // Number of contacts in the previous HardwareState.
+  size_t prev_finger_cnt_;
 
   // Previously input timestamp
   stime_t prev_time_;
@@ -67,6 +67,13 @@ class Property {
   virtual Json::Value NewValue() const = 0;
   // Returns true on success
   virtual bool SetValue(const Json::Value& value) = 0;
+  // Whether the property still has the value it was created with. Array
+  // properties, whose values are often filled in after they are created,
+  // don't know their default and never have it.
+  virtual bool IsDefault() const { return false; }
+  // Sets the value the property was created with. Returns false if the
+  // default isn't known.
+  virtual bool RestoreDefault() { return false; }
 
   static GesturesPropBool StaticHandleGesturesPropWillRead(void* data) {
     GesturesPropBool ret =
@@ -92,16 +99,24 @@ class Property {
 class BoolProperty : public Property {
  public:
   BoolProperty(PropRegistry* reg, const char* name, GesturesPropBool val)
-      : Property(reg, name), val_(val) {
+      : Property(reg, name), val_(val), default_(val) {
     if (parent_)
       parent_->Register(this);
   }
   virtual void CreatePropImpl();
   virtual Json::Value NewValue() const;
   virtual bool SetValue(const Json::Value& value);
+  virtual bool IsDefault() const { return val_ == default_; }
+  virtual bool RestoreDefault() {
+    val_ = default_;
+    return true;
+  }
   virtual void HandleGesturesPropWritten();
 
   GesturesPropBool val_;
+
+ private:
+  GesturesPropBool default_;
 };
 
 class BoolArrayProperty : public Property {
@@ -124,16 +139,24 @@ class BoolArrayProperty : public Property {
 class DoubleProperty : public Property {
  public:
   DoubleProperty(PropRegistry* reg, const char* name, double val)
-      : Property(reg, name), val_(val) {
+      : Property(reg, name), val_(val), default_(val) {
     if (parent_)
       parent_->Register(this);
   }
   virtual void CreatePropImpl();
   virtual Json::Value NewValue() const;
   virtual bool SetValue(const Json::Value& value);
+  virtual bool IsDefault() const { return val_ == default_; }
+  virtual bool RestoreDefault() {
+    val_ = default_;
+    return true;
+  }
   virtual void HandleGesturesPropWritten();
 
   double val_;
+
+ private:
+  double default_;
 };
 
 class DoubleArrayProperty : public Property {
@@ -156,16 +179,24 @@ class DoubleArrayProperty : public Property {
 class IntProperty : public Property {
  public:
   IntProperty(PropRegistry* reg, const char* name, int val)
-      : Property(reg, name), val_(val) {
+      : Property(reg, name), val_(val), default_(val) {
     if (parent_)
       parent_->Register(this);
   }
   virtual void CreatePropImpl();
   virtual Json::Value NewValue() const;
   virtual bool SetValue(const Json::Value& value);
+  virtual bool IsDefault() const { return val_ == default_; }
+  virtual bool RestoreDefault() {
+    val_ = default_;
+    return true;
+  }
   virtual void HandleGesturesPropWritten();
 
   int val_;
+
+ private:
+  int default_;
 };
 
 class IntArrayProperty : public Property {
@@ -188,17 +219,22 @@ class IntArrayProperty : public Property {
 class StringProperty : public Property {
  public:
   StringProperty(PropRegistry* reg, const char* name, const char* val)
-      : Property(reg, name), val_(val) {
+      : Property(reg, name), val_(val), default_(val) {
     if (parent_)
       parent_->Register(this);
   }
   virtual void CreatePropImpl();
   virtual Json::Value NewValue() const;
   virtual bool SetValue(const Json::Value& value);
+  virtual bool IsDefault() const { return default_ == val_; }
+  virtual bool RestoreDefault();
   virtual void HandleGesturesPropWritten();
 
   std::string parsed_val_;
   const char* val_;
+
+ private:
+  std::string default_;
 };
 
 class PropertyDelegate {
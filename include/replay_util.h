@@ -0,0 +1,35 @@
+// Copyright 2026 The ChromiumOS Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef GESTURES_REPLAY_UTIL_H_
+#define GESTURES_REPLAY_UTIL_H_
+
+#include <set>
+#include <string>
+#include <vector>
+
+// Helpers shared by the tools that replay logs.
+
+namespace gestures {
+
+// Parses a comma-separated --only_honor list of property names. Empty names
+// are dropped, so an empty list honors every property.
+std::set<std::string> ParseHonorProps(const std::string& only_honor);
+
+// Appends the regular files at or under |path| to |out|, searching
+// directories recursively. Paths that can't be read are reported on stderr
+// and skipped.
+void FindLogs(const std::string& path, std::vector<std::string>* out);
+
+// Seconds on the monotonic clock, for timing runs.
+double NowSeconds();
+
+// Whether library log messages are printed to stderr. They are dropped by
+// default: messages from many logs at once would be interleaved, and would
+// slow the run down and distort its timings.
+void SetVerboseLogging(bool verbose);
+
+}  // namespace gestures
+
+#endif  // GESTURES_REPLAY_UTIL_H_
@@ -0,0 +1,145 @@
+// Copyright 2026 The ChromiumOS Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef GESTURES_RING_BUFFER_H__
+#define GESTURES_RING_BUFFER_H__
+
+#include <stdlib.h>
+
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+namespace gestures {
+
+// A queue of elements in a circular array whose capacity is chosen at run
+// time. Slots are reused rather than constructed/destroyed, so a queue that
+// stays within its capacity never calls malloc/free:
+// - push_back() hands back the next free slot as-is, still holding whatever
+//   it held when it was last used. Callers must overwrite it, and may keep
+//   buffers that the element owns from one use to the next.
+// - pop_front()/pop_back()/clear() only adjust indices.
+// - Pushing onto a full buffer drops the front element, like a history.
+//   Callers that can't lose elements check full() and set_capacity() first.
+// Iterators and references are invalidated by set_capacity(). Otherwise,
+// they stay valid until their element is popped.
+template<typename Elem>
+class RingBuffer {
+ public:
+  template<typename Buffer, typename Value>
+  class Iterator {
+   public:
+    typedef std::bidirectional_iterator_tag iterator_category;
+    typedef Value value_type;
+    typedef ptrdiff_t difference_type;
+    typedef Value* pointer;
+    typedef Value& reference;
+
+    Iterator(Buffer* buffer, size_t index) : buffer_(buffer), index_(index) {}
+
+    Value& operator*() const { return buffer_->Slot(index_); }
+    Value* operator->() const { return &buffer_->Slot(index_); }
+    Iterator& operator++() {
+      ++index_;
+      return *this;
+    }
+    Iterator& operator--() {
+      --index_;
+      return *this;
+    }
+    bool operator==(const Iterator& that) const {
+      return index_ == that.index_;
+    }
+    bool operator!=(const Iterator& that) const {
+      return !(*this == that);
+    }
+
+   private:
+    Buffer* buffer_;
+    size_t index_;  // Offset from the front
+  };
+  typedef Iterator<RingBuffer<Elem>, Elem> iterator;
+  typedef Iterator<const RingBuffer<Elem>, const Elem> const_iterator;
+
+  RingBuffer() : capacity_(0), head_(0), size_(0) {}
+  explicit RingBuffer(size_t capacity) : RingBuffer() {
+    set_capacity(capacity);
+  }
+
+  size_t capacity() const { return capacity_; }
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  bool full() const { return size_ == capacity_; }
+
+  // Reallocates the slots. If there are more elements than |capacity|, only
+  // the newest ones are kept.
+  void set_capacity(size_t capacity) {
+    std::unique_ptr<Elem[]> buffer(new Elem[capacity]);
+    size_t keep = std::min(size_, capacity);
+    for (size_t i = 0; i < keep; i++)
+      buffer[i] = std::move(Slot(size_ - keep + i));
+    buffer_ = std::move(buffer);
+    capacity_ = capacity;
+    head_ = 0;
+    size_ = keep;
+  }
+
+  iterator begin() { return iterator(this, 0); }
+  iterator end() { return iterator(this, size_); }
+  const_iterator begin() const { return const_iterator(this, 0); }
+  const_iterator end() const { return const_iterator(this, size_); }
+
+  Elem& front() { return at(0); }
+  const Elem& front() const { return at(0); }
+  Elem& back() { return at(-1); }
+  const Elem& back() const { return at(-1); }
+
+  // Like List::at(): negative offsets count back from the end, so at(-1) is
+  // the newest element. Aborts on an invalid offset.
+  Elem& at(int offset) {
+    return Slot(Index(offset));
+  }
+  const Elem& at(int offset) const {
+    return Slot(Index(offset));
+  }
+
+  Elem& push_back() {
+    if (capacity_ == 0)
+      abort();
+    if (full())
+      pop_front();
+    ++size_;
+    return back();
+  }
+
+  void pop_front() {
+    head_ = (head_ + 1) % capacity_;
+    --size_;
+  }
+  void pop_back() { --size_; }
+  void clear() { size_ = 0; }
+
+ private:
+  size_t Index(int offset) const {
+    size_t index = offset < 0 ? size_ + offset : offset;
+    if (index >= size_)
+      abort();
+    return index;
+  }
+
+  Elem& Slot(size_t index) { return buffer_[(head_ + index) % capacity_]; }
+  const Elem& Slot(size_t index) const {
+    return buffer_[(head_ + index) % capacity_];
+  }
+
+  std::unique_ptr<Elem[]> buffer_;
+  size_t capacity_;
+  size_t head_;  // Slot of the front element
+  size_t size_;
+};
+
+}  // namespace gestures
+
+#endif  // GESTURES_RING_BUFFER_H__
@@ -2,8 +2,6 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
-#include <map>
-
 #include <gtest/gtest.h>  // For FRIEND_TEST
 
 #include "include/filter_interpreter.h"
@@ -11,6 +9,7 @@
 #include "include/gestures.h"
 #include "include/prop_registry.h"
 #include "include/tracer.h"
+#include "include/util.h"
 
 #ifndef GESTURES_SENSOR_JUMP_FILTER_INTERPRETER_H_
 #define GESTURES_SENSOR_JUMP_FILTER_INTERPRETER_H_
@@ -34,13 +33,18 @@ class SensorJumpFilterInterpreter : public FilterInterpreter,
                               Tracer* tracer);
   virtual ~SensorJumpFilterInterpreter() {}
 
+  virtual void ArchiveState(StateArchive* archive);
+
+  virtual void BoolWasWritten(BoolProperty* prop);
+
  protected:
   virtual void SyncInterpretImpl(HardwareState& hwstate, stime_t* timeout);
+  virtual bool IsActive() const { return enabled_.val_; }
 
  private:
   // Fingers from the previous two SyncInterpret calls. previous_input_[0]
   // is the more recent.
-  std::map<short, FingerState> previous_input_[2];
+  TrackingIdMap<FingerState> previous_input_[2];
 
   // When a finger is flagged with a warp flag for the first time, we note it
   // here.
@@ -48,7 +52,7 @@ class SensorJumpFilterInterpreter : public FilterInterpreter,
   // first_flag_[1] for WARP_Y_NON_MOVE;
   // first_flag_[2] for WARP_X_MOVE;
   // first_flag_[3] for WARP_Y_MOVE.
-  std::set<short> first_flag_[4];
+  TrackingIdSet first_flag_[4];
 
   // Whether or not this filter is enabled. If disabled, it behaves as a
   // simple passthrough.
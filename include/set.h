@@ -0,0 +1,128 @@
+// Copyright 2026 The ChromiumOS Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef GESTURES_SET_H__
+#define GESTURES_SET_H__
+
+#include <algorithm>
+#include <initializer_list>
+#include <utility>
+
+#include "include/logging.h"
+
+namespace gestures {
+
+// The set class mimicks a subset of the std::set functionality while using
+// a fixed size of memory to avoid calls to malloc/free. Elements are kept
+// sorted in an inline array, so iteration order matches std::set.
+// The limitations of this class are:
+// - All insert/erase operations might invalidate existing iterators
+// - The ValueType type should be a POD type, since elements are moved with
+//   plain assignment.
+// - Inserting into a full set prints an error and leaves the set unchanged,
+//   instead of allocating more room.
+template<typename ValueType, size_t kMaxSize>
+class set {
+ public:
+  typedef ValueType value_type;
+  typedef ValueType key_type;
+  typedef const ValueType* iterator;
+  typedef const ValueType* const_iterator;
+  typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+  set() : size_(0) {}
+  set(std::initializer_list<ValueType> values) : size_(0) {
+    for (const ValueType& value : values)
+      insert(value);
+  }
+  set(const set<ValueType, kMaxSize>& that) {
+    *this = that;
+  }
+
+  size_t size() const { return size_; }
+  bool empty() const { return size() == 0; }
+  static size_t max_size() { return kMaxSize; }
+
+  const_iterator begin() const { return buffer_; }
+  const_iterator end() const { return &buffer_[size_]; }
+  const_reverse_iterator rbegin() const {
+    return const_reverse_iterator(end());
+  }
+  const_reverse_iterator rend() const {
+    return const_reverse_iterator(begin());
+  }
+
+  const_iterator find(const ValueType& value) const {
+    const_iterator it = std::lower_bound(begin(), end(), value);
+    return (it != end() && *it == value) ? it : end();
+  }
+  size_t count(const ValueType& value) const {
+    return find(value) != end();
+  }
+
+  // Inserts |value| if it's not already present. Returns an iterator to the
+  // element, and whether it was inserted.
+  std::pair<iterator, bool> insert(const ValueType& value) {
+    ValueType* it = std::lower_bound(buffer_, &buffer_[size_], value);
+    if (it != end() && *it == value)
+      return std::make_pair(it, false);
+    if (size_ == kMaxSize) {
+      Err("set::insert: out of space!");
+      return std::make_pair(end(), false);
+    }
+    std::copy_backward(it, &buffer_[size_], &buffer_[size_ + 1]);
+    *it = value;
+    ++size_;
+    return std::make_pair(it, true);
+  }
+
+  template<typename InputIterator>
+  void insert(InputIterator first, InputIterator last) {
+    for (; first != last; ++first)
+      insert(*first);
+  }
+
+  // The hint is ignored; provided so std::inserter() works.
+  iterator insert(const_iterator hint, const ValueType& value) {
+    return insert(value).first;
+  }
+
+  iterator erase(const_iterator it) {
+    ValueType* pos = &buffer_[it - buffer_];
+    std::copy(pos + 1, &buffer_[size_], pos);
+    --size_;
+    return pos;
+  }
+
+  size_t erase(const ValueType& value) {
+    const_iterator it = find(value);
+    if (it == end())
+      return 0;
+    erase(it);
+    return 1;
+  }
+
+  void clear() { size_ = 0; }
+
+  set<ValueType, kMaxSize>& operator=(const set<ValueType, kMaxSize>& that) {
+    size_ = that.size_;
+    std::copy(that.begin(), that.end(), buffer_);
+    return *this;
+  }
+
+  bool operator==(const set<ValueType, kMaxSize>& that) const {
+    return size_ == that.size_ && std::equal(begin(), end(), that.begin());
+  }
+  bool operator!=(const set<ValueType, kMaxSize>& that) const {
+    return !(*this == that);
+  }
+
+ private:
+  ValueType buffer_[kMaxSize];
+  size_t size_;
+};
+
+}  // namespace gestures
+
+#endif  // GESTURES_SET_H__
@@ -44,7 +44,8 @@ struct MergedContact {
   short output_id;
 };
 
-class SplitCorrectingFilterInterpreter : public FilterInterpreter {
+class SplitCorrectingFilterInterpreter : public FilterInterpreter,
+                                         public PropertyDelegate {
   FRIEND_TEST(SplitCorrectingFilterInterpreterTest, DistFromPointToLineTest);
  public:
   // Takes ownership of |next|:
@@ -52,10 +53,18 @@ class SplitCorrectingFilterInterpreter : public FilterInterpreter {
                                    Tracer* tracer);
   virtual ~SplitCorrectingFilterInterpreter() {}
 
-  void Enable() { enabled_.val_ = 1; }
+  virtual void ArchiveState(StateArchive* archive);
+
+  void Enable() {
+    enabled_.val_ = 1;
+    UpdateRoute();
+  }
+
+  virtual void BoolWasWritten(BoolProperty* prop);
 
  protected:
   virtual void SyncInterpretImpl(HardwareState& hwstate, stime_t* timeout);
+  virtual bool IsActive() const { return enabled_.val_; }
 
  private:
   void RemoveMissingUnmergedContacts(const HardwareState& hwstate);
@@ -0,0 +1,254 @@
+// Copyright 2026 The ChromiumOS Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef GESTURES_STATE_ARCHIVE_H_
+#define GESTURES_STATE_ARCHIVE_H_
+
+#include <stddef.h>
+
+#include <map>
+#include <set>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "include/gestures.h"
+#include "include/macros.h"
+#include "include/ring_buffer.h"
+#include "include/set.h"
+#include "include/util.h"
+#include "include/vector.h"
+
+namespace gestures {
+
+class Interpreter;
+class PropRegistry;
+
+// Saves or restores the dynamic state of an interpreter chain, so that replay
+// can resume from the middle of a log instead of from its start.
+//
+// Archiving is symmetric: an object describes its state once, in an
+// ArchiveState(StateArchive*) member, and the same code either appends each
+// field to a byte string or overwrites each field from one, depending on
+// saving(). Fields are stored in their native binary form with no names or
+// padding, so a checkpoint is only meaningful to the same build of the
+// library, with the same chain of interpreters.
+//
+// Trivially copyable fields are copied as bytes. Classes that own memory or
+// hold pointers provide ArchiveState(), and the standard and fixed-size
+// containers used by the interpreters are handled here. Configuration that
+// is derived from properties or hardware properties is not archived; it is
+// expected to be recomputed when the properties are restored.
+class StateArchive {
+ public:
+  // Creates an archive that appends the state to |out|.
+  explicit StateArchive(std::string* out);
+  // Creates an archive that restores state from |size| bytes at |data|.
+  StateArchive(const char* data, size_t size);
+
+  bool saving() const { return out_ != nullptr; }
+  // False once restoring has run out of data or found a mismatch. Once
+  // failed, further calls leave the fields untouched.
+  bool ok() const { return ok_; }
+  void Fail() { ok_ = false; }
+  // When restoring, whether all of the data was consumed.
+  bool AtEnd() const { return pos_ == size_; }
+
+  // Saves or restores |size| raw bytes at |data|.
+  void Bytes(void* data, size_t size);
+
+  // Saves |tag|, or checks that the same tag was saved, failing if not. Used
+  // to detect data from a different chain of interpreters.
+  void Tag(const char* tag);
+
+  // Saves or restores an element count. When restoring, fails if the count
+  // can't possibly fit in the remaining data.
+  void Count(size_t* count);
+
+  // Classes with an ArchiveState() member archive themselves, even if they
+  // are trivially copyable, since they may hold pointers.
+  template<typename T>
+  void Archive(T* value) {
+    if constexpr (requires { value->ArchiveState(this); }) {
+      value->ArchiveState(this);
+    } else {
+      static_assert(std::is_trivially_copyable_v<T>,
+                    "Type needs an ArchiveState() member");
+      Bytes(value, sizeof(T));
+    }
+  }
+
+  // HardwareState points at its fingers, so it can't be copied as bytes.
+  // Use ArchiveHardwareState() instead.
+  void Archive(HardwareState* value) = delete;
+
+  // Saves or restores |hwstate|. When restoring, the fingers are copied into
+  // |fingers|, which has room for |max_fingers|, and hwstate->fingers is
+  // pointed at it.
+  void ArchiveHardwareState(HardwareState* hwstate, FingerState* fingers,
+                            size_t max_fingers);
+
+  template<typename T, size_t N>
+  void Archive(T (*array)[N]) {
+    for (T& elem : *array)
+      Archive(&elem);
+  }
+
+  void Archive(std::string* value);
+
+  template<typename T>
+  void Archive(std::vector<T>* value) {
+    size_t count = value->size();
+    Count(&count);
+    if (!saving() && ok())
+      value->resize(count);
+    for (T& elem : *value)
+      Archive(&elem);
+  }
+
+  template<typename Key, typename Value>
+  void Archive(std::map<Key, Value>* value) {
+    size_t count = value->size();
+    Count(&count);
+    if (saving()) {
+      for (auto& [key, elem] : *value) {
+        Key saved_key = key;
+        Archive(&saved_key);
+        Archive(&elem);
+      }
+      return;
+    }
+    value->clear();
+    for (size_t i = 0; i < count && ok(); i++) {
+      Key key{};
+      Archive(&key);
+      Archive(&(*value)[key]);
+    }
+  }
+
+  template<typename T>
+  void Archive(std::set<T>* value) {
+    size_t count = value->size();
+    Count(&count);
+    if (saving()) {
+      for (T elem : *value)
+        Archive(&elem);
+      return;
+    }
+    value->clear();
+    for (size_t i = 0; i < count && ok(); i++) {
+      T elem{};
+      Archive(&elem);
+      value->insert(elem);
+    }
+  }
+
+  template<typename Data>
+  void Archive(TrackingIdMap<Data>* value) {
+    size_t count = value->size();
+    Count(&count);
+    if (saving()) {
+      for (auto& [id, elem] : *value) {
+        short saved_id = id;
+        Archive(&saved_id);
+        Archive(&elem);
+      }
+      return;
+    }
+    value->clear();
+    for (size_t i = 0; i < count && ok(); i++) {
+      short id = 0;
+      Archive(&id);
+      Archive(&(*value)[id]);
+    }
+  }
+
+  template<typename T, size_t kMaxSize>
+  void Archive(set<T, kMaxSize>* value) {
+    size_t count = value->size();
+    Count(&count);
+    if (count > kMaxSize)
+      Fail();
+    if (saving()) {
+      for (T elem : *value)
+        Archive(&elem);
+      return;
+    }
+    value->clear();
+    for (size_t i = 0; i < count && ok(); i++) {
+      T elem{};
+      Archive(&elem);
+      value->insert(elem);
+    }
+  }
+
+  template<typename T, size_t kMaxSize>
+  void Archive(vector<T, kMaxSize>* value) {
+    size_t count = value->size();
+    Count(&count);
+    if (count > kMaxSize)
+      Fail();
+    if (!saving() && ok()) {
+      value->clear();
+      for (size_t i = 0; i < count; i++)
+        value->push_back(T());
+    }
+    for (T& elem : *value)
+      Archive(&elem);
+  }
+
+  template<typename Elem>
+  void Archive(RingBuffer<Elem>* value) {
+    size_t capacity = value->capacity();
+    size_t count = value->size();
+    Archive(&capacity);
+    Count(&count);
+    if (count > capacity)
+      Fail();
+    if (saving()) {
+      for (Elem& elem : *value)
+        Archive(&elem);
+      return;
+    }
+    if (!ok())
+      return;
+    if (capacity != value->capacity())
+      value->set_capacity(capacity);
+    value->clear();
+    for (size_t i = 0; i < count && ok(); i++)
+      Archive(&value->push_back());
+  }
+
+  // Appends a checkpoint of |interpreter|'s chain and the values of the
+  // properties in |prop_reg| that differ from their defaults to |out|. |time|
+  // is when the checkpoint is taken, and |deadline| is when the chain's
+  // pending timer is due, or NO_DEADLINE.
+  static void SaveCheckpoint(Interpreter* interpreter, PropRegistry* prop_reg,
+                             stime_t time, stime_t deadline,
+                             std::string* out);
+
+  // Restores a checkpoint made by SaveCheckpoint into a chain built the same
+  // way. Properties are restored first, so that configuration derived from
+  // them is updated, unless |prop_reg| is null; those left out of the
+  // checkpoint are set back to their defaults. Returns false, possibly
+  // after restoring part of the state, if the checkpoint doesn't match the
+  // chain.
+  static bool RestoreCheckpoint(const std::string& data,
+                                Interpreter* interpreter,
+                                PropRegistry* prop_reg,
+                                stime_t* time, stime_t* deadline);
+
+ private:
+  std::string* out_;
+  const char* data_;
+  size_t size_;
+  size_t pos_;
+  bool ok_;
+
+  DISALLOW_COPY_AND_ASSIGN(StateArchive);
+};
+
+}  // namespace gestures
+
+#endif  // GESTURES_STATE_ARCHIVE_H_
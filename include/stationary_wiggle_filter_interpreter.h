@@ -122,7 +122,8 @@ class FingerEnergyHistory {
   stime_t prev_;
 };
 
-class StationaryWiggleFilterInterpreter : public FilterInterpreter {
+class StationaryWiggleFilterInterpreter : public FilterInterpreter,
+                                          public PropertyDelegate {
   FRIEND_TEST(StationaryWiggleFilterInterpreterTest, SimpleTest);
 
  public:
@@ -132,8 +133,13 @@ class StationaryWiggleFilterInterpreter : public FilterInterpreter {
                                     Tracer* tracer);
   virtual ~StationaryWiggleFilterInterpreter() {}
 
+  virtual void ArchiveState(StateArchive* archive);
+
+  virtual void BoolWasWritten(BoolProperty* prop);
+
  protected:
   virtual void SyncInterpretImpl(HardwareState& hwstate, stime_t* timeout);
+  virtual bool IsActive() const { return enabled_.val_; }
 
  private:
   // Calculate signal energy from input data and update finger flag if
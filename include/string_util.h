@@ -25,6 +25,13 @@ void StringAppendV(std::string* dst, const char* format, va_list ap)
 // is for ASCII strings and only looks for ASCII whitespace.
 std::string TrimWhitespaceASCII(const std::string& input);
 
+// Encodes binary data as standard (RFC 4648) padded base64.
+std::string Base64Encode(const std::string& input);
+
+// Decodes padded base64 into |output|. Returns false on malformed input, in
+// which case |output| is left in an unspecified state.
+bool Base64Decode(const std::string& input, std::string* output);
+
 }  // namespace gestures
 
 #endif  // GESTURES_STRING_UTIL_H_
@@ -28,6 +28,8 @@ class StuckButtonInhibitorFilterInterpreter : public FilterInterpreter {
   virtual ~StuckButtonInhibitorFilterInterpreter() {}
   virtual void ConsumeGesture(const Gesture& gesture);
 
+  virtual void ArchiveState(StateArchive* archive);
+
  protected:
   virtual void SyncInterpretImpl(HardwareState& hwstate, stime_t* timeout);
 
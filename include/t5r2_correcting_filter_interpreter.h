@@ -33,6 +33,8 @@ class T5R2CorrectingFilterInterpreter : public FilterInterpreter {
                                   Tracer* tracer);
   virtual ~T5R2CorrectingFilterInterpreter() {}
 
+  virtual void ArchiveState(StateArchive* archive);
+
  protected:
   virtual void SyncInterpretImpl(HardwareState& hwstate, stime_t* timeout);
 
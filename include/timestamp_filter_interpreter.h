@@ -36,6 +36,8 @@ class TimestampFilterInterpreter : public FilterInterpreter {
                                       Tracer* tracer);
   virtual ~TimestampFilterInterpreter() {}
 
+  virtual void ArchiveState(StateArchive* archive);
+
  protected:
   virtual void SyncInterpretImpl(HardwareState& hwstate, stime_t* timeout);
   virtual void HandleTimerImpl(stime_t now, stime_t* timeout);
@@ -9,6 +9,7 @@
 #include "include/finger_metrics.h"
 #include "include/gestures.h"
 #include "include/prop_registry.h"
+#include "include/ring_buffer.h"
 #include "include/tracer.h"
 #include "include/util.h"
 
@@ -77,12 +78,15 @@ namespace gestures {
 
 class TrendClassifyingFilterInterpreter: public FilterInterpreter {
   FRIEND_TEST(TrendClassifyingFilterInterpreterTest, SimpleTest);
+  FRIEND_TEST(TrendClassifyingFilterInterpreterTest, IncrementalScoreTest);
 
 public:
   TrendClassifyingFilterInterpreter(PropRegistry* prop_reg, Interpreter* next,
                                     Tracer* tracer);
   virtual ~TrendClassifyingFilterInterpreter() {}
 
+  virtual void ArchiveState(StateArchive* archive);
+
 protected:
   virtual void SyncInterpretImpl(HardwareState& hwstate, stime_t* timeout);
 
@@ -151,7 +155,23 @@ private:
     }
   };
 
-  typedef List<KState> FingerHistory;
+  // Running sums over one axis of a finger's history, from which S and Var(S)
+  // are computed. See UpdateKTValuePair for how they are maintained.
+  struct KTotals {
+    int score;   // S = Σsum_i
+    int tie_n2;  // Σties_i
+    int tie_n3;  // Σ(ties_i * (ties_i - 1) / 2)
+  };
+
+  // One finger's last num_of_samples_ states, oldest first, and the totals
+  // of each axis over them. The delta axes leave out the oldest state, whose
+  // delta is relative to a state no longer in the history.
+  struct FingerHistory {
+    void ArchiveState(StateArchive* archive);
+
+    RingBuffer<KState> states;
+    KTotals totals[KState::n_axes_];
+  };
 
   // Trend types for internal use
   enum TrendType {
@@ -172,8 +192,7 @@ private:
   // Given a time-series (t1, d1), (t2, d2) .... (tn, dn), a naive
   // implementation to compute the Kendall's S-statistic as in (1) would take
   // O(n^2) time, which might be too much even for a moderate size of n. To
-  // speed it up, we save temp values sum_i and ties_i for each item and
-  // incrementally update them upon each new data point's arrival. For each
+  // speed it up, we save temp values sum_i and ties_i for each item. For each
   // item (ti, di), sum_i and ties_i stand for:
   //
   // sum_i = (# of concordant pairs w.r.t. (ti, di)) -
@@ -190,21 +209,37 @@ private:
   // C(ui, 3) =      Σ (ties_j * (ties_j - 1) / 2)
   //          j∈i-th ties group
   //
-  // The sum_i and ties_i can be updated in O(1) time for each item, thus
-  // reducing the total time complexity to compute S and Var(S) from O(n^2) to
-  // O(n).
-  inline void UpdateKTValuePair(KState::KAxis* past, KState::KAxis* current,
-      int* t_n2_sum, int* t_n3_sum) {
-    if (past->val < current->val)
-      past->sum++;
-    else if (past->val > current->val)
-      past->sum--;
-    else
-      past->ties++;
-    current->score += past->sum, (*t_n2_sum) += past->ties;
-    (*t_n3_sum) += ((past->ties * (past->ties - 1)) >> 1);
+  // A new item only changes sum_i and ties_i through its pairs with the
+  // items before it, and the oldest item takes its own sum_i and ties_i with
+  // it when it leaves the window, so the sums in KTotals are kept up to date
+  // with one comparison per item already in the window. S and Var(S) then
+  // cost O(n) per new item instead of O(n^2).
+  inline void UpdateKTValuePair(KState::KAxis* past,
+                                const KState::KAxis& current,
+                                KTotals* totals) {
+    if (past->val < current.val) {
+      past->sum++, totals->score++;
+    } else if (past->val > current.val) {
+      past->sum--, totals->score--;
+    } else {
+      totals->tie_n3 += past->ties;
+      past->ties++, totals->tie_n2++;
+    }
+  }
+
+  // Take an item leaving the window out of the totals
+  inline void RemoveKTValue(const KState::KAxis& past, KTotals* totals) {
+    totals->score -= past.sum;
+    totals->tie_n2 -= past.ties;
+    totals->tie_n3 -= (past.ties * (past.ties - 1)) >> 1;
   }
 
+  // Evict the oldest state of the history
+  void PopOldestState(FingerHistory& history);
+
+  // Rebuild the totals of a history from its states
+  void RecomputeTotals(FingerHistory& history);
+
   // Compute the variance of the Kendall's S-statistic according to (2)
   double ComputeKTVariance(const int tie_n2, const int tie_n3,
       const size_t n_samples);
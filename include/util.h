@@ -5,15 +5,19 @@
 #ifndef GESTURES_UTIL_H_
 #define GESTURES_UTIL_H_
 
-#include <list>
+#include <algorithm>
 #include <map>
 #include <set>
+#include <utility>
 #include <vector>
 
 #include <math.h>
 
+#include "include/finger_metrics.h"
 #include "include/gestures.h"
 #include "include/interpreter.h"
+#include "include/logging.h"
+#include "include/set.h"
 
 namespace gestures {
 
@@ -62,31 +66,135 @@ bool MapContainsKey(const Map& the_map, const Key& the_key) {
   return the_map.find(the_key) != the_map.end();
 }
 
-// Removes any ids from the map that are not finger ids in hs.
+// Set of tracking ids, with room for kMaxFingers of them.
+typedef set<short, kMaxFingers> TrackingIdSet;
+
+// Map from tracking id to per-finger data, with room for kMaxFingers entries.
+// It mimicks the subset of std::map used by the filters, but keeps the
+// entries sorted by id in an inline array, so lookups don't chase pointers
+// and inserts never allocate. Inserting into a full map prints an error and
+// the new entry is dropped.
 template<typename Data>
-void RemoveMissingIdsFromMap(std::map<short, Data>* the_map,
-                             const HardwareState& hs) {
-  std::map<short, Data> removed;
-  for (const auto& [key, value] : *the_map) {
-    if (!hs.GetFingerState(key))
-      removed[key] = value;
+class TrackingIdMap {
+ public:
+  typedef short key_type;
+  typedef Data mapped_type;
+  typedef std::pair<short, Data> value_type;
+  typedef value_type* iterator;
+  typedef const value_type* const_iterator;
+
+  TrackingIdMap() : size_(0) {}
+
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  iterator begin() { return entries_; }
+  iterator end() { return &entries_[size_]; }
+  const_iterator begin() const { return entries_; }
+  const_iterator end() const { return &entries_[size_]; }
+
+  iterator find(short id) {
+    iterator it = LowerBound(id);
+    return (it != end() && it->first == id) ? it : end();
+  }
+  const_iterator find(short id) const {
+    const_iterator it = LowerBound(id);
+    return (it != end() && it->first == id) ? it : end();
+  }
+  size_t count(short id) const { return find(id) != end(); }
+
+  // Returns the entry for |id|, adding a value-initialized one if needed.
+  Data& operator[](short id) {
+    iterator it = LowerBound(id);
+    if (it != end() && it->first == id)
+      return it->second;
+    if (size_ == kMaxFingers) {
+      Err("TrackingIdMap: out of space for id %d", id);
+      overflow_ = value_type(id, Data());
+      return overflow_.second;
+    }
+    std::move_backward(it, end(), end() + 1);
+    *it = value_type(id, Data());
+    ++size_;
+    return it->second;
+  }
+
+  // Like std::map::at(), but prints an error rather than aborting if |id|
+  // is missing, returning a scratch entry or, for a const map, a shared
+  // value-initialized one.
+  Data& at(short id) {
+    iterator it = find(id);
+    if (it == end()) {
+      Err("TrackingIdMap::at: missing id %d", id);
+      overflow_ = value_type(id, Data());
+      return overflow_.second;
+    }
+    return it->second;
+  }
+  const Data& at(short id) const {
+    const_iterator it = find(id);
+    if (it == end()) {
+      Err("TrackingIdMap::at: missing id %d", id);
+      static const Data kMissing = Data();
+      return kMissing;
+    }
+    return it->second;
+  }
+
+  iterator erase(const_iterator it) {
+    iterator pos = begin() + (it - begin());
+    std::move(pos + 1, end(), pos);
+    --size_;
+    return pos;
+  }
+  size_t erase(short id) {
+    const_iterator it = find(id);
+    if (it == end())
+      return 0;
+    erase(it);
+    return 1;
+  }
+
+  void clear() { size_ = 0; }
+
+ private:
+  static bool KeyLess(const value_type& entry, short key) {
+    return entry.first < key;
+  }
+  iterator LowerBound(short id) {
+    return std::lower_bound(begin(), end(), id, KeyLess);
+  }
+  const_iterator LowerBound(short id) const {
+    return std::lower_bound(begin(), end(), id, KeyLess);
+  }
+
+  value_type entries_[kMaxFingers];
+  size_t size_;
+  // Handed out by the non-const accessors when the map is full or an id is
+  // missing.
+  value_type overflow_;
+};
+
+// Removes any ids from the map that are not finger ids in hs.
+template<typename Map>
+void RemoveMissingIdsFromMap(Map* the_map, const HardwareState& hs) {
+  for (auto it = the_map->begin(); it != the_map->end();) {
+    if (!hs.GetFingerState(it->first))
+      it = the_map->erase(it);
+    else
+      ++it;
   }
-  for (const auto& [key, value] : removed)
-    the_map->erase(key);
 }
 
 // Removes any ids from the set that are not finger ids in hs.
-static inline
-void RemoveMissingIdsFromSet(std::set<short>* the_set,
-                             const HardwareState& hs) {
-  std::vector<short> old_ids;
-  old_ids.reserve(the_set->size() + 1);
-  for (typename std::set<short>::const_iterator it = the_set->begin();
-       it != the_set->end(); ++it)
+template<typename Set>
+void RemoveMissingIdsFromSet(Set* the_set, const HardwareState& hs) {
+  for (auto it = the_set->begin(); it != the_set->end();) {
     if (!hs.GetFingerState(*it))
-      old_ids.push_back(*it);
-  for (auto id : old_ids)
-    the_set->erase(id);
+      it = the_set->erase(it);
+    else
+      ++it;
+  }
 }
 
 template<typename Set, typename Elt>
@@ -95,29 +203,6 @@ inline bool SetContainsValue(const Set& the_set,
   return the_set.find(elt) != the_set.end();
 }
 
-template<typename Elem>
-class List : public std::list<Elem> {
-public:
-  Elem& at(int offset) {
-    // Traverse to the appropriate offset
-    if (offset < 0) {
-      // negative offset is from end to begin
-      for (auto iter = this->rbegin(); iter != this->rend(); ++iter) {
-        if (++offset == 0)
-          return *iter;
-      }
-    } else {
-      // positive offset is from begin to end
-      for (auto iter = this->begin(); iter != this->end(); ++iter) {
-        if (offset-- == 0)
-          return *iter;
-      }
-    }
-    // Invalid offset
-    abort();
-  }
-};
-
 }  // namespace gestures
 
 #endif  // GESTURES_UTIL_H_
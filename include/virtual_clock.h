@@ -0,0 +1,97 @@
+// Copyright 2026 The ChromiumOS Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef GESTURES_VIRTUAL_CLOCK_H_
+#define GESTURES_VIRTUAL_CLOCK_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>  // For FRIEND_TEST
+
+#include "include/gestures.h"
+#include "include/macros.h"
+
+namespace gestures {
+
+// Drives a GestureInterpreter on simulated time. It is the interpreter's
+// timer provider, and rather than waiting for a timer to expire it keeps the
+// deadline, and calls the timer back, with the deadline as the time, once
+// the input being pushed reaches it. Time only moves when input is pushed or
+// a timer fires, so a raw input trace runs as fast as the pipeline can take
+// it, with HandleTimer() calls interleaved with the hardware states exactly
+// where the pipeline asked for them, and the same output every run.
+//
+// Hardware state timestamps are the clock: each push first fires the timers
+// due at or before its timestamp, in deadline order, then sets the time to
+// it, so that the delays the pipeline asks for are measured from it.
+class VirtualClock {
+ public:
+  // Becomes |gi|'s timer provider until destroyed, which must happen before
+  // |gi| is deleted.
+  explicit VirtualClock(GestureInterpreter* gi);
+  // For an interpreter driven through the C API, possibly from another build
+  // of the library: pass timer_provider() and this to
+  // GestureInterpreterSetTimerProvider(), call AdvanceTo() with the
+  // timestamp of each hardware state before pushing it, and delete the
+  // interpreter before this.
+  VirtualClock();
+  ~VirtualClock();
+
+  static GesturesTimerProvider* timer_provider() { return &kTimerProvider; }
+
+  // Fires the timers due by |hwstate|'s timestamp, then pushes it to the
+  // interpreter passed to the constructor.
+  void PushHardwareState(HardwareState* hwstate);
+  // Fires the timers due by |time|, then sets the time to it.
+  void AdvanceTo(stime_t time);
+  // Fires the timer with the earliest deadline, if that is at or before
+  // |limit|, setting the time to the deadline. Timers due at the same time
+  // fire in the order they were set. Returns true if a timer fired.
+  bool FireNextTimer(stime_t limit);
+  // Fires timers until none is set, as if the clock were left running after
+  // the last input.
+  void RunUntilIdle();
+
+  stime_t now() const { return now_; }
+  // The deadline of the next timer to fire, or NO_DEADLINE if none is set
+  stime_t NextDeadline() const;
+  // The number of timer callbacks made so far
+  size_t timer_callbacks() const { return timer_callbacks_; }
+
+ private:
+  FRIEND_TEST(VirtualClockTest, DeadlineOrderTest);
+
+  struct Timer {
+    bool set = false;
+    stime_t deadline = 0.0;
+    uint64_t order = 0;  // When it was set, to break ties between deadlines
+    GesturesTimerCallback callback = nullptr;
+    void* callback_data = nullptr;
+  };
+
+  Timer* NextTimer() const;
+
+  static GesturesTimer* CreateTimer(void* data);
+  static void SetTimer(void* data, GesturesTimer* timer, stime_t delay,
+                       GesturesTimerCallback callback, void* callback_data);
+  static void CancelTimer(void* data, GesturesTimer* timer);
+  static void FreeTimer(void* data, GesturesTimer* timer);
+  static GesturesTimerProvider kTimerProvider;
+
+  GestureInterpreter* gi_;
+  stime_t now_;
+  uint64_t next_order_;
+  size_t timer_callbacks_;
+  std::vector<std::unique_ptr<Timer>> timers_;
+
+  DISALLOW_COPY_AND_ASSIGN(VirtualClock);
+};
+
+}  // namespace gestures
+
+#endif  // GESTURES_VIRTUAL_CLOCK_H_
@@ -0,0 +1,59 @@
+// Copyright 2026 The ChromiumOS Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef GESTURES_WORK_STEALING_POOL_H_
+#define GESTURES_WORK_STEALING_POOL_H_
+
+#include <stddef.h>
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "include/macros.h"
+
+namespace gestures {
+
+// Runs numbered tasks on a fixed number of threads. Each thread has its own
+// queue of task numbers, which it takes from the back of; a thread whose
+// queue runs dry steals from the front of another's. Tasks that take much
+// longer than others, like replaying a long log, so don't hold up the
+// threads that were dealt short ones.
+class WorkStealingPool {
+ public:
+  // |threads| of 0 means one per core.
+  explicit WorkStealingPool(size_t threads);
+
+  size_t threads() const { return threads_; }
+
+  // Calls |task| with every number in [0, |count|), from the pool's threads,
+  // and returns once all the calls have returned. The calling thread is one
+  // of the pool's threads. |task| is also passed the number of the thread
+  // calling it, in [0, threads()).
+  void Run(size_t count,
+           const std::function<void(size_t task, size_t thread)>& task);
+
+ private:
+  struct Queue {
+    std::mutex mutex;
+    std::deque<size_t> tasks;
+  };
+
+  // Takes a task number for |thread|, from its own queue if it can. Returns
+  // false once every queue is empty.
+  bool Take(size_t thread, size_t* task);
+  void Work(size_t thread,
+            const std::function<void(size_t task, size_t thread)>& task);
+
+  size_t threads_;
+  std::vector<std::unique_ptr<Queue>> queues_;
+
+  DISALLOW_COPY_AND_ASSIGN(WorkStealingPool);
+};
+
+}  // namespace gestures
+
+#endif  // GESTURES_WORK_STEALING_POOL_H_
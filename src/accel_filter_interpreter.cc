@@ -12,6 +12,7 @@
 #include "include/interpreter.h"
 #include "include/logging.h"
 #include "include/macros.h"
+#include "include/state_archive.h"
 #include "include/tracer.h"
 
 namespace gestures {
@@ -158,6 +159,50 @@ AccelFilterInterpreter::AccelFilterInterpreter(PropRegistry* prop_reg,
     const float icept = y_at_border - slope * x_border;
     scroll_curves_[i][2] = CurveSegment(INFINITY, 0, slope, icept);
   }
+
+  for (size_t i = 0; i < kMaxAccelCurves; ++i) {
+    compiled_point_curves_[i].Compile(point_curves_[i], kMaxCurveSegs);
+    compiled_old_mouse_point_curves_[i].Compile(old_mouse_point_curves_[i],
+                                                kMaxCurveSegs);
+    compiled_mouse_point_curves_[i].Compile(mouse_point_curves_[i],
+                                            kMaxCurveSegs);
+    compiled_scroll_curves_[i].Compile(scroll_curves_[i], kMaxCurveSegs);
+    compiled_unaccel_point_curves_[i].Compile(&unaccel_point_curves_[i],
+                                              kMaxUnaccelCurveSegs);
+    compiled_unaccel_mouse_curves_[i].Compile(&unaccel_mouse_curves_[i],
+                                              kMaxUnaccelCurveSegs);
+  }
+  DoubleArrayWasWritten(&tp_custom_point_prop_);
+  DoubleArrayWasWritten(&tp_custom_scroll_prop_);
+  DoubleArrayWasWritten(&mouse_custom_point_prop_);
+  tp_custom_point_prop_.SetDelegate(this);
+  tp_custom_scroll_prop_.SetDelegate(this);
+  mouse_custom_point_prop_.SetDelegate(this);
+}
+
+void AccelFilterInterpreter::DoubleArrayWasWritten(DoubleArrayProperty* prop) {
+  if (prop == &tp_custom_point_prop_)
+    compiled_tp_custom_point_.Compile(tp_custom_point_, kMaxCustomCurveSegs);
+  else if (prop == &tp_custom_scroll_prop_)
+    compiled_tp_custom_scroll_.Compile(tp_custom_scroll_, kMaxCustomCurveSegs);
+  else if (prop == &mouse_custom_point_prop_)
+    compiled_mouse_custom_point_.Compile(mouse_custom_point_,
+                                         kMaxCustomCurveSegs);
+}
+
+void AccelFilterInterpreter::CompiledCurve::Compile(const CurveSegment* segs,
+                                                    size_t num_segs) {
+  segs_ = segs;
+  num_segs_ =
+      num_segs < kMaxCustomCurveSegs ? num_segs : kMaxCustomCurveSegs;
+  // Written so that a NaN x_ never raises the bound, just like it never
+  // matches a speed in RatioFromAccelCurve.
+  double bound = -INFINITY;
+  for (size_t i = 0; i < num_segs_; ++i) {
+    if (segs[i].x_ > bound)
+      bound = segs[i].x_;
+    bounds_[i] = bound;
+  }
 }
 
 void AccelFilterInterpreter::ConsumeGesture(const Gesture& gs) {
@@ -178,15 +223,14 @@ void AccelFilterInterpreter::ConsumeGesture(const Gesture& gs) {
   float* scale_out_y;
   float* scale_out_x_ordinal;
   float* scale_out_y_ordinal;
-  size_t max_segs;
-  CurveSegment* segs;
+  const CompiledCurve* curve;
 
   if (!get_accel_parameters(gs_copy,
                             dx, dy,
                             x_scale, y_scale,
                             scale_out_x, scale_out_y,
                             scale_out_x_ordinal, scale_out_y_ordinal,
-                            segs, max_segs)) {
+                            curve)) {
     // It was determined no acceleration was required.
     debug_data.no_accel_for_gesture_type = true;
     LogDebugData(debug_data);
@@ -228,7 +272,7 @@ void AccelFilterInterpreter::ConsumeGesture(const Gesture& gs) {
     }
   } else {
     // Find the appropriate ratio and apply scaling.
-    auto ratio = RatioFromAccelCurve(segs, max_segs, speed);
+    auto ratio = RatioFromCompiledCurve(*curve, speed);
     debug_data.gain_x = ratio;
     debug_data.gain_y = ratio;
     if (ratio > 0.0) {
@@ -276,10 +320,9 @@ bool AccelFilterInterpreter::get_accel_parameters(
     float& x_scale, float& y_scale,
     float*& scale_out_x, float*& scale_out_y,
     float*& scale_out_x_ordinal, float*& scale_out_y_ordinal,
-    CurveSegment*& segs, size_t& max_segs) {
+    const CompiledCurve*& curve) {
   // CurveSegments to use.
-  max_segs = kMaxCurveSegs;
-  segs = nullptr;
+  curve = nullptr;
 
   dx = nullptr;
   dy = nullptr;
@@ -326,30 +369,29 @@ bool AccelFilterInterpreter::get_accel_parameters(
       // Setup CurveSegments for the device options set.
       if (use_mouse_point_curves_.val_ && use_custom_mouse_curve_.val_) {
         // Custom Mouse.
-        segs = mouse_custom_point_;
-        max_segs = kMaxCustomCurveSegs;
+        curve = &compiled_mouse_custom_point_;
       } else if (!use_mouse_point_curves_.val_ &&
                  use_custom_tp_point_curve_.val_) {
         // Custom Touch.
-        segs = tp_custom_point_;
-        max_segs = kMaxCustomCurveSegs;
+        curve = &compiled_tp_custom_point_;
       } else if (use_mouse_point_curves_.val_) {
         // Standard Mouse.
         if (!pointer_acceleration_.val_) {
-          segs = &unaccel_mouse_curves_[pointer_sensitivity_.val_ - 1];
-          max_segs = kMaxUnaccelCurveSegs;
+          curve =
+              &compiled_unaccel_mouse_curves_[pointer_sensitivity_.val_ - 1];
         } else if (use_old_mouse_point_curves_.val_) {
-          segs = old_mouse_point_curves_[pointer_sensitivity_.val_ - 1];
+          curve =
+              &compiled_old_mouse_point_curves_[pointer_sensitivity_.val_ - 1];
         } else {
-          segs = mouse_point_curves_[pointer_sensitivity_.val_ - 1];
+          curve = &compiled_mouse_point_curves_[pointer_sensitivity_.val_ - 1];
         }
       } else {
         // Standard Touch.
         if (!pointer_acceleration_.val_) {
-          segs = &unaccel_point_curves_[pointer_sensitivity_.val_ - 1];
-          max_segs = kMaxUnaccelCurveSegs;
+          curve =
+              &compiled_unaccel_point_curves_[pointer_sensitivity_.val_ - 1];
         } else {
-          segs = point_curves_[pointer_sensitivity_.val_ - 1];
+          curve = &compiled_point_curves_[pointer_sensitivity_.val_ - 1];
         }
       }
 
@@ -379,10 +421,9 @@ bool AccelFilterInterpreter::get_accel_parameters(
 
       // Setup CurveSegments for the device options set.
       if (!use_custom_tp_scroll_curve_.val_) {
-        segs = scroll_curves_[scroll_sensitivity_.val_ - 1];
+        curve = &compiled_scroll_curves_[scroll_sensitivity_.val_ - 1];
       } else {
-        segs = tp_custom_scroll_;
-        max_segs = kMaxCustomCurveSegs;
+        curve = &compiled_tp_custom_scroll_;
       }
 
       x_scale = scroll_x_out_scale_.val_;
@@ -452,4 +493,35 @@ float AccelFilterInterpreter::RatioFromAccelCurve(
   return 0.0;
 }
 
+float AccelFilterInterpreter::RatioFromCompiledCurve(
+    const CompiledCurve& curve,
+    const float speed) {
+  if (speed <= 0.0 || curve.num_segs_ == 0)
+    return 0.0;
+
+  // Branch-free lower bound: find the first bound that is not less than
+  // |speed|. The comparison is written so that a NaN speed matches nothing,
+  // as in RatioFromAccelCurve.
+  const double* base = curve.bounds_;
+  size_t len = curve.num_segs_;
+  while (len > 1) {
+    size_t half = len / 2;
+    base += !(speed <= base[half - 1]) * half;
+    len -= half;
+  }
+  base += !(speed <= *base);
+  size_t i = base - curve.bounds_;
+  if (i == curve.num_segs_)
+    return 0.0;
+  const CurveSegment& seg = curve.segs_[i];
+  return (seg.sqr_ * speed) + seg.mul_ + (seg.int_ / speed);
+}
+
+void AccelFilterInterpreter::ArchiveState(StateArchive* archive) {
+  FilterInterpreter::ArchiveState(archive);
+  archive->Archive(&last_reasonable_dt_);
+  archive->Archive(&last_end_time_);
+  archive->Archive(&last_mags_);
+}
+
 }  // namespace gestures
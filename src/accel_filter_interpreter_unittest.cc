@@ -647,6 +647,10 @@ TEST_F(AccelFilterInterpreterTest, CustomAccelTest) {
       AccelFilterInterpreter::CurveSegment(2.0, 0.0, 0.0, 2.0);
   accel_interpreter.tp_custom_scroll_[3] =
       AccelFilterInterpreter::CurveSegment(INFINITY, 0.0, 2.0, -2.0);
+  accel_interpreter.DoubleArrayWasWritten(
+      &accel_interpreter.tp_custom_point_prop_);
+  accel_interpreter.DoubleArrayWasWritten(
+      &accel_interpreter.tp_custom_scroll_prop_);
 
   float move_in[]  = { 1.0, 2.5, 3.5, 5.0 };
   float move_out[] = { 0.5, 2.0, 3.0, 3.0 };
@@ -1161,4 +1165,65 @@ TEST_F(AccelFilterInterpreterTest, AccelDebugDataTest) {
   accel_interpreter.log_->Clear();
 }
 
+TEST_F(AccelFilterInterpreterTest, CompiledCurveEquivalenceTest) {
+  AccelFilterInterpreterTestInterpreter* base_interpreter =
+      new AccelFilterInterpreterTestInterpreter;
+  AccelFilterInterpreter accel_interpreter(nullptr, base_interpreter, nullptr);
+  TestInterpreterWrapper interpreter(&accel_interpreter);
+  typedef AccelFilterInterpreter::CurveSegment CurveSegment;
+  typedef AccelFilterInterpreter::CompiledCurve CompiledCurve;
+
+  // Custom curves with a varying number of segments. Some of their x_ go
+  // down or are NaN, which RatioFromAccelCurve never matches.
+  accel_interpreter.tp_custom_point_[0] = CurveSegment(2.0, 0.0, 0.5, 0.0);
+  accel_interpreter.tp_custom_point_[1] = CurveSegment(1.0, 0.0, 9.0, 9.0);
+  accel_interpreter.tp_custom_point_[2] = CurveSegment(3.0, 0.0, 2.0, -3.0);
+  accel_interpreter.tp_custom_point_[3] = CurveSegment(NAN, 0.0, 9.0, 9.0);
+  accel_interpreter.tp_custom_point_[4] = CurveSegment(50.0, 0.01, 1.0, 2.0);
+  for (size_t i = 5; i < AccelFilterInterpreter::kMaxCustomCurveSegs; ++i) {
+    accel_interpreter.tp_custom_point_[i] =
+        CurveSegment(50.0 + 10.0 * i, 0.001 * i, 0.1 * i, -1.0 * i);
+  }
+  accel_interpreter.tp_custom_point_[19].x_ = 150.0;
+  accel_interpreter.tp_custom_scroll_[0] = CurveSegment(NAN, 0.0, 2.0, 0.0);
+  accel_interpreter.tp_custom_scroll_[1] = CurveSegment(0.5, 0.0, 2.0, 0.0);
+  accel_interpreter.tp_custom_scroll_[2] = CurveSegment(0.2, 0.0, 3.0, 0.0);
+  accel_interpreter.tp_custom_scroll_[3] = CurveSegment(600.0, 0.0, 2.0, -2.0);
+  accel_interpreter.DoubleArrayWasWritten(
+      &accel_interpreter.tp_custom_point_prop_);
+  accel_interpreter.DoubleArrayWasWritten(
+      &accel_interpreter.tp_custom_scroll_prop_);
+
+  std::vector<const CompiledCurve*> curves = {
+    &accel_interpreter.compiled_tp_custom_point_,
+    &accel_interpreter.compiled_tp_custom_scroll_,
+    &accel_interpreter.compiled_mouse_custom_point_,
+  };
+  for (size_t i = 0; i < AccelFilterInterpreter::kMaxAccelCurves; ++i) {
+    curves.push_back(&accel_interpreter.compiled_point_curves_[i]);
+    curves.push_back(&accel_interpreter.compiled_old_mouse_point_curves_[i]);
+    curves.push_back(&accel_interpreter.compiled_mouse_point_curves_[i]);
+    curves.push_back(&accel_interpreter.compiled_scroll_curves_[i]);
+    curves.push_back(&accel_interpreter.compiled_unaccel_point_curves_[i]);
+    curves.push_back(&accel_interpreter.compiled_unaccel_mouse_curves_[i]);
+  }
+
+  std::vector<float> speeds = { -1.0, 0.0, 0.5, 1.0, 2.0, 3.0, 150.0, 600.0,
+                                1e9, INFINITY, NAN };
+  for (float speed = 0.01; speed < 1000.0; speed *= 1.01)
+    speeds.push_back(speed);
+
+  for (const CompiledCurve* curve : curves) {
+    for (float speed : speeds) {
+      float expected = accel_interpreter.RatioFromAccelCurve(
+          curve->segs_, curve->num_segs_, speed);
+      float actual = accel_interpreter.RatioFromCompiledCurve(*curve, speed);
+      if (isnan(expected))
+        EXPECT_TRUE(isnan(actual)) << "speed=" << speed;
+      else
+        EXPECT_EQ(expected, actual) << "speed=" << speed;
+    }
+  }
+}
+
 }  // namespace gestures
@@ -7,14 +7,22 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <set>
+#include <stdio.h>
+#include <string.h>
 #include <string>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <vector>
 
 #include <json/value.h>
 #include <json/writer.h>
 
+#include "include/eintr_wrapper.h"
 #include "include/file_util.h"
+#include "include/flight_recorder.h"
 #include "include/logging.h"
 #include "include/prop_registry.h"
 #include "include/string_util.h"
@@ -24,25 +32,14 @@
 using std::set;
 using std::string;
 
-namespace {
-
-// Helper to std::visit with lambdas.
-template <typename... V>
-struct Visitor : V... {
-  using V::operator()...;
-};
-// Explicit deduction guide (not needed as of C++20).
-template <typename... V>
-Visitor(V...) -> Visitor<V...>;
-
-} // namespace
-
 namespace gestures {
 
 ActivityLog::ActivityLog(PropRegistry* prop_reg)
     : head_idx_(0), size_(0), max_fingers_(0), hwprops_(),
       prop_reg_(prop_reg) {}
 
+ActivityLog::~ActivityLog() {}
+
 void ActivityLog::SetHardwareProperties(const HardwareProperties& hwprops) {
   hwprops_ = hwprops;
 
@@ -61,44 +58,64 @@ void ActivityLog::SetHardwareProperties(const HardwareProperties& hwprops) {
   }
 
   finger_states_.reset(new FingerState[kBufferSize * max_fingers_]);
+
+  // The slots have to fit the new number of fingers.
+  if (flight_recorder_)
+    StartFlightRecorder(flight_recorder_path_,
+                        flight_recorder_interpreter_name_.c_str());
 }
 
 void ActivityLog::LogHardwareState(const HardwareState& hwstate) {
   Entry* entry = PushBack();
   entry->details = hwstate;
-  HardwareState& entry_hwstate = std::get<HardwareState>(entry->details);
-  if (hwstate.finger_cnt > max_fingers_) {
+  CopyFingersToTail(&std::get<HardwareState>(entry->details));
+  MaybeRecordTail();
+}
+
+void ActivityLog::CopyFingersToTail(HardwareState* hwstate) {
+  if (hwstate->finger_cnt > max_fingers_) {
     Err("Too many fingers! Max is %zu, but I got %d",
-        max_fingers_, hwstate.finger_cnt);
-    entry_hwstate.fingers = nullptr;
-    entry_hwstate.finger_cnt = 0;
+        max_fingers_, hwstate->finger_cnt);
+    hwstate->fingers = nullptr;
+    hwstate->finger_cnt = 0;
     return;
   }
   if (!finger_states_.get())
     return;
-  entry_hwstate.fingers = &finger_states_[TailIdx() * max_fingers_];
-  std::copy(&hwstate.fingers[0], &hwstate.fingers[hwstate.finger_cnt],
-            entry_hwstate.fingers);
+  FingerState* fingers = &finger_states_[TailIdx() * max_fingers_];
+  std::copy(&hwstate->fingers[0], &hwstate->fingers[hwstate->finger_cnt],
+            fingers);
+  hwstate->fingers = fingers;
 }
 
 void ActivityLog::LogTimerCallback(stime_t now) {
   Entry* entry = PushBack();
   entry->details = TimerCallbackEntry{now};
+  MaybeRecordTail();
 }
 
 void ActivityLog::LogCallbackRequest(stime_t when) {
   Entry* entry = PushBack();
   entry->details = CallbackRequestEntry{when};
+  MaybeRecordTail();
 }
 
 void ActivityLog::LogGesture(const Gesture& gesture) {
   Entry* entry = PushBack();
   entry->details = gesture;
+  MaybeRecordTail();
 }
 
 void ActivityLog::LogPropChange(const PropChangeEntry& prop_change) {
   Entry* entry = PushBack();
   entry->details = prop_change;
+  MaybeRecordTail();
+}
+
+void ActivityLog::LogCheckpoint(stime_t timestamp, const string& state) {
+  Entry* entry = PushBack();
+  entry->details = CheckpointEntry{timestamp, state};
+  MaybeRecordTail();
 }
 
 void ActivityLog::LogGestureConsume(
@@ -106,6 +123,7 @@ void ActivityLog::LogGestureConsume(
   GestureConsume gesture_consume { name, gesture };
   Entry* entry = PushBack();
   entry->details = gesture_consume;
+  MaybeRecordTail();
 }
 
 void ActivityLog::LogGestureProduce(
@@ -113,6 +131,7 @@ void ActivityLog::LogGestureProduce(
   GestureProduce gesture_produce { name, gesture };
   Entry* entry = PushBack();
   entry->details = gesture_produce;
+  MaybeRecordTail();
 }
 
 void ActivityLog::LogHardwareStatePre(const std::string& name,
@@ -120,6 +139,7 @@ void ActivityLog::LogHardwareStatePre(const std::string& name,
   HardwareStatePre hwstate_pre { name, hwstate };
   Entry* entry = PushBack();
   entry->details = hwstate_pre;
+  MaybeRecordTail();
 }
 
 void ActivityLog::LogHardwareStatePost(const std::string& name,
@@ -127,6 +147,7 @@ void ActivityLog::LogHardwareStatePost(const std::string& name,
   HardwareStatePost hwstate_post { name, hwstate };
   Entry* entry = PushBack();
   entry->details = hwstate_post;
+  MaybeRecordTail();
 }
 
 void ActivityLog::LogHandleTimerPre(const std::string& name,
@@ -138,6 +159,7 @@ void ActivityLog::LogHandleTimerPre(const std::string& name,
   handle.timeout = (timeout == nullptr) ? 0 : *timeout;
   Entry* entry = PushBack();
   entry->details = handle;
+  MaybeRecordTail();
 }
 
 void ActivityLog::LogHandleTimerPost(const std::string& name,
@@ -149,11 +171,52 @@ void ActivityLog::LogHandleTimerPost(const std::string& name,
   handle.timeout = (timeout == nullptr) ? 0 : *timeout;
   Entry* entry = PushBack();
   entry->details = handle;
+  MaybeRecordTail();
 }
 
 void ActivityLog::Dump(const char* filename) {
-  string data = Encode();
-  WriteFile(filename, data.c_str(), data.size());
+  DumpJson(filename, nullptr);
+}
+
+void ActivityLog::Snapshot(ActivityLog* snapshot, BinaryInfo* info) {
+  snapshot->hwprops_ = hwprops_;
+  if (snapshot->max_fingers_ != max_fingers_ ||
+      !snapshot->finger_states_.get() != !finger_states_.get()) {
+    snapshot->max_fingers_ = max_fingers_;
+    snapshot->finger_states_.reset(finger_states_.get() ?
+        new FingerState[kBufferSize * max_fingers_] : nullptr);
+  }
+  snapshot->head_idx_ = head_idx_;
+  snapshot->size_ = size_;
+  snapshot->prop_reg_ = nullptr;
+  for (size_t i = 0; i < size_; ++i) {
+    size_t idx = (head_idx_ + i) % kBufferSize;
+    Entry* entry = &snapshot->buffer_[idx];
+    *entry = buffer_[idx];
+    // Give every hardware state its own copy of its fingers. Pre and Post
+    // states still point at the interpreters' fingers, which will change.
+    HardwareState* hwstate = std::visit(
+      Visitor {
+        [](HardwareState& hwstate) { return &hwstate; },
+        [](HardwareStatePre& pre) { return &pre.hwstate; },
+        [](HardwareStatePost& post) { return &post.hwstate; },
+        [](auto& arg) -> HardwareState* { return nullptr; }
+      }, entry->details);
+    if (!hwstate || !hwstate->fingers)
+      continue;
+    if (!snapshot->finger_states_.get() ||
+        hwstate->finger_cnt > max_fingers_) {
+      hwstate->fingers = nullptr;
+      continue;
+    }
+    FingerState* fingers = &snapshot->finger_states_[idx * max_fingers_];
+    std::copy(&hwstate->fingers[0], &hwstate->fingers[hwstate->finger_cnt],
+              fingers);
+    hwstate->fingers = fingers;
+  }
+  info->interpreter_name.clear();
+  info->gestures_version = GesturesVersion();
+  info->properties = EncodePropRegistry();
 }
 
 ActivityLog::Entry* ActivityLog::PushBack() {
@@ -561,6 +624,14 @@ Json::Value ActivityLog::EncodeCommonInfo() {
         [this, &entries](TimestampHardwareStateDebug debug_data) {
           entries.append(EncodeHardwareStateDebug(debug_data));
         },
+        [&entries](const CheckpointEntry& checkpoint) {
+          Json::Value ret(Json::objectValue);
+          ret[kKeyType] = Json::Value(kKeyCheckpoint);
+          ret[kKeyCheckpointTimestamp] = Json::Value(checkpoint.timestamp);
+          ret[kKeyCheckpointState] =
+              Json::Value(Base64Encode(checkpoint.state));
+          entries.append(ret);
+        },
         [](auto arg) {
           Err("Unknown entry type");
         }
@@ -572,20 +643,490 @@ Json::Value ActivityLog::EncodeCommonInfo() {
   return root;
 }
 
-void ActivityLog::AddEncodeInfo(Json::Value* root) {
-  (*root)["version"] = Json::Value(1);
+string ActivityLog::GesturesVersion() {
   string gestures_version = VCSID;
 
   // Strip tailing whitespace.
-  gestures_version = TrimWhitespaceASCII(gestures_version);
+  return TrimWhitespaceASCII(gestures_version);
+}
+
+void ActivityLog::AddEncodeInfo(Json::Value* root,
+                                const string& gestures_version,
+                                const Json::Value& properties) {
+  (*root)["version"] = Json::Value(1);
   (*root)["gesturesVersion"] = Json::Value(gestures_version);
-  (*root)[kKeyProperties] = EncodePropRegistry();
+  (*root)[kKeyProperties] = properties;
+}
+
+void ActivityLog::AddEncodeInfo(Json::Value* root) {
+  AddEncodeInfo(root, GesturesVersion(), EncodePropRegistry());
+}
+
+string ActivityLog::Encode(const char* interpreter_name) {
+  string out;
+  JsonWriter writer(&out);
+  WriteJson(&writer, interpreter_name, GesturesVersion(), nullptr);
+  writer.Flush();
+  return out;
+}
+
+string ActivityLog::Encode(const BinaryInfo& info) {
+  string out;
+  JsonWriter writer(&out);
+  WriteJson(&writer,
+            info.interpreter_name.empty() ?
+                nullptr : info.interpreter_name.c_str(),
+            info.gestures_version, &info.properties);
+  writer.Flush();
+  return out;
+}
+
+bool ActivityLog::WriteJson(int fd, const char* interpreter_name) {
+  JsonWriter writer(fd);
+  WriteJson(&writer, interpreter_name, GesturesVersion(), nullptr);
+  return writer.Flush();
+}
+
+bool ActivityLog::DumpJson(const char* filename,
+                           const char* interpreter_name) {
+  int fd = HANDLE_EINTR(creat(filename, 0666));
+  if (fd < 0) {
+    Err("Unable to create %s", filename);
+    return false;
+  }
+  bool ok = WriteJson(fd, interpreter_name);
+  if (IGNORE_EINTR(close(fd)) < 0)
+    ok = false;
+  return ok;
+}
+
+void ActivityLog::WriteJson(JsonWriter* writer, const char* interpreter_name,
+                            const string& gestures_version,
+                            const Json::Value* properties) const {
+  // The entries come first, as the keys are sorted, so the seek index is
+  // complete by the time it is written.
+  std::vector<SeekPoint> seek_index;
+  struct EntriesArg {
+    const ActivityLog* log;
+    std::vector<SeekPoint>* seek_index;
+  } entries = { this, &seek_index };
+  JsonWriter::Object root(writer);
+  root.Add(kKeyRoot, [](JsonWriter* writer, const void* arg) {
+    const EntriesArg* entries = static_cast<const EntriesArg*>(arg);
+    entries->log->StreamEntries(writer, entries->seek_index);
+  }, &entries);
+  root.Add(kKeyHardwarePropRoot, [](JsonWriter* writer, const void* arg) {
+    static_cast<const ActivityLog*>(arg)->StreamHardwareProperties(writer);
+  }, this);
+  if (interpreter_name)
+    root.Add(kKeyInterpreterName, interpreter_name);
+  root.Add("version", 1);
+  root.Add("gesturesVersion", gestures_version);
+  if (properties) {
+    root.Add(kKeyProperties, [](JsonWriter* writer, const void* arg) {
+      writer->Value(*static_cast<const Json::Value*>(arg));
+    }, properties);
+  } else {
+    root.Add(kKeyProperties, [](JsonWriter* writer, const void* arg) {
+      static_cast<const ActivityLog*>(arg)->StreamPropRegistry(writer);
+    }, this);
+  }
+  // Logs without checkpoints are written as they always were.
+  bool has_checkpoints = false;
+  for (size_t i = 0; i < size_ && !has_checkpoints; ++i)
+    has_checkpoints = std::holds_alternative<CheckpointEntry>(
+        buffer_[(i + head_idx_) % kBufferSize].details);
+  if (has_checkpoints) {
+    root.Add(kKeySeekIndex, [](JsonWriter* writer, const void* arg) {
+      StreamSeekIndex(writer,
+                      *static_cast<const std::vector<SeekPoint>*>(arg));
+    }, &seek_index);
+  }
+  root.End();
+  writer->EndDocument();
+}
+
+void ActivityLog::StreamHardwareProperties(JsonWriter* writer) const {
+  JsonWriter::Object ret(writer);
+  ret.Add(kKeyHardwarePropLeft, hwprops_.left);
+  ret.Add(kKeyHardwarePropTop, hwprops_.top);
+  ret.Add(kKeyHardwarePropRight, hwprops_.right);
+  ret.Add(kKeyHardwarePropBottom, hwprops_.bottom);
+  ret.Add(kKeyHardwarePropXResolution, hwprops_.res_x);
+  ret.Add(kKeyHardwarePropYResolution, hwprops_.res_y);
+  ret.Add(kKeyHardwarePropOrientationMinimum, hwprops_.orientation_minimum);
+  ret.Add(kKeyHardwarePropOrientationMaximum, hwprops_.orientation_maximum);
+  ret.Add(kKeyHardwarePropMaxFingerCount, hwprops_.max_finger_cnt);
+  ret.Add(kKeyHardwarePropMaxTouchCount, hwprops_.max_touch_cnt);
+
+  ret.Add(kKeyHardwarePropSupportsT5R2, hwprops_.supports_t5r2 != 0);
+  ret.Add(kKeyHardwarePropSemiMt, hwprops_.support_semi_mt != 0);
+  ret.Add(kKeyHardwarePropIsButtonPad, hwprops_.is_button_pad != 0);
+  ret.Add(kKeyHardwarePropHasWheel, hwprops_.has_wheel != 0);
+  ret.End();
+}
+
+void ActivityLog::StreamEntries(JsonWriter* writer,
+                                std::vector<SeekPoint>* seek_index) const {
+  writer->BeginArray();
+  for (size_t i = 0; i < size_; ++i) {
+    const Entry& entry = buffer_[(i + head_idx_) % kBufferSize];
+    if (const CheckpointEntry* checkpoint =
+            std::get_if<CheckpointEntry>(&entry.details)) {
+      seek_index->push_back(
+          SeekPoint{checkpoint->timestamp, writer->offset()});
+    }
+    std::visit(
+      Visitor {
+        [writer](const HardwareState& hwstate) {
+          StreamHardwareState(writer, hwstate, kKeyHardwareState, nullptr);
+        },
+        [writer](const HardwareStatePre& pre) {
+          StreamHardwareState(writer, pre.hwstate, kKeyHardwareStatePre,
+                             &pre.name);
+        },
+        [writer](const HardwareStatePost& post) {
+          StreamHardwareState(writer, post.hwstate, kKeyHardwareStatePost,
+                             &post.name);
+        },
+        [writer](const TimerCallbackEntry& now) {
+          JsonWriter::Object ret(writer);
+          ret.Add(kKeyType, kKeyTimerCallback);
+          ret.Add(kKeyTimerNow, now.timestamp);
+          ret.End();
+        },
+        [writer](const CallbackRequestEntry& when) {
+          JsonWriter::Object ret(writer);
+          ret.Add(kKeyType, kKeyCallbackRequest);
+          ret.Add(kKeyCallbackRequestWhen, when.timestamp);
+          ret.End();
+        },
+        [writer](const Gesture& gesture) {
+          StreamGesture(writer, gesture, kKeyGesture, nullptr);
+        },
+        [writer](const GestureConsume& consume) {
+          StreamGesture(writer, consume.gesture, kKeyGestureConsume,
+                       &consume.name);
+        },
+        [writer](const GestureProduce& produce) {
+          StreamGesture(writer, produce.gesture, kKeyGestureProduce,
+                       &produce.name);
+        },
+        [writer](const PropChangeEntry& prop_change) {
+          StreamPropChange(writer, prop_change);
+        },
+        [writer](const HandleTimerPre& handle) {
+          StreamHandleTimer(writer, kKeyHandleTimerPre, handle.name,
+                           handle.now, handle.timeout_is_present ?
+                               &handle.timeout : nullptr);
+        },
+        [writer](const HandleTimerPost& handle) {
+          StreamHandleTimer(writer, kKeyHandleTimerPost, handle.name,
+                           handle.now, handle.timeout_is_present ?
+                               &handle.timeout : nullptr);
+        },
+        [writer](const AccelGestureDebug& debug_data) {
+          StreamGestureDebug(writer, debug_data);
+        },
+        [writer](const TimestampGestureDebug& debug_data) {
+          JsonWriter::Object ret(writer);
+          ret.Add(kKeyType, kKeyTimestampGestureDebug);
+          ret.Add(kKeyTimestampDebugSkew, debug_data.skew);
+          ret.End();
+        },
+        [writer](const TimestampHardwareStateDebug& debug_data) {
+          StreamHardwareStateDebug(writer, debug_data);
+        },
+        [writer](const CheckpointEntry& checkpoint) {
+          string state = Base64Encode(checkpoint.state);
+          JsonWriter::Object ret(writer);
+          ret.Add(kKeyType, kKeyCheckpoint);
+          ret.Add(kKeyCheckpointTimestamp, checkpoint.timestamp);
+          ret.Add(kKeyCheckpointState, state);
+          ret.End();
+        },
+        [](const auto& arg) {
+          Err("Unknown entry type");
+        }
+      }, entry.details);
+  }
+  writer->EndArray();
 }
 
-string ActivityLog::Encode() {
-  Json::Value root = EncodeCommonInfo();
-  AddEncodeInfo(&root);
-  return root.toStyledString();
+void ActivityLog::StreamSeekIndex(JsonWriter* writer,
+                                  const std::vector<SeekPoint>& seek_index) {
+  writer->BeginArray();
+  for (const SeekPoint& point : seek_index) {
+    // Written directly, since offsets may not fit in JsonWriter::Object's
+    // int
+    writer->BeginObject();
+    writer->Key(kKeySeekIndexOffset, strlen(kKeySeekIndexOffset));
+    writer->UInt(point.offset);
+    writer->Key(kKeySeekIndexTimestamp, strlen(kKeySeekIndexTimestamp));
+    writer->Double(point.timestamp);
+    writer->EndObject();
+  }
+  writer->EndArray();
+}
+
+void ActivityLog::StreamPropRegistry(JsonWriter* writer) const {
+  if (!prop_reg_) {
+    writer->BeginObject();
+    writer->EndObject();
+    return;
+  }
+  // As in EncodePropRegistry(), the last property with a name wins.
+  const set<Property*>& props = prop_reg_->props();
+  std::vector<Property*> sorted(props.rbegin(), props.rend());
+  std::stable_sort(sorted.begin(), sorted.end(), [](Property* a, Property* b) {
+    return strcmp(a->name(), b->name()) < 0;
+  });
+  sorted.erase(std::unique(sorted.begin(), sorted.end(),
+                           [](Property* a, Property* b) {
+                             return !strcmp(a->name(), b->name());
+                           }),
+               sorted.end());
+  writer->BeginObject();
+  for (Property* prop : sorted) {
+    writer->Key(prop->name(), strlen(prop->name()));
+    writer->Value(prop->NewValue());
+  }
+  writer->EndObject();
+}
+
+void ActivityLog::StreamHardwareState(JsonWriter* writer,
+                                      const HardwareState& hwstate,
+                                      const char* type, const string* name) {
+  JsonWriter::Object ret(writer);
+  ret.Add(kKeyHardwareStateButtonsDown, hwstate.buttons_down);
+  ret.Add(kKeyHardwareStateTouchCnt, hwstate.touch_cnt);
+  ret.Add(kKeyHardwareStateTimestamp, hwstate.timestamp);
+  ret.Add(kKeyHardwareStateFingers, [](JsonWriter* writer, const void* arg) {
+    const HardwareState& hwstate = *static_cast<const HardwareState*>(arg);
+    writer->BeginArray();
+    for (size_t i = 0; i < hwstate.finger_cnt; ++i) {
+      if (hwstate.fingers == nullptr) {
+        Err("Have finger_cnt %d but fingers is null!", hwstate.finger_cnt);
+        break;
+      }
+      const FingerState& fs = hwstate.fingers[i];
+      JsonWriter::Object finger(writer);
+      finger.Add(kKeyFingerStateTouchMajor, fs.touch_major);
+      finger.Add(kKeyFingerStateTouchMinor, fs.touch_minor);
+      finger.Add(kKeyFingerStateWidthMajor, fs.width_major);
+      finger.Add(kKeyFingerStateWidthMinor, fs.width_minor);
+      finger.Add(kKeyFingerStatePressure, fs.pressure);
+      finger.Add(kKeyFingerStateOrientation, fs.orientation);
+      finger.Add(kKeyFingerStatePositionX, fs.position_x);
+      finger.Add(kKeyFingerStatePositionY, fs.position_y);
+      finger.Add(kKeyFingerStateTrackingId, fs.tracking_id);
+      finger.Add(kKeyFingerStateFlags, static_cast<int>(fs.flags));
+      finger.End();
+    }
+    writer->EndArray();
+  }, &hwstate);
+  ret.Add(kKeyHardwareStateRelX, hwstate.rel_x);
+  ret.Add(kKeyHardwareStateRelY, hwstate.rel_y);
+  ret.Add(kKeyHardwareStateRelWheel, hwstate.rel_wheel);
+  ret.Add(kKeyHardwareStateRelHWheel, hwstate.rel_hwheel);
+  ret.Add(kKeyType, type);
+  if (name)
+    ret.Add(kKeyMethodName, *name);
+  ret.End();
+}
+
+void ActivityLog::StreamGesture(JsonWriter* writer, const Gesture& gesture,
+                                const char* type, const string* name) {
+  JsonWriter::Object ret(writer);
+  char unhandled[32];
+  ret.Add(kKeyGestureStartTime, gesture.start_time);
+  ret.Add(kKeyGestureEndTime, gesture.end_time);
+
+  switch (gesture.type) {
+    case kGestureTypeNull:
+      ret.Add(kKeyGestureType, "null");
+      break;
+    case kGestureTypeContactInitiated:
+      ret.Add(kKeyGestureType, kValueGestureTypeContactInitiated);
+      break;
+    case kGestureTypeMove:
+      ret.Add(kKeyGestureType, kValueGestureTypeMove);
+      ret.Add(kKeyGestureDX, gesture.details.move.dx);
+      ret.Add(kKeyGestureDY, gesture.details.move.dy);
+      ret.Add(kKeyGestureOrdinalDX, gesture.details.move.ordinal_dx);
+      ret.Add(kKeyGestureOrdinalDY, gesture.details.move.ordinal_dy);
+      break;
+    case kGestureTypeScroll:
+      ret.Add(kKeyGestureType, kValueGestureTypeScroll);
+      ret.Add(kKeyGestureDX, gesture.details.scroll.dx);
+      ret.Add(kKeyGestureDY, gesture.details.scroll.dy);
+      ret.Add(kKeyGestureOrdinalDX, gesture.details.scroll.ordinal_dx);
+      ret.Add(kKeyGestureOrdinalDY, gesture.details.scroll.ordinal_dy);
+      break;
+    case kGestureTypeMouseWheel:
+      ret.Add(kKeyGestureType, kValueGestureTypeMouseWheel);
+      ret.Add(kKeyGestureDX, gesture.details.wheel.dx);
+      ret.Add(kKeyGestureDY, gesture.details.wheel.dy);
+      ret.Add(kKeyGestureMouseWheelTicksDX,
+              gesture.details.wheel.tick_120ths_dx);
+      ret.Add(kKeyGestureMouseWheelTicksDY,
+              gesture.details.wheel.tick_120ths_dy);
+      break;
+    case kGestureTypePinch:
+      ret.Add(kKeyGestureType, kValueGestureTypePinch);
+      ret.Add(kKeyGesturePinchDZ, gesture.details.pinch.dz);
+      ret.Add(kKeyGesturePinchOrdinalDZ, gesture.details.pinch.ordinal_dz);
+      ret.Add(kKeyGesturePinchZoomState,
+              static_cast<int>(gesture.details.pinch.zoom_state));
+      break;
+    case kGestureTypeButtonsChange:
+      ret.Add(kKeyGestureType, kValueGestureTypeButtonsChange);
+      ret.Add(kKeyGestureButtonsChangeDown,
+              static_cast<int>(gesture.details.buttons.down));
+      ret.Add(kKeyGestureButtonsChangeUp,
+              static_cast<int>(gesture.details.buttons.up));
+      break;
+    case kGestureTypeFling:
+      ret.Add(kKeyGestureType, kValueGestureTypeFling);
+      ret.Add(kKeyGestureFlingVX, gesture.details.fling.vx);
+      ret.Add(kKeyGestureFlingVY, gesture.details.fling.vy);
+      ret.Add(kKeyGestureFlingOrdinalVX, gesture.details.fling.ordinal_vx);
+      ret.Add(kKeyGestureFlingOrdinalVY, gesture.details.fling.ordinal_vy);
+      ret.Add(kKeyGestureFlingState,
+              static_cast<int>(gesture.details.fling.fling_state));
+      break;
+    case kGestureTypeSwipe:
+      ret.Add(kKeyGestureType, kValueGestureTypeSwipe);
+      ret.Add(kKeyGestureDX, gesture.details.swipe.dx);
+      ret.Add(kKeyGestureDY, gesture.details.swipe.dy);
+      ret.Add(kKeyGestureOrdinalDX, gesture.details.swipe.ordinal_dx);
+      ret.Add(kKeyGestureOrdinalDY, gesture.details.swipe.ordinal_dy);
+      break;
+    case kGestureTypeSwipeLift:
+      ret.Add(kKeyGestureType, kValueGestureTypeSwipeLift);
+      break;
+    case kGestureTypeFourFingerSwipe:
+      ret.Add(kKeyGestureType, kValueGestureTypeFourFingerSwipe);
+      ret.Add(kKeyGestureDX, gesture.details.four_finger_swipe.dx);
+      ret.Add(kKeyGestureDY, gesture.details.four_finger_swipe.dy);
+      ret.Add(kKeyGestureOrdinalDX,
+              gesture.details.four_finger_swipe.ordinal_dx);
+      ret.Add(kKeyGestureOrdinalDY,
+              gesture.details.four_finger_swipe.ordinal_dy);
+      break;
+    case kGestureTypeFourFingerSwipeLift:
+      ret.Add(kKeyGestureType, kValueGestureTypeFourFingerSwipeLift);
+      break;
+    case kGestureTypeMetrics:
+      ret.Add(kKeyGestureType, kValueGestureTypeMetrics);
+      ret.Add(kKeyGestureMetricsType,
+              static_cast<int>(gesture.details.metrics.type));
+      ret.Add(kKeyGestureMetricsData1, gesture.details.metrics.data[0]);
+      ret.Add(kKeyGestureMetricsData2, gesture.details.metrics.data[1]);
+      break;
+    default:
+      snprintf(unhandled, sizeof(unhandled), "Unhandled %d", gesture.type);
+      ret.Add(kKeyGestureType, unhandled);
+  }
+  ret.Add(kKeyType, type);
+  if (name)
+    ret.Add(kKeyMethodName, *name);
+  ret.End();
+}
+
+void ActivityLog::StreamHandleTimer(JsonWriter* writer, const char* type,
+                                    const string& name, stime_t now,
+                                    const stime_t* timeout) {
+  JsonWriter::Object ret(writer);
+  ret.Add(kKeyType, type);
+  ret.Add(kKeyMethodName, name);
+  ret.Add(kKeyTimerNow, now);
+  if (timeout)
+    ret.Add(kKeyHandleTimerTimeout, *timeout);
+  ret.End();
+}
+
+void ActivityLog::StreamPropChange(JsonWriter* writer,
+                                   const PropChangeEntry& prop_change) {
+  JsonWriter::Object ret(writer);
+  ret.Add(kKeyType, kKeyPropChange);
+  ret.Add(kKeyPropChangeName, prop_change.name);
+  std::visit(
+    Visitor {
+      [&ret](GesturesPropBool value) {
+        ret.Add(kKeyPropChangeValue, static_cast<int>(value));
+        ret.Add(kKeyPropChangeType, kValuePropChangeTypeBool);
+      },
+      [&ret](double value) {
+        ret.Add(kKeyPropChangeValue, value);
+        ret.Add(kKeyPropChangeType, kValuePropChangeTypeDouble);
+      },
+      [&ret](int value) {
+        ret.Add(kKeyPropChangeValue, value);
+        ret.Add(kKeyPropChangeType, kValuePropChangeTypeInt);
+      },
+      [&ret](short value) {
+        ret.Add(kKeyPropChangeValue, static_cast<int>(value));
+        ret.Add(kKeyPropChangeType, kValuePropChangeTypeShort);
+      },
+      [](auto arg) {
+        Err("Invalid value type");
+      }
+    }, prop_change.value);
+  ret.End();
+}
+
+void ActivityLog::StreamGestureDebug(JsonWriter* writer,
+                                     const AccelGestureDebug& debug_data) {
+  JsonWriter::Object ret(writer);
+  ret.Add(kKeyType, kKeyAccelGestureDebug);
+  ret.Add(kKeyAccelDebugDroppedGesture, debug_data.dropped_gesture);
+  if (debug_data.no_accel_for_gesture_type)
+    ret.Add(kKeyAccelDebugNoAccelGestureType, true);
+  else if (debug_data.no_accel_for_small_dt)
+    ret.Add(kKeyAccelDebugNoAccelSmallDt, true);
+  else if (debug_data.no_accel_for_small_speed)
+    ret.Add(kKeyAccelDebugNoAccelSmallSpeed, true);
+  else if (debug_data.no_accel_for_bad_gain)
+    ret.Add(kKeyAccelDebugNoAccelBadGain, true);
+  ret.Add(kKeyAccelDebugXYAreVelocity, debug_data.x_y_are_velocity);
+  ret.Add(kKeyAccelDebugXScale, debug_data.x_scale);
+  ret.Add(kKeyAccelDebugYScale, debug_data.y_scale);
+  ret.Add(kKeyAccelDebugDt, debug_data.dt);
+  ret.Add(kKeyAccelDebugAdjustedDt, debug_data.adjusted_dt);
+  ret.Add(kKeyAccelDebugSpeed, debug_data.speed);
+  if (debug_data.speed != debug_data.smoothed_speed)
+    ret.Add(kKeyAccelDebugSmoothSpeed, debug_data.smoothed_speed);
+  ret.Add(kKeyAccelDebugGainX, debug_data.gain_x);
+  ret.Add(kKeyAccelDebugGainY, debug_data.gain_y);
+  ret.End();
+}
+
+void ActivityLog::StreamHardwareStateDebug(
+    JsonWriter* writer, const TimestampHardwareStateDebug& debug_data) {
+  JsonWriter::Object ret(writer);
+  ret.Add(kKeyType, kKeyTimestampHardwareStateDebug);
+  ret.Add(kKeyTimestampDebugIsUsingFake, debug_data.is_using_fake);
+  if (debug_data.is_using_fake) {
+    ret.Add(kKeyTimestampDebugWasFirstOrBackward,
+            debug_data.was_first_or_backward);
+    ret.Add(kKeyTimestampDebugPrevMscTimestampIn,
+            debug_data.prev_msc_timestamp_in);
+    ret.Add(kKeyTimestampDebugPrevMscTimestampOut,
+            debug_data.prev_msc_timestamp_out);
+  } else {
+    ret.Add(kKeyTimestampDebugWasDivergenceReset,
+            debug_data.was_divergence_reset);
+    ret.Add(kKeyTimestampDebugFakeTimestampIn,
+            debug_data.fake_timestamp_in);
+    ret.Add(kKeyTimestampDebugFakeTimestampDelta,
+            debug_data.fake_timestamp_delta);
+    ret.Add(kKeyTimestampDebugFakeTimestampOut,
+            debug_data.fake_timestamp_out);
+  }
+  ret.Add(kKeyTimestampDebugSkew, debug_data.skew);
+  ret.Add(kKeyTimestampDebugMaxSkew, debug_data.max_skew);
+  ret.End();
 }
 
 const char ActivityLog::kKeyInterpreterName[] = "interpreterName";
@@ -727,5 +1268,11 @@ const char ActivityLog::kKeyTimestampDebugFakeTimestampOut[] =
     "fakeTimestampOut";
 const char ActivityLog::kKeyTimestampDebugSkew[] = "skew";
 const char ActivityLog::kKeyTimestampDebugMaxSkew[] = "maxSkew";
+const char ActivityLog::kKeyCheckpoint[] = "checkpoint";
+const char ActivityLog::kKeyCheckpointTimestamp[] = "timestamp";
+const char ActivityLog::kKeyCheckpointState[] = "state";
+const char ActivityLog::kKeySeekIndex[] = "seekIndex";
+const char ActivityLog::kKeySeekIndexOffset[] = "offset";
+const char ActivityLog::kKeySeekIndexTimestamp[] = "timestamp";
 
 }  // namespace gestures
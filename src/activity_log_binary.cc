@@ -0,0 +1,874 @@
+// Copyright 2026 The ChromiumOS Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Binary encoding of ActivityLog. See activity_log_binary.h for the format.
+
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <json/reader.h>
+#include <json/writer.h>
+
+#include "include/activity_log.h"
+#include "include/activity_log_binary.h"
+#include "include/eintr_wrapper.h"
+#include "include/file_util.h"
+#include "include/flight_recorder.h"
+#include "include/logging.h"
+
+using std::string;
+
+namespace gestures {
+
+using namespace activity_log_binary;
+
+namespace {
+
+size_t Padded(size_t size) {
+  return (size + 7) & ~static_cast<size_t>(7);
+}
+
+// Collects records in a fixed buffer, writing it to the file whenever it
+// fills up.
+class RecordWriter {
+ public:
+  explicit RecordWriter(int fd) : fd_(fd), used_(0), ok_(true) {}
+
+  void Write(uint16_t type, uint16_t name, const void* payload, size_t size) {
+    Begin(type, name, size);
+    Append(payload, size);
+    End(size);
+  }
+  template<typename Record>
+  void Write(uint16_t type, uint16_t name, const Record& record) {
+    Write(type, name, &record, sizeof(record));
+  }
+
+  // A record whose payload is passed to Append() in pieces. |size| is the
+  // total.
+  void Begin(uint16_t type, uint16_t name, size_t size) {
+    RecordHeader header = { type, name, static_cast<uint32_t>(size) };
+    Append(&header, sizeof(header));
+  }
+  void Append(const void* data, size_t size) {
+    const char* bytes = static_cast<const char*>(data);
+    while (size) {
+      if (used_ == sizeof(buffer_))
+        Flush();
+      size_t count = std::min(size, sizeof(buffer_) - used_);
+      memcpy(&buffer_[used_], bytes, count);
+      used_ += count;
+      bytes += count;
+      size -= count;
+    }
+  }
+  void End(size_t size) {
+    static const char kZeros[8] = { 0 };
+    Append(kZeros, Padded(size) - size);
+  }
+
+  // Returns false if any write failed.
+  bool Flush() {
+    if (ok_ && used_ && WriteFileDescriptor(fd_, buffer_, used_) < 0)
+      ok_ = false;
+    used_ = 0;
+    return ok_;
+  }
+
+  // Returns the number of |name|, first writing a kRecordName record for it
+  // if it hasn't been written yet.
+  uint16_t Name(const string& name) {
+    for (size_t i = 0; i < names_.size(); i++)
+      if (*names_[i] == name)
+        return i;
+    if (names_.size() == kNoName) {
+      ErrOnce("Too many names in the activity log");
+      return kNoName;
+    }
+    uint16_t number = names_.size();
+    names_.push_back(&name);
+    Write(kRecordName, number, name.data(), name.size());
+    return number;
+  }
+
+ private:
+  int fd_;
+  char buffer_[16384];
+  size_t used_;
+  bool ok_;
+  // Strings that have been given numbers, by number. They point into the
+  // entries, which outlive the writer.
+  std::vector<const string*> names_;
+};
+
+// Writes a single record, without padding, to a fixed buffer. Its name, if
+// it has one, is kept aside and numbered 0.
+class BufferWriter {
+ public:
+  BufferWriter(char* buffer, size_t capacity)
+      : buffer_(buffer), capacity_(capacity), used_(0), fits_(true),
+        name_(nullptr) {}
+
+  void Write(uint16_t type, uint16_t name, const void* payload, size_t size) {
+    Begin(type, name, size);
+    Append(payload, size);
+  }
+  template<typename Record>
+  void Write(uint16_t type, uint16_t name, const Record& record) {
+    Write(type, name, &record, sizeof(record));
+  }
+
+  void Begin(uint16_t type, uint16_t name, size_t size) {
+    RecordHeader header = { type, name, static_cast<uint32_t>(size) };
+    fits_ = sizeof(header) + size <= capacity_;
+    Append(&header, sizeof(header));
+  }
+  void Append(const void* data, size_t size) {
+    if (!fits_)
+      return;
+    memcpy(&buffer_[used_], data, size);
+    used_ += size;
+  }
+  void End(size_t size) {}
+
+  uint16_t Name(const string& name) {
+    name_ = &name;
+    return 0;
+  }
+
+  // Bytes written, or 0 if the record didn't fit
+  size_t size() const { return fits_ ? used_ : 0; }
+  const string* name() const { return name_; }
+
+ private:
+  char* buffer_;
+  size_t capacity_;
+  size_t used_;
+  bool fits_;
+  const string* name_;
+};
+
+template<typename Writer>
+void WriteHardwareState(Writer* writer, uint16_t type, uint16_t name,
+                        const HardwareState& hwstate) {
+  size_t finger_cnt = hwstate.fingers ? hwstate.finger_cnt : 0;
+  if (finger_cnt != hwstate.finger_cnt)
+    Err("Have finger_cnt %d but fingers is null!", hwstate.finger_cnt);
+  HardwareStateRecord record = {
+    .timestamp = hwstate.timestamp,
+    .msc_timestamp = hwstate.msc_timestamp,
+    .buttons_down = hwstate.buttons_down,
+    .finger_cnt = static_cast<uint16_t>(finger_cnt),
+    .touch_cnt = hwstate.touch_cnt,
+    .rel_x = hwstate.rel_x,
+    .rel_y = hwstate.rel_y,
+    .rel_wheel = hwstate.rel_wheel,
+    .rel_wheel_hi_res = hwstate.rel_wheel_hi_res,
+    .rel_hwheel = hwstate.rel_hwheel,
+    .reserved = 0,
+  };
+  size_t size = sizeof(record) + finger_cnt * sizeof(FingerStateRecord);
+  writer->Begin(type, name, size);
+  writer->Append(&record, sizeof(record));
+  for (size_t i = 0; i < finger_cnt; i++) {
+    const FingerState& fs = hwstate.fingers[i];
+    FingerStateRecord finger = {
+      .touch_major = fs.touch_major,
+      .touch_minor = fs.touch_minor,
+      .width_major = fs.width_major,
+      .width_minor = fs.width_minor,
+      .pressure = fs.pressure,
+      .orientation = fs.orientation,
+      .position_x = fs.position_x,
+      .position_y = fs.position_y,
+      .tracking_id = fs.tracking_id,
+      .tool_type = static_cast<uint16_t>(fs.tool_type),
+      .flags = fs.flags,
+    };
+    writer->Append(&finger, sizeof(finger));
+  }
+  writer->End(size);
+}
+
+HardwarePropertiesRecord MakeHardwarePropertiesRecord(
+    const HardwareProperties& hwprops) {
+  HardwarePropertiesRecord record = {
+    .left = hwprops.left,
+    .top = hwprops.top,
+    .right = hwprops.right,
+    .bottom = hwprops.bottom,
+    .res_x = hwprops.res_x,
+    .res_y = hwprops.res_y,
+    .orientation_minimum = hwprops.orientation_minimum,
+    .orientation_maximum = hwprops.orientation_maximum,
+    .max_finger_cnt = hwprops.max_finger_cnt,
+    .max_touch_cnt = hwprops.max_touch_cnt,
+    .flags = (hwprops.supports_t5r2 ? kSupportsT5R2 : 0u) |
+             (hwprops.support_semi_mt ? kSupportSemiMt : 0u) |
+             (hwprops.is_button_pad ? kIsButtonPad : 0u) |
+             (hwprops.has_wheel ? kHasWheel : 0u) |
+             (hwprops.wheel_is_hi_res ? kWheelIsHiRes : 0u) |
+             (hwprops.is_haptic_pad ? kIsHapticPad : 0u) |
+             (hwprops.reports_pressure ? kReportsPressure : 0u),
+  };
+  return record;
+}
+
+GestureRecord MakeGestureRecord(const Gesture& gesture) {
+  GestureRecord record = {
+    .start_time = gesture.start_time,
+    .end_time = gesture.end_time,
+    .type = gesture.type,
+    .flags = 0,
+    .ints = { 0, 0 },
+    .floats = { 0, 0, 0, 0 },
+  };
+  auto set_floats = [&record](float a, float b, float c, float d) {
+    record.floats[0] = a;
+    record.floats[1] = b;
+    record.floats[2] = c;
+    record.floats[3] = d;
+  };
+  const auto& details = gesture.details;
+  switch (gesture.type) {
+    case kGestureTypeMove:
+      set_floats(details.move.dx, details.move.dy,
+                 details.move.ordinal_dx, details.move.ordinal_dy);
+      break;
+    case kGestureTypeScroll:
+      set_floats(details.scroll.dx, details.scroll.dy,
+                 details.scroll.ordinal_dx, details.scroll.ordinal_dy);
+      if (details.scroll.stop_fling)
+        record.flags |= kScrollStopFling;
+      break;
+    case kGestureTypeMouseWheel:
+      set_floats(details.wheel.dx, details.wheel.dy, 0, 0);
+      record.ints[0] = details.wheel.tick_120ths_dx;
+      record.ints[1] = details.wheel.tick_120ths_dy;
+      break;
+    case kGestureTypePinch:
+      set_floats(details.pinch.dz, details.pinch.ordinal_dz, 0, 0);
+      record.ints[0] = details.pinch.zoom_state;
+      break;
+    case kGestureTypeButtonsChange:
+      record.ints[0] = details.buttons.down;
+      record.ints[1] = details.buttons.up;
+      if (details.buttons.is_tap)
+        record.flags |= kButtonsIsTap;
+      break;
+    case kGestureTypeFling:
+      set_floats(details.fling.vx, details.fling.vy,
+                 details.fling.ordinal_vx, details.fling.ordinal_vy);
+      if (details.fling.fling_state)
+        record.flags |= kFlingState;
+      break;
+    case kGestureTypeSwipe:
+      set_floats(details.swipe.dx, details.swipe.dy,
+                 details.swipe.ordinal_dx, details.swipe.ordinal_dy);
+      break;
+    case kGestureTypeFourFingerSwipe:
+      set_floats(details.four_finger_swipe.dx, details.four_finger_swipe.dy,
+                 details.four_finger_swipe.ordinal_dx,
+                 details.four_finger_swipe.ordinal_dy);
+      break;
+    case kGestureTypeMetrics:
+      set_floats(details.metrics.data[0], details.metrics.data[1], 0, 0);
+      record.ints[0] = details.metrics.type;
+      break;
+    default:
+      break;
+  }
+  return record;
+}
+
+Gesture GestureFromRecord(const GestureRecord& record) {
+  Gesture gesture;
+  gesture.start_time = record.start_time;
+  gesture.end_time = record.end_time;
+  gesture.type = static_cast<GestureType>(record.type);
+  const float* f = record.floats;
+  auto& details = gesture.details;
+  switch (gesture.type) {
+    case kGestureTypeMove:
+      details.move = { f[0], f[1], f[2], f[3] };
+      break;
+    case kGestureTypeScroll:
+      details.scroll = { f[0], f[1], f[2], f[3],
+                         (record.flags & kScrollStopFling) ? 1u : 0u };
+      break;
+    case kGestureTypeMouseWheel:
+      details.wheel = { f[0], f[1], record.ints[0], record.ints[1] };
+      break;
+    case kGestureTypePinch:
+      details.pinch = { f[0], f[1], static_cast<unsigned>(record.ints[0]) };
+      break;
+    case kGestureTypeButtonsChange:
+      details.buttons = { static_cast<unsigned>(record.ints[0]),
+                          static_cast<unsigned>(record.ints[1]),
+                          (record.flags & kButtonsIsTap) != 0 };
+      break;
+    case kGestureTypeFling:
+      details.fling = { f[0], f[1], f[2], f[3],
+                        (record.flags & kFlingState) ? 1u : 0u };
+      break;
+    case kGestureTypeSwipe:
+      details.swipe = { f[0], f[1], f[2], f[3] };
+      break;
+    case kGestureTypeFourFingerSwipe:
+      details.four_finger_swipe = { f[0], f[1], f[2], f[3] };
+      break;
+    case kGestureTypeMetrics:
+      details.metrics = { static_cast<GestureMetricsType>(record.ints[0]),
+                          { f[0], f[1] } };
+      break;
+    default:
+      break;
+  }
+  return gesture;
+}
+
+HandleTimerRecord MakeHandleTimerRecord(bool timeout_is_present, stime_t now,
+                                        stime_t timeout) {
+  return { now, timeout, timeout_is_present, 0 };
+}
+
+}  // namespace
+
+template<typename Writer>
+void ActivityLog::WriteRecord(Writer* writer, const Entry& entry) {
+  std::visit(
+    Visitor {
+      [writer](const HardwareState& hwstate) {
+        WriteHardwareState(writer, kRecordHardwareState, kNoName, hwstate);
+      },
+      [writer](const HardwareStatePre& pre) {
+        WriteHardwareState(writer, kRecordHardwareStatePre,
+                           writer->Name(pre.name), pre.hwstate);
+      },
+      [writer](const HardwareStatePost& post) {
+        WriteHardwareState(writer, kRecordHardwareStatePost,
+                           writer->Name(post.name), post.hwstate);
+      },
+      [writer](const TimerCallbackEntry& now) {
+        writer->Write(kRecordTimerCallback, kNoName,
+                      TimeRecord{now.timestamp});
+      },
+      [writer](const CallbackRequestEntry& when) {
+        writer->Write(kRecordCallbackRequest, kNoName,
+                      TimeRecord{when.timestamp});
+      },
+      [writer](const Gesture& gesture) {
+        writer->Write(kRecordGesture, kNoName, MakeGestureRecord(gesture));
+      },
+      [writer](const GestureConsume& consume) {
+        writer->Write(kRecordGestureConsume, writer->Name(consume.name),
+                      MakeGestureRecord(consume.gesture));
+      },
+      [writer](const GestureProduce& produce) {
+        writer->Write(kRecordGestureProduce, writer->Name(produce.name),
+                      MakeGestureRecord(produce.gesture));
+      },
+      [writer](const PropChangeEntry& prop_change) {
+        PropChangeRecord record = { 0, 0, 0 };
+        std::visit(
+          Visitor {
+            [&record](GesturesPropBool value) {
+              record = { static_cast<double>(value), kPropChangeBool, 0 };
+            },
+            [&record](double value) {
+              record = { value, kPropChangeDouble, 0 };
+            },
+            [&record](int value) {
+              record = { static_cast<double>(value), kPropChangeInt, 0 };
+            },
+            [&record](short value) {
+              record = { static_cast<double>(value), kPropChangeShort, 0 };
+            },
+          }, prop_change.value);
+        writer->Write(kRecordPropChange, writer->Name(prop_change.name),
+                      record);
+      },
+      [writer](const HandleTimerPre& handle) {
+        writer->Write(kRecordHandleTimerPre, writer->Name(handle.name),
+                      MakeHandleTimerRecord(handle.timeout_is_present,
+                                            handle.now, handle.timeout));
+      },
+      [writer](const HandleTimerPost& handle) {
+        writer->Write(kRecordHandleTimerPost, writer->Name(handle.name),
+                      MakeHandleTimerRecord(handle.timeout_is_present,
+                                            handle.now, handle.timeout));
+      },
+      [writer](const AccelGestureDebug& debug) {
+        AccelGestureDebugRecord record = {
+          .flags =
+              (debug.no_accel_for_gesture_type ? kNoAccelForGestureType
+                                               : 0u) |
+              (debug.no_accel_for_small_dt ? kNoAccelForSmallDt : 0u) |
+              (debug.no_accel_for_small_speed ? kNoAccelForSmallSpeed
+                                              : 0u) |
+              (debug.no_accel_for_bad_gain ? kNoAccelForBadGain : 0u) |
+              (debug.dropped_gesture ? kDroppedGesture : 0u) |
+              (debug.x_y_are_velocity ? kXYAreVelocity : 0u),
+          .x_scale = debug.x_scale,
+          .y_scale = debug.y_scale,
+          .dt = debug.dt,
+          .adjusted_dt = debug.adjusted_dt,
+          .speed = debug.speed,
+          .smoothed_speed = debug.smoothed_speed,
+          .gain_x = debug.gain_x,
+          .gain_y = debug.gain_y,
+          .reserved = 0,
+        };
+        writer->Write(kRecordAccelGestureDebug, kNoName, record);
+      },
+      [writer](const TimestampGestureDebug& debug) {
+        writer->Write(kRecordTimestampGestureDebug, kNoName,
+                      TimeRecord{debug.skew});
+      },
+      [writer](const TimestampHardwareStateDebug& debug) {
+        TimestampHardwareStateDebugRecord record = {
+          .flags = debug.is_using_fake ? kIsUsingFake : 0u,
+          .reserved = 0,
+          .times = { 0, 0, 0 },
+          .skew = debug.skew,
+          .max_skew = debug.max_skew,
+        };
+        if (debug.is_using_fake) {
+          if (debug.was_first_or_backward)
+            record.flags |= kWasFirstOrBackwardOrDivergenceReset;
+          record.times[0] = debug.prev_msc_timestamp_in;
+          record.times[1] = debug.prev_msc_timestamp_out;
+        } else {
+          if (debug.was_divergence_reset)
+            record.flags |= kWasFirstOrBackwardOrDivergenceReset;
+          record.times[0] = debug.fake_timestamp_in;
+          record.times[1] = debug.fake_timestamp_delta;
+          record.times[2] = debug.fake_timestamp_out;
+        }
+        writer->Write(kRecordTimestampHardwareStateDebug, kNoName, record);
+      },
+      [writer](const CheckpointEntry& checkpoint) {
+        TimeRecord time = { checkpoint.timestamp };
+        size_t size = sizeof(time) + checkpoint.state.size();
+        writer->Begin(kRecordCheckpoint, kNoName, size);
+        writer->Append(&time, sizeof(time));
+        writer->Append(checkpoint.state.data(), checkpoint.state.size());
+        writer->End(size);
+      },
+    }, entry.details);
+}
+
+size_t ActivityLog::EncodeRecord(const Entry& entry, char* buffer,
+                                 size_t capacity, const string** name) {
+  BufferWriter writer(buffer, capacity);
+  WriteRecord(&writer, entry);
+  *name = writer.name();
+  return writer.size();
+}
+
+bool ActivityLog::WriteBinary(int fd, const char* interpreter_name) {
+  RecordWriter writer(fd);
+  FileHeader header;
+  memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.byte_order_mark = kByteOrderMark;
+  header.version = kVersion;
+  writer.Append(&header, sizeof(header));
+
+  writer.Write(kRecordHardwareProperties, kNoName,
+               MakeHardwarePropertiesRecord(hwprops_));
+  if (interpreter_name)
+    writer.Write(kRecordInterpreterName, kNoName, interpreter_name,
+                 strlen(interpreter_name));
+  string gestures_version = GesturesVersion();
+  writer.Write(kRecordGesturesVersion, kNoName, gestures_version.data(),
+               gestures_version.size());
+  if (prop_reg_) {
+    Json::StreamWriterBuilder builder;
+    builder["indentation"] = "";
+    string properties = Json::writeString(builder, EncodePropRegistry());
+    writer.Write(kRecordProperties, kNoName, properties.data(),
+                 properties.size());
+  }
+
+  for (size_t i = 0; i < size_; ++i)
+    WriteRecord(&writer, buffer_[(i + head_idx_) % kBufferSize]);
+  return writer.Flush();
+}
+
+bool ActivityLog::StartFlightRecorder(const string& path,
+                                      const char* interpreter_name) {
+  FlightRecorderHeader header = {};
+  memcpy(header.magic, kFlightRecorderMagic, sizeof(kFlightRecorderMagic));
+  header.byte_order_mark = kByteOrderMark;
+  header.version = kFlightRecorderVersion;
+  // Room for the largest record this log can have
+  size_t record_size = std::max({
+      sizeof(HardwareStateRecord) + max_fingers_ * sizeof(FingerStateRecord),
+      sizeof(GestureRecord),
+      sizeof(AccelGestureDebugRecord),
+      sizeof(TimestampHardwareStateDebugRecord)});
+  header.slot_size =
+      Padded(sizeof(FlightRecorderSlot) + sizeof(RecordHeader) + record_size);
+  header.slot_count = kBufferSize;
+  header.hwprops = MakeHardwarePropertiesRecord(hwprops_);
+  // Strings that don't fit are cut short, leaving no NUL.
+  auto copy = [](char* out, size_t capacity, const string& in) {
+    memcpy(out, in.data(), std::min(in.size(), capacity));
+  };
+  if (interpreter_name)
+    copy(header.interpreter_name, sizeof(header.interpreter_name),
+         interpreter_name);
+  copy(header.gestures_version, sizeof(header.gestures_version),
+       GesturesVersion());
+
+  flight_recorder_ = FlightRecorder::Create(path.c_str(), header);
+  if (!flight_recorder_)
+    return false;
+  flight_recorder_path_ = path;
+  flight_recorder_interpreter_name_ = interpreter_name ? interpreter_name : "";
+  for (size_t i = 0; i < size_; ++i) {
+    const Entry& entry = buffer_[(i + head_idx_) % kBufferSize];
+    if (!std::holds_alternative<CheckpointEntry>(entry.details))
+      flight_recorder_->Record(entry);
+  }
+  return true;
+}
+
+void ActivityLog::StopFlightRecorder() {
+  flight_recorder_.reset();
+}
+
+void ActivityLog::RecordTail() {
+  // Checkpoints don't fit in a slot, and a crash dump has no use for them.
+  const Entry& entry = buffer_[TailIdx()];
+  if (!std::holds_alternative<CheckpointEntry>(entry.details))
+    flight_recorder_->Record(entry);
+}
+
+bool ActivityLog::DumpBinary(const char* filename,
+                             const char* interpreter_name) {
+  int fd = HANDLE_EINTR(creat(filename, 0666));
+  if (fd < 0) {
+    Err("Unable to create %s", filename);
+    return false;
+  }
+  bool ok = WriteBinary(fd, interpreter_name);
+  if (IGNORE_EINTR(close(fd)) < 0)
+    ok = false;
+  return ok;
+}
+
+bool ActivityLog::ReadBinary(const char* data, size_t size,
+                             BinaryInfo* info) {
+  if (size >= sizeof(kFlightRecorderMagic) &&
+      !memcmp(data, kFlightRecorderMagic, sizeof(kFlightRecorderMagic))) {
+    string log;
+    if (!FlightRecorder::ToBinaryLog(data, size, &log))
+      return false;
+    return ReadBinary(log.data(), log.size(), info);
+  }
+
+  FileHeader header;
+  if (size < sizeof(header)) {
+    Err("Binary log is too short");
+    return false;
+  }
+  memcpy(&header, data, sizeof(header));
+  if (memcmp(header.magic, kMagic, sizeof(kMagic))) {
+    Err("Not a binary activity log");
+    return false;
+  }
+  if (header.byte_order_mark != kByteOrderMark) {
+    Err("Binary log was written with the other byte order");
+    return false;
+  }
+  if (header.version != kVersion) {
+    Err("Unsupported binary log version %u", header.version);
+    return false;
+  }
+
+  Clear();
+  *info = BinaryInfo();
+  std::vector<string> names;
+  std::vector<FingerState> fingers;
+  size_t offset = sizeof(header);
+  while (offset < size) {
+    RecordHeader record;
+    if (size - offset < sizeof(record)) {
+      Err("Truncated record header at %zu", offset);
+      return false;
+    }
+    memcpy(&record, data + offset, sizeof(record));
+    offset += sizeof(record);
+    if (size - offset < record.size) {
+      Err("Truncated record at %zu", offset);
+      return false;
+    }
+    const char* payload = data + offset;
+    offset += std::min(Padded(record.size), size - offset);
+
+    // Copies the payload into |out|, if it is big enough.
+    auto read = [&record, payload](auto* out) {
+      if (record.size < sizeof(*out)) {
+        Err("Record of type %d is too short", record.type);
+        return false;
+      }
+      memcpy(out, payload, sizeof(*out));
+      return true;
+    };
+    const string* name = nullptr;
+    if (record.name != kNoName && record.type != kRecordName) {
+      if (record.name >= names.size()) {
+        Err("Undefined name %d", record.name);
+        return false;
+      }
+      name = &names[record.name];
+    }
+    static const string kEmpty;
+    const string& name_or_empty = name ? *name : kEmpty;
+
+    switch (record.type) {
+      case kRecordHardwareProperties: {
+        HardwarePropertiesRecord in;
+        if (!read(&in))
+          return false;
+        HardwareProperties hwprops = {
+          .left = in.left,
+          .top = in.top,
+          .right = in.right,
+          .bottom = in.bottom,
+          .res_x = in.res_x,
+          .res_y = in.res_y,
+          .orientation_minimum = in.orientation_minimum,
+          .orientation_maximum = in.orientation_maximum,
+          .max_finger_cnt = in.max_finger_cnt,
+          .max_touch_cnt = in.max_touch_cnt,
+          .supports_t5r2 = (in.flags & kSupportsT5R2) != 0,
+          .support_semi_mt = (in.flags & kSupportSemiMt) != 0,
+          .is_button_pad = (in.flags & kIsButtonPad) != 0,
+          .has_wheel = (in.flags & kHasWheel) != 0,
+          .wheel_is_hi_res = (in.flags & kWheelIsHiRes) != 0,
+          .is_haptic_pad = (in.flags & kIsHapticPad) != 0,
+          .reports_pressure = (in.flags & kReportsPressure) != 0,
+        };
+        SetHardwareProperties(hwprops);
+        break;
+      }
+      case kRecordInterpreterName:
+        info->interpreter_name.assign(payload, record.size);
+        break;
+      case kRecordGesturesVersion:
+        info->gestures_version.assign(payload, record.size);
+        break;
+      case kRecordProperties: {
+        Json::CharReaderBuilder builder;
+        std::unique_ptr<Json::CharReader> const reader(
+            builder.newCharReader());
+        string error_msg;
+        if (!reader->parse(payload, payload + record.size,
+                           &info->properties, &error_msg)) {
+          Err("Parsing properties failed: %s", error_msg.c_str());
+          return false;
+        }
+        break;
+      }
+      case kRecordName:
+        if (record.name == kNoName)
+          break;
+        if (record.name >= names.size())
+          names.resize(record.name + 1);
+        names[record.name].assign(payload, record.size);
+        break;
+      case kRecordHardwareState:
+      case kRecordHardwareStatePre:
+      case kRecordHardwareStatePost: {
+        HardwareStateRecord in;
+        if (!read(&in))
+          return false;
+        if (record.size < sizeof(in) +
+                          in.finger_cnt * sizeof(FingerStateRecord)) {
+          Err("Hardware state record is too short for its fingers");
+          return false;
+        }
+        fingers.resize(in.finger_cnt);
+        for (size_t i = 0; i < in.finger_cnt; i++) {
+          FingerStateRecord fs;
+          memcpy(&fs, payload + sizeof(in) + i * sizeof(fs), sizeof(fs));
+          fingers[i] = {
+            .touch_major = fs.touch_major,
+            .touch_minor = fs.touch_minor,
+            .width_major = fs.width_major,
+            .width_minor = fs.width_minor,
+            .pressure = fs.pressure,
+            .orientation = fs.orientation,
+            .position_x = fs.position_x,
+            .position_y = fs.position_y,
+            .tracking_id = fs.tracking_id,
+            .flags = fs.flags,
+            .tool_type = static_cast<FingerState::ToolType>(fs.tool_type),
+          };
+        }
+        HardwareState hwstate = {
+          .timestamp = in.timestamp,
+          .buttons_down = in.buttons_down,
+          .finger_cnt = in.finger_cnt,
+          .touch_cnt = in.touch_cnt,
+          .fingers = in.finger_cnt ? fingers.data() : nullptr,
+          .rel_x = in.rel_x,
+          .rel_y = in.rel_y,
+          .rel_wheel = in.rel_wheel,
+          .rel_wheel_hi_res = in.rel_wheel_hi_res,
+          .rel_hwheel = in.rel_hwheel,
+          .msc_timestamp = in.msc_timestamp,
+        };
+        if (record.type == kRecordHardwareState) {
+          LogHardwareState(hwstate);
+        } else if (record.type == kRecordHardwareStatePre) {
+          LogHardwareStatePre(name_or_empty, hwstate);
+          CopyFingersToTail(
+              &std::get<HardwareStatePre>(GetEntry(size_ - 1)->details)
+                  .hwstate);
+        } else {
+          LogHardwareStatePost(name_or_empty, hwstate);
+          CopyFingersToTail(
+              &std::get<HardwareStatePost>(GetEntry(size_ - 1)->details)
+                  .hwstate);
+        }
+        break;
+      }
+      case kRecordTimerCallback:
+      case kRecordCallbackRequest:
+      case kRecordTimestampGestureDebug: {
+        TimeRecord in;
+        if (!read(&in))
+          return false;
+        if (record.type == kRecordTimerCallback)
+          LogTimerCallback(in.time);
+        else if (record.type == kRecordCallbackRequest)
+          LogCallbackRequest(in.time);
+        else
+          LogDebugData(TimestampGestureDebug{in.time});
+        break;
+      }
+      case kRecordGesture:
+      case kRecordGestureConsume:
+      case kRecordGestureProduce: {
+        GestureRecord in;
+        if (!read(&in))
+          return false;
+        Gesture gesture = GestureFromRecord(in);
+        if (record.type == kRecordGesture)
+          LogGesture(gesture);
+        else if (record.type == kRecordGestureConsume)
+          LogGestureConsume(name_or_empty, gesture);
+        else
+          LogGestureProduce(name_or_empty, gesture);
+        break;
+      }
+      case kRecordPropChange: {
+        PropChangeRecord in;
+        if (!read(&in))
+          return false;
+        PropChangeEntry prop_change;
+        prop_change.name = name_or_empty;
+        switch (in.type) {
+          case kPropChangeBool:
+            prop_change.value = static_cast<GesturesPropBool>(in.value);
+            break;
+          case kPropChangeDouble:
+            prop_change.value = in.value;
+            break;
+          case kPropChangeInt:
+            prop_change.value = static_cast<int>(in.value);
+            break;
+          case kPropChangeShort:
+            prop_change.value = static_cast<short>(in.value);
+            break;
+          default:
+            Err("Unknown property change type %u", in.type);
+            return false;
+        }
+        LogPropChange(prop_change);
+        break;
+      }
+      case kRecordHandleTimerPre:
+      case kRecordHandleTimerPost: {
+        HandleTimerRecord in;
+        if (!read(&in))
+          return false;
+        const stime_t* timeout = in.timeout_is_present ? &in.timeout : nullptr;
+        if (record.type == kRecordHandleTimerPre)
+          LogHandleTimerPre(name_or_empty, in.now, timeout);
+        else
+          LogHandleTimerPost(name_or_empty, in.now, timeout);
+        break;
+      }
+      case kRecordAccelGestureDebug: {
+        AccelGestureDebugRecord in;
+        if (!read(&in))
+          return false;
+        auto flag = [&in](uint32_t mask) { return (in.flags & mask) != 0; };
+        AccelGestureDebug debug = {
+          .no_accel_for_gesture_type = flag(kNoAccelForGestureType),
+          .no_accel_for_small_dt = flag(kNoAccelForSmallDt),
+          .no_accel_for_small_speed = flag(kNoAccelForSmallSpeed),
+          .no_accel_for_bad_gain = flag(kNoAccelForBadGain),
+          .dropped_gesture = flag(kDroppedGesture),
+          .x_y_are_velocity = flag(kXYAreVelocity),
+          .x_scale = in.x_scale,
+          .y_scale = in.y_scale,
+          .dt = in.dt,
+          .adjusted_dt = in.adjusted_dt,
+          .speed = in.speed,
+          .smoothed_speed = in.smoothed_speed,
+          .gain_x = in.gain_x,
+          .gain_y = in.gain_y,
+        };
+        LogDebugData(debug);
+        break;
+      }
+      case kRecordTimestampHardwareStateDebug: {
+        TimestampHardwareStateDebugRecord in;
+        if (!read(&in))
+          return false;
+        TimestampHardwareStateDebug debug;
+        debug.is_using_fake = (in.flags & kIsUsingFake) != 0;
+        bool flag = (in.flags & kWasFirstOrBackwardOrDivergenceReset) != 0;
+        if (debug.is_using_fake) {
+          debug.was_first_or_backward = flag;
+          debug.prev_msc_timestamp_in = in.times[0];
+          debug.prev_msc_timestamp_out = in.times[1];
+        } else {
+          debug.was_divergence_reset = flag;
+          debug.fake_timestamp_in = in.times[0];
+          debug.fake_timestamp_delta = in.times[1];
+          debug.fake_timestamp_out = in.times[2];
+        }
+        debug.skew = in.skew;
+        debug.max_skew = in.max_skew;
+        LogDebugData(debug);
+        break;
+      }
+      case kRecordCheckpoint: {
+        TimeRecord in;
+        if (!read(&in))
+          return false;
+        LogCheckpoint(in.time, string(payload + sizeof(in),
+                                      record.size - sizeof(in)));
+        break;
+      }
+      default:
+        // From a newer writer; skip it.
+        break;
+    }
+  }
+  return true;
+}
+
+}  // namespace gestures
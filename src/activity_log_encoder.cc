@@ -0,0 +1,85 @@
+// Copyright 2026 The ChromiumOS Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "include/activity_log_encoder.h"
+
+#include <utility>
+
+namespace gestures {
+
+namespace {
+
+// Most encoded snapshots to keep for reuse. Each holds a whole ring buffer.
+const size_t kMaxSpareSnapshots = 2;
+
+}  // namespace
+
+ActivityLogEncoder::ActivityLogEncoder() : busy_(false), quit_(false) {}
+
+ActivityLogEncoder::~ActivityLogEncoder() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    quit_ = true;
+  }
+  queued_.notify_one();
+  if (worker_.joinable())
+    worker_.join();
+}
+
+void ActivityLogEncoder::Encode(ActivityLog* log,
+                                const char* interpreter_name,
+                                ActivityLogReadyFunction callback,
+                                void* client_data) {
+  Request request;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!spare_snapshots_.empty()) {
+      request.snapshot = std::move(spare_snapshots_.back());
+      spare_snapshots_.pop_back();
+    }
+  }
+  if (!request.snapshot)
+    request.snapshot.reset(new ActivityLog(nullptr));
+  log->Snapshot(request.snapshot.get(), &request.info);
+  if (interpreter_name)
+    request.info.interpreter_name = interpreter_name;
+  request.callback = callback;
+  request.client_data = client_data;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    requests_.push_back(std::move(request));
+    if (!worker_.joinable())
+      worker_ = std::thread(&ActivityLogEncoder::Run, this);
+  }
+  queued_.notify_one();
+}
+
+void ActivityLogEncoder::Wait() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  done_.wait(lock, [this] { return requests_.empty() && !busy_; });
+}
+
+void ActivityLogEncoder::Run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    queued_.wait(lock, [this] { return quit_ || !requests_.empty(); });
+    if (requests_.empty())
+      return;  // Quitting, with nothing left to encode
+    Request request = std::move(requests_.front());
+    requests_.pop_front();
+    busy_ = true;
+    lock.unlock();
+
+    std::string json = request.snapshot->Encode(request.info);
+    request.callback(request.client_data, json);
+
+    lock.lock();
+    if (spare_snapshots_.size() < kMaxSpareSnapshots)
+      spare_snapshots_.push_back(std::move(request.snapshot));
+    busy_ = false;
+    done_.notify_all();
+  }
+}
+
+}  // namespace gestures
@@ -0,0 +1,91 @@
+// Copyright 2026 The ChromiumOS Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "include/activity_log.h"
+#include "include/activity_log_encoder.h"
+#include "include/prop_registry.h"
+#include "include/unittest_util.h"
+
+using std::string;
+
+namespace gestures {
+
+class ActivityLogEncoderTest : public ::testing::Test {};
+
+namespace {
+
+void AppendLog(void* client_data, const string& log) {
+  static_cast<std::vector<string>*>(client_data)->push_back(log);
+}
+
+}  // namespace
+
+TEST(ActivityLogEncoderTest, SnapshotTest) {
+  PropRegistry prop_reg;
+  DoubleProperty double_prop(&prop_reg, "double prop", 77.25);
+  std::unique_ptr<ActivityLog> log(new ActivityLog(&prop_reg));
+  HardwareProperties hwprops = {
+    .right = 100, .bottom = 60,
+    .res_x = 10, .res_y = 12,
+    .orientation_minimum = -1, .orientation_maximum = 2,
+    .max_finger_cnt = 2, .max_touch_cnt = 5,
+    .supports_t5r2 = 0, .support_semi_mt = 0, .is_button_pad = 1,
+    .has_wheel = 0, .wheel_is_hi_res = 0, .is_haptic_pad = 0,
+  };
+  log->SetHardwareProperties(hwprops);
+  FingerState fs[] = {
+    { 1.5, 2.5, 0.0, 0.0, 9.0, 0.25, 3.0, 4.0, 22, 0 },
+    { 0.0, 0.0, 0.0, 0.0, 19.0, 0.0, 30.0, 40.0, 23, 0 },
+  };
+  HardwareState hs = make_hwstate(1.0, 0, 2, 2, fs);
+  log->LogHardwareState(hs);
+  log->LogHardwareStatePre("Pre", hs);
+  log->LogGesture(Gesture(kGestureMove, 1.0, 2.0, 3.5, -4.5));
+  log->LogPropChange({ "double prop", 3.25 });
+  string expected = log->Encode("Interpreter");
+
+  std::vector<string> logs;
+  ActivityLogEncoder encoder;
+  encoder.Encode(log.get(), "Interpreter", AppendLog, &logs);
+  // Nothing done to the log or what it points at after the snapshot shows.
+  fs[0].position_x = 99;
+  double_prop.val_ = 1.0;
+  log->LogTimerCallback(2.0);
+  encoder.Wait();
+  ASSERT_EQ(1, logs.size());
+  EXPECT_EQ(expected, logs[0]);
+
+  // A recycled snapshot holds only the newer log.
+  log->Clear();
+  log->LogCallbackRequest(3.0);
+  expected = log->Encode(nullptr);
+  encoder.Encode(log.get(), nullptr, AppendLog, &logs);
+  encoder.Wait();
+  ASSERT_EQ(2, logs.size());
+  EXPECT_EQ(expected, logs[1]);
+}
+
+TEST(ActivityLogEncoderTest, OrderTest) {
+  std::unique_ptr<ActivityLog> log(new ActivityLog(nullptr));
+  std::vector<string> expected;
+  std::vector<string> logs;
+  {
+    ActivityLogEncoder encoder;
+    for (int i = 0; i < 5; i++) {
+      log->LogTimerCallback(i);
+      expected.push_back(log->Encode(nullptr));
+      encoder.Encode(log.get(), nullptr, AppendLog, &logs);
+    }
+    // Destroying the encoder finishes the requests still queued.
+  }
+  EXPECT_EQ(expected, logs);
+}
+
+}  // namespace gestures
@@ -2,6 +2,9 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <unistd.h>
+
+#include <memory>
 #include <string>
 
 #include <gtest/gtest.h>
@@ -146,6 +149,165 @@ TEST(ActivityLogTest, VersionTest) {
   EXPECT_TRUE(thelog.find(VCSID) != string::npos);
 }
 
+// Returns |log| in the binary format.
+string WriteBinaryToString(ActivityLog* log, const char* interpreter_name) {
+  int fds[2];
+  if (pipe(fds) < 0)
+    return "";
+  // The test logs are small enough to fit in the pipe's buffer.
+  bool ok = log->WriteBinary(fds[1], interpreter_name);
+  close(fds[1]);
+  string data;
+  char buf[4096];
+  ssize_t len;
+  while ((len = read(fds[0], buf, sizeof(buf))) > 0)
+    data.append(buf, len);
+  close(fds[0]);
+  return ok ? data : "";
+}
+
+// Fills |log| with at least one of every kind of entry.
+void LogEveryEntryType(ActivityLog* log) {
+  HardwareProperties hwprops = {
+    .right = 100, .bottom = 60,
+    .res_x = 10, .res_y = 12,
+    .orientation_minimum = -1, .orientation_maximum = 2,
+    .max_finger_cnt = 2, .max_touch_cnt = 5,
+    .supports_t5r2 = 0, .support_semi_mt = 1, .is_button_pad = 1,
+    .has_wheel = 0, .wheel_is_hi_res = 0, .is_haptic_pad = 1,
+  };
+  log->SetHardwareProperties(hwprops);
+
+  // Pre and Post entries keep pointing at these fingers, so they must outlive
+  // the log.
+  static FingerState fs[] = {
+    { 1.5, 2.5, 0.0, 0.0, 9.0, 0.25, 3.0, 4.0, 22, GESTURES_FINGER_PALM },
+    { 0.0, 0.0, 0.0, 0.0, 19.0, 0.0, 30.0, 40.0, 23, 0 },
+  };
+  HardwareState hs = make_hwstate(1.0, GESTURES_BUTTON_LEFT, 2, 3, fs);
+  log->LogHardwareState(hs);
+  log->LogHardwareStatePre("Pre", hs);
+  log->LogHardwareStatePost("Post", hs);
+  log->LogTimerCallback(1.5);
+  log->LogCallbackRequest(1.75);
+  stime_t timeout = 0.125;
+  log->LogHandleTimerPre("Pre", 1.5, &timeout);
+  log->LogHandleTimerPost("Post", 1.5, nullptr);
+  Gesture gestures[] = {
+    Gesture(kGestureMove, 1.0, 2.0, 3.5, -4.5),
+    Gesture(kGestureScroll, 1.0, 2.0, 0.5, 1.5),
+    Gesture(kGestureMouseWheel, 1.0, 2.0, 1, 2, 120, 240),
+    Gesture(kGesturePinch, 1.0, 2.0, 1.25, GESTURES_ZOOM_UPDATE),
+    Gesture(kGestureButtonsChange, 1.0, 2.0, GESTURES_BUTTON_LEFT,
+            GESTURES_BUTTON_RIGHT, true),
+    Gesture(kGestureFling, 1.0, 2.0, 100, -200, GESTURES_FLING_TAP_DOWN),
+    Gesture(kGestureSwipe, 1.0, 2.0, 5, 6),
+    Gesture(kGestureSwipeLift, 1.0, 2.0),
+    Gesture(kGestureFourFingerSwipe, 1.0, 2.0, 7, 8),
+    Gesture(kGestureFourFingerSwipeLift, 1.0, 2.0),
+    Gesture(kGestureMetrics, 1.0, 2.0, kGestureMetricsTypeMouseMovement,
+            0.5, 0.75),
+    Gesture(),
+  };
+  for (const Gesture& gesture : gestures) {
+    log->LogGesture(gesture);
+    log->LogGestureConsume("Consume", gesture);
+    log->LogGestureProduce("Produce", gesture);
+  }
+  log->LogPropChange({ "bool prop", GesturesPropBool(false) });
+  log->LogPropChange({ "double prop", 3.25 });
+  log->LogPropChange({ "int prop", 7 });
+  log->LogPropChange({ "short prop", short(-3) });
+
+  ActivityLog::AccelGestureDebug accel = {};
+  accel.no_accel_for_small_speed = true;
+  accel.x_y_are_velocity = true;
+  accel.x_scale = 1.5;
+  accel.speed = 3;
+  accel.smoothed_speed = 2.5;
+  accel.gain_x = 0.75;
+  log->LogDebugData(accel);
+  log->LogDebugData(ActivityLog::TimestampGestureDebug{ 0.5 });
+  ActivityLog::TimestampHardwareStateDebug ts_debug = {};
+  ts_debug.is_using_fake = true;
+  ts_debug.was_first_or_backward = true;
+  ts_debug.prev_msc_timestamp_in = 1.5;
+  ts_debug.prev_msc_timestamp_out = 2.5;
+  ts_debug.skew = 0.25;
+  log->LogDebugData(ts_debug);
+  ts_debug.is_using_fake = false;
+  ts_debug.was_divergence_reset = false;
+  ts_debug.fake_timestamp_in = 3.5;
+  ts_debug.fake_timestamp_delta = 0.5;
+  ts_debug.fake_timestamp_out = 4;
+  ts_debug.max_skew = 1;
+  log->LogDebugData(ts_debug);
+}
+
+TEST(ActivityLogTest, BinaryRoundTripTest) {
+  PropRegistry prop_reg;
+  BoolProperty bool_prop(&prop_reg, "bool prop", true);
+  DoubleProperty double_prop(&prop_reg, "double prop", 77.25);
+  StringProperty string_prop(&prop_reg, "string prop", "foobarstr");
+  std::unique_ptr<ActivityLog> log(new ActivityLog(&prop_reg));
+  LogEveryEntryType(log.get());
+
+  string data = WriteBinaryToString(log.get(), "TestInterpreter");
+  std::unique_ptr<ActivityLog> copy(new ActivityLog(nullptr));
+  ActivityLog::BinaryInfo info;
+  ASSERT_TRUE(copy->ReadBinary(data.data(), data.size(), &info));
+  EXPECT_EQ(log->size(), copy->size());
+  EXPECT_EQ("TestInterpreter", info.interpreter_name);
+  EXPECT_EQ(log->EncodePropRegistry(), info.properties);
+
+  Json::Value expected = log->EncodeCommonInfo();
+  expected[ActivityLog::kKeyInterpreterName] = Json::Value("TestInterpreter");
+  log->AddEncodeInfo(&expected);
+  EXPECT_EQ(expected.toStyledString(), copy->Encode(info));
+
+  // Anything that isn't a whole binary log is rejected.
+  string encoded = log->Encode();
+  EXPECT_FALSE(copy->ReadBinary(encoded.data(), encoded.size(), &info));
+  EXPECT_FALSE(copy->ReadBinary(data.data(), data.size() - 1, &info));
+  EXPECT_FALSE(copy->ReadBinary(data.data(), 20, &info));
+  // A header alone is an empty log.
+  EXPECT_TRUE(copy->ReadBinary(data.data(), 16, &info));
+  EXPECT_EQ(0, copy->size());
+}
+
+TEST(ActivityLogTest, StreamedEncodeTest) {
+  PropRegistry prop_reg;
+  BoolProperty bool_prop(&prop_reg, "bool prop", true);
+  DoubleProperty double_prop(&prop_reg, "double prop", 77.25);
+  IntProperty int_prop(&prop_reg, "int prop", -816);
+  StringProperty string_prop(&prop_reg, "string prop", "foo\"bar\n");
+  std::unique_ptr<ActivityLog> log(new ActivityLog(&prop_reg));
+  LogEveryEntryType(log.get());
+  Gesture unknown;
+  unknown.type = static_cast<GestureType>(99);
+  log->LogGesture(unknown);
+
+  // Encode() streams exactly what the Json::Value tree prints as.
+  Json::Value expected = log->EncodeCommonInfo();
+  log->AddEncodeInfo(&expected);
+  EXPECT_EQ(expected.toStyledString(), log->Encode());
+  expected[ActivityLog::kKeyInterpreterName] = Json::Value("TestInterpreter");
+  EXPECT_EQ(expected.toStyledString(), log->Encode("TestInterpreter"));
+
+  // Including after the ring buffer wraps around.
+  for (size_t i = 0; i < log->MaxSize() - 10; i++)
+    log->LogCallbackRequest(i * 0.25);
+  expected = log->EncodeCommonInfo();
+  log->AddEncodeInfo(&expected);
+  EXPECT_EQ(expected.toStyledString(), log->Encode());
+
+  // And for an empty log without properties.
+  ActivityLog empty(nullptr);
+  expected = empty.EncodeCommonInfo();
+  empty.AddEncodeInfo(&expected);
+  EXPECT_EQ(expected.toStyledString(), empty.Encode());
+}
+
 TEST(ActivityLogTest, EncodePropChangeBoolTest) {
   ActivityLog log(nullptr);
   Json::Value ret;
@@ -4,16 +4,24 @@
 
 #include "include/activity_replay.h"
 
+#include <algorithm>
+#include <fcntl.h>
 #include <limits.h>
 #include <set>
 #include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include <gtest/gtest.h>
 #include <json/reader.h>
 #include <json/writer.h>
 
 #include "include/logging.h"
+#include "include/logging_filter_interpreter.h"
 #include "include/prop_registry.h"
+#include "include/state_archive.h"
+#include "include/string_util.h"
 #include "include/unittest_util.h"
 #include "include/util.h"
 
@@ -23,21 +31,64 @@ using std::string;
 
 namespace {
 
-// Helper to std::visit with lambdas.
-template <typename... V>
-struct Visitor : V... {
-  using V::operator()...;
-};
-// Explicit deduction guide (not needed as of C++20).
-template <typename... V>
-Visitor(V...) -> Visitor<V...>;
+size_t SkipWhitespace(const char* data, size_t size, size_t pos) {
+  while (pos < size && (data[pos] == ' ' || data[pos] == '\t' ||
+                        data[pos] == '\n' || data[pos] == '\r'))
+    pos++;
+  return pos;
+}
+
+// Returns the offset just past the JSON value at |pos|, or npos if it is cut
+// short. Only strings and brackets are looked at, so this is much cheaper
+// than parsing the value, and malformed values are left for the parser.
+size_t SkipValue(const char* data, size_t size, size_t pos) {
+  size_t depth = 0;
+  for (; pos < size; pos++) {
+    switch (data[pos]) {
+      case '"':
+        for (pos++; pos < size && data[pos] != '"'; pos++)
+          if (data[pos] == '\\')
+            pos++;
+        if (pos >= size)
+          return std::string::npos;
+        break;
+      case '[':
+      case '{':
+        depth++;
+        break;
+      case ']':
+      case '}':
+        if (!depth)
+          return pos;  // The end of the enclosing value
+        depth--;
+        break;
+      case ',':
+      case ' ':
+      case '\t':
+      case '\n':
+      case '\r':
+        if (!depth)
+          return pos;
+        break;
+    }
+    if (!depth && (data[pos] == '"' || data[pos] == ']' || data[pos] == '}'))
+      return pos + 1;
+  }
+  return depth ? std::string::npos : pos;
+}
 
 } // namespace
 
 namespace gestures {
 
 ActivityReplay::ActivityReplay(PropRegistry* prop_reg)
-    : log_(nullptr), prop_reg_(prop_reg) {}
+    : log_(nullptr), prop_reg_(prop_reg), mapping_(nullptr), mapping_size_(0),
+      stream_pos_(0), stream_failed_(false), honor_all_props_(true),
+      has_checkpoint_(false), first_entry_(0), failures_(0) {}
+
+ActivityReplay::~ActivityReplay() {
+  Close();
+}
 
 bool ActivityReplay::Parse(const string& data) {
   std::set<string> emptyset;
@@ -46,8 +97,8 @@ bool ActivityReplay::Parse(const string& data) {
 
 bool ActivityReplay::Parse(const string& data,
                            const std::set<string>& honor_props) {
+  Close();
   log_.Clear();
-  names_.clear();
 
   string error_msg;
   Json::Value root;
@@ -67,24 +118,11 @@ bool ActivityReplay::Parse(const string& data,
         root.type(), Json::objectValue);
     return false;
   }
-  // Get and apply user-configurable properties
-  Json::Value props_dict =
-      root.get(ActivityLog::kKeyProperties, Json::Value());
-  if (root.isMember(ActivityLog::kKeyProperties) &&
-      !ParseProperties(props_dict, honor_props)) {
-    Err("Unable to parse properties.");
-    return false;
-  }
-  // Get and apply hardware properties
-  if (!root.isMember(ActivityLog::kKeyHardwarePropRoot)) {
-    Err("Unable to get hwprops dict.");
+  if (!ParseHeader(root.get(ActivityLog::kKeyProperties, Json::Value()),
+                   root.isMember(ActivityLog::kKeyProperties),
+                   root.get(ActivityLog::kKeyHardwarePropRoot, Json::Value()),
+                   honor_props))
     return false;
-  }
-  Json::Value hwprops_dict =
-      root.get(ActivityLog::kKeyHardwarePropRoot, Json::Value());
-  if (!ParseHardwareProperties(hwprops_dict, &hwprops_))
-    return false;
-  log_.SetHardwareProperties(hwprops_);
   Json::Value entries = root.get(ActivityLog::kKeyRoot, Json::Value());
   char next_layer_path[PATH_MAX];
   snprintf(next_layer_path, sizeof(next_layer_path), "%s.%s",
@@ -105,12 +143,287 @@ bool ActivityReplay::Parse(const string& data,
       Err("Invalid entry at index %zu", i);
       return false;
     }
-    if (!ParseEntry(entry))
+    ActivityLog::Entry parsed;
+    if (!ParseEntry(entry, &parsed))
       return false;
+    AppendToLog(parsed);
   }
   return true;
 }
 
+bool ActivityReplay::ParseHeader(const Json::Value& props_dict,
+                                 bool has_props,
+                                 const Json::Value& hwprops_dict,
+                                 const std::set<string>& honor_props) {
+  // Get and apply user-configurable properties
+  properties_ = has_props ? props_dict : Json::Value(Json::objectValue);
+  honor_all_props_ = honor_props.empty();
+  if (has_props && !ParseProperties(props_dict, honor_props)) {
+    Err("Unable to parse properties.");
+    return false;
+  }
+  // Get and apply hardware properties
+  if (hwprops_dict.isNull()) {
+    Err("Unable to get hwprops dict.");
+    return false;
+  }
+  if (!ParseHardwareProperties(hwprops_dict, &hwprops_))
+    return false;
+  log_.SetHardwareProperties(hwprops_);
+  return true;
+}
+
+void ActivityReplay::AppendToLog(const ActivityLog::Entry& entry) {
+  std::visit(
+    Visitor {
+      [this](const HardwareState& hs) {
+        log_.LogHardwareState(hs);
+      },
+      [this](const ActivityLog::TimerCallbackEntry& now) {
+        log_.LogTimerCallback(now.timestamp);
+      },
+      [this](const ActivityLog::CallbackRequestEntry& when) {
+        log_.LogCallbackRequest(when.timestamp);
+      },
+      [this](const Gesture& gesture) {
+        log_.LogGesture(gesture);
+      },
+      [this](const ActivityLog::PropChangeEntry& prop_change) {
+        log_.LogPropChange(prop_change);
+      },
+      [this](const ActivityLog::CheckpointEntry& checkpoint) {
+        log_.LogCheckpoint(checkpoint.timestamp, checkpoint.state);
+      },
+      [](const auto& arg) {
+        Err("Unknown ActivityLog type");
+      }
+    }, entry.details);
+}
+
+bool ActivityReplay::Open(const char* path,
+                          const std::set<string>& honor_props) {
+  Close();
+  log_.Clear();
+  int fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    Err("Unable to open %s", path);
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) < 0 || st.st_size <= 0) {
+    Err("Unable to read %s", path);
+    close(fd);
+    return false;
+  }
+  void* mapping = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapping == MAP_FAILED) {
+    Err("Unable to map %s", path);
+    return false;
+  }
+  // Entries are read once, front to back.
+  madvise(mapping, st.st_size, MADV_SEQUENTIAL);
+  mapping_ = static_cast<char*>(mapping);
+  mapping_size_ = st.st_size;
+
+  // Find the top-level members without parsing the entries, which come
+  // first, then parse the small members that have to be applied before any
+  // entry is replayed.
+  const char* data = mapping_;
+  size_t size = mapping_size_;
+  size_t pos = SkipWhitespace(data, size, 0);
+  if (pos == size || data[pos] != '{') {
+    Err("Root of %s isn't a dictionary", path);
+    Close();
+    return false;
+  }
+  pos++;
+  size_t entries_pos = string::npos;
+  Json::Value props_dict;
+  Json::Value hwprops_dict;
+  Json::Value seek_index;
+  bool has_props = false;
+  Json::CharReaderBuilder builder;
+  std::unique_ptr<Json::CharReader> const reader(builder.newCharReader());
+  while (true) {
+    pos = SkipWhitespace(data, size, pos);
+    if (pos < size && data[pos] == '}')
+      break;
+    size_t key_end = SkipValue(data, size, pos);
+    if (key_end == string::npos || data[pos] != '"') {
+      Err("Malformed key in %s at %zu", path, pos);
+      Close();
+      return false;
+    }
+    string key(data + pos + 1, key_end - pos - 2);
+    pos = SkipWhitespace(data, size, key_end);
+    if (pos == size || data[pos] != ':') {
+      Err("Missing ':' in %s at %zu", path, pos);
+      Close();
+      return false;
+    }
+    size_t value_pos = SkipWhitespace(data, size, pos + 1);
+    size_t value_end = SkipValue(data, size, value_pos);
+    if (value_end == string::npos) {
+      Err("Malformed value in %s at %zu", path, value_pos);
+      Close();
+      return false;
+    }
+    Json::Value* dict = nullptr;
+    if (key == ActivityLog::kKeyRoot) {
+      entries_pos = value_pos;
+    } else if (key == ActivityLog::kKeyProperties) {
+      dict = &props_dict;
+      has_props = true;
+    } else if (key == ActivityLog::kKeyHardwarePropRoot) {
+      dict = &hwprops_dict;
+    } else if (key == ActivityLog::kKeySeekIndex) {
+      dict = &seek_index;
+    }
+    string error_msg;
+    if (dict && !reader->parse(data + value_pos, data + value_end, dict,
+                               &error_msg)) {
+      Err("Parse of %s failed: %s", key.c_str(), error_msg.c_str());
+      Close();
+      return false;
+    }
+    pos = SkipWhitespace(data, size, value_end);
+    if (pos < size && data[pos] == ',')
+      pos++;
+  }
+  if (entries_pos == string::npos || data[entries_pos] != '[') {
+    Err("Unable to get list of entries from root.");
+    Close();
+    return false;
+  }
+  if (!ParseHeader(props_dict, has_props, hwprops_dict, honor_props) ||
+      !ParseSeekIndex(seek_index)) {
+    Close();
+    return false;
+  }
+  stream_pos_ = entries_pos + 1;
+  entry_reader_.reset(builder.newCharReader());
+  return true;
+}
+
+bool ActivityReplay::NextEntry(ActivityLog::Entry* entry) {
+  if (!mapping_ || stream_failed_)
+    return false;
+  const char* data = mapping_;
+  size_t size = mapping_size_;
+  size_t pos = SkipWhitespace(data, size, stream_pos_);
+  if (pos < size && data[pos] == ',')
+    pos = SkipWhitespace(data, size, pos + 1);
+  if (pos < size && data[pos] == ']')
+    return false;
+  size_t end = SkipValue(data, size, pos);
+  string error_msg;
+  if (end == string::npos ||
+      !entry_reader_->parse(data + pos, data + end, &entry_json_,
+                            &error_msg) ||
+      !ParseEntry(entry_json_, entry)) {
+    Err("Unable to parse entry at %zu: %s", pos, error_msg.c_str());
+    stream_failed_ = true;
+    return false;
+  }
+  stream_pos_ = end;
+  return true;
+}
+
+void ActivityReplay::Close() {
+  if (mapping_)
+    munmap(mapping_, mapping_size_);
+  mapping_ = nullptr;
+  mapping_size_ = 0;
+  stream_pos_ = 0;
+  stream_failed_ = false;
+  entry_reader_.reset();
+  seek_index_.clear();
+  has_checkpoint_ = false;
+  checkpoint_ = ActivityLog::CheckpointEntry();
+  first_entry_ = 0;
+}
+
+bool ActivityReplay::ParseSeekIndex(const Json::Value& index) {
+  if (index.isNull())
+    return true;
+  if (!index.isArray()) {
+    Err("Seek index isn't an array");
+    return false;
+  }
+  for (const Json::Value& point : index) {
+    if (!point.isObject() ||
+        !point[ActivityLog::kKeySeekIndexOffset].isUInt64() ||
+        !point[ActivityLog::kKeySeekIndexTimestamp].isDouble()) {
+      Err("Malformed seek index");
+      return false;
+    }
+    size_t offset = point[ActivityLog::kKeySeekIndexOffset].asUInt64();
+    if (offset >= mapping_size_) {
+      Err("Seek index offset %zu is past the end of the log", offset);
+      return false;
+    }
+    seek_index_.push_back(std::make_pair(
+        point[ActivityLog::kKeySeekIndexTimestamp].asDouble(), offset));
+  }
+  std::sort(seek_index_.begin(), seek_index_.end());
+  return true;
+}
+
+bool ActivityReplay::SeekToCheckpoint(stime_t time) {
+  if (!mapping_) {
+    for (size_t i = log_.size(); i-- > 0;) {
+      const ActivityLog::CheckpointEntry* checkpoint =
+          std::get_if<ActivityLog::CheckpointEntry>(
+              &log_.GetEntry(i)->details);
+      if (checkpoint && checkpoint->timestamp <= time) {
+        has_checkpoint_ = true;
+        checkpoint_ = *checkpoint;
+        first_entry_ = i + 1;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // The last checkpoint at or before |time|
+  auto it = std::upper_bound(
+      seek_index_.begin(), seek_index_.end(), time,
+      [](stime_t time, const std::pair<stime_t, size_t>& point) {
+        return time < point.first;
+      });
+  if (it == seek_index_.begin())
+    return false;
+  --it;
+  // The offset is where the entry before the checkpoint ends, or for the
+  // first entry, where the array of entries is opened.
+  size_t saved_pos = stream_pos_;
+  stream_pos_ = SkipWhitespace(mapping_, mapping_size_, it->second);
+  if (stream_pos_ < mapping_size_ && mapping_[stream_pos_] == '[')
+    stream_pos_++;
+  ActivityLog::Entry entry;
+  const ActivityLog::CheckpointEntry* checkpoint = nullptr;
+  if (NextEntry(&entry))
+    checkpoint = std::get_if<ActivityLog::CheckpointEntry>(&entry.details);
+  if (!checkpoint || checkpoint->timestamp != it->first) {
+    Err("Seek index doesn't point at a checkpoint");
+    stream_pos_ = saved_pos;
+    stream_failed_ = false;
+    return false;
+  }
+  has_checkpoint_ = true;
+  checkpoint_ = *checkpoint;
+  return true;
+}
+
+bool ActivityReplay::IsIgnoredProperty(const char* name) {
+  // TODO(clchiou): This is just a emporary workaround for property changes.
+  // I will work out a solution for this kind of changes.
+  return !strcmp(name, "Compute Surface Area from Pressure") ||
+         !strcmp(name, "Touchpad Device Output Bias on X-Axis") ||
+         !strcmp(name, "Touchpad Device Output Bias on Y-Axis");
+}
+
 bool ActivityReplay::ParseProperties(const Json::Value& dict,
                                      const std::set<string>& honor_props) {
   if (!prop_reg_)
@@ -119,15 +432,8 @@ bool ActivityReplay::ParseProperties(const Json::Value& dict,
   for (::set<Property*>::const_iterator it = props.begin(), e = props.end();
        it != e; ++it) {
     const char* key = (*it)->name();
-
-    // TODO(clchiou): This is just a emporary workaround for property changes.
-    // I will work out a solution for this kind of changes.
-    if (!strcmp(key, "Compute Surface Area from Pressure") ||
-        !strcmp(key, "Touchpad Device Output Bias on X-Axis") ||
-        !strcmp(key, "Touchpad Device Output Bias on Y-Axis")) {
+    if (IsIgnoredProperty(key))
       continue;
-    }
-
     if (!honor_props.empty() && !SetContainsValue(honor_props, string(key)))
       continue;
     if (!dict.isMember(key)) {
@@ -139,6 +445,11 @@ bool ActivityReplay::ParseProperties(const Json::Value& dict,
       Err("Unable to restore value for property %s", key);
       return false;
     }
+    // Let the interpreters update anything they derive from the value. The
+    // logging controls are only recorded, as acting on them would dump,
+    // clear or move the replaying chain's log.
+    if (!LoggingFilterInterpreter::IsLoggingProperty(key))
+      (*it)->HandleGesturesPropWritten();
   }
   return true;
 }
@@ -190,7 +501,8 @@ bool ActivityReplay::ParseHardwareProperties(const Json::Value& obj,
 
 #undef PARSE_HP
 
-bool ActivityReplay::ParseEntry(const Json::Value& entry) {
+bool ActivityReplay::ParseEntry(const Json::Value& entry,
+                                ActivityLog::Entry* out) {
   if (!entry.isMember(ActivityLog::kKeyType) ||
       entry[ActivityLog::kKeyType].type() != Json::stringValue) {
     Err("Can't get entry type.");
@@ -198,20 +510,23 @@ bool ActivityReplay::ParseEntry(const Json::Value& entry) {
   }
   string type = entry[ActivityLog::kKeyType].asString();
   if (type == ActivityLog::kKeyHardwareState)
-    return ParseHardwareState(entry);
+    return ParseHardwareState(entry, out);
   if (type == ActivityLog::kKeyTimerCallback)
-    return ParseTimerCallback(entry);
+    return ParseTimerCallback(entry, out);
   if (type == ActivityLog::kKeyCallbackRequest)
-    return ParseCallbackRequest(entry);
+    return ParseCallbackRequest(entry, out);
   if (type == ActivityLog::kKeyGesture)
-    return ParseGesture(entry);
+    return ParseGesture(entry, out);
   if (type == ActivityLog::kKeyPropChange)
-    return ParsePropChange(entry);
+    return ParsePropChange(entry, out);
+  if (type == ActivityLog::kKeyCheckpoint)
+    return ParseCheckpoint(entry, out);
   Err("Unknown entry type");
   return false;
 }
 
-bool ActivityReplay::ParseHardwareState(const Json::Value& entry) {
+bool ActivityReplay::ParseHardwareState(const Json::Value& entry,
+                                        ActivityLog::Entry* out) {
   HardwareState hs = HardwareState();
   if (!entry.isMember(ActivityLog::kKeyHardwareStateButtonsDown)) {
     Err("Unable to parse hardware state buttons down");
@@ -232,24 +547,21 @@ bool ActivityReplay::ParseHardwareState(const Json::Value& entry) {
     Err("Unable to parse hardware state fingers");
     return false;
   }
-  Json::Value fingers = entry[ActivityLog::kKeyHardwareStateFingers];
-  // Sanity check
-  const size_t kMaxFingers = 30;
+  const Json::Value& fingers = entry[ActivityLog::kKeyHardwareStateFingers];
   if (fingers.size() > kMaxFingers) {
     Err("Too many fingers in hardware state");
     return false;
   }
-  FingerState fs[kMaxFingers];
   for (size_t i = 0; i < fingers.size(); ++i) {
     if (!fingers.isValidIndex(i)) {
       Err("Invalid entry at index %zu", i);
       return false;
     }
     const Json::Value& finger_state = fingers[static_cast<int>(i)];
-    if (!ParseFingerState(finger_state, &fs[i]))
+    if (!ParseFingerState(finger_state, &fingers_[i]))
       return false;
   }
-  hs.fingers = fs;
+  hs.fingers = fingers_;
   hs.finger_cnt = fingers.size();
   // There may not have rel_ entries for old logs
   if (entry.isMember(ActivityLog::kKeyHardwareStateRelX)) {
@@ -270,7 +582,7 @@ bool ActivityReplay::ParseHardwareState(const Json::Value& entry) {
     }
     hs.rel_hwheel = entry[ActivityLog::kKeyHardwareStateRelHWheel].asDouble();
   }
-  log_.LogHardwareState(hs);
+  out->details = hs;
   return true;
 }
 
@@ -332,26 +644,30 @@ bool ActivityReplay::ParseFingerState(const Json::Value& entry,
   return true;
 }
 
-bool ActivityReplay::ParseTimerCallback(const Json::Value& entry) {
+bool ActivityReplay::ParseTimerCallback(const Json::Value& entry,
+                                        ActivityLog::Entry* out) {
   if (!entry.isMember(ActivityLog::kKeyTimerNow)) {
     Err("can't parse timercallback");
     return false;
   }
-  log_.LogTimerCallback(entry[ActivityLog::kKeyTimerNow].asDouble());
+  out->details = ActivityLog::TimerCallbackEntry{
+      entry[ActivityLog::kKeyTimerNow].asDouble()};
   return true;
 }
 
-bool ActivityReplay::ParseCallbackRequest(const Json::Value& entry) {
+bool ActivityReplay::ParseCallbackRequest(const Json::Value& entry,
+                                          ActivityLog::Entry* out) {
   if (!entry.isMember(ActivityLog::kKeyCallbackRequestWhen)) {
     Err("can't parse callback request");
     return false;
   }
-  log_.LogCallbackRequest(
-      entry[ActivityLog::kKeyCallbackRequestWhen].asDouble());
+  out->details = ActivityLog::CallbackRequestEntry{
+      entry[ActivityLog::kKeyCallbackRequestWhen].asDouble()};
   return true;
 }
 
-bool ActivityReplay::ParseGesture(const Json::Value& entry) {
+bool ActivityReplay::ParseGesture(const Json::Value& entry,
+                                  ActivityLog::Entry* out) {
   if (!entry.isMember(ActivityLog::kKeyGestureType)) {
     Err("can't parse gesture type");
     return false;
@@ -399,7 +715,7 @@ bool ActivityReplay::ParseGesture(const Json::Value& entry) {
   } else {
     gs.type = kGestureTypeNull;
   }
-  log_.LogGesture(gs);
+  out->details = gs;
   return true;
 }
 
@@ -598,7 +914,8 @@ bool ActivityReplay::ParseGestureMetrics(const Json::Value& entry,
   return true;
 }
 
-bool ActivityReplay::ParsePropChange(const Json::Value& entry) {
+bool ActivityReplay::ParsePropChange(const Json::Value& entry,
+                                     ActivityLog::Entry* out) {
   ActivityLog::PropChangeEntry prop_change;
   if (!entry.isMember(ActivityLog::kKeyPropChangeType)) {
     Err("Can't get prop change type");
@@ -644,12 +961,23 @@ bool ActivityReplay::ParsePropChange(const Json::Value& entry) {
     Err("Unable to parse prop change name.");
     return false;
   }
-  const string* stored_name =
-      new string(entry[ActivityLog::kKeyPropChangeName].asString());  // alloc
-  // transfer ownership:
-  names_.push_back(std::shared_ptr<const string>(stored_name));
-  prop_change.name = stored_name->c_str();
-  log_.LogPropChange(prop_change);
+  prop_change.name = entry[ActivityLog::kKeyPropChangeName].asString();
+  out->details = std::move(prop_change);
+  return true;
+}
+
+bool ActivityReplay::ParseCheckpoint(const Json::Value& entry,
+                                     ActivityLog::Entry* out) {
+  ActivityLog::CheckpointEntry checkpoint;
+  if (!entry[ActivityLog::kKeyCheckpointTimestamp].isDouble() ||
+      !entry[ActivityLog::kKeyCheckpointState].isString() ||
+      !Base64Decode(entry[ActivityLog::kKeyCheckpointState].asString(),
+                    &checkpoint.state)) {
+    Err("Can't parse checkpoint");
+    return false;
+  }
+  checkpoint.timestamp = entry[ActivityLog::kKeyCheckpointTimestamp].asDouble();
+  out->details = std::move(checkpoint);
   return true;
 }
 
@@ -658,68 +986,101 @@ void ActivityReplay::Replay(Interpreter* interpreter,
                             MetricsProperties* mprops) {
   interpreter->Initialize(&hwprops_, nullptr, mprops, this);
 
+  failures_ = 0;
   stime_t last_timeout_req = -1.0;
-  // Use last_gs to save a copy of last gesture.
-  Gesture last_gs;
-  for (size_t i = 0; i < log_.size(); ++i) {
-    ActivityLog::Entry* entry = log_.GetEntry(i);
-    std::visit(
-      Visitor {
-        [&interpreter, &last_timeout_req](HardwareState hs) {
-          last_timeout_req = -1.0;
-          for (size_t i = 0; i < hs.finger_cnt; i++)
-            Log("Input Finger ID: %d", hs.fingers[i].tracking_id);
-          interpreter->SyncInterpret(hs, &last_timeout_req);
-        },
-        [&interpreter, &last_timeout_req]
-            (ActivityLog::TimerCallbackEntry now) {
-          last_timeout_req = -1.0;
-          interpreter->HandleTimer(now.timestamp, &last_timeout_req);
-        },
-        [&i, &last_timeout_req](ActivityLog::CallbackRequestEntry when) {
-          if (!DoubleEq(last_timeout_req, when.timestamp)) {
-            Err("Expected timeout request of %f, "
-                "but log has %f (entry idx %zu)",
-                last_timeout_req, when.timestamp, i);
-          }
-        },
-        [this](Gesture gesture) {
-          bool matched = false;
-          while (!consumed_gestures_.empty() && !matched) {
-            if (consumed_gestures_.front() == gesture) {
-              Log("Gesture matched:\n  Actual gesture: %s.\n"
-                  "Expected gesture: %s",
-                  consumed_gestures_.front().String().c_str(),
-                  gesture.String().c_str());
-              matched = true;
-            } else {
-              Log("Unmatched actual gesture: %s\n",
-                  consumed_gestures_.front().String().c_str());
-              ADD_FAILURE();
-            }
-            consumed_gestures_.pop_front();
-          }
-          if (!matched) {
-            Log("Missing logged gesture: %s", gesture.String().c_str());
-            ADD_FAILURE();
-          }
-        },
-        [this](ActivityLog::PropChangeEntry prop_change) {
-          ReplayPropChange(prop_change);
-        },
-        [](auto arg) {
-          Err("Unknown ActivityLog type");
-        }
-      }, entry->details);
+  if (has_checkpoint_) {
+    stime_t time = 0.0;
+    stime_t deadline = NO_DEADLINE;
+    if (!StateArchive::RestoreCheckpoint(
+            checkpoint_.state, interpreter,
+            honor_all_props_ ? prop_reg_ : nullptr, &time, &deadline)) {
+      failures_++;
+      ADD_FAILURE();
+    }
+    // Pick up the timeout the chain had requested when the checkpoint was
+    // taken, as if it had just returned it.
+    if (deadline != NO_DEADLINE)
+      last_timeout_req = deadline - time;
+  }
+  if (mapping_) {
+    ActivityLog::Entry entry;
+    for (size_t i = 0; NextEntry(&entry); ++i)
+      ReplayEntry(interpreter, entry, i, &last_timeout_req);
+    if (stream_failed_) {
+      failures_++;
+      ADD_FAILURE();
+    }
+  } else {
+    for (size_t i = has_checkpoint_ ? first_entry_ : 0; i < log_.size(); ++i)
+      ReplayEntry(interpreter, *log_.GetEntry(i), i, &last_timeout_req);
   }
   while (!consumed_gestures_.empty()) {
     Log("Unmatched actual gesture: %s\n",
         consumed_gestures_.front().String().c_str());
+    failures_++;
     ADD_FAILURE();
     consumed_gestures_.pop_front();
   }
 }
 
+void ActivityReplay::ReplayEntry(Interpreter* interpreter,
+                                 const ActivityLog::Entry& entry, size_t idx,
+                                 stime_t* last_timeout_req) {
+  std::visit(
+    Visitor {
+      [&interpreter, &last_timeout_req](HardwareState hs) {
+        *last_timeout_req = -1.0;
+        for (size_t i = 0; i < hs.finger_cnt; i++)
+          Log("Input Finger ID: %d", hs.fingers[i].tracking_id);
+        interpreter->SyncInterpret(hs, last_timeout_req);
+      },
+      [&interpreter, &last_timeout_req]
+          (ActivityLog::TimerCallbackEntry now) {
+        *last_timeout_req = -1.0;
+        interpreter->HandleTimer(now.timestamp, last_timeout_req);
+      },
+      [&idx, &last_timeout_req](ActivityLog::CallbackRequestEntry when) {
+        if (!DoubleEq(*last_timeout_req, when.timestamp)) {
+          Err("Expected timeout request of %f, "
+              "but log has %f (entry idx %zu)",
+              *last_timeout_req, when.timestamp, idx);
+        }
+      },
+      [this](Gesture gesture) {
+        bool matched = false;
+        while (!consumed_gestures_.empty() && !matched) {
+          if (consumed_gestures_.front() == gesture) {
+            Log("Gesture matched:\n  Actual gesture: %s.\n"
+                "Expected gesture: %s",
+                consumed_gestures_.front().String().c_str(),
+                gesture.String().c_str());
+            matched = true;
+          } else {
+            Log("Unmatched actual gesture: %s\n",
+                consumed_gestures_.front().String().c_str());
+            failures_++;
+            ADD_FAILURE();
+          }
+          consumed_gestures_.pop_front();
+        }
+        if (!matched) {
+          Log("Missing logged gesture: %s", gesture.String().c_str());
+          failures_++;
+          ADD_FAILURE();
+        }
+      },
+      [this](ActivityLog::PropChangeEntry prop_change) {
+        ReplayPropChange(prop_change);
+      },
+      [](const ActivityLog::CheckpointEntry& checkpoint) {
+        // Only used to start replay part way through
+      },
+      [](auto arg) {
+        Err("Unknown ActivityLog type");
+      }
+    }, entry.details);
+}
+
 void ActivityReplay::ConsumeGesture(const Gesture& gesture) {
   consumed_gestures_.push_back(gesture);
 }
@@ -2,19 +2,32 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <memory>
 #include <set>
 #include <string>
+#include <variant>
 #include <vector>
 
 #include <gtest/gtest.h>
+#include <json/reader.h>
+#include <json/value.h>
+#include <json/writer.h>
 
+#include "include/accel_filter_interpreter.h"
+#include "include/activity_log.h"
 #include "include/activity_replay.h"
 #include "include/command_line.h"
 #include "include/file_util.h"
 #include "include/finger_metrics.h"
 #include "include/gestures.h"
 #include "include/logging_filter_interpreter.h"
+#include "include/prop_registry.h"
 #include "include/string_util.h"
+#include "include/unittest_util.h"
 
 using std::string;
 
@@ -54,10 +67,253 @@ void SplitString(const std::string& str,
   SplitStringT(str, c, true, r);
 }
 
+// Writes |contents| to a new temporary file and returns its name
+string WriteTempFile(const string& contents) {
+  // std::tmpnam is considered unsafe because another process could create the
+  // temporary file after time std::tmpnam returns the name but before the code
+  // actually opens it. Because this is just test code, we don't need to be
+  // concerned about such security holes here.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+  const char* filename = std::tmpnam(nullptr);
+#pragma GCC diagnostic pop
+  if (!filename)
+    return "";
+  WriteFile(filename, contents.data(), contents.size());
+  return filename;
+}
+
+// Produces a one pixel per millisecond move for each frame
+class MoveInterpreter : public Interpreter {
+ public:
+  MoveInterpreter() : Interpreter(nullptr, nullptr, false) {}
+
+  virtual void SyncInterpret(HardwareState& hwstate, stime_t* timeout) {
+    ProduceGesture(Gesture(kGestureMove, hwstate.timestamp - 0.01,
+                           hwstate.timestamp, 10, 0));
+  }
+
+  virtual void HandleTimer(stime_t now, stime_t* timeout) {}
+};
+
+void SetProperty(PropRegistry* prop_reg, const char* name,
+                 const Json::Value& value) {
+  for (Property* prop : prop_reg->props()) {
+    if (strcmp(prop->name(), name))
+      continue;
+    EXPECT_TRUE(prop->SetValue(value));
+    prop->HandleGesturesPropWritten();
+    return;
+  }
+  ADD_FAILURE() << "No property " << name;
+}
+
+const HardwareProperties kHwprops = {
+  .right = 100, .bottom = 60,
+  .res_x = 10, .res_y = 12,
+  .orientation_minimum = -1, .orientation_maximum = 2,
+  .max_finger_cnt = 2, .max_touch_cnt = 5,
+  .supports_t5r2 = 0, .support_semi_mt = 0, .is_button_pad = 1,
+  .has_wheel = 0, .wheel_is_hi_res = 0, .is_haptic_pad = 0,
+};
+
 }  // namespace
 
 class ActivityReplayTest : public ::testing::Test {};
 
+TEST(ActivityReplayTest, StreamMatchesParseTest) {
+  PropRegistry prop_reg;
+  DoubleProperty double_prop(&prop_reg, "double prop", 1.5);
+  std::unique_ptr<ActivityLog> log(new ActivityLog(&prop_reg));
+  log->SetHardwareProperties(kHwprops);
+  FingerState fs[] = {
+    { 1.5, 2.5, 0.0, 0.0, 9.0, 0.25, 3.0, 4.0, 22, 0 },
+    { 0.0, 0.0, 0.0, 0.0, 19.0, 0.0, 30.0, 40.0, 23, 0 },
+  };
+  HardwareState hs = make_hwstate(1.0, 0, 2, 2, fs);
+  log->LogHardwareState(hs);
+  log->LogCallbackRequest(1.25);
+  log->LogTimerCallback(1.25);
+  log->LogGesture(Gesture(kGestureMove, 1.0, 1.25, 3.5, -4.5));
+  log->LogPropChange({ "double prop", 3.25 });
+  log->LogGesture(Gesture(kGestureFling, 1.0, 2.0, 100, -200,
+                          GESTURES_FLING_START));
+  string json = log->Encode();
+  string filename = WriteTempFile(json);
+  ASSERT_FALSE(filename.empty());
+
+  PropRegistry parsed_reg;
+  ActivityReplay parsed(&parsed_reg);
+  ASSERT_TRUE(parsed.Parse(json));
+
+  PropRegistry streamed_reg;
+  DoubleProperty streamed_prop(&streamed_reg, "double prop", 0.0);
+  ActivityReplay streamed(&streamed_reg);
+  ASSERT_TRUE(streamed.Open(filename.c_str(), std::set<string>()));
+  // Properties are applied before the first entry.
+  EXPECT_EQ(1.5, streamed_prop.val_);
+  std::unique_ptr<ActivityLog> copy(new ActivityLog(nullptr));
+  copy->SetHardwareProperties(streamed.hwprops());
+  ActivityLog::Entry entry;
+  while (streamed.NextEntry(&entry)) {
+    std::visit(
+      Visitor {
+        [&copy](const HardwareState& hs) { copy->LogHardwareState(hs); },
+        [&copy](const ActivityLog::TimerCallbackEntry& now) {
+          copy->LogTimerCallback(now.timestamp);
+        },
+        [&copy](const ActivityLog::CallbackRequestEntry& when) {
+          copy->LogCallbackRequest(when.timestamp);
+        },
+        [&copy](const Gesture& gesture) { copy->LogGesture(gesture); },
+        [&copy](const ActivityLog::PropChangeEntry& prop_change) {
+          copy->LogPropChange(prop_change);
+        },
+        [](const auto& other) { ADD_FAILURE(); }
+      }, entry.details);
+  }
+  EXPECT_FALSE(streamed.stream_failed());
+  EXPECT_EQ(parsed.log()->Encode(), copy->Encode());
+  unlink(filename.c_str());
+}
+
+TEST(ActivityReplayTest, StreamLongLogTest) {
+  std::unique_ptr<ActivityLog> log(new ActivityLog(nullptr));
+  log->SetHardwareProperties(kHwprops);
+  string json = log->Encode();
+  const string kNoEntries = "\"entries\" : []";
+  size_t entries_pos = json.find(kNoEntries);
+  ASSERT_NE(string::npos, entries_pos);
+  // More entries than an ActivityLog, and so Parse(), can hold
+  const size_t kEntries = log->MaxSize() + 100;
+  string entries = "\"entries\" : [";
+  for (size_t i = 0; i < kEntries; i++) {
+    if (i)
+      entries += ",";
+    entries += "{ \"now\" : " + std::to_string(i) +
+               ", \"type\" : \"timerCallback\" }";
+  }
+  entries += "]";
+  json.replace(entries_pos, kNoEntries.size(), entries);
+  string filename = WriteTempFile(json);
+  ASSERT_FALSE(filename.empty());
+
+  ActivityReplay replay(nullptr);
+  ASSERT_TRUE(replay.Open(filename.c_str(), std::set<string>()));
+  size_t count = 0;
+  ActivityLog::Entry entry;
+  while (replay.NextEntry(&entry)) {
+    auto* now = std::get_if<ActivityLog::TimerCallbackEntry>(&entry.details);
+    ASSERT_NE(nullptr, now);
+    EXPECT_EQ(count, now->timestamp);
+    count++;
+  }
+  EXPECT_FALSE(replay.stream_failed());
+  EXPECT_EQ(kEntries, count);
+  unlink(filename.c_str());
+
+  // A log cut short in its entries is rejected.
+  filename = WriteTempFile(json.substr(0, entries_pos + entries.size() / 2));
+  ASSERT_FALSE(filename.empty());
+  EXPECT_FALSE(replay.Open(filename.c_str(), std::set<string>()));
+  unlink(filename.c_str());
+}
+
+TEST(ActivityReplayTest, CustomAccelCurveTest) {
+  // Record a log with a custom pointer curve that triples all but the
+  // slowest motion.
+  PropRegistry record_reg;
+  LoggingFilterInterpreter recorder(
+      &record_reg,
+      new AccelFilterInterpreter(&record_reg, new MoveInterpreter, nullptr),
+      nullptr);
+  // The property holds all 20 segments, as (x, sqr, mul, int).
+  Json::Value curve(Json::arrayValue);
+  for (size_t i = 0; i < 20; i++) {
+    for (double val : { i ? 1e30 : 1.0, 0.0, i ? 3.0 : 1.0, 0.0 })
+      curve.append(val);
+  }
+  SetProperty(&record_reg, "Pointer Accel Curve", curve);
+  SetProperty(&record_reg, "Use Custom Touchpad Pointer Accel Curve",
+              Json::Value(true));
+  SetProperty(&record_reg, "Event Logging Enable", Json::Value(true));
+  // Like a log cut from a longer session, it has the curve only in its
+  // properties, not as a change.
+  recorder.Clear();
+  TestInterpreterWrapper wrapper(&recorder, &kHwprops);
+  FingerState fs = { 0, 0, 0, 0, 1, 0, 10, 10, 1, 0 };
+  for (int i = 0; i < 5; i++) {
+    HardwareState hs = make_hwstate(1.0 + i * 0.01, 0, 1, 1, &fs);
+    stime_t timeout = NO_DEADLINE;
+    Gesture* gesture = wrapper.SyncInterpret(hs, &timeout);
+    ASSERT_NE(nullptr, gesture);
+    EXPECT_FLOAT_EQ(30, gesture->details.move.dx);
+  }
+  string json = recorder.EncodeActivityLog();
+
+  // A chain starting from the default curve replays it once the logged
+  // properties are applied.
+  PropRegistry replay_reg;
+  LoggingFilterInterpreter replayed(
+      &replay_reg,
+      new AccelFilterInterpreter(&replay_reg, new MoveInterpreter, nullptr),
+      nullptr);
+  MetricsProperties mprops(&replay_reg);
+  ActivityReplay replay(&replay_reg);
+  ASSERT_TRUE(replay.Parse(json));
+  replay.Replay(&replayed, &mprops);
+  EXPECT_EQ(0, replay.failures());
+}
+
+TEST(ActivityReplayTest, LoggingPropertiesTest) {
+  PropRegistry record_reg;
+  LoggingFilterInterpreter recorder(&record_reg, new MoveInterpreter,
+                                    nullptr);
+  SetProperty(&record_reg, "Event Logging Enable", Json::Value(true));
+  TestInterpreterWrapper wrapper(&recorder, &kHwprops);
+  FingerState fs = { 0, 0, 0, 0, 1, 0, 10, 10, 1, 0 };
+  for (int i = 0; i < 3; i++) {
+    HardwareState hs = make_hwstate(1.0 + i * 0.01, 0, 1, 1, &fs);
+    stime_t timeout = NO_DEADLINE;
+    wrapper.SyncInterpret(hs, &timeout);
+  }
+
+  // A log whose properties ask for the log to be dumped, cleared and
+  // recorded to a file, as they may have been on the logged device.
+  string dump_path = WriteTempFile("");
+  string flight_path = WriteTempFile("");
+  ASSERT_FALSE(dump_path.empty());
+  ASSERT_FALSE(flight_path.empty());
+  unlink(dump_path.c_str());
+  unlink(flight_path.c_str());
+  string json = recorder.EncodeActivityLog();
+  Json::CharReaderBuilder reader_builder;
+  std::unique_ptr<Json::CharReader> reader(reader_builder.newCharReader());
+  Json::Value root;
+  ASSERT_TRUE(reader->parse(json.data(), json.data() + json.size(), &root,
+                            nullptr));
+  Json::Value& props = root[ActivityLog::kKeyProperties];
+  props["Log Path"] = dump_path;
+  props["Logging Notify"] = 1;
+  props["Logging Reset"] = 1;
+  props["Flight Recorder Path"] = flight_path;
+
+  // Replaying it doesn't act on them.
+  PropRegistry replay_reg;
+  LoggingFilterInterpreter replayed(&replay_reg, new MoveInterpreter,
+                                    nullptr);
+  MetricsProperties mprops(&replay_reg);
+  ActivityReplay replay(&replay_reg);
+  ASSERT_TRUE(replay.Parse(Json::writeString(Json::StreamWriterBuilder(),
+                                             root)));
+  replay.Replay(&replayed, &mprops);
+  EXPECT_EQ(0, replay.failures());
+  EXPECT_NE(0, access(dump_path.c_str(), F_OK));
+  EXPECT_NE(0, access(flight_path.c_str(), F_OK));
+  unlink(dump_path.c_str());
+  unlink(flight_path.c_str());
+}
+
 // This test reads a log file and replays it. This test should be enabled for a
 // hands-on debugging session.
 
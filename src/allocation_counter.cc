@@ -0,0 +1,89 @@
+// Copyright 2026 The ChromiumOS Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "include/allocation_counter.h"
+
+#include <atomic>
+#include <new>
+#include <stdlib.h>
+
+namespace {
+
+std::atomic<size_t> g_allocations(0);
+std::atomic<size_t> g_deallocations(0);
+
+void* CountedAlloc(size_t size) {
+  g_allocations.fetch_add(1, std::memory_order_relaxed);
+  void* ret = malloc(size ? size : 1);
+  if (!ret)
+    abort();
+  return ret;
+}
+
+void* CountedAlignedAlloc(size_t size, std::align_val_t align) {
+  g_allocations.fetch_add(1, std::memory_order_relaxed);
+  void* ret = nullptr;
+  if (posix_memalign(&ret, static_cast<size_t>(align), size ? size : 1))
+    abort();
+  return ret;
+}
+
+void CountedFree(void* ptr) {
+  if (!ptr)
+    return;
+  g_deallocations.fetch_add(1, std::memory_order_relaxed);
+  free(ptr);
+}
+
+}  // namespace
+
+void* operator new(size_t size) { return CountedAlloc(size); }
+void* operator new[](size_t size) { return CountedAlloc(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+  return CountedAlloc(size);
+}
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+  return CountedAlloc(size);
+}
+void* operator new(size_t size, std::align_val_t align) {
+  return CountedAlignedAlloc(size, align);
+}
+void* operator new[](size_t size, std::align_val_t align) {
+  return CountedAlignedAlloc(size, align);
+}
+
+void operator delete(void* ptr) noexcept { CountedFree(ptr); }
+void operator delete[](void* ptr) noexcept { CountedFree(ptr); }
+void operator delete(void* ptr, size_t) noexcept { CountedFree(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { CountedFree(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept {
+  CountedFree(ptr);
+}
+void operator delete[](void* ptr, std::align_val_t) noexcept {
+  CountedFree(ptr);
+}
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept {
+  CountedFree(ptr);
+}
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept {
+  CountedFree(ptr);
+}
+
+namespace gestures {
+
+void AllocationCounter::Reset() {
+  start_allocations_ = g_allocations.load(std::memory_order_relaxed);
+  start_deallocations_ = g_deallocations.load(std::memory_order_relaxed);
+}
+
+size_t AllocationCounter::allocations() const {
+  return g_allocations.load(std::memory_order_relaxed) - start_allocations_;
+}
+
+size_t AllocationCounter::deallocations() const {
+  return g_deallocations.load(std::memory_order_relaxed) -
+      start_deallocations_;
+}
+
+}  // namespace gestures
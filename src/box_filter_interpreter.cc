@@ -5,6 +5,7 @@
 #include "include/box_filter_interpreter.h"
 
 #include "include/macros.h"
+#include "include/state_archive.h"
 #include "include/tracer.h"
 #include "include/util.h"
 
@@ -26,7 +27,7 @@ void BoxFilterInterpreter::SyncInterpretImpl(HardwareState& hwstate,
 
   if (box_width_.val_ == 0.0 && box_height_.val_ == 0.0) {
     LogHardwareStatePost(name, hwstate);
-    next_->SyncInterpret(hwstate, timeout);
+    SyncInterpretNext(hwstate, timeout);
     return;
   }
   RemoveMissingIdsFromMap(&previous_output_, hwstate);
@@ -68,7 +69,12 @@ void BoxFilterInterpreter::SyncInterpretImpl(HardwareState& hwstate,
     previous_output_[hwstate.fingers[i].tracking_id] = hwstate.fingers[i];
 
   LogHardwareStatePost(name, hwstate);
-  next_->SyncInterpret(hwstate, timeout);
+  SyncInterpretNext(hwstate, timeout);
+}
+
+void BoxFilterInterpreter::ArchiveState(StateArchive* archive) {
+  FilterInterpreter::ArchiveState(archive);
+  archive->Archive(&previous_output_);
 }
 
 }  // namespace gestures
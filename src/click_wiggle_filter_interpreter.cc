@@ -7,6 +7,7 @@
 #include "include/gestures.h"
 #include "include/interpreter.h"
 #include "include/logging.h"
+#include "include/state_archive.h"
 #include "include/tracer.h"
 #include "include/util.h"
 
@@ -46,7 +47,7 @@ void ClickWiggleFilterInterpreter::SyncInterpretImpl(HardwareState& hwstate,
   }
 
   LogHardwareStatePost(name, hwstate);
-  next_->SyncInterpret(hwstate, timeout);
+  SyncInterpretNext(hwstate, timeout);
 }
 
 void ClickWiggleFilterInterpreter::UpdateClickWiggle(
@@ -76,7 +77,7 @@ void ClickWiggleFilterInterpreter::UpdateClickWiggle(
   // Update wiggle_recs_ for each current finger
   for (size_t i = 0; i < hwstate.finger_cnt; i++) {
     const FingerState& fs = hwstate.fingers[i];
-    std::map<short, ClickWiggleRec>::iterator it =
+    auto it =
         wiggle_recs_.find(fs.tracking_id);
     const bool new_finger = it == wiggle_recs_.end();
 
@@ -138,4 +139,13 @@ void ClickWiggleFilterInterpreter::SetWarpFlags(HardwareState& hwstate) const {
   }
 }
 
+void ClickWiggleFilterInterpreter::ArchiveState(StateArchive* archive) {
+  FilterInterpreter::ArchiveState(archive);
+  archive->Archive(&wiggle_recs_);
+  archive->Archive(&button_edge_occurred_);
+  archive->Archive(&button_edge_with_one_finger_);
+  archive->Archive(&prev_pressure_);
+  archive->Archive(&prev_buttons_);
+}
+
 }  // namespace gestures
@@ -0,0 +1,63 @@
+// Copyright 2026 The ChromiumOS Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Converts a binary activity log or a flight recorder file (see
+// activity_log_binary.h) to the JSON format that ActivityLog::Encode()
+// produces, so that ActivityReplay, tools/tplog.py and other consumers of the
+// JSON logs can read it.
+//
+// Usage: convert_activity_log binary_log [output.json]
+//
+// The JSON is written to stdout if no output file is given.
+
+#include <stdarg.h>
+#include <stdio.h>
+
+#include <memory>
+#include <string>
+
+#include "include/activity_log.h"
+#include "include/file_util.h"
+
+int main(int argc, char** argv) {
+  using namespace gestures;
+  if (argc != 2 && argc != 3) {
+    fprintf(stderr, "usage: %s binary_log [output.json]\n", argv[0]);
+    return 1;
+  }
+  std::string data;
+  if (!ReadFileToString(argv[1], &data)) {
+    fprintf(stderr, "Unable to read %s\n", argv[1]);
+    return 1;
+  }
+  // ActivityLog holds its whole ring buffer, too much for the stack.
+  std::unique_ptr<ActivityLog> log(new ActivityLog(nullptr));
+  ActivityLog::BinaryInfo info;
+  if (!log->ReadBinary(data.data(), data.size(), &info)) {
+    fprintf(stderr, "Unable to parse %s\n", argv[1]);
+    return 1;
+  }
+  std::string json = log->Encode(info);
+  if (argc == 2) {
+    fwrite(json.data(), 1, json.size(), stdout);
+    return 0;
+  }
+  if (WriteFile(argv[2], json.data(), json.size()) !=
+      static_cast<int>(json.size())) {
+    fprintf(stderr, "Unable to write %s\n", argv[2]);
+    return 1;
+  }
+  return 0;
+}
+
+extern "C" {
+
+void gestures_log(int verb, const char* fmt, ...) {
+  va_list args;
+  va_start(args, fmt);
+  vfprintf(stderr, fmt, args);
+  va_end(args);
+}
+
+}
@@ -0,0 +1,297 @@
+// Copyright 2026 The ChromiumOS Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Microbenchmark for the individual stages of the touchpad pipeline.
+//
+// Each interpreter is driven in isolation through TestInterpreterWrapper with
+// a synthetic HardwareState stream of 1 to N fingers, and the cost of each
+// frame is reported as ns/frame and heap allocations/frame. Filters are
+// terminated by a sink interpreter that turns the first finger's motion into
+// a Move gesture, so gesture-processing filters (accel, scaling, ...) have
+// work to do as well.
+//
+// Usage: bench [--frames=N] [--max_fingers=N] [--filter=SubstringOfName]
+//
+// Numbers are only comparable between runs of the same build configuration.
+
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "include/accel_filter_interpreter.h"
+#include "include/allocation_counter.h"
+#include "include/box_filter_interpreter.h"
+#include "include/click_wiggle_filter_interpreter.h"
+#include "include/command_line.h"
+#include "include/finger_merge_filter_interpreter.h"
+#include "include/finger_metrics.h"
+#include "include/fling_stop_filter_interpreter.h"
+#include "include/gestures.h"
+#include "include/haptic_button_generator_filter_interpreter.h"
+#include "include/iir_filter_interpreter.h"
+#include "include/immediate_interpreter.h"
+#include "include/integral_gesture_filter_interpreter.h"
+#include "include/logging_filter_interpreter.h"
+#include "include/lookahead_filter_interpreter.h"
+#include "include/metrics_filter_interpreter.h"
+#include "include/non_linearity_filter_interpreter.h"
+#include "include/palm_classifying_filter_interpreter.h"
+#include "include/prop_registry.h"
+#include "include/scaling_filter_interpreter.h"
+#include "include/sensor_jump_filter_interpreter.h"
+#include "include/split_correcting_filter_interpreter.h"
+#include "include/stationary_wiggle_filter_interpreter.h"
+#include "include/stuck_button_inhibitor_filter_interpreter.h"
+#include "include/t5r2_correcting_filter_interpreter.h"
+#include "include/timestamp_filter_interpreter.h"
+#include "include/trend_classifying_filter_interpreter.h"
+#include "include/unittest_util.h"
+
+namespace gestures {
+
+namespace {
+
+// Report rate of the synthetic device.
+const stime_t kFrameInterval = 0.01;
+
+// Terminal interpreter for filters under test: reports the first finger's
+// motion as a Move gesture.
+class BenchmarkSinkInterpreter : public Interpreter {
+ public:
+  BenchmarkSinkInterpreter() : Interpreter(nullptr, nullptr, false) {}
+
+ protected:
+  virtual void SyncInterpretImpl(HardwareState& hwstate, stime_t* timeout) {
+    if (hwstate.finger_cnt == 0) {
+      has_prev_ = false;
+      return;
+    }
+    const FingerState& fs = hwstate.fingers[0];
+    if (has_prev_) {
+      ProduceGesture(Gesture(kGestureMove, prev_time_, hwstate.timestamp,
+                             fs.position_x - prev_x_,
+                             fs.position_y - prev_y_));
+    }
+    has_prev_ = true;
+    prev_x_ = fs.position_x;
+    prev_y_ = fs.position_y;
+    prev_time_ = hwstate.timestamp;
+  }
+
+ private:
+  bool has_prev_ = false;
+  float prev_x_ = 0.0;
+  float prev_y_ = 0.0;
+  stime_t prev_time_ = 0.0;
+};
+
+struct BenchmarkCase {
+  const char* name;
+  // Takes ownership of |next|.
+  Interpreter* (*create)(PropRegistry* prop_reg, Interpreter* next);
+};
+
+template<typename T>
+Interpreter* CreateFilter(PropRegistry* prop_reg, Interpreter* next) {
+  return new T(prop_reg, next, nullptr);
+}
+
+template<typename T>
+Interpreter* CreateTouchpadFilter(PropRegistry* prop_reg, Interpreter* next) {
+  return new T(prop_reg, next, nullptr, GESTURES_DEVCLASS_TOUCHPAD);
+}
+
+template<typename T>
+Interpreter* CreatePropertylessFilter(PropRegistry* prop_reg,
+                                      Interpreter* next) {
+  return new T(next, nullptr);
+}
+
+Interpreter* CreateImmediateInterpreter(PropRegistry* prop_reg,
+                                        Interpreter* next) {
+  delete next;
+  return new ImmediateInterpreter(prop_reg, nullptr);
+}
+
+const BenchmarkCase kCases[] = {
+  { "AccelFilterInterpreter", CreateFilter<AccelFilterInterpreter> },
+  { "BoxFilterInterpreter", CreateFilter<BoxFilterInterpreter> },
+  { "ClickWiggleFilterInterpreter",
+    CreateFilter<ClickWiggleFilterInterpreter> },
+  { "FingerMergeFilterInterpreter",
+    CreateFilter<FingerMergeFilterInterpreter> },
+  { "FlingStopFilterInterpreter",
+    CreateTouchpadFilter<FlingStopFilterInterpreter> },
+  { "HapticButtonGeneratorFilterInterpreter",
+    CreateFilter<HapticButtonGeneratorFilterInterpreter> },
+  { "IirFilterInterpreter", CreateFilter<IirFilterInterpreter> },
+  { "IntegralGestureFilterInterpreter",
+    CreatePropertylessFilter<IntegralGestureFilterInterpreter> },
+  { "LoggingFilterInterpreter", CreateFilter<LoggingFilterInterpreter> },
+  { "LookaheadFilterInterpreter", CreateFilter<LookaheadFilterInterpreter> },
+  { "MetricsFilterInterpreter",
+    CreateTouchpadFilter<MetricsFilterInterpreter> },
+  { "NonLinearityFilterInterpreter",
+    CreateFilter<NonLinearityFilterInterpreter> },
+  { "PalmClassifyingFilterInterpreter",
+    CreateFilter<PalmClassifyingFilterInterpreter> },
+  { "ScalingFilterInterpreter",
+    CreateTouchpadFilter<ScalingFilterInterpreter> },
+  { "SensorJumpFilterInterpreter",
+    CreateFilter<SensorJumpFilterInterpreter> },
+  { "SplitCorrectingFilterInterpreter",
+    CreateFilter<SplitCorrectingFilterInterpreter> },
+  { "StationaryWiggleFilterInterpreter",
+    CreateFilter<StationaryWiggleFilterInterpreter> },
+  { "StuckButtonInhibitorFilterInterpreter",
+    CreatePropertylessFilter<StuckButtonInhibitorFilterInterpreter> },
+  { "T5R2CorrectingFilterInterpreter",
+    CreateFilter<T5R2CorrectingFilterInterpreter> },
+  { "TimestampFilterInterpreter", CreateFilter<TimestampFilterInterpreter> },
+  { "TrendClassifyingFilterInterpreter",
+    CreateFilter<TrendClassifyingFilterInterpreter> },
+  { "ImmediateInterpreter", CreateImmediateInterpreter },
+};
+
+HardwareProperties BenchmarkHardwareProperties() {
+  return {
+    .right = 1000,
+    .bottom = 600,
+    .res_x = 10,
+    .res_y = 10,
+    .orientation_minimum = -1,
+    .orientation_maximum = 2,
+    .max_finger_cnt = static_cast<unsigned short>(kMaxFingers),
+    .max_touch_cnt = static_cast<unsigned short>(kMaxFingers),
+    .supports_t5r2 = 0,
+    .support_semi_mt = 0,
+    .is_button_pad = 1,
+    .has_wheel = 0,
+    .wheel_is_hi_res = 0,
+    .is_haptic_pad = 0,
+  };
+}
+
+// Fills |fingers| with frame |frame| of a stream in which |finger_cnt|
+// fingers rest on the pad side by side and drift diagonally, with a little
+// pressure and size noise so the classifiers see realistic input.
+void SyntheticFrame(size_t frame, unsigned short finger_cnt,
+                    FingerState* fingers) {
+  for (unsigned short i = 0; i < finger_cnt; i++) {
+    const float wobble = static_cast<float>((frame * 7 + i * 3) % 5) * 0.2;
+    FingerState& fs = fingers[i];
+    fs = FingerState();
+    fs.touch_major = 10 + wobble;
+    fs.touch_minor = 8 + wobble;
+    fs.pressure = 40 + wobble * 5;
+    fs.position_x = 100 + 80 * i + static_cast<float>(frame % 500) * 0.5;
+    fs.position_y = 100 + 20 * i + static_cast<float>(frame % 500) * 0.3;
+    fs.tracking_id = i + 1;
+  }
+}
+
+uint64_t NowNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+struct BenchmarkResult {
+  double ns_per_frame;
+  double allocs_per_frame;
+};
+
+// Runs |frames| synthetic frames with |finger_cnt| fingers through a freshly
+// created instance of |bench_case|. The first frames are used as warm-up so
+// that the reported numbers reflect the steady state.
+BenchmarkResult RunCase(const BenchmarkCase& bench_case,
+                        unsigned short finger_cnt, size_t frames) {
+  PropRegistry prop_reg;
+  std::unique_ptr<Interpreter> interpreter(
+      bench_case.create(&prop_reg, new BenchmarkSinkInterpreter));
+  HardwareProperties hwprops = BenchmarkHardwareProperties();
+  TestInterpreterWrapper wrapper(interpreter.get(), &hwprops);
+
+  const size_t warmup_frames = std::min<size_t>(frames / 10 + 1, 1000);
+  FingerState fingers[kMaxFingers];
+  stime_t deadline = NO_DEADLINE;
+  uint64_t start_ns = 0;
+  AllocationCounter counter;
+  for (size_t i = 0; i < warmup_frames + frames; i++) {
+    if (i == warmup_frames) {
+      start_ns = NowNs();
+      counter.Reset();
+    }
+    const stime_t now = i * kFrameInterval;
+    // Fire any timer the pipeline asked for before the next frame arrives.
+    while (deadline != NO_DEADLINE && deadline <= now) {
+      stime_t timeout = NO_DEADLINE;
+      wrapper.HandleTimer(deadline, &timeout);
+      deadline = timeout < 0.0 ? NO_DEADLINE : deadline + timeout;
+    }
+    SyntheticFrame(i, finger_cnt, fingers);
+    HardwareState hs = make_hwstate(now, 0, finger_cnt, finger_cnt, fingers);
+    stime_t timeout = NO_DEADLINE;
+    wrapper.SyncInterpret(hs, &timeout);
+    deadline = timeout < 0.0 ? NO_DEADLINE : now + timeout;
+  }
+  const uint64_t elapsed_ns = NowNs() - start_ns;
+  return {
+    static_cast<double>(elapsed_ns) / frames,
+    static_cast<double>(counter.allocations()) / frames,
+  };
+}
+
+}  // namespace
+
+}  // namespace gestures
+
+int main(int argc, char** argv) {
+  using gestures::CommandLine;
+  CommandLine::Init(argc, argv);
+  CommandLine* cl = CommandLine::ForCurrentProcess();
+
+  size_t frames = 20000;
+  if (cl->HasSwitch("frames"))
+    frames = strtoul(cl->GetSwitchValueASCII("frames").c_str(), nullptr, 10);
+  size_t max_fingers = gestures::kMaxFingers;
+  if (cl->HasSwitch("max_fingers"))
+    max_fingers = std::min<size_t>(
+        strtoul(cl->GetSwitchValueASCII("max_fingers").c_str(), nullptr, 10),
+        gestures::kMaxFingers);
+  const std::string filter = cl->GetSwitchValueASCII("filter");
+  if (frames == 0 || max_fingers == 0) {
+    fprintf(stderr, "usage: %s [--frames=N] [--max_fingers=N] "
+            "[--filter=Name]\n", argv[0]);
+    return 1;
+  }
+
+  printf("%-40s %7s %12s %14s\n", "interpreter", "fingers", "ns/frame",
+         "allocs/frame");
+  for (const auto& bench_case : gestures::kCases) {
+    if (!filter.empty() && !strstr(bench_case.name, filter.c_str()))
+      continue;
+    for (size_t fingers = 1; fingers <= max_fingers; fingers++) {
+      gestures::BenchmarkResult result =
+          gestures::RunCase(bench_case, fingers, frames);
+      printf("%-40s %7zu %12.1f %14.3f\n", bench_case.name, fingers,
+             result.ns_per_frame, result.allocs_per_frame);
+    }
+  }
+  return 0;
+}
+
+extern "C" {
+
+// Library diagnostics would dominate the measurements; drop them.
+void gestures_log(int verb, const char* fmt, ...) {}
+
+}
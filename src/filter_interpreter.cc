@@ -6,15 +6,17 @@
 
 #include <json/value.h>
 
+#include "include/state_archive.h"
+
 namespace gestures {
 
 void FilterInterpreter::SyncInterpretImpl(HardwareState& hwstate,
                                           stime_t* timeout) {
-  next_->SyncInterpret(hwstate, timeout);
+  SyncInterpretNext(hwstate, timeout);
 }
 
 void FilterInterpreter::HandleTimerImpl(stime_t now, stime_t* timeout) {
-  next_->HandleTimer(now, timeout);
+  HandleTimerNext(now, timeout);
 }
 
 void FilterInterpreter::Initialize(const HardwareProperties* hwprops,
@@ -24,12 +26,19 @@ void FilterInterpreter::Initialize(const HardwareProperties* hwprops,
   Interpreter::Initialize(hwprops, metrics, mprops, consumer);
   if (next_)
     next_->Initialize(hwprops, metrics, mprops, this);
+  UpdateRoute();
 }
 
 void FilterInterpreter::ConsumeGesture(const Gesture& gesture) {
   ProduceGesture(gesture);
 }
 
+void FilterInterpreter::ArchiveState(StateArchive* archive) {
+  Interpreter::ArchiveState(archive);
+  archive->Archive(&next_timer_deadline_);
+  next_->ArchiveState(archive);
+}
+
 Json::Value FilterInterpreter::EncodeCommonInfo() {
   Json::Value root = Interpreter::EncodeCommonInfo();
 #ifdef DEEP_LOGS
@@ -60,6 +69,18 @@ stime_t FilterInterpreter::SetNextDeadlineAndReturnTimeoutVal(
   return std::min(next_timeout, local_timeout);
 }
 
+void FilterInterpreter::UpdateRoute() {
+  if (!next_)
+    return;
+  Interpreter* old_active = ActiveInterpreter();
+  // Inner filters only log their input in DEEP_LOGS builds, and then they
+  // keep logging it.
+  active_ = IsActive() || log_.get();
+  route_ = next_->ActiveInterpreter();
+  if (initialized_ && consumer_ && ActiveInterpreter() != old_active)
+    consumer_->RouteChanged();
+}
+
 bool FilterInterpreter::ShouldCallNextTimer(stime_t local_deadline) {
   if (local_deadline > 0.0 && next_timer_deadline_ > 0.0)
     return local_deadline > next_timer_deadline_;
@@ -2,12 +2,17 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <string.h>
+
 #include <string>
 
 #include <gtest/gtest.h>
 
 #include "include/filter_interpreter.h"
 #include "include/gestures.h"
+#include "include/prop_registry.h"
+#include "include/split_correcting_filter_interpreter.h"
+#include "include/stationary_wiggle_filter_interpreter.h"
 #include "include/unittest_util.h"
 #include "include/util.h"
 
@@ -68,4 +73,76 @@ TEST_F(FilterInterpreterTest, DeadlineSettingNextBeforeLocal) {
   EXPECT_TRUE(interpreter.ShouldCallNextTimer(10002.0));
 }
 
+namespace {
+
+class FilterInterpreterTestInterpreter : public Interpreter {
+ public:
+  FilterInterpreterTestInterpreter()
+      : Interpreter(nullptr, nullptr, false), sync_count_(0),
+        timer_count_(0) {}
+
+  int sync_count_;
+  int timer_count_;
+
+ protected:
+  virtual void SyncInterpretImpl(HardwareState& hwstate, stime_t* timeout) {
+    sync_count_++;
+  }
+  virtual void HandleTimerImpl(stime_t now, stime_t* timeout) {
+    timer_count_++;
+  }
+};
+
+void WriteBoolProperty(PropRegistry* prop_reg, const char* name, bool value) {
+  for (Property* prop : prop_reg->props()) {
+    if (strcmp(prop->name(), name))
+      continue;
+    static_cast<BoolProperty*>(prop)->val_ = value;
+    prop->HandleGesturesPropWritten();
+    return;
+  }
+  ADD_FAILURE() << "No property " << name;
+}
+
+}  // namespace
+
+TEST_F(FilterInterpreterTest, BypassInactiveFiltersTest) {
+  PropRegistry prop_reg;
+  FilterInterpreterTestInterpreter* base = new FilterInterpreterTestInterpreter;
+  StationaryWiggleFilterInterpreter* wiggle =
+      new StationaryWiggleFilterInterpreter(&prop_reg, base, nullptr);
+  SplitCorrectingFilterInterpreter* split =
+      new SplitCorrectingFilterInterpreter(&prop_reg, wiggle, nullptr);
+  FilterInterpreter outer(nullptr, split, nullptr, false);
+  HardwareProperties hwprops = {};
+  TestInterpreterWrapper wrapper(&outer, &hwprops);
+
+  // Both filters are disabled by default, so input skips them.
+  EXPECT_EQ(base, split->ActiveInterpreter());
+  EXPECT_EQ(base, wiggle->ActiveInterpreter());
+  EXPECT_EQ(base, outer.route_);
+  HardwareState hs = make_hwstate(1.0, 0, 0, 0, nullptr);
+  stime_t timeout = NO_DEADLINE;
+  wrapper.SyncInterpret(hs, &timeout);
+  wrapper.HandleTimer(1.5, &timeout);
+  EXPECT_EQ(1, base->sync_count_);
+  EXPECT_EQ(1, base->timer_count_);
+
+  // Enabling a filter routes input to it again.
+  WriteBoolProperty(&prop_reg, "Stationary Wiggle Filter Enabled", true);
+  EXPECT_EQ(wiggle, split->ActiveInterpreter());
+  EXPECT_EQ(wiggle, outer.route_);
+  EXPECT_EQ(base, wiggle->route_);
+  WriteBoolProperty(&prop_reg, "Split Corrector Enabled", true);
+  EXPECT_EQ(split, outer.route_);
+  EXPECT_EQ(wiggle, split->route_);
+
+  WriteBoolProperty(&prop_reg, "Stationary Wiggle Filter Enabled", false);
+  EXPECT_EQ(split, outer.route_);
+  EXPECT_EQ(base, split->route_);
+  hs = make_hwstate(2.0, 0, 0, 0, nullptr);
+  wrapper.SyncInterpret(hs, &timeout);
+  EXPECT_EQ(2, base->sync_count_);
+}
+
 }  // namespace gestures
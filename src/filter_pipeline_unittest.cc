@@ -0,0 +1,209 @@
+// Copyright 2026 The ChromiumOS Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string.h>
+
+#include <memory>
+#include <typeinfo>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "include/filter_pipeline.h"
+#include "include/finger_metrics.h"
+#include "include/fling_stop_filter_interpreter.h"
+#include "include/gestures.h"
+#include "include/immediate_interpreter.h"
+#include "include/interpreter.h"
+#include "include/logging_filter_interpreter.h"
+#include "include/lookahead_filter_interpreter.h"
+#include "include/prop_registry.h"
+#include "include/scaling_filter_interpreter.h"
+#include "include/stuck_button_inhibitor_filter_interpreter.h"
+#include "include/unittest_util.h"
+
+namespace gestures {
+
+class FilterPipelineTest : public ::testing::Test {};
+
+namespace {
+
+const HardwareProperties kHwprops = {
+  .right = 100, .bottom = 60,
+  .res_x = 1, .res_y = 1,
+  .orientation_minimum = -1, .orientation_maximum = 2,
+  .max_finger_cnt = 5, .max_touch_cnt = 5,
+  .supports_t5r2 = 0, .support_semi_mt = 0, .is_button_pad = 1,
+  .has_wheel = 0, .wheel_is_hi_res = 0, .is_haptic_pad = 0,
+};
+
+const size_t kFrames = 120;
+
+typedef PipelineStage<LoggingFilterInterpreter,
+                      StuckButtonInhibitorFilterInterpreter,
+                      ScalingFilterInterpreter, LookaheadFilterInterpreter,
+                      FlingStopFilterInterpreter,
+                      ImmediateInterpreter> TestPipeline;
+
+Interpreter* NewRuntimeChain(PropRegistry* prop_reg) {
+  Interpreter* temp = new ImmediateInterpreter(prop_reg, nullptr);
+  temp = new FlingStopFilterInterpreter(prop_reg, temp, nullptr,
+                                        GESTURES_DEVCLASS_TOUCHPAD);
+  temp = new LookaheadFilterInterpreter(prop_reg, temp, nullptr);
+  temp = new ScalingFilterInterpreter(prop_reg, temp, nullptr,
+                                      GESTURES_DEVCLASS_TOUCHPAD);
+  temp = new StuckButtonInhibitorFilterInterpreter(temp, nullptr);
+  return new LoggingFilterInterpreter(prop_reg, temp, nullptr);
+}
+
+// Runs a one finger move with a click, a pause, then a two finger scroll
+// through |interpreter|, calling its timer as a client would, and returns the
+// gestures it produced.
+class Driver : public GestureConsumer {
+ public:
+  explicit Driver(Interpreter* interpreter) : interpreter_(interpreter) {}
+
+  std::vector<Gesture> Run(PropRegistry* prop_reg) {
+    MetricsProperties mprops(prop_reg);
+    interpreter_->Initialize(&kHwprops, nullptr, &mprops, this);
+    stime_t deadline = NO_DEADLINE;
+    for (size_t i = 0; i < kFrames; i++) {
+      FingerState fingers[2];
+      memset(fingers, 0, sizeof(fingers));
+      unsigned short finger_cnt = 0;
+      int buttons = 0;
+      if (i < 40) {
+        fingers[0].pressure = 50;
+        fingers[0].position_x = 20 + i;
+        fingers[0].position_y = 30;
+        fingers[0].tracking_id = 1;
+        finger_cnt = 1;
+        buttons = i >= 20 && i < 25 ? GESTURES_BUTTON_LEFT : 0;
+      } else if (i >= 50 && i < 100) {
+        for (int j = 0; j < 2; j++) {
+          fingers[j].pressure = 50;
+          fingers[j].position_x = 30 + 20 * j;
+          fingers[j].position_y = 5 + (i - 50) * 0.8;
+          fingers[j].tracking_id = 2 + j;
+        }
+        finger_cnt = 2;
+      }
+      HardwareState hwstate =
+          make_hwstate(1.0 + i * 0.0125, buttons, finger_cnt, finger_cnt,
+                       fingers);
+      while (deadline != NO_DEADLINE && deadline <= hwstate.timestamp) {
+        stime_t now = deadline;
+        stime_t timeout = NO_DEADLINE;
+        interpreter_->HandleTimer(now, &timeout);
+        deadline = timeout == NO_DEADLINE ? NO_DEADLINE : now + timeout;
+      }
+      stime_t timeout = NO_DEADLINE;
+      interpreter_->SyncInterpret(hwstate, &timeout);
+      deadline =
+          timeout == NO_DEADLINE ? NO_DEADLINE : hwstate.timestamp + timeout;
+    }
+    return gestures_;
+  }
+
+  virtual void ConsumeGesture(const Gesture& gesture) {
+    gestures_.push_back(gesture);
+  }
+
+ private:
+  Interpreter* interpreter_;
+  std::vector<Gesture> gestures_;
+};
+
+// A property provider that configures the touchpad stack version and whether
+// the chain is composed at compile time, leaving other properties at their
+// defaults
+struct StackConfig {
+  int version;
+  bool use_static;
+};
+
+GesturesProp* CreateIntProp(void* data, const char* name, int* loc,
+                            size_t count, const int* init) {
+  if (!strcmp(name, "Touchpad Stack Version"))
+    *loc = static_cast<StackConfig*>(data)->version;
+  return reinterpret_cast<GesturesProp*>(data);
+}
+
+GesturesProp* CreateBoolProp(void* data, const char* name,
+                             GesturesPropBool* loc, size_t count,
+                             const GesturesPropBool* init) {
+  if (!strcmp(name, "Static Touchpad Pipeline"))
+    *loc = static_cast<StackConfig*>(data)->use_static;
+  return reinterpret_cast<GesturesProp*>(data);
+}
+
+GesturesProp* CreateStringProp(void* data, const char* name, const char** loc,
+                               const char* const init) {
+  return reinterpret_cast<GesturesProp*>(data);
+}
+
+GesturesProp* CreateRealProp(void* data, const char* name, double* loc,
+                             size_t count, const double* init) {
+  return reinterpret_cast<GesturesProp*>(data);
+}
+
+void RegisterHandlers(void* data, GesturesProp* prop, void* handler_data,
+                      GesturesPropGetHandler getter,
+                      GesturesPropSetHandler setter) {}
+
+void FreeProp(void* data, GesturesProp* prop) {}
+
+GesturesPropProvider stack_config_provider = {
+  CreateIntProp,
+  nullptr,
+  CreateBoolProp,
+  CreateStringProp,
+  CreateRealProp,
+  RegisterHandlers,
+  FreeProp
+};
+
+}  // namespace
+
+TEST(FilterPipelineTest, MatchesRuntimeChainTest) {
+  PropRegistry runtime_props;
+  std::unique_ptr<Interpreter> runtime(NewRuntimeChain(&runtime_props));
+  std::vector<Gesture> expected = Driver(runtime.get()).Run(&runtime_props);
+
+  PropRegistry static_props;
+  std::unique_ptr<Interpreter> composed(
+      TestPipeline::Create(&static_props, nullptr,
+                           GESTURES_DEVCLASS_TOUCHPAD));
+  // Each stage is named for its interpreter, as in the runtime chain.
+  EXPECT_STREQ(runtime->name(), composed->name());
+  std::vector<Gesture> actual = Driver(composed.get()).Run(&static_props);
+
+  EXPECT_FALSE(expected.empty());
+  EXPECT_EQ(expected, actual);
+  // Both chains registered the same properties.
+  EXPECT_EQ(runtime_props.props().size(), static_props.props().size());
+}
+
+TEST(FilterPipelineTest, GestureInterpreterTest) {
+  // The runtime and static touchpad chains of both stack versions produce the
+  // same gestures.
+  for (int version : { 1, 2 }) {
+    std::vector<Gesture> results[2];
+    for (bool use_static : { false, true }) {
+      StackConfig config = { version, use_static };
+      GestureInterpreter gi(0);
+      gi.SetPropProvider(&stack_config_provider, &config);
+      gi.Initialize(GESTURES_DEVCLASS_TOUCHPAD);
+      Interpreter* chain = gi.interpreter();
+      EXPECT_EQ(use_static,
+                strstr(typeid(*chain).name(), "PipelineStage") != nullptr);
+      results[use_static] = Driver(gi.interpreter()).Run(gi.prop_reg());
+      gi.SetPropProvider(nullptr, nullptr);
+    }
+    EXPECT_FALSE(results[0].empty()) << version;
+    EXPECT_EQ(results[0], results[1]) << version;
+  }
+}
+
+}  // namespace gestures
@@ -0,0 +1,93 @@
+// Copyright 2026 The ChromiumOS Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "include/finger_map.h"
+
+#include "include/logging.h"
+#include "include/state_archive.h"
+
+namespace gestures {
+
+size_t FingerSlots::Assign(short id) {
+  size_t slot = Find(id);
+  if (slot != kMaxSlots)
+    return slot;
+  if (used_ == ~0ULL) {
+    Err("FingerSlots: out of slots for id %d", id);
+    return kMaxSlots;
+  }
+  slot = __builtin_ctzll(~used_);
+  ids_[slot] = id;
+  used_ |= 1ULL << slot;
+  return slot;
+}
+
+void FingerSlots::ArchiveState(StateArchive* archive) {
+  archive->Archive(&ids_);
+  archive->Archive(&used_);
+}
+
+size_t FingerMap::const_iterator::LowestIdSlot() const {
+  if (!remaining_)
+    return 0;
+  size_t ret = __builtin_ctzll(remaining_);
+  for (uint64_t bits = remaining_ & (remaining_ - 1); bits; bits &= bits - 1) {
+    size_t slot = __builtin_ctzll(bits);
+    if (slots_->IdAt(slot) < slots_->IdAt(ret))
+      ret = slot;
+  }
+  return ret;
+}
+
+FingerMap::const_iterator FingerMap::find(short id) const {
+  uint64_t bit = Bit(id);
+  if (!(bit & bits_))
+    return end();
+  // The iterator for |id| still has every id not less than it to visit.
+  uint64_t remaining = 0;
+  for (uint64_t bits = bits_; bits; bits &= bits - 1) {
+    size_t slot = __builtin_ctzll(bits);
+    if (slots_->IdAt(slot) >= id)
+      remaining |= 1ULL << slot;
+  }
+  return const_iterator(slots_, remaining);
+}
+
+std::pair<FingerMap::iterator, bool> FingerMap::insert(short id) {
+  size_t slot = slots_->Assign(id);
+  if (slot == FingerSlots::kMaxSlots)
+    return std::make_pair(end(), false);
+  uint64_t bit = 1ULL << slot;
+  bool inserted = !(bits_ & bit);
+  bits_ |= bit;
+  return std::make_pair(find(id), inserted);
+}
+
+FingerMap FingerMap::SlowUnion(const FingerMap& that) const {
+  FingerMap ret = *this;
+  ret.insert(that.begin(), that.end());
+  return ret;
+}
+
+FingerMap FingerMap::SlowDifference(const FingerMap& that) const {
+  FingerMap ret = *this;
+  for (short id : that)
+    ret.erase(id);
+  return ret;
+}
+
+bool FingerMap::SlowEquals(const FingerMap& that) const {
+  if (size() != that.size())
+    return false;
+  for (short id : *this)
+    if (!that.count(id))
+      return false;
+  return true;
+}
+
+void FingerMap::ArchiveState(StateArchive* archive) {
+  archive->Archive(&bits_);
+}
+
+}  // namespace gestures
@@ -0,0 +1,117 @@
+// Copyright 2026 The ChromiumOS Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <algorithm>
+#include <iterator>
+
+#include <gtest/gtest.h>
+
+#include "include/finger_map.h"
+
+namespace gestures {
+
+class FingerMapTest : public ::testing::Test {};
+
+TEST(FingerMapTest, IterationOrderTest) {
+  FingerSlots slots;
+  FingerMap fingers(&slots);
+  EXPECT_TRUE(fingers.empty());
+  // Slots are handed out in insertion order, but iteration is by id.
+  EXPECT_TRUE(fingers.insert(30).second);
+  EXPECT_TRUE(fingers.insert(10).second);
+  EXPECT_TRUE(fingers.insert(20).second);
+  EXPECT_FALSE(fingers.insert(20).second);
+  EXPECT_EQ(3, fingers.size());
+  short expected = 10;
+  for (short id : fingers) {
+    EXPECT_EQ(expected, id);
+    expected += 10;
+  }
+  EXPECT_EQ(20, *fingers.find(20));
+  EXPECT_EQ(30, *std::next(fingers.find(20)));
+  EXPECT_TRUE(fingers.find(40) == fingers.end());
+  EXPECT_EQ(1, fingers.count(10));
+  EXPECT_EQ(0, fingers.count(40));
+}
+
+TEST(FingerMapTest, EraseTest) {
+  FingerSlots slots;
+  FingerMap fingers(&slots);
+  fingers.insert(1);
+  fingers.insert(2);
+  fingers.insert(3);
+  EXPECT_EQ(1, fingers.erase(2));
+  EXPECT_EQ(0, fingers.erase(2));
+  FingerMap::iterator it = fingers.erase(fingers.begin());
+  EXPECT_EQ(3, *it);
+  EXPECT_TRUE(++it == fingers.end());
+  fingers.clear();
+  EXPECT_TRUE(fingers.empty());
+}
+
+TEST(FingerMapTest, SetAlgebraTest) {
+  FingerSlots slots;
+  FingerSlots other_slots;
+  FingerMap a(&slots);
+  FingerMap b(&slots);
+  FingerMap c(&other_slots);
+  a.insert(1);
+  a.insert(2);
+  a.insert(3);
+  b.insert(2);
+  b.insert(4);
+  // Insert in a different order so the slots don't line up with |b|'s.
+  c.insert(4);
+  c.insert(2);
+
+  FingerMap expected_difference(&other_slots);
+  expected_difference.insert(3);
+  expected_difference.insert(1);
+  EXPECT_TRUE(a.Difference(b) == expected_difference);
+  EXPECT_TRUE(a.Difference(c) == expected_difference);
+  EXPECT_TRUE(b == c);
+  EXPECT_TRUE(c == b);
+  EXPECT_TRUE(a != c);
+
+  FingerMap expected_union(&slots);
+  expected_union.insert(1);
+  expected_union.insert(2);
+  expected_union.insert(3);
+  expected_union.insert(4);
+  EXPECT_TRUE(a.Union(b) == expected_union);
+  EXPECT_TRUE(a.Union(c) == expected_union);
+
+  FingerMap via_inserter(&slots);
+  std::set_difference(a.begin(), a.end(), b.begin(), b.end(),
+                      std::inserter(via_inserter, via_inserter.begin()));
+  EXPECT_TRUE(via_inserter == expected_difference);
+}
+
+TEST(FingerMapTest, RetainTest) {
+  FingerSlots slots;
+  FingerMap kept(&slots);
+  FingerMap dropped(&slots);
+  kept.insert(1);
+  dropped.insert(2);
+  slots.Retain(kept.bits());
+  EXPECT_EQ(FingerSlots::kMaxSlots, slots.Find(2));
+  // The freed slot goes to the next new id.
+  FingerMap fresh(&slots);
+  fresh.insert(3);
+  EXPECT_TRUE(fresh.bits() == dropped.bits());
+  EXPECT_EQ(1, kept.count(1));
+  EXPECT_EQ(0, kept.count(3));
+}
+
+TEST(FingerMapTest, OutOfSlotsTest) {
+  FingerSlots slots;
+  FingerMap fingers(&slots);
+  for (size_t i = 0; i < FingerSlots::kMaxSlots; i++)
+    EXPECT_TRUE(fingers.insert(i).second);
+  EXPECT_FALSE(fingers.insert(FingerSlots::kMaxSlots).second);
+  EXPECT_EQ(FingerSlots::kMaxSlots, fingers.size());
+  EXPECT_EQ(0, fingers.count(FingerSlots::kMaxSlots));
+}
+
+}  // namespace gestures
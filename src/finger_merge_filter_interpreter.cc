@@ -10,6 +10,7 @@
 #include "include/gestures.h"
 #include "include/logging.h"
 #include "include/prop_registry.h"
+#include "include/state_archive.h"
 #include "include/tracer.h"
 #include "include/util.h"
 
@@ -52,7 +53,7 @@ void FingerMergeFilterInterpreter::SyncInterpretImpl(HardwareState& hwstate,
     UpdateFingerMergeState(hwstate);
 
   LogHardwareStatePost(name, hwstate);
-  next_->SyncInterpret(hwstate, timeout);
+  SyncInterpretNext(hwstate, timeout);
 }
 
 // Suspicious angle is between the 45 degree angle of going down and to the
@@ -180,4 +181,13 @@ void FingerMergeFilterInterpreter::UpdateFingerMergeState(
   }
 }
 
+void FingerMergeFilterInterpreter::ArchiveState(StateArchive* archive) {
+  FilterInterpreter::ArchiveState(archive);
+  archive->Archive(&start_info_);
+  archive->Archive(&merge_tracking_ids_);
+  archive->Archive(&never_merge_ids_);
+  archive->Archive(&prev_x_displacement_);
+  archive->Archive(&prev2_x_displacement_);
+}
+
 }
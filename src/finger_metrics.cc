@@ -4,6 +4,8 @@
 
 #include "include/finger_metrics.h"
 
+#include "include/state_archive.h"
+
 namespace gestures {
 
 Vector2 Add(const Vector2& left, const Vector2& right) {
@@ -18,6 +20,11 @@ float Dot(const Vector2& left, const Vector2& right) {
   return left.x * right.x +  left.y * right.y;
 }
 
+void Vector2::ArchiveState(StateArchive* archive) {
+  archive->Archive(&x);
+  archive->Archive(&y);
+}
+
 MetricsProperties::MetricsProperties(PropRegistry* prop_reg)
     : two_finger_close_horizontal_distance_thresh(
           prop_reg,
@@ -57,6 +64,16 @@ void FingerMetrics::Update(const FingerState& state, stime_t timestamp,
   }
 }
 
+void FingerMetrics::ArchiveState(StateArchive* archive) {
+  archive->Archive(&tracking_id_);
+  archive->Archive(&position_);
+  archive->Archive(&delta_);
+  archive->Archive(&origin_position_);
+  archive->Archive(&start_position_);
+  archive->Archive(&origin_time_);
+  archive->Archive(&start_time_);
+}
+
 bool Metrics::CloseEnoughToGesture(const Vector2& pos_a,
                                    const Vector2& pos_b) const {
   float horiz_axis_sq =
@@ -138,6 +155,10 @@ void Metrics::Clear() {
   fingers_.clear();
 }
 
+void Metrics::ArchiveState(StateArchive* archive) {
+  archive->Archive(&fingers_);
+}
+
 void Metrics::SetFingerOriginTimestampForTesting(short tracking_id,
                                                  stime_t time) {
   for (auto iter = fingers_.begin(); iter != fingers_.end(); ++iter) {
@@ -0,0 +1,191 @@
+// Copyright 2026 The ChromiumOS Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "include/flight_recorder.h"
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <utility>
+#include <vector>
+
+#include "include/eintr_wrapper.h"
+#include "include/logging.h"
+
+using std::string;
+
+namespace gestures {
+
+using namespace activity_log_binary;
+
+namespace {
+
+void AppendRecord(string* out, uint16_t type, uint16_t name,
+                  const void* payload, size_t size) {
+  static const char kZeros[8] = { 0 };
+  RecordHeader header = { type, name, static_cast<uint32_t>(size) };
+  out->append(reinterpret_cast<const char*>(&header), sizeof(header));
+  out->append(static_cast<const char*>(payload), size);
+  out->append(kZeros, (8 - size % 8) % 8);
+}
+
+}  // namespace
+
+FlightRecorder::FlightRecorder(char* mapping, size_t mapping_size,
+                               size_t slot_size, size_t slot_count)
+    : mapping_(mapping), mapping_size_(mapping_size), slot_size_(slot_size),
+      slot_count_(slot_count), sequence_(0) {}
+
+FlightRecorder::~FlightRecorder() {
+  munmap(mapping_, mapping_size_);
+}
+
+std::unique_ptr<FlightRecorder> FlightRecorder::Create(
+    const char* path, const FlightRecorderHeader& header) {
+  if (header.slot_size < sizeof(FlightRecorderSlot) ||
+      header.slot_size % 8 || !header.slot_count) {
+    Err("Bad flight recorder slots");
+    return nullptr;
+  }
+  size_t mapping_size = sizeof(header) +
+                        static_cast<size_t>(header.slot_size) *
+                        header.slot_count;
+  int fd = HANDLE_EINTR(open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC,
+                             0666));
+  if (fd < 0) {
+    Err("Unable to create %s", path);
+    return nullptr;
+  }
+  // The file reads as zeros, so every slot starts out empty.
+  void* mapping = MAP_FAILED;
+  if (ftruncate(fd, mapping_size) == 0)
+    mapping = mmap(nullptr, mapping_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                   fd, 0);
+  IGNORE_EINTR(close(fd));
+  if (mapping == MAP_FAILED) {
+    Err("Unable to map %s", path);
+    return nullptr;
+  }
+  memcpy(mapping, &header, sizeof(header));
+  return std::unique_ptr<FlightRecorder>(
+      new FlightRecorder(static_cast<char*>(mapping), mapping_size,
+                         header.slot_size, header.slot_count));
+}
+
+void FlightRecorder::Record(const ActivityLog::Entry& entry) {
+  char* data = mapping_ + sizeof(FlightRecorderHeader) +
+               (sequence_ % slot_count_) * slot_size_;
+  FlightRecorderSlot* slot = reinterpret_cast<FlightRecorderSlot*>(data);
+  // Mark the slot as being written before touching the rest of it, so that
+  // a crash part way through leaves a slot that readers drop.
+  std::atomic_ref<uint64_t> sequence(slot->sequence);
+  sequence.store(0, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  const string* name = nullptr;
+  size_t size = ActivityLog::EncodeRecord(entry, data + sizeof(*slot),
+                                          slot_size_ - sizeof(*slot), &name);
+  if (!size) {
+    ErrOnce("Activity log entry is too big for the flight recorder");
+    return;
+  }
+  slot->size = size;
+  memset(slot->name, 0, sizeof(slot->name));
+  if (name)
+    memcpy(slot->name, name->data(),
+           std::min(name->size(), sizeof(slot->name)));
+  sequence.store(++sequence_, std::memory_order_release);
+}
+
+bool FlightRecorder::ToBinaryLog(const char* data, size_t size,
+                                 string* out) {
+  FlightRecorderHeader header;
+  if (size < sizeof(header)) {
+    Err("Flight recorder file is too short");
+    return false;
+  }
+  memcpy(&header, data, sizeof(header));
+  if (memcmp(header.magic, kFlightRecorderMagic,
+             sizeof(kFlightRecorderMagic))) {
+    Err("Not a flight recorder file");
+    return false;
+  }
+  if (header.byte_order_mark != kByteOrderMark) {
+    Err("Flight recorder file was written with the other byte order");
+    return false;
+  }
+  if (header.version != kFlightRecorderVersion) {
+    Err("Unsupported flight recorder version %u", header.version);
+    return false;
+  }
+  if (header.slot_size < sizeof(FlightRecorderSlot) + sizeof(RecordHeader) ||
+      (size - sizeof(header)) / header.slot_size < header.slot_count) {
+    Err("Flight recorder file is truncated");
+    return false;
+  }
+
+  // Slots that hold a whole record, oldest first
+  std::vector<std::pair<uint64_t, const char*>> slots;
+  for (size_t i = 0; i < header.slot_count; i++) {
+    const char* slot_data = data + sizeof(header) + i * header.slot_size;
+    FlightRecorderSlot slot;
+    memcpy(&slot, slot_data, sizeof(slot));
+    if (!slot.sequence || slot.size < sizeof(RecordHeader) ||
+        slot.size > header.slot_size - sizeof(slot))
+      continue;
+    slots.emplace_back(slot.sequence, slot_data);
+  }
+  std::sort(slots.begin(), slots.end());
+
+  out->clear();
+  FileHeader file_header;
+  memcpy(file_header.magic, kMagic, sizeof(kMagic));
+  file_header.byte_order_mark = kByteOrderMark;
+  file_header.version = kVersion;
+  out->append(reinterpret_cast<const char*>(&file_header),
+              sizeof(file_header));
+  AppendRecord(out, kRecordHardwareProperties, kNoName, &header.hwprops,
+               sizeof(header.hwprops));
+  size_t length = strnlen(header.interpreter_name,
+                          sizeof(header.interpreter_name));
+  if (length)
+    AppendRecord(out, kRecordInterpreterName, kNoName,
+                 header.interpreter_name, length);
+  AppendRecord(out, kRecordGesturesVersion, kNoName, header.gestures_version,
+               strnlen(header.gestures_version,
+                       sizeof(header.gestures_version)));
+
+  std::vector<string> names;
+  for (const auto& [sequence, slot_data] : slots) {
+    FlightRecorderSlot slot;
+    memcpy(&slot, slot_data, sizeof(slot));
+    RecordHeader record;
+    memcpy(&record, slot_data + sizeof(slot), sizeof(record));
+    if (record.size != slot.size - sizeof(record))
+      continue;
+    if (record.name != kNoName) {
+      string name(slot.name, strnlen(slot.name, sizeof(slot.name)));
+      auto it = std::find(names.begin(), names.end(), name);
+      if (it == names.end()) {
+        if (names.size() == kNoName) {
+          Err("Too many names in the flight recorder file");
+          return false;
+        }
+        AppendRecord(out, kRecordName, names.size(), name.data(),
+                     name.size());
+        it = names.insert(names.end(), name);
+      }
+      record.name = it - names.begin();
+    }
+    AppendRecord(out, record.type, record.name,
+                 slot_data + sizeof(slot) + sizeof(record), record.size);
+  }
+  return true;
+}
+
+}  // namespace gestures
@@ -0,0 +1,152 @@
+// Copyright 2026 The ChromiumOS Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <memory>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "include/activity_log.h"
+#include "include/activity_log_binary.h"
+#include "include/file_util.h"
+#include "include/flight_recorder.h"
+#include "include/unittest_util.h"
+
+using std::string;
+
+namespace gestures {
+
+using namespace activity_log_binary;
+
+class FlightRecorderTest : public ::testing::Test {};
+
+namespace {
+
+string TempFileName() {
+  // std::tmpnam is considered unsafe because another process could create the
+  // temporary file after time std::tmpnam returns the name but before the code
+  // actually opens it. Because this is just test code, we don't need to be
+  // concerned about such security holes here.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+  const char* filename = std::tmpnam(nullptr);
+#pragma GCC diagnostic pop
+  return filename ? filename : "";
+}
+
+void SetHardwareProperties(ActivityLog* log) {
+  HardwareProperties hwprops = {
+    .right = 100, .bottom = 60,
+    .res_x = 10, .res_y = 12,
+    .orientation_minimum = -1, .orientation_maximum = 2,
+    .max_finger_cnt = 2, .max_touch_cnt = 5,
+    .supports_t5r2 = 0, .support_semi_mt = 0, .is_button_pad = 1,
+    .has_wheel = 0, .wheel_is_hi_res = 0, .is_haptic_pad = 0,
+  };
+  log->SetHardwareProperties(hwprops);
+}
+
+}  // namespace
+
+TEST(FlightRecorderTest, RoundTripTest) {
+  string filename = TempFileName();
+  ASSERT_FALSE(filename.empty());
+  std::unique_ptr<ActivityLog> log(new ActivityLog(nullptr));
+  SetHardwareProperties(log.get());
+  FingerState fs[] = {
+    { 1.5, 2.5, 0.0, 0.0, 9.0, 0.25, 3.0, 4.0, 22, 0 },
+    { 0.0, 0.0, 0.0, 0.0, 19.0, 0.0, 30.0, 40.0, 23, 0 },
+  };
+  HardwareState hs = make_hwstate(1.0, 0, 2, 2, fs);
+  log->LogHardwareState(hs);
+  log->LogHardwareStatePre("Pre", hs);
+  // Entries logged before the recorder starts are recorded too.
+  ASSERT_TRUE(log->StartFlightRecorder(filename, "Interpreter"));
+  stime_t timeout = 0.125;
+  log->LogHandleTimerPre("Pre", 1.5, &timeout);
+  log->LogGestureConsume("Consume", Gesture(kGestureMove, 1.0, 2.0, 3, 4));
+  log->LogPropChange({ "double prop", 3.25 });
+  log->LogDebugData(ActivityLog::TimestampGestureDebug{ 0.5 });
+
+  // The file is up to date without being flushed or closed.
+  string data;
+  ASSERT_TRUE(ReadFileToString(filename.c_str(), &data));
+  std::unique_ptr<ActivityLog> copy(new ActivityLog(nullptr));
+  ActivityLog::BinaryInfo info;
+  ASSERT_TRUE(copy->ReadBinary(data.data(), data.size(), &info));
+  EXPECT_EQ("Interpreter", info.interpreter_name);
+  EXPECT_EQ(log->size(), copy->size());
+  EXPECT_EQ(log->Encode(info), copy->Encode(info));
+
+  // Once stopped, the file is left as it was.
+  log->StopFlightRecorder();
+  log->LogTimerCallback(2.0);
+  string stopped;
+  ASSERT_TRUE(ReadFileToString(filename.c_str(), &stopped));
+  EXPECT_EQ(data, stopped);
+
+  // Truncated files are rejected.
+  EXPECT_FALSE(copy->ReadBinary(data.data(), data.size() - 1, &info));
+  unlink(filename.c_str());
+}
+
+TEST(FlightRecorderTest, WrapAroundTest) {
+  string filename = TempFileName();
+  ASSERT_FALSE(filename.empty());
+  std::unique_ptr<ActivityLog> log(new ActivityLog(nullptr));
+  SetHardwareProperties(log.get());
+  ASSERT_TRUE(log->StartFlightRecorder(filename, nullptr));
+  const size_t kExtra = 10;
+  for (size_t i = 0; i < log->MaxSize() + kExtra; i++)
+    log->LogTimerCallback(i);
+
+  string data;
+  ASSERT_TRUE(ReadFileToString(filename.c_str(), &data));
+  std::unique_ptr<ActivityLog> copy(new ActivityLog(nullptr));
+  ActivityLog::BinaryInfo info;
+  ASSERT_TRUE(copy->ReadBinary(data.data(), data.size(), &info));
+  ASSERT_EQ(log->MaxSize(), copy->size());
+  // Only the newest entries are kept, oldest first.
+  for (size_t i = 0; i < copy->size(); i++) {
+    auto* entry = std::get_if<ActivityLog::TimerCallbackEntry>(
+        &copy->GetEntry(i)->details);
+    ASSERT_NE(nullptr, entry);
+    EXPECT_EQ(i + kExtra, entry->timestamp);
+  }
+  unlink(filename.c_str());
+}
+
+TEST(FlightRecorderTest, TornSlotTest) {
+  string filename = TempFileName();
+  ASSERT_FALSE(filename.empty());
+  std::unique_ptr<ActivityLog> log(new ActivityLog(nullptr));
+  SetHardwareProperties(log.get());
+  ASSERT_TRUE(log->StartFlightRecorder(filename, nullptr));
+  log->LogTimerCallback(1.0);
+  log->LogCallbackRequest(2.0);
+  log->LogTimerCallback(3.0);
+  string data;
+  ASSERT_TRUE(ReadFileToString(filename.c_str(), &data));
+
+  // A crash while the second entry was being written leaves it with no
+  // sequence number, and it is dropped.
+  FlightRecorderHeader header;
+  memcpy(&header, data.data(), sizeof(header));
+  memset(&data[sizeof(header) + header.slot_size], 0, sizeof(uint64_t));
+  std::unique_ptr<ActivityLog> copy(new ActivityLog(nullptr));
+  ActivityLog::BinaryInfo info;
+  ASSERT_TRUE(copy->ReadBinary(data.data(), data.size(), &info));
+  ASSERT_EQ(2, copy->size());
+  EXPECT_EQ(1.0, std::get<ActivityLog::TimerCallbackEntry>(
+      copy->GetEntry(0)->details).timestamp);
+  EXPECT_EQ(3.0, std::get<ActivityLog::TimerCallbackEntry>(
+      copy->GetEntry(1)->details).timestamp);
+  unlink(filename.c_str());
+}
+
+}  // namespace gestures
@@ -4,6 +4,7 @@
 
 #include "include/fling_stop_filter_interpreter.h"
 
+#include "include/state_archive.h"
 #include "include/util.h"
 
 namespace gestures {
@@ -28,7 +29,7 @@ void FlingStopFilterInterpreter::SyncInterpretImpl(HardwareState& hwstate,
   const char name[] = "FlingStopFilterInterpreter::SyncInterpretImpl";
   LogHardwareStatePre(name, hwstate);
 
-  fingers_of_last_hwstate_.clear();
+  RemoveMissingIdsFromSet(&fingers_of_last_hwstate_, hwstate);
   for (int i = 0; i < hwstate.finger_cnt; i++)
     fingers_of_last_hwstate_.insert(hwstate.fingers[i].tracking_id);
 
@@ -53,7 +54,7 @@ void FlingStopFilterInterpreter::SyncInterpretImpl(HardwareState& hwstate,
 
   stime_t next_timeout = NO_DEADLINE;
   LogHardwareStatePost(name, hwstate);
-  next_->SyncInterpret(hwstate, &next_timeout);
+  SyncInterpretNext(hwstate, &next_timeout);
 
   *timeout = SetNextDeadlineAndReturnTimeoutVal(hwstate.timestamp,
                                                 fling_stop_deadline_,
@@ -141,7 +142,7 @@ void FlingStopFilterInterpreter::HandleTimerImpl(stime_t now,
       return;
     }
     next_timeout = NO_DEADLINE;
-    next_->HandleTimer(now, &next_timeout);
+    HandleTimerNext(now, &next_timeout);
   } else {
     if (fling_stop_deadline_ > now) {
       Err("Spurious callback. now: %f, fs deadline: %f, next deadline: %f",
@@ -166,4 +167,16 @@ void FlingStopFilterInterpreter::HandleTimerImpl(stime_t now,
   LogHandleTimerPost(name, now, timeout);
 }
 
+void FlingStopFilterInterpreter::ArchiveState(StateArchive* archive) {
+  FilterInterpreter::ArchiveState(archive);
+  archive->Archive(&already_extended_);
+  archive->Archive(&fingers_present_for_last_fling_);
+  archive->Archive(&fingers_of_last_hwstate_);
+  archive->Archive(&prev_touch_cnt_);
+  archive->Archive(&prev_timestamp_);
+  archive->Archive(&prev_gesture_type_);
+  archive->Archive(&fling_stop_already_sent_);
+  archive->Archive(&fling_stop_deadline_);
+}
+
 }  // namespace gestures
@@ -0,0 +1,138 @@
+// Copyright 2026 The ChromiumOS Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "include/gesture_coalescing_filter_interpreter.h"
+
+#include "include/gestures.h"
+#include "include/interpreter.h"
+#include "include/logging.h"
+#include "include/state_archive.h"
+#include "include/tracer.h"
+
+namespace gestures {
+
+// Takes ownership of |next|:
+GestureCoalescingFilterInterpreter::GestureCoalescingFilterInterpreter(
+    PropRegistry* prop_reg, Interpreter* next, Tracer* tracer)
+    : FilterInterpreter(nullptr, next, tracer, false),
+      flush_deadline_(NO_DEADLINE),
+      enabled_(prop_reg, "Gesture Coalescing Enable", false),
+      max_delay_(prop_reg, "Gesture Coalescing Max Delay", 0.016) {
+  InitName();
+  enabled_.SetDelegate(this);
+}
+
+void GestureCoalescingFilterInterpreter::BoolWasWritten(BoolProperty* prop) {
+  if (prop != &enabled_)
+    return;
+  if (!enabled_.val_)
+    Flush();
+  UpdateRoute();
+}
+
+void GestureCoalescingFilterInterpreter::SyncInterpretImpl(
+    HardwareState& hwstate, stime_t* timeout) {
+  const char name[] = "GestureCoalescingFilterInterpreter::SyncInterpretImpl";
+  LogHardwareStatePre(name, hwstate);
+
+  stime_t next_timeout = NO_DEADLINE;
+  LogHardwareStatePost(name, hwstate);
+  SyncInterpretNext(hwstate, &next_timeout);
+  if (flush_deadline_ != NO_DEADLINE && flush_deadline_ <= hwstate.timestamp)
+    Flush();
+  *timeout = SetNextDeadlineAndReturnTimeoutVal(
+      hwstate.timestamp, flush_deadline_, next_timeout);
+}
+
+void GestureCoalescingFilterInterpreter::HandleTimerImpl(
+    stime_t now, stime_t* timeout) {
+  const char name[] = "GestureCoalescingFilterInterpreter::HandleTimerImpl";
+  LogHandleTimerPre(name, now, timeout);
+
+  // With no gesture held, the callback can only be for next_. That is also
+  // the case just after this filter is enabled, before next_timer_deadline_
+  // has caught up.
+  stime_t next_timeout = NO_DEADLINE;
+  if (flush_deadline_ == NO_DEADLINE ||
+      (next_timer_deadline_ != NO_DEADLINE && next_timer_deadline_ <= now)) {
+    HandleTimerNext(now, &next_timeout);
+  } else if (next_timer_deadline_ != NO_DEADLINE) {
+    next_timeout = next_timer_deadline_ - now;
+  }
+  if (flush_deadline_ != NO_DEADLINE && flush_deadline_ <= now)
+    Flush();
+  *timeout = SetNextDeadlineAndReturnTimeoutVal(now, flush_deadline_,
+                                                next_timeout);
+  LogHandleTimerPost(name, now, timeout);
+}
+
+void GestureCoalescingFilterInterpreter::ConsumeGesture(
+    const Gesture& gesture) {
+  const char name[] = "GestureCoalescingFilterInterpreter::ConsumeGesture";
+  LogGestureConsume(name, gesture);
+
+  if (Merge(gesture))
+    return;
+  Flush();
+  bool holdable = gesture.type == kGestureTypeMove ||
+                  gesture.type == kGestureTypeScroll ||
+                  (gesture.type == kGestureTypePinch &&
+                   gesture.details.pinch.zoom_state == GESTURES_ZOOM_UPDATE);
+  if (enabled_.val_ && max_delay_.val_ > 0.0 && holdable) {
+    held_ = gesture;
+    flush_deadline_ = gesture.end_time + max_delay_.val_;
+    return;
+  }
+  LogGestureProduce(name, gesture);
+  ProduceGesture(gesture);
+}
+
+bool GestureCoalescingFilterInterpreter::Merge(const Gesture& gesture) {
+  if (held_.type == kGestureTypeNull || gesture.type != held_.type)
+    return false;
+  switch (gesture.type) {
+    case kGestureTypeMove:
+      held_.details.move.dx += gesture.details.move.dx;
+      held_.details.move.dy += gesture.details.move.dy;
+      held_.details.move.ordinal_dx += gesture.details.move.ordinal_dx;
+      held_.details.move.ordinal_dy += gesture.details.move.ordinal_dy;
+      break;
+    case kGestureTypeScroll:
+      held_.details.scroll.dx += gesture.details.scroll.dx;
+      held_.details.scroll.dy += gesture.details.scroll.dy;
+      held_.details.scroll.ordinal_dx += gesture.details.scroll.ordinal_dx;
+      held_.details.scroll.ordinal_dy += gesture.details.scroll.ordinal_dy;
+      held_.details.scroll.stop_fling |= gesture.details.scroll.stop_fling;
+      break;
+    case kGestureTypePinch:
+      if (gesture.details.pinch.zoom_state != GESTURES_ZOOM_UPDATE)
+        return false;
+      held_.details.pinch.dz *= gesture.details.pinch.dz;
+      held_.details.pinch.ordinal_dz *= gesture.details.pinch.ordinal_dz;
+      break;
+    default:
+      return false;
+  }
+  held_.end_time = gesture.end_time;
+  return true;
+}
+
+void GestureCoalescingFilterInterpreter::Flush() {
+  if (held_.type == kGestureTypeNull)
+    return;
+  const char name[] = "GestureCoalescingFilterInterpreter::Flush";
+  Gesture held = held_;
+  held_ = Gesture();
+  flush_deadline_ = NO_DEADLINE;
+  LogGestureProduce(name, held);
+  ProduceGesture(held);
+}
+
+void GestureCoalescingFilterInterpreter::ArchiveState(StateArchive* archive) {
+  FilterInterpreter::ArchiveState(archive);
+  archive->Archive(&held_);
+  archive->Archive(&flush_deadline_);
+}
+
+}  // namespace gestures
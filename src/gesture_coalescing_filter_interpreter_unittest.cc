@@ -0,0 +1,228 @@
+// Copyright 2026 The ChromiumOS Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string.h>
+
+#include <deque>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <json/value.h>
+
+#include "include/finger_metrics.h"
+#include "include/gesture_coalescing_filter_interpreter.h"
+#include "include/gestures.h"
+#include "include/prop_registry.h"
+#include "include/unittest_util.h"
+
+namespace gestures {
+
+class GestureCoalescingFilterInterpreterTest : public ::testing::Test {};
+
+namespace {
+
+// Produces the next queued group of gestures on each SyncInterpret()
+class GestureCoalescingFilterInterpreterTestInterpreter : public Interpreter {
+ public:
+  GestureCoalescingFilterInterpreterTestInterpreter()
+      : Interpreter(nullptr, nullptr, false), handle_timer_calls_(0) {}
+
+  virtual void SyncInterpret(HardwareState& hwstate, stime_t* timeout) {
+    *timeout = NO_DEADLINE;
+    if (return_values_.empty())
+      return;
+    std::vector<Gesture> gestures = return_values_.front();
+    return_values_.pop_front();
+    for (const Gesture& gesture : gestures)
+      ProduceGesture(gesture);
+  }
+
+  virtual void HandleTimer(stime_t now, stime_t* timeout) {
+    handle_timer_calls_++;
+    *timeout = NO_DEADLINE;
+  }
+
+  std::deque<std::vector<Gesture>> return_values_;
+  int handle_timer_calls_;
+};
+
+// Records every gesture that comes out of the filter
+class GestureRecorder : public GestureConsumer {
+ public:
+  explicit GestureRecorder(Interpreter* interpreter)
+      : mprops_(&prop_reg_) {
+    memset(&hwprops_, 0, sizeof(hwprops_));
+    interpreter->Initialize(&hwprops_, nullptr, &mprops_, this);
+  }
+
+  virtual void ConsumeGesture(const Gesture& gesture) {
+    gestures_.push_back(gesture);
+  }
+
+  std::vector<Gesture> gestures_;
+
+ private:
+  HardwareProperties hwprops_;
+  PropRegistry prop_reg_;
+  MetricsProperties mprops_;
+};
+
+void SetProperty(PropRegistry* prop_reg, const char* name,
+                 const Json::Value& value) {
+  for (Property* prop : prop_reg->props()) {
+    if (strcmp(prop->name(), name))
+      continue;
+    EXPECT_TRUE(prop->SetValue(value));
+    prop->HandleGesturesPropWritten();
+    return;
+  }
+  ADD_FAILURE() << "No property " << name;
+}
+
+}  // namespace
+
+TEST(GestureCoalescingFilterInterpreterTest, MergeTest) {
+  GestureCoalescingFilterInterpreterTestInterpreter* base_interpreter =
+      new GestureCoalescingFilterInterpreterTestInterpreter;
+  PropRegistry prop_reg;
+  GestureCoalescingFilterInterpreter interpreter(&prop_reg, base_interpreter,
+                                                 nullptr);
+  GestureRecorder recorder(&interpreter);
+  SetProperty(&prop_reg, "Gesture Coalescing Enable", Json::Value(true));
+  SetProperty(&prop_reg, "Gesture Coalescing Max Delay", Json::Value(1.0));
+
+  // Ordinal values are summed separately from the accelerated ones.
+  Gesture move(kGestureMove, 1.01, 1.02, 3, -1);
+  move.details.move.ordinal_dy = -3;
+  Gesture scroll_stop(kGestureScroll, 1.04, 1.05, 0, 2);
+  scroll_stop.details.scroll.stop_fling = 1;
+  base_interpreter->return_values_ = {
+    { Gesture(kGestureMove, 1.0, 1.01, 1, 2) },
+    { move },
+    // A button change sends the move on first.
+    { Gesture(kGestureButtonsChange, 1.02, 1.02, GESTURES_BUTTON_LEFT, 0,
+              false) },
+    { Gesture(kGestureScroll, 1.03, 1.04, 0, 1) },
+    { scroll_stop },
+    // So does a fling.
+    { Gesture(kGestureFling, 1.05, 1.05, 0, 10, GESTURES_FLING_START) },
+    { Gesture(kGesturePinch, 1.06, 1.06, 1, GESTURES_ZOOM_START) },
+    { Gesture(kGesturePinch, 1.06, 1.07, 1.5, GESTURES_ZOOM_UPDATE),
+      Gesture(kGesturePinch, 1.07, 1.08, 2, GESTURES_ZOOM_UPDATE) },
+    { Gesture(kGesturePinch, 1.08, 1.09, 1, GESTURES_ZOOM_END) },
+    // A move after a scroll is a type change.
+    { Gesture(kGestureScroll, 1.09, 1.10, 5, 0) },
+    { Gesture(kGestureMove, 1.10, 1.11, 1, 1) },
+  };
+  FingerState fs = { 0, 0, 0, 0, 1, 0, 0, 0, 1, 0 };
+  while (!base_interpreter->return_values_.empty()) {
+    HardwareState hs = make_hwstate(1.0, 0, 1, 1, &fs);
+    stime_t timeout = NO_DEADLINE;
+    interpreter.SyncInterpret(hs, &timeout);
+  }
+
+  std::vector<Gesture> expected = {
+    Gesture(kGestureMove, 1.0, 1.02, 4, 1),
+    Gesture(kGestureButtonsChange, 1.02, 1.02, GESTURES_BUTTON_LEFT, 0, false),
+    Gesture(kGestureScroll, 1.03, 1.05, 0, 3),
+    Gesture(kGestureFling, 1.05, 1.05, 0, 10, GESTURES_FLING_START),
+    Gesture(kGesturePinch, 1.06, 1.06, 1, GESTURES_ZOOM_START),
+    Gesture(kGesturePinch, 1.06, 1.08, 3, GESTURES_ZOOM_UPDATE),
+    Gesture(kGesturePinch, 1.08, 1.09, 1, GESTURES_ZOOM_END),
+    Gesture(kGestureScroll, 1.09, 1.10, 5, 0),
+  };
+  expected[2].details.scroll.stop_fling = 1;
+  EXPECT_EQ(expected, recorder.gestures_);
+  ASSERT_EQ(expected.size(), recorder.gestures_.size());
+  EXPECT_FLOAT_EQ(-1, recorder.gestures_[0].details.move.ordinal_dy);
+  EXPECT_FLOAT_EQ(3, recorder.gestures_[2].details.scroll.ordinal_dy);
+  EXPECT_FLOAT_EQ(3, recorder.gestures_[5].details.pinch.ordinal_dz);
+}
+
+TEST(GestureCoalescingFilterInterpreterTest, DeadlineTest) {
+  GestureCoalescingFilterInterpreterTestInterpreter* base_interpreter =
+      new GestureCoalescingFilterInterpreterTestInterpreter;
+  PropRegistry prop_reg;
+  GestureCoalescingFilterInterpreter interpreter(&prop_reg, base_interpreter,
+                                                 nullptr);
+  GestureRecorder recorder(&interpreter);
+  SetProperty(&prop_reg, "Gesture Coalescing Enable", Json::Value(true));
+  SetProperty(&prop_reg, "Gesture Coalescing Max Delay", Json::Value(0.02));
+
+  base_interpreter->return_values_ = {
+    { Gesture(kGestureMove, 1.0, 1.0, 1, 0) },
+    { Gesture(kGestureMove, 1.01, 1.01, 1, 0) },
+    {},
+    { Gesture(kGestureScroll, 1.04, 1.04, 0, 1) },
+    {},
+  };
+  FingerState fs = { 0, 0, 0, 0, 1, 0, 0, 0, 1, 0 };
+  stime_t timeout = NO_DEADLINE;
+  HardwareState hs = make_hwstate(1.0, 0, 1, 1, &fs);
+  interpreter.SyncInterpret(hs, &timeout);
+  EXPECT_NEAR(0.02, timeout, 1e-9);
+  // Merging doesn't move the deadline.
+  hs = make_hwstate(1.01, 0, 1, 1, &fs);
+  interpreter.SyncInterpret(hs, &timeout);
+  EXPECT_NEAR(0.01, timeout, 1e-9);
+  EXPECT_TRUE(recorder.gestures_.empty());
+
+  // The timer sends the held move, without calling next_, which had nothing
+  // to wait for.
+  interpreter.HandleTimer(1.02, &timeout);
+  EXPECT_EQ(NO_DEADLINE, timeout);
+  EXPECT_EQ(0, base_interpreter->handle_timer_calls_);
+  ASSERT_EQ(1, recorder.gestures_.size());
+  EXPECT_EQ(Gesture(kGestureMove, 1.0, 1.01, 2, 0), recorder.gestures_[0]);
+
+  // An input frame past the deadline sends it too.
+  hs = make_hwstate(1.03, 0, 1, 1, &fs);
+  interpreter.SyncInterpret(hs, &timeout);
+  hs = make_hwstate(1.04, 0, 1, 1, &fs);
+  interpreter.SyncInterpret(hs, &timeout);
+  EXPECT_EQ(1, recorder.gestures_.size());
+  hs = make_hwstate(1.07, 0, 1, 1, &fs);
+  interpreter.SyncInterpret(hs, &timeout);
+  EXPECT_EQ(NO_DEADLINE, timeout);
+  ASSERT_EQ(2, recorder.gestures_.size());
+  EXPECT_EQ(Gesture(kGestureScroll, 1.04, 1.04, 0, 1), recorder.gestures_[1]);
+
+  // With nothing held, the timer is for next_.
+  interpreter.HandleTimer(1.08, &timeout);
+  EXPECT_EQ(1, base_interpreter->handle_timer_calls_);
+}
+
+TEST(GestureCoalescingFilterInterpreterTest, DisabledTest) {
+  GestureCoalescingFilterInterpreterTestInterpreter* base_interpreter =
+      new GestureCoalescingFilterInterpreterTestInterpreter;
+  PropRegistry prop_reg;
+  GestureCoalescingFilterInterpreter interpreter(&prop_reg, base_interpreter,
+                                                 nullptr);
+  GestureRecorder recorder(&interpreter);
+  // Disabled by default, in which case it's left out of the chain.
+  EXPECT_EQ(base_interpreter, interpreter.ActiveInterpreter());
+
+  SetProperty(&prop_reg, "Gesture Coalescing Enable", Json::Value(true));
+  EXPECT_EQ(&interpreter, interpreter.ActiveInterpreter());
+  base_interpreter->return_values_ = {
+    { Gesture(kGestureMove, 1.0, 1.0, 1, 0) },
+  };
+  FingerState fs = { 0, 0, 0, 0, 1, 0, 0, 0, 1, 0 };
+  stime_t timeout = NO_DEADLINE;
+  HardwareState hs = make_hwstate(1.0, 0, 1, 1, &fs);
+  interpreter.SyncInterpret(hs, &timeout);
+  EXPECT_TRUE(recorder.gestures_.empty());
+
+  // Disabling sends a held gesture on right away.
+  SetProperty(&prop_reg, "Gesture Coalescing Enable", Json::Value(false));
+  EXPECT_EQ(1, recorder.gestures_.size());
+  base_interpreter->return_values_ = {
+    { Gesture(kGestureMove, 1.01, 1.01, 1, 0) },
+  };
+  hs = make_hwstate(1.01, 0, 1, 1, &fs);
+  interpreter.SyncInterpret(hs, &timeout);
+  EXPECT_EQ(2, recorder.gestures_.size());
+}
+
+}  // namespace gestures
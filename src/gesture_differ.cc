@@ -0,0 +1,172 @@
+// Copyright 2026 The ChromiumOS Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "include/gesture_differ.h"
+
+#include <float.h>
+#include <math.h>
+
+#include <algorithm>
+
+namespace gestures {
+
+GestureDiffer::GestureDiffer(const Tolerances& tolerances,
+                             const DiffCallback& callback)
+    : tolerances_(tolerances),
+      callback_(callback),
+      matched_(0),
+      missing_(0),
+      extra_(0),
+      changed_(0),
+      max_motion_delta_(0.0),
+      max_fling_delta_(0.0) {}
+
+void GestureDiffer::AddA(const Gesture& gesture) {
+  pending_a_.push_back(gesture);
+}
+
+void GestureDiffer::AddB(const Gesture& gesture) {
+  pending_b_.push_back(gesture);
+}
+
+void GestureDiffer::Advance(stime_t time) {
+  while (AlignNext(time - tolerances_.time)) {}
+}
+
+void GestureDiffer::Finish() {
+  while (AlignNext(DBL_MAX)) {}
+}
+
+bool GestureDiffer::AlignNext(stime_t limit) {
+  bool from_a;
+  if (pending_a_.empty() && pending_b_.empty())
+    return false;
+  else if (pending_a_.empty())
+    from_a = false;
+  else if (pending_b_.empty())
+    from_a = true;
+  else
+    from_a = pending_a_.front().end_time <= pending_b_.front().end_time;
+  std::deque<Gesture>* own = from_a ? &pending_a_ : &pending_b_;
+  std::deque<Gesture>* other = from_a ? &pending_b_ : &pending_a_;
+  const Gesture gesture = own->front();
+  // A gesture from the other pipeline ending up to the tolerance after this
+  // one could still be a match.
+  if (gesture.end_time > limit)
+    return false;
+  own->pop_front();
+
+  for (auto it = other->begin(); it != other->end(); ++it) {
+    if (it->end_time > gesture.end_time + tolerances_.time)
+      break;
+    if (it->type != gesture.type)
+      continue;
+    Gesture match = *it;
+    other->erase(it);
+    if (from_a)
+      Compare(gesture, match);
+    else
+      Compare(match, gesture);
+    return true;
+  }
+
+  Diff diff;
+  if (from_a) {
+    diff.kind = kMissing;
+    diff.a = gesture;
+    missing_++;
+  } else {
+    diff.kind = kExtra;
+    diff.b = gesture;
+    extra_++;
+  }
+  callback_(diff);
+  return true;
+}
+
+void GestureDiffer::CompareField(const char* field, double a, double b,
+                                 double tolerance, double* max_delta,
+                                 Diff* diff) {
+  double delta = fabs(a - b);
+  if (max_delta)
+    *max_delta = std::max(*max_delta, delta);
+  if (delta > tolerance)
+    diff->deltas.push_back({ field, a, b });
+}
+
+void GestureDiffer::Compare(const Gesture& a, const Gesture& b) {
+  matched_++;
+  Diff diff;
+  diff.kind = kChanged;
+  diff.a = a;
+  diff.b = b;
+  const double motion = tolerances_.motion;
+  double* max_motion = &max_motion_delta_;
+  switch (a.type) {
+    case kGestureTypeMove:
+      CompareField("dx", a.details.move.dx, b.details.move.dx, motion,
+                   max_motion, &diff);
+      CompareField("dy", a.details.move.dy, b.details.move.dy, motion,
+                   max_motion, &diff);
+      break;
+    case kGestureTypeScroll:
+      CompareField("dx", a.details.scroll.dx, b.details.scroll.dx, motion,
+                   max_motion, &diff);
+      CompareField("dy", a.details.scroll.dy, b.details.scroll.dy, motion,
+                   max_motion, &diff);
+      break;
+    case kGestureTypeMouseWheel:
+      CompareField("dx", a.details.wheel.dx, b.details.wheel.dx, motion,
+                   max_motion, &diff);
+      CompareField("dy", a.details.wheel.dy, b.details.wheel.dy, motion,
+                   max_motion, &diff);
+      break;
+    case kGestureTypeSwipe:
+      CompareField("dx", a.details.swipe.dx, b.details.swipe.dx, motion,
+                   max_motion, &diff);
+      CompareField("dy", a.details.swipe.dy, b.details.swipe.dy, motion,
+                   max_motion, &diff);
+      break;
+    case kGestureTypeFourFingerSwipe:
+      CompareField("dx", a.details.four_finger_swipe.dx,
+                   b.details.four_finger_swipe.dx, motion, max_motion, &diff);
+      CompareField("dy", a.details.four_finger_swipe.dy,
+                   b.details.four_finger_swipe.dy, motion, max_motion, &diff);
+      break;
+    case kGestureTypePinch:
+      CompareField("dz", a.details.pinch.dz, b.details.pinch.dz, motion,
+                   max_motion, &diff);
+      CompareField("zoom_state", a.details.pinch.zoom_state,
+                   b.details.pinch.zoom_state, 0.0, nullptr, &diff);
+      break;
+    case kGestureTypeButtonsChange:
+      CompareField("down", a.details.buttons.down, b.details.buttons.down,
+                   0.0, nullptr, &diff);
+      CompareField("up", a.details.buttons.up, b.details.buttons.up, 0.0,
+                   nullptr, &diff);
+      CompareField("is_tap", a.details.buttons.is_tap,
+                   b.details.buttons.is_tap, 0.0, nullptr, &diff);
+      break;
+    case kGestureTypeFling:
+      CompareField("vx", a.details.fling.vx, b.details.fling.vx,
+                   tolerances_.fling, &max_fling_delta_, &diff);
+      CompareField("vy", a.details.fling.vy, b.details.fling.vy,
+                   tolerances_.fling, &max_fling_delta_, &diff);
+      CompareField("fling_state", a.details.fling.fling_state,
+                   b.details.fling.fling_state, 0.0, nullptr, &diff);
+      break;
+    case kGestureTypeMetrics:
+      CompareField("metrics_type", a.details.metrics.type,
+                   b.details.metrics.type, 0.0, nullptr, &diff);
+      break;
+    default:
+      break;
+  }
+  if (diff.deltas.empty())
+    return;
+  changed_++;
+  callback_(diff);
+}
+
+}  // namespace gestures
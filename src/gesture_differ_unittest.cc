@@ -0,0 +1,109 @@
+// Copyright 2026 The ChromiumOS Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "include/gesture_differ.h"
+#include "include/gestures.h"
+
+namespace gestures {
+
+class GestureDifferTest : public ::testing::Test {};
+
+namespace {
+
+Gesture Move(stime_t end, float dx) {
+  return Gesture(kGestureMove, end - 0.01, end, dx, 0.0);
+}
+
+Gesture Fling(stime_t end, float vx) {
+  return Gesture(kGestureFling, end, end, vx, 0.0, GESTURES_FLING_START);
+}
+
+Gesture Click(stime_t end) {
+  return Gesture(kGestureButtonsChange, end, end, GESTURES_BUTTON_LEFT, 0,
+                 false);
+}
+
+}  // namespace
+
+TEST(GestureDifferTest, SameTest) {
+  std::vector<GestureDiffer::Diff> diffs;
+  GestureDiffer differ(GestureDiffer::Tolerances(),
+                       [&diffs](const GestureDiffer::Diff& diff) {
+                         diffs.push_back(diff);
+                       });
+  for (int i = 0; i < 10; i++) {
+    differ.AddA(Move(1.0 + i * 0.01, 1.0));
+    // Within the tolerances
+    differ.AddB(Move(1.0 + i * 0.01 + 0.001, 1.005));
+  }
+  differ.AddA(Fling(1.2, 100.0));
+  differ.AddB(Fling(1.2, 100.5));
+  differ.Finish();
+  EXPECT_TRUE(diffs.empty());
+  EXPECT_EQ(11, differ.matched());
+  EXPECT_NEAR(0.005, differ.max_motion_delta(), 1e-6);
+  EXPECT_NEAR(0.5, differ.max_fling_delta(), 1e-6);
+}
+
+TEST(GestureDifferTest, DiffTest) {
+  std::vector<GestureDiffer::Diff> diffs;
+  GestureDiffer differ(GestureDiffer::Tolerances(),
+                       [&diffs](const GestureDiffer::Diff& diff) {
+                         diffs.push_back(diff);
+                       });
+  differ.AddA(Move(1.0, 1.0));
+  differ.AddB(Move(1.0, 1.0));
+  // Only a clicks
+  differ.AddA(Click(1.05));
+  // b's move comes a frame late: a's is missing and b's is extra
+  differ.AddA(Move(1.1, 2.0));
+  differ.AddB(Move(1.2, 2.0));
+  differ.AddA(Fling(1.3, 100.0));
+  differ.AddB(Fling(1.3, 150.0));
+  differ.Finish();
+
+  ASSERT_EQ(4, diffs.size());
+  EXPECT_EQ(GestureDiffer::kMissing, diffs[0].kind);
+  EXPECT_EQ(kGestureTypeButtonsChange, diffs[0].a.type);
+  EXPECT_EQ(GestureDiffer::kMissing, diffs[1].kind);
+  EXPECT_DOUBLE_EQ(1.1, diffs[1].a.end_time);
+  EXPECT_EQ(GestureDiffer::kExtra, diffs[2].kind);
+  EXPECT_DOUBLE_EQ(1.2, diffs[2].b.end_time);
+  EXPECT_EQ(GestureDiffer::kChanged, diffs[3].kind);
+  ASSERT_EQ(1, diffs[3].deltas.size());
+  EXPECT_STREQ("vx", diffs[3].deltas[0].field);
+  EXPECT_DOUBLE_EQ(100.0, diffs[3].deltas[0].a);
+  EXPECT_DOUBLE_EQ(150.0, diffs[3].deltas[0].b);
+
+  EXPECT_EQ(2, differ.matched());
+  EXPECT_EQ(2, differ.missing());
+  EXPECT_EQ(1, differ.extra());
+  EXPECT_EQ(1, differ.changed());
+}
+
+TEST(GestureDifferTest, AdvanceTest) {
+  size_t diffs = 0;
+  GestureDiffer differ(GestureDiffer::Tolerances(),
+                       [&diffs](const GestureDiffer::Diff& diff) {
+                         diffs++;
+                       });
+  differ.AddA(Move(1.0, 1.0));
+  differ.AddA(Move(2.0, 1.0));
+  // b's match for the first move could still come
+  differ.Advance(1.005);
+  EXPECT_EQ(0, diffs);
+  differ.Advance(1.5);
+  EXPECT_EQ(1, diffs);
+  // The second move is matched, however late
+  differ.AddB(Move(2.0, 1.0));
+  differ.Finish();
+  EXPECT_EQ(1, diffs);
+  EXPECT_EQ(1, differ.matched());
+}
+
+}  // namespace gestures
@@ -11,8 +11,10 @@
 #include "include/box_filter_interpreter.h"
 #include "include/click_wiggle_filter_interpreter.h"
 #include "include/finger_merge_filter_interpreter.h"
+#include "include/filter_pipeline.h"
 #include "include/finger_metrics.h"
 #include "include/fling_stop_filter_interpreter.h"
+#include "include/gesture_coalescing_filter_interpreter.h"
 #include "include/haptic_button_generator_filter_interpreter.h"
 #include "include/iir_filter_interpreter.h"
 #include "include/immediate_interpreter.h"
@@ -368,6 +370,12 @@ void GestureInterpreterPushHardwareState(GestureInterpreter* obj,
   obj->PushHardwareState(hwstate);
 }
 
+void GestureInterpreterPushHardwareStates(GestureInterpreter* obj,
+                                          struct HardwareState* hwstates,
+                                          size_t count) {
+  obj->PushHardwareStates(hwstates, count);
+}
+
 void GestureInterpreterSetHardwareProperties(
     GestureInterpreter* obj,
     const struct HardwareProperties* hwprops) {
@@ -421,6 +429,35 @@ class GestureInterpreterConsumer : public GestureConsumer {
   GestureReadyFunction callback_;
   void* callback_data_;
 };
+
+namespace {
+// The chains of InitializeTouchpad() and InitializeTouchpad2(), outermost
+// first, composed at compile time
+typedef PipelineStage<
+    LoggingFilterInterpreter, GestureCoalescingFilterInterpreter,
+    TimestampFilterInterpreter,
+    NonLinearityFilterInterpreter, T5R2CorrectingFilterInterpreter,
+    HapticButtonGeneratorFilterInterpreter,
+    StuckButtonInhibitorFilterInterpreter, FingerMergeFilterInterpreter,
+    ScalingFilterInterpreter, MetricsFilterInterpreter,
+    TrendClassifyingFilterInterpreter, SplitCorrectingFilterInterpreter,
+    AccelFilterInterpreter, SensorJumpFilterInterpreter,
+    StationaryWiggleFilterInterpreter, BoxFilterInterpreter,
+    LookaheadFilterInterpreter, IirFilterInterpreter,
+    PalmClassifyingFilterInterpreter, ClickWiggleFilterInterpreter,
+    FlingStopFilterInterpreter, ImmediateInterpreter> TouchpadPipeline;
+typedef PipelineStage<
+    LoggingFilterInterpreter, GestureCoalescingFilterInterpreter,
+    TimestampFilterInterpreter,
+    HapticButtonGeneratorFilterInterpreter,
+    StuckButtonInhibitorFilterInterpreter, FingerMergeFilterInterpreter,
+    ScalingFilterInterpreter, MetricsFilterInterpreter,
+    TrendClassifyingFilterInterpreter, AccelFilterInterpreter,
+    StationaryWiggleFilterInterpreter, BoxFilterInterpreter,
+    LookaheadFilterInterpreter, PalmClassifyingFilterInterpreter,
+    ClickWiggleFilterInterpreter, FlingStopFilterInterpreter,
+    ImmediateInterpreter> TouchpadPipeline2;
+}  // namespace
 }
 
 GestureInterpreter::GestureInterpreter(int version)
@@ -429,6 +466,7 @@ GestureInterpreter::GestureInterpreter(int version)
       timer_provider_(nullptr),
       timer_provider_data_(nullptr),
       interpret_timer_(nullptr),
+      timer_deadline_(NO_DEADLINE),
       loggingFilter_(nullptr) {
   prop_reg_.reset(new PropRegistry);
   tracer_.reset(new Tracer(prop_reg_.get(), TraceMarker::StaticTraceWrite));
@@ -458,6 +496,38 @@ void GestureInterpreter::PushHardwareState(HardwareState* hwstate) {
   }
   stime_t timeout = NO_DEADLINE;
   interpreter_->SyncInterpret(*hwstate, &timeout);
+  SetTimer(hwstate->timestamp, timeout);
+}
+
+void GestureInterpreter::PushHardwareStates(HardwareState* hwstates,
+                                            size_t count) {
+  if (!interpreter_.get()) {
+    Err("Filters are not composed yet!");
+    return;
+  }
+  if (!count)
+    return;
+  stime_t deadline = timer_deadline_;
+  for (size_t i = 0; i < count; i++) {
+    HardwareState* hwstate = &hwstates[i];
+    // Fire the timer, as it would have fired had the states come in one at a
+    // time, for each deadline up to this state.
+    while (deadline != NO_DEADLINE && deadline <= hwstate->timestamp) {
+      stime_t timeout = NO_DEADLINE;
+      interpreter_->HandleTimer(deadline, &timeout);
+      deadline = timeout == NO_DEADLINE ? NO_DEADLINE : deadline + timeout;
+    }
+    stime_t timeout = NO_DEADLINE;
+    interpreter_->SyncInterpret(*hwstate, &timeout);
+    deadline = timeout == NO_DEADLINE ? NO_DEADLINE
+                                      : hwstate->timestamp + timeout;
+  }
+  stime_t now = hwstates[count - 1].timestamp;
+  SetTimer(now, deadline == NO_DEADLINE ? NO_DEADLINE : deadline - now);
+}
+
+void GestureInterpreter::SetTimer(stime_t now, stime_t timeout) {
+  timer_deadline_ = timeout == NO_DEADLINE ? NO_DEADLINE : now + timeout;
   if (timer_provider_ && interpret_timer_) {
     if (timeout == NO_DEADLINE) {
       timer_provider_->cancel_fn(timer_provider_data_, interpret_timer_);
@@ -492,6 +562,8 @@ void GestureInterpreter::TimerCallback(stime_t now, stime_t* timeout) {
     return;
   }
   interpreter_->HandleTimer(now, timeout);
+  // The timer provider sets the timer again from the returned timeout.
+  timer_deadline_ = *timeout == NO_DEADLINE ? NO_DEADLINE : now + *timeout;
 }
 
 void GestureInterpreter::SetTimerProvider(GesturesTimerProvider* tp,
@@ -533,12 +605,21 @@ void GestureInterpreter::InitializeTouchpad(void) {
   if (prop_reg_.get()) {
     stack_version_ = std::make_unique<IntProperty>(prop_reg_.get(),
                                                    "Touchpad Stack Version", 2);
+    static_pipeline_ = std::make_unique<BoolProperty>(
+        prop_reg_.get(), "Static Touchpad Pipeline", false);
     if (stack_version_->val_ == 2) {
       InitializeTouchpad2();
       return;
     }
   }
 
+  if (static_pipeline_ && static_pipeline_->val_) {
+    loggingFilter_ = TouchpadPipeline::Create(prop_reg_.get(), tracer_.get(),
+                                              GESTURES_DEVCLASS_TOUCHPAD);
+    interpreter_.reset(loggingFilter_);
+    return;
+  }
+
   Interpreter* temp = new ImmediateInterpreter(prop_reg_.get(), tracer_.get());
   temp = new FlingStopFilterInterpreter(prop_reg_.get(), temp, tracer_.get(),
                                         GESTURES_DEVCLASS_TOUCHPAD);
@@ -569,6 +650,8 @@ void GestureInterpreter::InitializeTouchpad(void) {
   temp = new NonLinearityFilterInterpreter(prop_reg_.get(), temp,
                                            tracer_.get());
   temp = new TimestampFilterInterpreter(prop_reg_.get(), temp, tracer_.get());
+  temp = new GestureCoalescingFilterInterpreter(prop_reg_.get(), temp,
+                                                tracer_.get());
   temp = loggingFilter_ = new LoggingFilterInterpreter(prop_reg_.get(), temp,
                                                        tracer_.get());
   interpreter_.reset(temp);
@@ -576,6 +659,13 @@ void GestureInterpreter::InitializeTouchpad(void) {
 }
 
 void GestureInterpreter::InitializeTouchpad2(void) {
+  if (static_pipeline_ && static_pipeline_->val_) {
+    loggingFilter_ = TouchpadPipeline2::Create(prop_reg_.get(), tracer_.get(),
+                                               GESTURES_DEVCLASS_TOUCHPAD);
+    interpreter_.reset(loggingFilter_);
+    return;
+  }
+
   Interpreter* temp = new ImmediateInterpreter(prop_reg_.get(), tracer_.get());
   temp = new FlingStopFilterInterpreter(prop_reg_.get(), temp, tracer_.get(),
                                         GESTURES_DEVCLASS_TOUCHPAD);
@@ -598,6 +688,8 @@ void GestureInterpreter::InitializeTouchpad2(void) {
   temp = new HapticButtonGeneratorFilterInterpreter(prop_reg_.get(), temp,
                                                     tracer_.get());
   temp = new TimestampFilterInterpreter(prop_reg_.get(), temp, tracer_.get());
+  temp = new GestureCoalescingFilterInterpreter(prop_reg_.get(), temp,
+                                                tracer_.get());
   temp = loggingFilter_ = new LoggingFilterInterpreter(prop_reg_.get(), temp,
                                                        tracer_.get());
   interpreter_.reset(temp);
@@ -613,6 +705,8 @@ void GestureInterpreter::InitializeMouse(GestureInterpreterDeviceClass cls) {
   temp = new MetricsFilterInterpreter(prop_reg_.get(), temp, tracer_.get(),
                                       cls);
   temp = new IntegralGestureFilterInterpreter(temp, tracer_.get());
+  temp = new GestureCoalescingFilterInterpreter(prop_reg_.get(), temp,
+                                                tracer_.get());
   temp = loggingFilter_ = new LoggingFilterInterpreter(prop_reg_.get(), temp,
                                                        tracer_.get());
   interpreter_.reset(temp);
@@ -637,6 +731,8 @@ void GestureInterpreter::InitializeMultitouchMouse(void) {
   temp = new StuckButtonInhibitorFilterInterpreter(temp, tracer_.get());
   temp = new NonLinearityFilterInterpreter(prop_reg_.get(), temp,
                                            tracer_.get());
+  temp = new GestureCoalescingFilterInterpreter(prop_reg_.get(), temp,
+                                                tracer_.get());
   temp = loggingFilter_ = new LoggingFilterInterpreter(prop_reg_.get(), temp,
                                                        tracer_.get());
   interpreter_.reset(temp);
@@ -664,6 +760,11 @@ std::string GestureInterpreter::EncodeActivityLog() {
   return loggingFilter_->EncodeActivityLog();
 }
 
+void GestureInterpreter::EncodeActivityLogAsync(
+    ActivityLogReadyFunction callback, void* client_data) {
+  loggingFilter_->EncodeActivityLogAsync(callback, client_data);
+}
+
 const GestureMove kGestureMove = { 0, 0, 0, 0 };
 const GestureScroll kGestureScroll = { 0, 0, 0, 0, 0 };
 const GestureMouseWheel kGestureMouseWheel = { 0, 0, 0, 0 };
@@ -2,10 +2,15 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <float.h>
 #include <gtest/gtest.h>
+#include <algorithm>
 #include <memory>
 #include <stdio.h>
+#include <vector>
 
+#include "include/allocation_counter.h"
+#include "include/finger_metrics.h"
 #include "include/gestures.h"
 #include "include/macros.h"
 #include "include/unittest_util.h"
@@ -587,4 +592,203 @@ TEST(GesturesTest, InvalidHardwareStateDeepCopyTest) {
   EXPECT_EQ(invalidHardwareState.msc_timestamp, hardwareStateCopy.msc_timestamp);
 }
 
+namespace {
+
+// Timer provider that only remembers the pending timer, so that a test can
+// fire it itself at the requested time.
+struct FakeTimer {
+  stime_t now = 0.0;  // Time of the hardware state being pushed
+  stime_t deadline = NO_DEADLINE;
+  GesturesTimerCallback callback = nullptr;
+  void* callback_data = nullptr;
+  size_t reprograms = 0;  // Times the timer was set or cancelled
+};
+
+GesturesTimer* FakeTimerCreate(void* data) {
+  return reinterpret_cast<GesturesTimer*>(data);
+}
+
+void FakeTimerSet(void* data, GesturesTimer* timer, stime_t delay,
+                  GesturesTimerCallback callback, void* callback_data) {
+  FakeTimer* fake = static_cast<FakeTimer*>(data);
+  fake->deadline = fake->now + delay;
+  fake->callback = callback;
+  fake->callback_data = callback_data;
+  fake->reprograms++;
+}
+
+void FakeTimerCancel(void* data, GesturesTimer* timer) {
+  FakeTimer* fake = static_cast<FakeTimer*>(data);
+  fake->deadline = NO_DEADLINE;
+  fake->reprograms++;
+}
+
+// Fires |timer| for each deadline at or before |now|.
+void FireFakeTimer(FakeTimer* timer, stime_t now) {
+  while (timer->deadline != NO_DEADLINE && timer->deadline <= now) {
+    const stime_t fire_time = timer->deadline;
+    timer->deadline = NO_DEADLINE;
+    stime_t next = timer->callback(fire_time, timer->callback_data);
+    if (next >= 0.0)
+      timer->deadline = fire_time + next;
+  }
+}
+
+void FakeTimerFree(void* data, GesturesTimer* timer) {}
+
+GesturesTimerProvider kFakeTimerProvider = {
+  FakeTimerCreate,
+  FakeTimerSet,
+  FakeTimerCancel,
+  FakeTimerFree,
+};
+
+void IgnoreGesture(void* data, const Gesture* gesture) {}
+
+void RecordGesture(void* data, const Gesture* gesture) {
+  static_cast<std::vector<Gesture>*>(data)->push_back(*gesture);
+}
+
+}  // namespace
+
+// Once the set of fingers on the pad stops changing, pushing hardware states
+// through the whole touchpad pipeline must not touch the heap. Allocator
+// jitter shows up directly as frame-time spikes on low-end devices.
+TEST(GesturesTest, SteadyStateDoesNotAllocateTest) {
+  HardwareProperties hwprops = {
+    .right = 1000, .bottom = 600,
+    .res_x = 10, .res_y = 10,
+    .orientation_minimum = -1,
+    .orientation_maximum = 2,
+    .max_finger_cnt = static_cast<unsigned short>(kMaxFingers),
+    .max_touch_cnt = static_cast<unsigned short>(kMaxFingers),
+    .supports_t5r2 = 0, .support_semi_mt = 0, .is_button_pad = 1,
+    .has_wheel = 0, .wheel_is_hi_res = 0,
+    .is_haptic_pad = 0,
+  };
+  const stime_t kFrameInterval = 0.01;
+  const size_t kWarmupFrames = 200;
+  const size_t kCheckedFrames = 300;
+
+  for (unsigned short finger_cnt = 1; finger_cnt <= 5; finger_cnt++) {
+    for (bool moving : { false, true }) {
+      FakeTimer timer;
+      GestureInterpreter* gi = NewGestureInterpreter();
+      gi->SetTimerProvider(&kFakeTimerProvider, &timer);
+      gi->SetCallback(IgnoreGesture, nullptr);
+      gi->Initialize(GESTURES_DEVCLASS_TOUCHPAD);
+      gi->SetHardwareProperties(hwprops);
+
+      FingerState fingers[kMaxFingers];
+      AllocationCounter counter;
+      size_t allocating_frames = 0;
+      for (size_t frame = 0; frame < kWarmupFrames + kCheckedFrames;
+           frame++) {
+        const stime_t now = frame * kFrameInterval;
+        if (frame == kWarmupFrames)
+          counter.Reset();
+        const size_t allocations_before = counter.allocations();
+        FireFakeTimer(&timer, now);
+        const float offset = moving ? static_cast<float>(frame) * 0.4 : 0.0;
+        for (unsigned short i = 0; i < finger_cnt; i++) {
+          fingers[i] = FingerState();
+          fingers[i].touch_major = 10;
+          fingers[i].touch_minor = 8;
+          fingers[i].pressure = 40;
+          fingers[i].position_x = 200 + 100 * i + offset;
+          fingers[i].position_y = 200 + offset * 0.5;
+          fingers[i].tracking_id = i + 1;
+        }
+        HardwareState hs =
+            make_hwstate(now, 0, finger_cnt, finger_cnt, fingers);
+        timer.now = now;
+        gi->PushHardwareState(&hs);
+        if (frame >= kWarmupFrames &&
+            counter.allocations() != allocations_before)
+          allocating_frames++;
+      }
+      EXPECT_EQ(0, counter.allocations())
+          << finger_cnt << " finger(s), moving=" << moving << ": "
+          << allocating_frames << " of " << kCheckedFrames
+          << " frames allocated";
+      DeleteGestureInterpreter(gi);
+    }
+  }
+}
+
+TEST(GesturesTest, PushHardwareStatesTest) {
+  HardwareProperties hwprops = {
+    .right = 1000, .bottom = 600,
+    .res_x = 10, .res_y = 10,
+    .orientation_minimum = -1,
+    .orientation_maximum = 2,
+    .max_finger_cnt = 2, .max_touch_cnt = 5,
+    .supports_t5r2 = 0, .support_semi_mt = 0, .is_button_pad = 1,
+    .has_wheel = 0, .wheel_is_hi_res = 0,
+    .is_haptic_pad = 0,
+  };
+  // A tap, a pause long enough for the tap timer, then a move and a fling.
+  // The interpreter changes the fingers it's passed, so each run makes its
+  // own.
+  const size_t kFrames = 120;
+  auto make_states = [](FingerState* fingers, HardwareState* states) {
+    for (size_t i = 0; i < kFrames; i++) {
+      fingers[i] = FingerState();
+      fingers[i].touch_major = 10;
+      fingers[i].touch_minor = 8;
+      fingers[i].pressure = 40;
+      fingers[i].position_x = 300 + (i < 60 ? 0 : (i - 60) * 4.0);
+      fingers[i].position_y = 300;
+      fingers[i].tracking_id = i < 60 ? 1 : 2;
+      unsigned short finger_cnt = i < 5 || (i >= 60 && i < 90) ? 1 : 0;
+      states[i] = make_hwstate(1.0 + i * 0.01, 0, finger_cnt, finger_cnt,
+                               &fingers[i]);
+    }
+  };
+  FingerState fingers[kFrames];
+  HardwareState states[kFrames];
+
+  // One state at a time, with the timer firing between them
+  std::vector<Gesture> expected;
+  FakeTimer single_timer;
+  GestureInterpreter* single = NewGestureInterpreter();
+  single->SetTimerProvider(&kFakeTimerProvider, &single_timer);
+  single->SetCallback(RecordGesture, &expected);
+  single->Initialize(GESTURES_DEVCLASS_TOUCHPAD);
+  single->SetHardwareProperties(hwprops);
+  make_states(fingers, states);
+  for (size_t i = 0; i < kFrames; i++) {
+    FireFakeTimer(&single_timer, states[i].timestamp);
+    single_timer.now = states[i].timestamp;
+    single->PushHardwareState(&states[i]);
+  }
+  FireFakeTimer(&single_timer, DBL_MAX);
+  DeleteGestureInterpreter(single);
+
+  // In batches, with the timer only firing after the last one
+  const size_t kBatch = 7;
+  std::vector<Gesture> batched_gestures;
+  FakeTimer batched_timer;
+  GestureInterpreter* batched = NewGestureInterpreter();
+  batched->SetTimerProvider(&kFakeTimerProvider, &batched_timer);
+  batched->SetCallback(RecordGesture, &batched_gestures);
+  batched->Initialize(GESTURES_DEVCLASS_TOUCHPAD);
+  batched->SetHardwareProperties(hwprops);
+  make_states(fingers, states);
+  size_t batches = 0;
+  for (size_t i = 0; i < kFrames; i += kBatch) {
+    size_t count = std::min(kBatch, kFrames - i);
+    batched_timer.now = states[i + count - 1].timestamp;
+    batched->PushHardwareStates(&states[i], count);
+    batches++;
+    EXPECT_EQ(batches, batched_timer.reprograms);
+  }
+  FireFakeTimer(&batched_timer, DBL_MAX);
+  DeleteGestureInterpreter(batched);
+
+  EXPECT_FALSE(expected.empty());
+  EXPECT_EQ(expected, batched_gestures);
+  EXPECT_GT(single_timer.reprograms, batched_timer.reprograms);
+}
+
 }  // namespace gestures
@@ -9,6 +9,7 @@
 #include "include/gestures.h"
 #include "include/interpreter.h"
 #include "include/logging.h"
+#include "include/state_archive.h"
 #include "include/tracer.h"
 #include "include/util.h"
 
@@ -65,7 +66,7 @@ void HapticButtonGeneratorFilterInterpreter::SyncInterpretImpl(
   stime_t next_timeout = NO_DEADLINE;
 
   LogHardwareStatePost(name, hwstate);
-  next_->SyncInterpret(hwstate, &next_timeout);
+  SyncInterpretNext(hwstate, &next_timeout);
   UpdatePalmState(hwstate);
   *timeout = SetNextDeadlineAndReturnTimeoutVal(
       hwstate.timestamp, active_gesture_deadline_, next_timeout);
@@ -174,7 +175,7 @@ void HapticButtonGeneratorFilterInterpreter::HandleTimerImpl(
   stime_t next_timeout;
   if (ShouldCallNextTimer(active_gesture_deadline_)) {
     next_timeout = NO_DEADLINE;
-    next_->HandleTimer(now, &next_timeout);
+    HandleTimerNext(now, &next_timeout);
   } else {
     if (active_gesture_deadline_ > now) {
       Err("Spurious callback. now: %f, active gesture deadline: %f",
@@ -255,4 +256,16 @@ void HapticButtonGeneratorFilterInterpreter::ConsumeGesture(
   ProduceGesture(gesture);
 }
 
+void HapticButtonGeneratorFilterInterpreter::ArchiveState(
+    StateArchive* archive) {
+  FilterInterpreter::ArchiveState(archive);
+  archive->Archive(&palms_);
+  archive->Archive(&release_suppress_factor_);
+  archive->Archive(&active_gesture_);
+  archive->Archive(&active_gesture_deadline_);
+  archive->Archive(&button_down_);
+  archive->Archive(&dynamic_down_threshold_);
+  archive->Archive(&dynamic_up_threshold_);
+}
+
 }  // namespace gestures
@@ -5,7 +5,9 @@
 #include "include/iir_filter_interpreter.h"
 
 #include <utility>
-#include <vector>
+
+#include "include/state_archive.h"
+#include "include/util.h"
 
 namespace gestures {
 
@@ -58,21 +60,12 @@ void IirFilterInterpreter::SyncInterpretImpl(HardwareState& hwstate,
   LogHardwareStatePre(name, hwstate);
 
   // Delete old entries from map
-  std::vector<short> dead_ids;
-  dead_ids.reserve(histories_.size());
-
-  for (std::map<short, IoHistory>::iterator it = histories_.begin(),
-           e = histories_.end(); it != e; ++it)
-    if (!hwstate.GetFingerState((*it).first))
-      dead_ids.push_back((*it).first);
-  for (auto dead_id : dead_ids)
-    histories_.erase(dead_id);
+  RemoveMissingIdsFromMap(&histories_, hwstate);
 
   // Modify current hwstate
   for (size_t i = 0; i < hwstate.finger_cnt; i++) {
     FingerState& fs = hwstate.fingers[i];
-    std::map<short, IoHistory>::iterator history =
-        histories_.find(fs.tracking_id);
+    auto history = histories_.find(fs.tracking_id);
     if (history == histories_.end()) {
       // new finger
       IoHistory hist(fs);
@@ -158,7 +151,7 @@ void IirFilterInterpreter::SyncInterpretImpl(HardwareState& hwstate,
     hist->Increment();
   }
   LogHardwareStatePost(name, hwstate);
-  next_->SyncInterpret(hwstate, timeout);
+  SyncInterpretNext(hwstate, timeout);
 }
 
 void IirFilterInterpreter::DoubleWasWritten(DoubleProperty* prop) {
@@ -177,4 +170,9 @@ void IirFilterInterpreter::IoHistory::WarpBy(float dx, float dy) {
   }
 }
 
+void IirFilterInterpreter::ArchiveState(StateArchive* archive) {
+  FilterInterpreter::ArchiveState(archive);
+  archive->Archive(&histories_);
+}
+
 }  // namespace gestures
@@ -15,6 +15,7 @@
 
 #include "include/gestures.h"
 #include "include/logging.h"
+#include "include/state_archive.h"
 #include "include/util.h"
 
 using std::bind;
@@ -94,9 +95,9 @@ float TapRecord::CotapMinPressure() const {
 
 void TapRecord::Update(const HardwareState& hwstate,
                        const HardwareState& prev_hwstate,
-                       const std::set<short>& added,
-                       const std::set<short>& removed,
-                       const std::set<short>& dead) {
+                       const FingerMap& added,
+                       const FingerMap& removed,
+                       const FingerMap& dead) {
   if (!t5r2_ && (hwstate.finger_cnt != hwstate.touch_cnt ||
                  prev_hwstate.finger_cnt != prev_hwstate.touch_cnt)) {
     // switch to T5R2 mode
@@ -154,6 +155,17 @@ void TapRecord::Update(const HardwareState& hwstate,
   }
 }
 
+void TapRecord::ArchiveState(StateArchive* archive) {
+  archive->Archive(&touched_);
+  archive->Archive(&released_);
+  archive->Archive(&min_tap_pressure_met_);
+  archive->Archive(&min_cotap_pressure_met_);
+  archive->Archive(&t5r2_);
+  archive->Archive(&t5r2_touched_size_);
+  archive->Archive(&t5r2_released_size_);
+  archive->Archive(&fingers_below_max_age_);
+}
+
 void TapRecord::Clear() {
   min_tap_pressure_met_.clear();
   min_cotap_pressure_met_.clear();
@@ -288,6 +300,24 @@ void ScrollEventBuffer::Clear() {
   size_ = 0;
 }
 
+void ScrollEventBuffer::ArchiveState(StateArchive* archive) {
+  // Only the events in use are stored, oldest last, so restoring rotates
+  // them to start at the front of buf_.
+  size_t count = size_;
+  archive->Count(&count);
+  if (count > max_size_) {
+    archive->Fail();
+    return;
+  }
+  if (!archive->saving()) {
+    head_ = 0;
+    size_ = count;
+  }
+  for (size_t i = 0; i < size_; i++)
+    archive->Archive(&buf_[(head_ + i) % max_size_]);
+  archive->Archive(&last_scroll_timestamp_);
+}
+
 const ScrollEvent& ScrollEventBuffer::Get(size_t offset) const {
   if (offset >= size_) {
     Err("Out of bounds access!");
@@ -352,6 +382,21 @@ void HardwareStateBuffer::PopState() {
   newest_index_ = (newest_index_ + 1) % size_;
 }
 
+void HardwareStateBuffer::ArchiveState(StateArchive* archive) {
+  size_t size = size_;
+  size_t max_finger_cnt = max_finger_cnt_;
+  archive->Archive(&size);
+  archive->Archive(&max_finger_cnt);
+  if (size != size_ || max_finger_cnt != max_finger_cnt_) {
+    archive->Fail();
+    return;
+  }
+  for (size_t i = 0; i < size_; i++)
+    archive->ArchiveHardwareState(&states_[i], states_[i].fingers,
+                                  max_finger_cnt_);
+  archive->Archive(&newest_index_);
+}
+
 ScrollManager::ScrollManager(PropRegistry* prop_reg)
     : prev_result_suppress_finger_movement_(false),
       did_generate_scroll_(false),
@@ -623,6 +668,12 @@ void ScrollManager::RegressScrollVelocity(
   }
 }
 
+void ScrollManager::ArchiveState(StateArchive* archive) {
+  archive->Archive(&prev_result_suppress_finger_movement_);
+  archive->Archive(&did_generate_scroll_);
+  archive->Archive(&stationary_start_positions_);
+}
+
 bool ScrollManager::SuppressStationaryFingerMovement(const FingerState& fs,
                                                      const FingerState& prev,
                                                      stime_t dt) {
@@ -988,13 +1039,21 @@ int FingerButtonClick::EvaluateButtonTypeUsingFigureLocation() {
 ImmediateInterpreter::ImmediateInterpreter(PropRegistry* prop_reg,
                                            Tracer* tracer)
     : Interpreter(nullptr, tracer, false),
+      tap_dead_fingers_(&finger_slots_),
+      prev_active_gs_fingers_(&finger_slots_),
+      non_gs_fingers_(&finger_slots_),
+      prev_gs_fingers_(&finger_slots_),
+      prev_tap_gs_fingers_(&finger_slots_),
       button_type_(0),
       finger_button_click_(this),
       sent_button_down_(false),
       button_down_deadline_(0.0),
       started_moving_time_(-1.0),
+      moving_(&finger_slots_),
       gs_changed_time_(-1.0),
       finger_leave_time_(-1.0),
+      pointing_(&finger_slots_),
+      fingers_(&finger_slots_),
       moving_finger_id_(-1),
       tap_to_click_state_(kTtcIdle),
       tap_to_click_state_entered_(-1.0),
@@ -1160,6 +1219,7 @@ void ImmediateInterpreter::SyncInterpretImpl(HardwareState& hwstate,
   }
 
   state_buffer_.PushState(hwstate);
+  ReleaseUnusedFingerSlots();
 
   FillOriginInfo(hwstate);
   result_.type = kGestureTypeNull;
@@ -1167,11 +1227,8 @@ void ImmediateInterpreter::SyncInterpretImpl(HardwareState& hwstate,
       (hwstate.buttons_down == state_buffer_.Get(1).buttons_down);
   if (!same_fingers) {
     // Fingers changed, do nothing this time
-    FingerMap new_gs_fingers;
-    FingerMap gs_fingers = GetGesturingFingers(hwstate);
-    std::set_difference(gs_fingers.begin(), gs_fingers.end(),
-                        non_gs_fingers_.begin(), non_gs_fingers_.end(),
-                        std::inserter(new_gs_fingers, new_gs_fingers.begin()));
+    FingerMap new_gs_fingers =
+        GetGesturingFingers(hwstate).Difference(non_gs_fingers_);
     ResetSameFingersState(hwstate);
     FillStartPositions(hwstate);
     if (pinch_enable_.val_ &&
@@ -1195,11 +1252,8 @@ void ImmediateInterpreter::SyncInterpretImpl(HardwareState& hwstate,
   UpdateThumbState(hwstate);
   FingerMap newly_moving_fingers = UpdateMovingFingers(hwstate);
   UpdateNonGsFingers(hwstate);
-  FingerMap gs_fingers;
-  FingerMap old_gs_fingers = GetGesturingFingers(hwstate);
-  std::set_difference(old_gs_fingers.begin(), old_gs_fingers.end(),
-                      non_gs_fingers_.begin(), non_gs_fingers_.end(),
-                      std::inserter(gs_fingers, gs_fingers.begin()));
+  FingerMap gs_fingers =
+      GetGesturingFingers(hwstate).Difference(non_gs_fingers_);
   if (gs_fingers != prev_gs_fingers_)
     gs_changed_time_ = hwstate.timestamp;
   UpdateStartedMovingTime(hwstate.timestamp, gs_fingers, newly_moving_fingers);
@@ -1211,7 +1265,7 @@ void ImmediateInterpreter::SyncInterpretImpl(HardwareState& hwstate,
                    hwstate.timestamp,
                    timeout);
 
-  FingerMap active_gs_fingers;
+  FingerMap active_gs_fingers(&finger_slots_);
   UpdateCurrentGestureType(hwstate, gs_fingers, &active_gs_fingers);
   GenerateFingerLiftGesture();
   if (result_.type == kGestureTypeNull)
@@ -1228,11 +1282,7 @@ void ImmediateInterpreter::SyncInterpretImpl(HardwareState& hwstate,
   prev_result_ = result_;
   prev_gesture_type_ = current_gesture_type_;
   if (result_.type != kGestureTypeNull) {
-    non_gs_fingers_.clear();
-    std::set_difference(gs_fingers.begin(), gs_fingers.end(),
-                        active_gs_fingers.begin(), active_gs_fingers.end(),
-                        std::inserter(non_gs_fingers_,
-                        non_gs_fingers_.begin()));
+    non_gs_fingers_ = gs_fingers.Difference(active_gs_fingers);
     LogGestureProduce(name, result_);
     ProduceGesture(result_);
   }
@@ -1248,7 +1298,7 @@ void ImmediateInterpreter::HandleTimerImpl(stime_t now, stime_t* timeout) {
   // don't need to worry about conflicts with these two types of callback.
   UpdateButtonsTimeout(now);
   UpdateTapGesture(nullptr,
-                   FingerMap(),
+                   FingerMap(&finger_slots_),
                    false,
                    now,
                    timeout);
@@ -1319,7 +1369,7 @@ float ImmediateInterpreter::DistanceTravelledSq(const FingerState& fs,
 
 Point ImmediateInterpreter::FingerTraveledVector(
     const FingerState& fs, bool origin, bool permit_warp) const {
-  const std::map<short, Point>* positions;
+  const TrackingIdMap<Point>* positions;
   if (origin)
     positions = &origin_positions_;
   else
@@ -1345,7 +1395,7 @@ bool ImmediateInterpreter::EarlyZoomPotential(const HardwareState& hwstate)
   if (fingers_.size() != 2)
     return false;
   int id1 = *(fingers_.begin());
-  int id2 = *(++fingers_.begin());
+  int id2 = *std::next(fingers_.begin());
   const FingerState* finger1 = hwstate.GetFingerState(id1);
   const FingerState* finger2 = hwstate.GetFingerState(id2);
   float pinch_eval_timeout = pinch_evaluation_timeout_.val_;
@@ -1417,7 +1467,7 @@ bool ImmediateInterpreter::ZoomFingersAreConsistent(
     return false;
 
   int id1 = *(fingers_.begin());
-  int id2 = *(++fingers_.begin());
+  int id2 = *std::next(fingers_.begin());
 
   const FingerState* curr1 = state_buffer.Get(min<int>(state_buffer.Size() - 1,
       pinch_zoom_min_events_.val_)).GetFingerState(id1);
@@ -1533,7 +1583,7 @@ float ImmediateInterpreter::TwoSpecificFingerDistanceSq(
     const HardwareState& hwstate, const FingerMap& fingers) const {
   if (fingers.size() == 2) {
     const FingerState* finger_a = hwstate.GetFingerState(*fingers.begin());
-    const FingerState* finger_b = hwstate.GetFingerState(*(++fingers.begin()));
+    const FingerState* finger_b = hwstate.GetFingerState(*std::next(fingers.begin()));
     if (finger_a == nullptr || finger_b == nullptr) {
       Err("Finger unexpectedly null");
       return -1;
@@ -1696,14 +1746,22 @@ void ImmediateInterpreter::UpdateThumbState(const HardwareState& hwstate) {
   }
 }
 
+void ImmediateInterpreter::ReleaseUnusedFingerSlots() {
+  const FingerMap* members[] = {
+    &tap_dead_fingers_, &prev_active_gs_fingers_, &non_gs_fingers_,
+    &prev_gs_fingers_, &prev_tap_gs_fingers_, &moving_, &pointing_, &fingers_
+  };
+  uint64_t in_use = 0;
+  for (const FingerMap* fingers : members)
+    if (fingers->slots() == &finger_slots_)
+      in_use |= fingers->bits();
+  finger_slots_.Retain(in_use);
+}
+
 void ImmediateInterpreter::UpdateNonGsFingers(const HardwareState& hwstate) {
   RemoveMissingIdsFromSet(&non_gs_fingers_, hwstate);
   // moving fingers may be gesturing, so take them out from the set.
-  FingerMap temp;
-  std::set_difference(non_gs_fingers_.begin(), non_gs_fingers_.end(),
-                      moving_.begin(), moving_.end(),
-                      std::inserter(temp, temp.begin()));
-  non_gs_fingers_ = temp;
+  non_gs_fingers_ = non_gs_fingers_.Difference(moving_);
 }
 
 bool ImmediateInterpreter::KeyboardRecentlyUsed(stime_t now) const {
@@ -1734,26 +1792,27 @@ FingerMap ImmediateInterpreter::GetGesturingFingers(
     return pointing_;
 
   if (hwstate.finger_cnt <= 0) {
-    return {};
+    return FingerMap(&finger_slots_);
   }
 
-  std::vector<FingerState*> fs(hwstate.finger_cnt);
-  for (size_t i = 0; i < hwstate.finger_cnt; ++i)
-    fs[i] = &hwstate.fingers[i];
+  // Like FingerMap, this only has room for kMaxFingers contacts.
+  vector<FingerState*, kMaxFingers> fs;
+  for (size_t i = 0; i < hwstate.finger_cnt && i < kMaxFingers; ++i)
+    fs.push_back(&hwstate.fingers[i]);
 
   // Pull the kMaxSize FingerStates w/ the lowest position_y to the
   // front of fs[].
   GetGesturingFingersCompare compare;
-  FingerMap ret;
+  FingerMap ret(&finger_slots_);
   size_t sorted_cnt;
-  if (hwstate.finger_cnt > kMaxGesturingFingers) {
+  if (fs.size() > kMaxGesturingFingers) {
     std::partial_sort(fs.begin(), fs.begin() + kMaxGesturingFingers,
                       fs.end(),
                       compare);
     sorted_cnt = kMaxGesturingFingers;
   } else {
     std::sort(fs.begin(), fs.end(), compare);
-    sorted_cnt = hwstate.finger_cnt;
+    sorted_cnt = fs.size();
   }
   for (size_t i = 0; i < sorted_cnt; i++)
     ret.insert(fs[i]->tracking_id);
@@ -1975,12 +2034,9 @@ void ImmediateInterpreter::SortFingersByProximity(
     return;
   }
   // To do the sort, we sort all inter-point distances^2, then scan through
-  // that until we have enough points
-  size_t dist_sq_capacity =
-      (finger_ids.size() * (finger_ids.size() - 1)) / 2;
-
-  std::vector<DistSqElt> dist_sq;
-  dist_sq.reserve(dist_sq_capacity);
+  // that until we have enough points. Every pair of ids in a FingerMap fits,
+  // so this never runs out of room.
+  vector<DistSqElt, kMaxFingers * (kMaxFingers - 1) / 2> dist_sq;
 
   for (size_t i = 0; i < hwstate.finger_cnt; i++) {
     const FingerState& fs1 = hwstate.fingers[i];
@@ -2052,7 +2108,7 @@ bool ImmediateInterpreter::UpdatePinchState(
   }
   const FingerState* finger1 = hwstate.GetFingerState(*(gs_fingers.begin()));
   const FingerState* finger2 =
-      hwstate.GetFingerState(*(++gs_fingers.begin()));
+      hwstate.GetFingerState(*std::next(gs_fingers.begin()));
   if (finger1 == nullptr || finger2 == nullptr) {
     Err("Finger unexpectedly null");
     return false;
@@ -2447,7 +2503,7 @@ GestureType ImmediateInterpreter::GetMultiFingerGestureType(
     const FingerState* const fingers[], const int num_fingers) {
   float swipe_distance_thresh;
   float swipe_distance_ratio;
-  std::map<short, Point> *swipe_start_positions;
+  TrackingIdMap<Point>* swipe_start_positions;
   GestureType gesture_type;
   if (num_fingers == 4) {
     swipe_distance_thresh = four_finger_swipe_distance_thresh_.val_;
@@ -2596,7 +2652,7 @@ void ImmediateInterpreter::UpdateTapState(
                                           tap_paused_.val_))
     return;
 
-  FingerMap tap_gs_fingers;
+  FingerMap tap_gs_fingers(&finger_slots_);
 
   if (hwstate)
     RemoveMissingIdsFromSet(&tap_dead_fingers_, *hwstate);
@@ -2617,13 +2673,13 @@ void ImmediateInterpreter::UpdateTapState(
       tap_gs_fingers.insert(tracking_id);
     }
   }
-  std::set<short> added_fingers;
+  FingerMap added_fingers(&finger_slots_);
 
   // Fingers removed from the pad entirely
-  std::set<short> removed_fingers;
+  FingerMap removed_fingers(&finger_slots_);
 
   // Fingers that were gesturing, but now aren't
-  std::set<short> dead_fingers;
+  FingerMap dead_fingers(&finger_slots_);
 
   const bool phys_click_in_progress = hwstate && hwstate->buttons_down != 0 &&
     (zero_finger_click_enable_.val_ || finger_seen_shortly_after_button_down_);
@@ -3007,7 +3063,7 @@ int ImmediateInterpreter::EvaluateButtonType(
 
 FingerMap ImmediateInterpreter::UpdateMovingFingers(
     const HardwareState& hwstate) {
-  FingerMap newly_moving_fingers;
+  FingerMap newly_moving_fingers(&finger_slots_);
   if (moving_.size() == hwstate.finger_cnt)
     return newly_moving_fingers;  // All fingers already started moving
   const float kMinDistSq =
@@ -3460,6 +3516,58 @@ void ImmediateInterpreter::Initialize(const HardwareProperties* hwprops,
   is_haptic_pad_ = hwprops_->is_haptic_pad;
 }
 
+void ImmediateInterpreter::ArchiveState(StateArchive* archive) {
+  Interpreter::ArchiveState(archive);
+  // The FingerMaps all share finger_slots_, so it goes first.
+  archive->Archive(&finger_slots_);
+  archive->Archive(&tap_dead_fingers_);
+  archive->Archive(&prev_active_gs_fingers_);
+  archive->Archive(&non_gs_fingers_);
+  archive->Archive(&prev_gs_fingers_);
+  archive->Archive(&prev_tap_gs_fingers_);
+  archive->Archive(&result_);
+  archive->Archive(&prev_result_);
+  archive->Archive(&distance_walked_);
+  archive->Archive(&button_type_);
+  archive->Archive(&sent_button_down_);
+  archive->Archive(&button_down_deadline_);
+  archive->Archive(&changed_time_);
+  archive->Archive(&started_moving_time_);
+  archive->Archive(&moving_);
+  archive->Archive(&gs_changed_time_);
+  archive->Archive(&finger_leave_time_);
+  archive->Archive(&start_positions_);
+  archive->Archive(&three_finger_swipe_start_positions_);
+  archive->Archive(&four_finger_swipe_start_positions_);
+  archive->Archive(&origin_positions_);
+  archive->Archive(&pointing_);
+  archive->Archive(&fingers_);
+  archive->Archive(&thumb_);
+  archive->Archive(&thumb_eval_timer_);
+  archive->Archive(&moving_finger_id_);
+  archive->Archive(&tap_to_click_state_);
+  archive->Archive(&tap_to_click_state_entered_);
+  archive->Archive(&tap_record_);
+  archive->Archive(&tap_drag_last_motion_time_);
+  archive->Archive(&tap_drag_finger_was_stationary_);
+  archive->Archive(&last_movement_timestamp_);
+  archive->Archive(&swipe_is_vertical_);
+  archive->Archive(&current_gesture_type_);
+  archive->Archive(&prev_gesture_type_);
+  archive->Archive(&pinch_prev_distance_sq_);
+  archive->Archive(&state_buffer_);
+  archive->Archive(&scroll_buffer_);
+  archive->Archive(&pinch_guess_);
+  archive->Archive(&pinch_guess_start_);
+  archive->Archive(&pinch_locked_);
+  archive->Archive(&pinch_status_);
+  archive->Archive(&pinch_prev_direction_);
+  archive->Archive(&pinch_prev_time_);
+  archive->Archive(&finger_seen_shortly_after_button_down_);
+  archive->Archive(&keyboard_touched_);
+  archive->Archive(&scroll_manager_);
+}
+
 bool AnyGesturingFingerLeft(const HardwareState& state,
                             const FingerMap& prev_gs_fingers) {
   for (short tracking_id : prev_gs_fingers) {
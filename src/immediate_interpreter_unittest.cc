@@ -1484,7 +1484,7 @@ TEST(ImmediateInterpreterTest, GetGesturingFingersTest) {
 
   ii.ResetSameFingersState(hardware_state[0]);
   ii.UpdatePointingFingers(hardware_state[1]);
-  std::set<short> ids =
+  FingerMap ids =
       ii.GetGesturingFingers(hardware_state[1]);
   EXPECT_EQ(1, ids.size());
   EXPECT_TRUE(ids.end() != ids.find(91));
@@ -1546,22 +1546,25 @@ TEST(ImmediateInterpreterTest, GetGesturingFingersWithEmptyStateTest) {
 }
 
 namespace {
-std::set<short> MkSet() {
-  return std::set<short>();
+// Slot table for the sets built by the tests themselves.
+FingerSlots test_finger_slots;
+
+FingerMap MkSet() {
+  return FingerMap(&test_finger_slots);
 }
-std::set<short> MkSet(short the_id) {
-  std::set<short> ret;
+FingerMap MkSet(short the_id) {
+  FingerMap ret = MkSet();
   ret.insert(the_id);
   return ret;
 }
-std::set<short> MkSet(short id1, short id2) {
-  std::set<short> ret;
+FingerMap MkSet(short id1, short id2) {
+  FingerMap ret = MkSet();
   ret.insert(id1);
   ret.insert(id2);
   return ret;
 }
-std::set<short> MkSet(short id1, short id2, short id3) {
-  std::set<short> ret;
+FingerMap MkSet(short id1, short id2, short id3) {
+  FingerMap ret = MkSet();
   ret.insert(id1);
   ret.insert(id2);
   ret.insert(id3);
@@ -1647,7 +1650,7 @@ struct HWStateGs {
   // callback.
   stime_t callback_now;
   // Tracking IDs of fingers that are considered to be gesturing.
-  std::set<short> gesturing_fingers;
+  FingerMap gesturing_fingers;
 
   unsigned expected_down;
   unsigned expected_up;
@@ -1762,7 +1765,7 @@ protected:
       newfs[0] = fs_thumb;
       for (size_t j = 0; j < hs->finger_cnt; ++j)
         newfs[j + 1] = hs->fingers[j];
-      std::set<short>& gs = states_with_thumbs[i].gesturing_fingers;
+      FingerMap& gs = states_with_thumbs[i].gesturing_fingers;
       if (thumb_gestures)
         gs.insert(fs_thumb.tracking_id);
       hs->fingers = &thumb_fs[i][0];
@@ -2780,7 +2783,7 @@ TEST(ImmediateInterpreterTest, TapToClickKeyboardTest) {
       down = 0;
       up = 0;
       stime_t timeout = NO_DEADLINE;
-      std::set<short> gs =
+      FingerMap gs =
           hwstates[i].finger_cnt == 1 ? MkSet(91) : MkSet();
       ii->metrics_->Update(hwstates[i]);
       ii->UpdateTapState(
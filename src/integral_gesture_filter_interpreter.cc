@@ -9,6 +9,7 @@
 #include "include/gestures.h"
 #include "include/interpreter.h"
 #include "include/logging.h"
+#include "include/state_archive.h"
 #include "include/tracer.h"
 
 namespace gestures {
@@ -34,7 +35,7 @@ void IntegralGestureFilterInterpreter::SyncInterpretImpl(
   stime_t next_timeout = NO_DEADLINE;
 
   LogHardwareStatePost(name, hwstate);
-  next_->SyncInterpret(hwstate, &next_timeout);
+  SyncInterpretNext(hwstate, &next_timeout);
   *timeout = SetNextDeadlineAndReturnTimeoutVal(
       hwstate.timestamp, remainder_reset_deadline_, next_timeout);
 }
@@ -52,7 +53,7 @@ void IntegralGestureFilterInterpreter::HandleTimerImpl(
       return;
     }
     next_timeout = NO_DEADLINE;
-    next_->HandleTimer(now, &next_timeout);
+    HandleTimerNext(now, &next_timeout);
   } else {
     if (remainder_reset_deadline_ > now) {
       Err("Spurious callback. now: %f, remainder reset deadline: %f",
@@ -144,4 +145,14 @@ void IntegralGestureFilterInterpreter::ConsumeGesture(const Gesture& gesture) {
   }
 }
 
+void IntegralGestureFilterInterpreter::ArchiveState(StateArchive* archive) {
+  FilterInterpreter::ArchiveState(archive);
+  archive->Archive(&hscroll_remainder_);
+  archive->Archive(&vscroll_remainder_);
+  archive->Archive(&hscroll_ordinal_remainder_);
+  archive->Archive(&vscroll_ordinal_remainder_);
+  archive->Archive(&can_clear_remainders_);
+  archive->Archive(&remainder_reset_deadline_);
+}
+
 }  // namespace gestures
@@ -14,6 +14,7 @@
 #include "include/finger_metrics.h"
 #include "include/gestures.h"
 #include "include/logging.h"
+#include "include/state_archive.h"
 #include "include/tracer.h"
 
 using std::string;
@@ -112,7 +113,20 @@ Json::Value Interpreter::EncodeCommonInfo() {
   return root;
 }
 
+void Interpreter::ArchiveState(StateArchive* archive) {
+  archive->Tag(name());
+  // Metrics passed in by the owner of the chain are archived by their owner.
+  if (own_metrics_)
+    archive->Archive(own_metrics_.get());
+}
+
 std::string Interpreter::Encode() {
+#ifndef DEEP_LOGS
+  // Without the next layers' logs nested inside, this is just the log with
+  // our name, which can be streamed without building a Json::Value tree.
+  if (log_.get())
+    return log_->Encode(name());
+#endif  // DEEP_LOGS
   Json::Value root = EncodeCommonInfo();
   if (log_.get())
     log_->AddEncodeInfo(&root);
@@ -190,37 +204,37 @@ void Interpreter::LogOutputs(const Gesture* result,
 }
 
 void Interpreter::LogGestureConsume(
-    const std::string& name, const Gesture& gesture) {
+    const char* name, const Gesture& gesture) {
   if (EventDebugLoggingIsEnabled(EventDebug::Gesture))
     log_->LogGestureConsume(name, gesture);
 }
 
 void Interpreter::LogGestureProduce(
-    const std::string& name, const Gesture& gesture) {
+    const char* name, const Gesture& gesture) {
   if (EventDebugLoggingIsEnabled(EventDebug::Gesture))
     log_->LogGestureProduce(name, gesture);
 }
 
 void Interpreter::LogHardwareStatePre(
-    const std::string& name, const HardwareState& hwstate) {
+    const char* name, const HardwareState& hwstate) {
   if (EventDebugLoggingIsEnabled(EventDebug::HardwareState))
     log_->LogHardwareStatePre(name, hwstate);
 }
 
 void Interpreter::LogHardwareStatePost(
-    const std::string& name, const HardwareState& hwstate) {
+    const char* name, const HardwareState& hwstate) {
   if (EventDebugLoggingIsEnabled(EventDebug::HardwareState))
     log_->LogHardwareStatePost(name, hwstate);
 }
 
 void Interpreter::LogHandleTimerPre(
-    const std::string& name, stime_t now, const stime_t* timeout) {
+    const char* name, stime_t now, const stime_t* timeout) {
   if (EventDebugLoggingIsEnabled(EventDebug::HandleTimer))
     log_->LogHandleTimerPre(name, now, timeout);
 }
 
 void Interpreter::LogHandleTimerPost(
-    const std::string& name, stime_t now, const stime_t* timeout) {
+    const char* name, stime_t now, const stime_t* timeout) {
   if (EventDebugLoggingIsEnabled(EventDebug::HandleTimer))
     log_->LogHandleTimerPost(name, now, timeout);
 }
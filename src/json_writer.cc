@@ -0,0 +1,406 @@
+// Copyright 2026 The ChromiumOS Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "include/json_writer.h"
+
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "include/file_util.h"
+#include "include/logging.h"
+
+namespace gestures {
+
+namespace {
+
+// The order jsoncpp keeps object members in
+bool KeyLess(const char* a, const char* b) {
+  return strcmp(a, b) < 0;
+}
+
+bool NeedsEscaping(const char* str, size_t len) {
+  for (size_t i = 0; i < len; i++) {
+    unsigned char c = str[i];
+    if (c < 0x20 || c >= 0x80 || c == '"' || c == '\\')
+      return true;
+  }
+  return false;
+}
+
+// Decodes the UTF-8 sequence at |*s|, leaving |*s| at its last byte, the way
+// jsoncpp does: invalid sequences become U+FFFD.
+unsigned Utf8ToCodepoint(const char** s, const char* end) {
+  const unsigned kReplacement = 0xfffd;
+  const unsigned char* p = reinterpret_cast<const unsigned char*>(*s);
+  unsigned first = p[0];
+  if (first < 0x80)
+    return first;
+  if (first < 0xe0) {
+    if (end - *s < 2)
+      return kReplacement;
+    unsigned ret = ((first & 0x1f) << 6) | (p[1] & 0x3f);
+    *s += 1;
+    return ret < 0x80 ? kReplacement : ret;
+  }
+  if (first < 0xf0) {
+    if (end - *s < 3)
+      return kReplacement;
+    unsigned ret = ((first & 0x0f) << 12) | ((p[1] & 0x3f) << 6) |
+                   (p[2] & 0x3f);
+    *s += 2;
+    if (ret >= 0xd800 && ret <= 0xdfff)
+      return kReplacement;
+    return ret < 0x800 ? kReplacement : ret;
+  }
+  if (first < 0xf8) {
+    if (end - *s < 4)
+      return kReplacement;
+    unsigned ret = ((first & 0x07) << 18) | ((p[1] & 0x3f) << 12) |
+                   ((p[2] & 0x3f) << 6) | (p[3] & 0x3f);
+    *s += 3;
+    return ret < 0x10000 ? kReplacement : ret;
+  }
+  return kReplacement;
+}
+
+}  // namespace
+
+void JsonWriter::Object::Add(const char* key, bool value) {
+  if (Member* member = Push(key, Type::kBool))
+    member->bool_value = value;
+}
+
+void JsonWriter::Object::Add(const char* key, int value) {
+  if (Member* member = Push(key, Type::kInt))
+    member->int_value = value;
+}
+
+void JsonWriter::Object::Add(const char* key, double value) {
+  if (Member* member = Push(key, Type::kDouble))
+    member->double_value = value;
+}
+
+void JsonWriter::Object::Add(const char* key, const char* value) {
+  if (Member* member = Push(key, Type::kString))
+    member->string_value = { value, strlen(value) };
+}
+
+void JsonWriter::Object::Add(const char* key, const std::string& value) {
+  if (Member* member = Push(key, Type::kString))
+    member->string_value = { value.data(), value.size() };
+}
+
+void JsonWriter::Object::Add(const char* key, WriteFunction write,
+                             const void* arg) {
+  if (Member* member = Push(key, Type::kFunction))
+    member->function_value = { write, arg };
+}
+
+JsonWriter::Object::Member* JsonWriter::Object::Push(const char* key,
+                                                     Type type) {
+  if (size_ == kMaxMembers) {
+    Err("Too many members for JSON object, dropping %s", key);
+    return nullptr;
+  }
+  Member* member = &members_[size_++];
+  member->key = key;
+  member->type = type;
+  return member;
+}
+
+void JsonWriter::Object::End() {
+  // Objects are small, so an insertion sort is all that's needed.
+  const Member* sorted[kMaxMembers];
+  for (size_t i = 0; i < size_; i++) {
+    size_t j = i;
+    for (; j > 0 && KeyLess(members_[i].key, sorted[j - 1]->key); j--)
+      sorted[j] = sorted[j - 1];
+    sorted[j] = &members_[i];
+  }
+
+  writer_->BeginObject();
+  for (size_t i = 0; i < size_; i++) {
+    const Member& member = *sorted[i];
+    writer_->Key(member.key, strlen(member.key));
+    switch (member.type) {
+      case Type::kBool:
+        writer_->Bool(member.bool_value);
+        break;
+      case Type::kInt:
+        writer_->Int(member.int_value);
+        break;
+      case Type::kDouble:
+        writer_->Double(member.double_value);
+        break;
+      case Type::kString:
+        writer_->String(member.string_value.str, member.string_value.len);
+        break;
+      case Type::kFunction:
+        member.function_value.write(writer_, member.function_value.arg);
+        break;
+    }
+  }
+  writer_->EndObject();
+  size_ = 0;
+}
+
+JsonWriter::JsonWriter(std::string* out)
+    : out_(out), fd_(-1), used_(0), flushed_(0), ok_(true), depth_(0),
+      indent_(0), indented_(true) {}
+
+JsonWriter::JsonWriter(int fd)
+    : out_(nullptr), fd_(fd), used_(0), flushed_(0), ok_(true), depth_(0),
+      indent_(0), indented_(true) {}
+
+bool JsonWriter::Flush() {
+  if (out_)
+    out_->append(buffer_, used_);
+  else if (ok_ && used_ && WriteFileDescriptor(fd_, buffer_, used_) < 0)
+    ok_ = false;
+  flushed_ += used_;
+  used_ = 0;
+  return ok_;
+}
+
+void JsonWriter::Null() {
+  BeginValue();
+  Append("null", 4);
+  EndValue();
+}
+
+void JsonWriter::Bool(bool value) {
+  BeginValue();
+  if (value)
+    Append("true", 4);
+  else
+    Append("false", 5);
+  EndValue();
+}
+
+void JsonWriter::Int(int64_t value) {
+  char buf[32];
+  int len = snprintf(buf, sizeof(buf), "%" PRId64, value);
+  BeginValue();
+  Append(buf, len);
+  EndValue();
+}
+
+void JsonWriter::UInt(uint64_t value) {
+  char buf[32];
+  int len = snprintf(buf, sizeof(buf), "%" PRIu64, value);
+  BeginValue();
+  Append(buf, len);
+  EndValue();
+}
+
+void JsonWriter::Double(double value) {
+  char buf[40];
+  int len;
+  if (isnan(value)) {
+    len = snprintf(buf, sizeof(buf), "null");
+  } else if (isinf(value)) {
+    len = snprintf(buf, sizeof(buf), value < 0 ? "-1e+9999" : "1e+9999");
+  } else {
+    // 17 significant digits round-trip every double.
+    len = snprintf(buf, sizeof(buf), "%.17g", value);
+    std::replace(buf, buf + len, ',', '.');
+    // Show that this is a real, not an integer.
+    if (!memchr(buf, '.', len) && !memchr(buf, 'e', len))
+      len += snprintf(buf + len, sizeof(buf) - len, ".0");
+  }
+  BeginValue();
+  Append(buf, len);
+  EndValue();
+}
+
+void JsonWriter::String(const char* str, size_t len) {
+  BeginValue();
+  AppendQuoted(str, len);
+  EndValue();
+}
+
+void JsonWriter::Value(const Json::Value& value) {
+  switch (value.type()) {
+    case Json::nullValue:
+      Null();
+      break;
+    case Json::intValue:
+      Int(value.asLargestInt());
+      break;
+    case Json::uintValue:
+      UInt(value.asLargestUInt());
+      break;
+    case Json::realValue:
+      Double(value.asDouble());
+      break;
+    case Json::stringValue: {
+      const char* begin;
+      const char* end;
+      value.getString(&begin, &end);
+      String(begin, end - begin);
+      break;
+    }
+    case Json::booleanValue:
+      Bool(value.asBool());
+      break;
+    case Json::arrayValue:
+      BeginArray();
+      for (const Json::Value& element : value)
+        Value(element);
+      EndArray();
+      break;
+    case Json::objectValue:
+      // Member iteration is already in key order.
+      BeginObject();
+      for (auto it = value.begin(); it != value.end(); ++it) {
+        const char* end;
+        const char* key = it.memberName(&end);
+        Key(key, end - key);
+        Value(*it);
+      }
+      EndObject();
+      break;
+  }
+}
+
+void JsonWriter::BeginArray() {
+  BeginValue();
+  Push(true);
+}
+
+void JsonWriter::EndArray() {
+  Pop('[', ']');
+}
+
+void JsonWriter::BeginObject() {
+  BeginValue();
+  Push(false);
+}
+
+void JsonWriter::Key(const char* key, size_t len) {
+  NextItem();
+  NewLine();
+  AppendQuoted(key, len);
+  Append(" : ", 3);
+}
+
+void JsonWriter::EndObject() {
+  Pop('{', '}');
+}
+
+void JsonWriter::BeginValue() {
+  if (depth_ == 0 || !scopes_[depth_ - 1].is_array)
+    return;
+  NextItem();
+  if (!indented_)
+    NewLine();
+  indented_ = true;
+}
+
+void JsonWriter::NextItem() {
+  Scope& scope = scopes_[depth_ - 1];
+  if (scope.opened) {
+    Append(",", 1);
+    return;
+  }
+  if (!indented_)
+    NewLine();
+  Append(scope.is_array ? "[" : "{", 1);
+  indented_ = false;
+  scope.opened = true;
+  ++indent_;
+}
+
+void JsonWriter::Push(bool is_array) {
+  if (depth_ == kMaxDepth) {
+    Err("JSON nested too deeply");
+    return;
+  }
+  scopes_[depth_++] = { is_array, false };
+}
+
+void JsonWriter::Pop(char open, char close) {
+  if (depth_ == 0) {
+    Err("Unbalanced JSON scopes");
+    return;
+  }
+  if (scopes_[--depth_].opened) {
+    --indent_;
+    NewLine();
+    Append(&close, 1);
+  } else {
+    Append(&open, 1);
+    Append(&close, 1);
+  }
+  EndValue();
+}
+
+void JsonWriter::NewLine() {
+  Append("\n", 1);
+  for (size_t i = 0; i < indent_; i++)
+    Append("\t", 1);
+}
+
+void JsonWriter::Append(const char* data, size_t len) {
+  while (len) {
+    if (used_ == sizeof(buffer_))
+      Flush();
+    size_t count = std::min(len, sizeof(buffer_) - used_);
+    memcpy(&buffer_[used_], data, count);
+    used_ += count;
+    data += count;
+    len -= count;
+  }
+}
+
+void JsonWriter::AppendQuoted(const char* str, size_t len) {
+  Append("\"", 1);
+  if (!NeedsEscaping(str, len)) {
+    Append(str, len);
+    Append("\"", 1);
+    return;
+  }
+  const char* end = str + len;
+  for (const char* c = str; c != end; ++c) {
+    switch (*c) {
+      case '"': Append("\\\"", 2); break;
+      case '\\': Append("\\\\", 2); break;
+      case '\b': Append("\\b", 2); break;
+      case '\f': Append("\\f", 2); break;
+      case '\n': Append("\\n", 2); break;
+      case '\r': Append("\\r", 2); break;
+      case '\t': Append("\\t", 2); break;
+      default: {
+        unsigned codepoint = Utf8ToCodepoint(&c, end);
+        if (codepoint >= 0x20 && codepoint < 0x80) {
+          Append(c, 1);
+          break;
+        }
+        // Characters outside ASCII are escaped, as UTF-16 surrogate pairs
+        // beyond the Basic Multilingual Plane.
+        unsigned units[2] = { codepoint, 0 };
+        size_t count = 1;
+        if (codepoint >= 0x10000) {
+          codepoint -= 0x10000;
+          units[0] = 0xd800 + ((codepoint >> 10) & 0x3ff);
+          units[1] = 0xdc00 + (codepoint & 0x3ff);
+          count = 2;
+        }
+        for (size_t i = 0; i < count; i++) {
+          char buf[8];
+          snprintf(buf, sizeof(buf), "\\u%04x", units[i]);
+          Append(buf, 6);
+        }
+        break;
+      }
+    }
+  }
+  Append("\"", 1);
+}
+
+}  // namespace gestures
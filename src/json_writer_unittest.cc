@@ -0,0 +1,144 @@
+// Copyright 2026 The ChromiumOS Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <math.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <string>
+
+#include <gtest/gtest.h>
+#include <json/value.h>
+
+#include "include/json_writer.h"
+
+using std::string;
+
+namespace gestures {
+
+class JsonWriterTest : public ::testing::Test {};
+
+namespace {
+
+string WriteValue(const Json::Value& value) {
+  string out;
+  JsonWriter writer(&out);
+  writer.Value(value);
+  writer.EndDocument();
+  writer.Flush();
+  return out;
+}
+
+}  // namespace
+
+TEST(JsonWriterTest, MatchesStyledStringTest) {
+  Json::Value empty_array(Json::arrayValue);
+  Json::Value empty_object(Json::objectValue);
+
+  Json::Value root(Json::objectValue);
+  root["int"] = Json::Value(-816);
+  root["uint"] = Json::Value(4000000000u);
+  root["bool"] = Json::Value(true);
+  root["null"] = Json::Value();
+  root["emptyArray"] = empty_array;
+  root["emptyObject"] = empty_object;
+  root["doubles"].append(Json::Value(0.1));
+  root["doubles"].append(Json::Value(1.0));
+  root["doubles"].append(Json::Value(-77.25));
+  root["doubles"].append(Json::Value(1e300));
+  root["doubles"].append(Json::Value(1.5e-7));
+  root["doubles"].append(Json::Value(NAN));
+  root["doubles"].append(Json::Value(INFINITY));
+  root["doubles"].append(Json::Value(-INFINITY));
+  root["strings"].append(Json::Value(""));
+  root["strings"].append(Json::Value("quote\" backslash\\ slash/"));
+  root["strings"].append(Json::Value("\b\f\n\r\t\x01\x1f"));
+  root["strings"].append(
+      Json::Value("caf\xc3\xa9 \xe2\x82\xac \xf0\x9f\x98\x80"));
+  root["strings"].append(Json::Value("bad \xff utf8"));
+  root["strings"].append(Json::Value(string("nul\0byte", 8)));
+  Json::Value nested(Json::arrayValue);
+  nested.append(empty_array);
+  nested.append(empty_object);
+  nested.append(root["doubles"]);
+  Json::Value inner(Json::objectValue);
+  inner["b"] = Json::Value(2);
+  inner["a"] = nested;
+  nested.append(inner);
+  root["nested"] = nested;
+  root["Z uppercase sorts first"] = Json::Value(1);
+
+  EXPECT_EQ(root.toStyledString(), WriteValue(root));
+  EXPECT_EQ(empty_array.toStyledString(), WriteValue(empty_array));
+  EXPECT_EQ(empty_object.toStyledString(), WriteValue(empty_object));
+  EXPECT_EQ(nested.toStyledString(), WriteValue(nested));
+  EXPECT_EQ(Json::Value(1.0).toStyledString(), WriteValue(Json::Value(1.0)));
+}
+
+TEST(JsonWriterTest, ObjectSortsMembersTest) {
+  const string str = "string";
+  Json::Value expected(Json::objectValue);
+  expected["b"] = Json::Value(2);
+  expected["a"] = Json::Value(true);
+  expected["d"] = Json::Value(str);
+  expected["c"] = Json::Value(0.25);
+  expected["ab"] = Json::Value("chars");
+  expected["e"].append(Json::Value(1));
+  expected["e"].append(Json::Value(2));
+
+  string out;
+  {
+    JsonWriter writer(&out);
+    JsonWriter::Object object(&writer);
+    object.Add("b", 2);
+    object.Add("a", true);
+    object.Add("d", str);
+    object.Add("c", 0.25);
+    object.Add("ab", "chars");
+    object.Add("e", [](JsonWriter* writer, const void* arg) {
+      writer->BeginArray();
+      writer->Int(1);
+      writer->Int(2);
+      writer->EndArray();
+    }, nullptr);
+    object.End();
+    writer.EndDocument();
+  }
+  EXPECT_EQ(expected.toStyledString(), out);
+}
+
+TEST(JsonWriterTest, FileDescriptorTest) {
+  // More than the writer's buffer, so that it has to flush on the way.
+  Json::Value root(Json::arrayValue);
+  for (int i = 0; i < 5000; i++)
+    root.append(Json::Value(i * 0.5));
+  string expected = root.toStyledString();
+
+  int fds[2];
+  ASSERT_EQ(0, pipe(fds));
+  string out;
+  // Write from a child process so that a full pipe can't block the test.
+  pid_t pid = fork();
+  ASSERT_GE(pid, 0);
+  if (pid == 0) {
+    close(fds[0]);
+    JsonWriter writer(fds[1]);
+    writer.Value(root);
+    writer.EndDocument();
+    _exit(writer.Flush() ? 0 : 1);
+  }
+  close(fds[1]);
+  char buf[4096];
+  ssize_t len;
+  while ((len = read(fds[0], buf, sizeof(buf))) > 0)
+    out.append(buf, len);
+  close(fds[0]);
+  int status = 0;
+  waitpid(pid, &status, 0);
+  EXPECT_TRUE(WIFEXITED(status));
+  EXPECT_EQ(0, WEXITSTATUS(status));
+  EXPECT_EQ(expected, out);
+}
+
+}  // namespace gestures
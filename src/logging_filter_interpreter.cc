@@ -6,13 +6,30 @@
 
 #include <errno.h>
 #include <fcntl.h>
+#include <string.h>
 #include <string>
 
 #include "include/file_util.h"
 #include "include/logging.h"
+#include "include/state_archive.h"
 
 namespace gestures {
 
+namespace {
+
+const char* const kLoggingProperties[] = {
+  "Checkpoint Interval",
+  "Event Debug Logging Components Enable",
+  "Event Logging Enable",
+  "Flight Recorder Path",
+  "Log Binary Format",
+  "Log Path",
+  "Logging Notify",
+  "Logging Reset",
+};
+
+}  // namespace
+
 LoggingFilterInterpreter::LoggingFilterInterpreter(PropRegistry* prop_reg,
                                                    Interpreter* next,
                                                    Tracer* tracer)
@@ -24,7 +41,12 @@ LoggingFilterInterpreter::LoggingFilterInterpreter(PropRegistry* prop_reg,
       logging_reset_(prop_reg, "Logging Reset", 0),
       log_location_(prop_reg, "Log Path",
                     "/var/log/xorg/touchpad_activity_log.txt"),
-      integrated_touchpad_(prop_reg, "Integrated Touchpad", false) {
+      log_binary_(prop_reg, "Log Binary Format", false),
+      flight_recorder_path_(prop_reg, "Flight Recorder Path", ""),
+      checkpoint_interval_(prop_reg, "Checkpoint Interval", 0.0),
+      integrated_touchpad_(prop_reg, "Integrated Touchpad", false),
+      prop_reg_(prop_reg),
+      last_checkpoint_time_(-1.0) {
   InitName();
   if (prop_reg && log_.get())
     prop_reg->set_activity_log(log_.get());
@@ -34,6 +56,15 @@ LoggingFilterInterpreter::LoggingFilterInterpreter(PropRegistry* prop_reg,
   BoolWasWritten(&event_logging_enable_);
   logging_notify_.SetDelegate(this);
   logging_reset_.SetDelegate(this);
+  flight_recorder_path_.SetDelegate(this);
+  StringWasWritten(&flight_recorder_path_);
+}
+
+bool LoggingFilterInterpreter::IsLoggingProperty(const char* name) {
+  for (const char* logging_prop : kLoggingProperties)
+    if (!strcmp(name, logging_prop))
+      return true;
+  return false;
 }
 
 void LoggingFilterInterpreter::IntWasWritten(IntProperty* prop) {
@@ -55,11 +86,60 @@ void LoggingFilterInterpreter::BoolWasWritten(BoolProperty* prop) {
   }
 }
 
+void LoggingFilterInterpreter::StringWasWritten(StringProperty* prop) {
+  if (prop != &flight_recorder_path_ || !log_.get())
+    return;
+  if (flight_recorder_path_.val_[0])
+    log_->StartFlightRecorder(flight_recorder_path_.val_, name());
+  else
+    log_->StopFlightRecorder();
+}
+
+void LoggingFilterInterpreter::SyncInterpret(HardwareState& hwstate,
+                                             stime_t* timeout) {
+  if (checkpoint_interval_.val_ > 0.0 && EventLoggingIsEnabled() &&
+      (last_checkpoint_time_ < 0.0 ||
+       hwstate.timestamp < last_checkpoint_time_ ||
+       hwstate.timestamp - last_checkpoint_time_ >=
+           checkpoint_interval_.val_)) {
+    std::string state;
+    StateArchive::SaveCheckpoint(this, prop_reg_, hwstate.timestamp,
+                                 next_timer_deadline_, &state);
+    log_->LogCheckpoint(hwstate.timestamp, state);
+    last_checkpoint_time_ = hwstate.timestamp;
+  }
+  FilterInterpreter::SyncInterpret(hwstate, timeout);
+}
+
 std::string LoggingFilterInterpreter::EncodeActivityLog() {
   return Encode();
 }
 
+void LoggingFilterInterpreter::EncodeActivityLogAsync(
+    ActivityLogReadyFunction callback, void* client_data) {
+#ifndef DEEP_LOGS
+  if (log_.get()) {
+    if (!encoder_.get())
+      encoder_.reset(new ActivityLogEncoder());
+    encoder_->Encode(log_.get(), name(), callback, client_data);
+    return;
+  }
+#endif  // DEEP_LOGS
+  // The logs of the next layers would have to be snapshotted too.
+  callback(client_data, Encode());
+}
+
 void LoggingFilterInterpreter::Dump(const char* filename) {
+  if (log_binary_.val_ && log_.get()) {
+    log_->DumpBinary(filename, name());
+    return;
+  }
+#ifndef DEEP_LOGS
+  if (log_.get()) {
+    log_->DumpJson(filename, name());
+    return;
+  }
+#endif  // DEEP_LOGS
   std::string data = Encode();
   WriteFile(filename, data.c_str(), data.size());
 }
@@ -3,6 +3,7 @@
 // found in the LICENSE file.
 
 #include <cstdio>
+#include <memory>
 #include <string>
 
 #include <gtest/gtest.h>
@@ -104,4 +105,90 @@ TEST(LoggingFilterInterpreterTest, LogResetHandlerTest) {
   EXPECT_TRUE(couldRead);
   EXPECT_NE(0, read_str.size());
 }
+
+TEST(LoggingFilterInterpreterTest, BinaryDumpTest) {
+  PropRegistry prop_reg;
+  LoggingFilterInterpreterResetLogTestInterpreter* base_interpreter =
+      new LoggingFilterInterpreterResetLogTestInterpreter();
+  LoggingFilterInterpreter interpreter(&prop_reg, base_interpreter, nullptr);
+  interpreter.event_logging_enable_.SetValue(Json::Value(true));
+  interpreter.BoolWasWritten(&interpreter.event_logging_enable_);
+
+  HardwareProperties hwprops = {
+    .right = 100, .bottom = 100,
+    .res_x = 10,
+    .res_y = 10,
+    .orientation_minimum = -1,
+    .orientation_maximum = 2,
+    .max_finger_cnt = 2, .max_touch_cnt = 5,
+    .supports_t5r2 = 0, .support_semi_mt = 0, .is_button_pad = 1,
+    .has_wheel = 0, .wheel_is_hi_res = 0,
+    .is_haptic_pad = 0,
+  };
+  TestInterpreterWrapper wrapper(&interpreter, &hwprops);
+  FingerState finger_state = {
+    // TM, Tm, WM, Wm, Press, Orientation, X, Y, TrID
+    0, 0, 0, 0, 10, 0, 50, 50, 1, 0
+  };
+  HardwareState hardware_state = make_hwstate(200000, 0, 1, 1, &finger_state);
+  stime_t timeout = NO_DEADLINE;
+  wrapper.SyncInterpret(hardware_state, &timeout);
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+  const char* filename = std::tmpnam(nullptr);
+#pragma GCC diagnostic pop
+  ASSERT_NE(nullptr, filename) << "Couldn't generate a temporary file name";
+  interpreter.log_location_.SetValue(Json::Value(filename));
+  interpreter.log_binary_.SetValue(Json::Value(true));
+  interpreter.IntWasWritten(&interpreter.logging_notify_);
+
+  std::string data;
+  ASSERT_TRUE(ReadFileToString(filename, &data));
+  std::unique_ptr<ActivityLog> log(new ActivityLog(nullptr));
+  ActivityLog::BinaryInfo info;
+  ASSERT_TRUE(log->ReadBinary(data.data(), data.size(), &info));
+  EXPECT_EQ("LoggingFilterInterpreter", info.interpreter_name);
+  EXPECT_EQ(interpreter.EncodeActivityLog(), log->Encode(info));
+  remove(filename);
+}
+
+TEST(LoggingFilterInterpreterTest, EncodeAsyncTest) {
+  PropRegistry prop_reg;
+  LoggingFilterInterpreterResetLogTestInterpreter* base_interpreter =
+      new LoggingFilterInterpreterResetLogTestInterpreter();
+  LoggingFilterInterpreter interpreter(&prop_reg, base_interpreter, nullptr);
+  interpreter.event_logging_enable_.SetValue(Json::Value(true));
+  interpreter.BoolWasWritten(&interpreter.event_logging_enable_);
+
+  HardwareProperties hwprops = {
+    .right = 100, .bottom = 100,
+    .res_x = 10,
+    .res_y = 10,
+    .orientation_minimum = -1,
+    .orientation_maximum = 2,
+    .max_finger_cnt = 2, .max_touch_cnt = 5,
+    .supports_t5r2 = 0, .support_semi_mt = 0, .is_button_pad = 1,
+    .has_wheel = 0, .wheel_is_hi_res = 0,
+    .is_haptic_pad = 0,
+  };
+  TestInterpreterWrapper wrapper(&interpreter, &hwprops);
+  FingerState finger_state = {
+    // TM, Tm, WM, Wm, Press, Orientation, X, Y, TrID
+    0, 0, 0, 0, 10, 0, 50, 50, 1, 0
+  };
+  HardwareState hardware_state = make_hwstate(200000, 0, 1, 1, &finger_state);
+  stime_t timeout = NO_DEADLINE;
+  wrapper.SyncInterpret(hardware_state, &timeout);
+
+  std::string expected = interpreter.EncodeActivityLog();
+  std::string encoded;
+  interpreter.EncodeActivityLogAsync(
+      [](void* client_data, const std::string& log) {
+        *static_cast<std::string*>(client_data) = log;
+      }, &encoded);
+  ASSERT_NE(nullptr, interpreter.encoder_.get());
+  interpreter.encoder_->Wait();
+  EXPECT_EQ(expected, encoded);
+}
 }  // namespace gestures
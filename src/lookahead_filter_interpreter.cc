@@ -8,6 +8,7 @@
 #include <memory>
 #include <math.h>
 
+#include "include/state_archive.h"
 #include "include/tracer.h"
 #include "include/util.h"
 
@@ -18,6 +19,8 @@ namespace gestures {
 
 namespace {
 static const stime_t kMaxDelay = 0.09;  // 90ms
+// Report rate used to size the queue. Faster devices just make it grow once.
+static const double kMaxExpectedReportRate = 250.0;  // Hz
 }
 
 LookaheadFilterInterpreter::LookaheadFilterInterpreter(
@@ -49,17 +52,14 @@ void LookaheadFilterInterpreter::SyncInterpretImpl(HardwareState& hwstate,
   const char name[] = "LookaheadFilterInterpreter::SyncInterpretImpl";
   LogHardwareStatePre(name, hwstate);
 
-  // Keep track of where the last node is in the current queue_
-  auto const queue_was_not_empty = !queue_.empty();
-  QState* old_back_node = queue_was_not_empty ? &queue_.back() : nullptr;
-
-  // Allocate and initialize a new node on the end of the queue_
-  auto& new_node = queue_.emplace_back(hwprops_->max_finger_cnt);
+  // Initialize a new node on the end of the queue_
+  auto& new_node = PushNode();
   new_node.state_.DeepCopy(hwstate, hwprops_->max_finger_cnt);
   double delay = max(0.0, min<stime_t>(kMaxDelay, min_delay_.val_));
   new_node.due_ = hwstate.timestamp + delay;
 
-  if (queue_was_not_empty) {
+  if (queue_.size() > 1) {
+    QState* old_back_node = &queue_.at(-2);
     new_node.output_ids_ = old_back_node->output_ids_;
 
     // At this point, if ExtraVariableDelay() > 0, old_back_node.due_ may have
@@ -67,16 +67,16 @@ void LookaheadFilterInterpreter::SyncInterpretImpl(HardwareState& hwstate,
     if (old_back_node->due_ - new_node.due_ > ExtraVariableDelay()) {
       Err("Clock changed backwards. Flushing queue.");
       stime_t next_timeout = NO_DEADLINE;
-      auto q_node_iter = queue_.begin();
       do {
-        if (!q_node_iter->completed_)
-          next_->SyncInterpret(q_node_iter->state_, &next_timeout);
-        ++q_node_iter;
+        if (!queue_.front().completed_)
+          SyncInterpretNext(queue_.front().state_, &next_timeout);
         queue_.pop_front();
       } while (queue_.size() > 1);
       interpreter_due_deadline_ = -1.0;
       last_interpreted_time_ = -1.0;
     }
+  } else {
+    new_node.output_ids_.clear();
   }
 
   AssignTrackingIds();
@@ -179,7 +179,7 @@ void LookaheadFilterInterpreter::AssignTrackingIds() {
       drumroll_max_speed_ratio_.val_;
   const float prev_dt_sq = prev_dt * prev_dt;
 
-  std::set<short> separated_fingers;  // input ids
+  TrackingIdSet separated_fingers;  // input ids
   float max_dist_sq = 0.0;  // largest non-drumroll dist squared.
   // If there is only a single finger drumrolling, this is the distance
   // it travelled squared.
@@ -294,9 +294,7 @@ void LookaheadFilterInterpreter::AssignTrackingIds() {
        max_dist_sq * co_move_ratio_.val_ * co_move_ratio_.val_)) {
     // Two fingers drumrolling at the exact same time. More likely this is
     // a fast multi-finger swipe. Abort the drumroll detection.
-    for (std::set<short>::const_iterator it = separated_fingers.begin(),
-             e = separated_fingers.end(); it != e; ++it) {
-      short input_id = *it;
+    for (short input_id : separated_fingers) {
       if (!MapContainsKey(prev_qs->output_ids_, input_id)) {
         Err("How is input ID missing from prev state? %d", input_id);
         continue;
@@ -417,16 +415,20 @@ void LookaheadFilterInterpreter::AttemptInterpolation() {
   }
   if (!prev.state_.SameFingersAs(new_node.state_))
     return;
-  auto node = QState(hwprops_->max_finger_cnt);
-  Interpolate(prev.state_, new_node.state_, &node.state_);
+  // Make sure time seems monotonically increasing w/ this new event
+  if ((prev.state_.timestamp + new_node.state_.timestamp) / 2.0 <=
+      last_interpreted_time_)
+    return;
+  // Push a node and swap it in front of new_node. Swapping a QState just
+  // exchanges the slots' finger storage, so state_.fingers stays valid.
+  PushNode();
+  std::swap(queue_.at(-1), queue_.at(-2));
+  QState& node = queue_.at(-2);
+  node.output_ids_.clear();
+  Interpolate(queue_.at(-3).state_, queue_.at(-1).state_, &node.state_);
 
   double delay = max(0.0, min<stime_t>(kMaxDelay, min_delay_.val_));
   node.due_ = node.state_.timestamp + delay;
-
-  // Make sure time seems monotonically increasing w/ this new event
-  if (node.state_.timestamp > last_interpreted_time_) {
-    queue_.insert(--queue_.end(), std::move(node));
-  }
 }
 
 void LookaheadFilterInterpreter::HandleTimerImpl(stime_t now,
@@ -451,7 +453,7 @@ void LookaheadFilterInterpreter::HandleTimerImpl(stime_t now,
       // Mark that we interpreted and propagate the next_ HandleTimer
       last_interpreted_time_ = now;
       next_timeout = NO_DEADLINE;
-      next_->HandleTimer(now, &next_timeout);
+      HandleTimerNext(now, &next_timeout);
     } else {
       // No previous detection of an expired node
       if (queue_.empty())
@@ -473,17 +475,15 @@ void LookaheadFilterInterpreter::HandleTimerImpl(stime_t now,
       // SyncInterpret
       last_interpreted_time_ = node->state_.timestamp;
       const size_t finger_cnt = node->state_.finger_cnt;
-      auto fs_copy =
-        std::make_unique<FingerState[]>(std::max(finger_cnt, (size_t)1));
       std::copy(&node->state_.fingers[0],
                 &node->state_.fingers[finger_cnt],
-                &fs_copy[0]);
+                &fs_copy_[0]);
       HardwareState hs_copy = {
         node->state_.timestamp,
         node->state_.buttons_down,
         node->state_.finger_cnt,
         node->state_.touch_cnt,
-        fs_copy.get(),
+        fs_copy_.get(),
         node->state_.rel_x,
         node->state_.rel_y,
         node->state_.rel_wheel,
@@ -492,7 +492,7 @@ void LookaheadFilterInterpreter::HandleTimerImpl(stime_t now,
         node->state_.msc_timestamp,
       };
       next_timeout = NO_DEADLINE;
-      next_->SyncInterpret(hs_copy, &next_timeout);
+      SyncInterpretNext(hs_copy, &next_timeout);
 
       // Clear previously completed nodes, but keep at least two nodes.
       while (queue_.size() > 2 && queue_.front().completed_) {
@@ -518,8 +518,6 @@ void LookaheadFilterInterpreter::ConsumeGesture(const Gesture& gesture) {
   const char name[] = "LookaheadFilterInterpreter::ConsumeGesture";
   LogGestureConsume(name, gesture);
 
-  QState& node = queue_.front();
-
   float distance_sq = 0.0;
   // Slow movements should potentially be suppressed
   switch (gesture.type) {
@@ -547,9 +545,11 @@ void LookaheadFilterInterpreter::ConsumeGesture(const Gesture& gesture) {
     return;
   }
   // Speed is slow. Suppress if fingers have changed.
-  for (auto iter = ++queue_.begin(); iter != queue_.end(); ++iter) {
-    if (!node.state_.SameFingersAs((*iter).state_) ||
-        (node.state_.buttons_down != (*iter).state_.buttons_down))
+  for (size_t i = 1; i < queue_.size(); i++) {
+    const HardwareState& front = queue_.front().state_;
+    const HardwareState& later = queue_.at(i).state_;
+    if (!front.SameFingersAs(later) ||
+        (front.buttons_down != later.buttons_down))
       return; // suppress
   }
 
@@ -590,22 +590,67 @@ void LookaheadFilterInterpreter::Initialize(
     GestureConsumer* consumer) {
   FilterInterpreter::Initialize(hwprops, nullptr, mprops, consumer);
   queue_.clear();
+  queue_.set_capacity(QueueCapacity());
+  fs_copy_.reset(new FingerState[std::max<unsigned short>(
+      hwprops->max_finger_cnt, 1)]);
+  // Allocate every slot's finger storage now rather than on first use.
+  while (!queue_.full())
+    PushNode();
+  queue_.clear();
 }
 
 stime_t LookaheadFilterInterpreter::ExtraVariableDelay() const {
   return std::max<stime_t>(0.0, max_delay_.val_ - min_delay_.val_);
 }
 
+size_t LookaheadFilterInterpreter::QueueCapacity() const {
+  // Frames wait for at most the delay plus the extra variable delay, and
+  // each may get an interpolated frame in front of it. On top of that, the
+  // two most recently completed frames are kept.
+  stime_t delay = max(0.0, min<stime_t>(kMaxDelay, min_delay_.val_)) +
+      ExtraVariableDelay();
+  return 2 * static_cast<size_t>(ceil(delay * kMaxExpectedReportRate)) + 4;
+}
+
+LookaheadFilterInterpreter::QState& LookaheadFilterInterpreter::PushNode() {
+  if (queue_.full())
+    queue_.set_capacity(max(queue_.capacity() * 2, QueueCapacity()));
+  QState& node = queue_.push_back();
+  if (node.max_fingers_ != hwprops_->max_finger_cnt || !node.fs_) {
+    node.max_fingers_ = hwprops_->max_finger_cnt;
+    node.fs_.reset(new FingerState[node.max_fingers_]);
+  }
+  node.state_ = HardwareState();
+  node.state_.fingers = node.fs_.get();
+  node.due_ = 0.0;
+  node.completed_ = false;
+  return node;
+}
+
 LookaheadFilterInterpreter::QState::QState()
     : max_fingers_(0) {
-  fs_.reset();
   state_.fingers = nullptr;
 }
 
-LookaheadFilterInterpreter::QState::QState(unsigned short max_fingers)
-    : max_fingers_(max_fingers) {
-  fs_.reset(new FingerState[max_fingers]);
-  state_.fingers = fs_.get();
+void LookaheadFilterInterpreter::ArchiveState(StateArchive* archive) {
+  FilterInterpreter::ArchiveState(archive);
+  size_t count = queue_.size();
+  archive->Count(&count);
+  if (!archive->saving() && archive->ok()) {
+    queue_.clear();
+    for (size_t i = 0; i < count; i++)
+      PushNode();
+  }
+  for (QState& node : queue_) {
+    archive->ArchiveHardwareState(&node.state_, node.fs_.get(),
+                                  node.max_fingers_);
+    archive->Archive(&node.output_ids_);
+    archive->Archive(&node.due_);
+    archive->Archive(&node.completed_);
+  }
+  archive->Archive(&last_id_);
+  archive->Archive(&interpreter_due_deadline_);
+  archive->Archive(&last_interpreted_time_);
 }
 
 }  // namespace gestures
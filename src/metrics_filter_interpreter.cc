@@ -11,6 +11,7 @@
 #include "include/gestures.h"
 #include "include/logging.h"
 #include "include/prop_registry.h"
+#include "include/state_archive.h"
 #include "include/tracer.h"
 #include "include/util.h"
 
@@ -66,19 +67,16 @@ void MetricsFilterInterpreter::SyncInterpretImpl(HardwareState& hwstate,
   }
 
   LogHardwareStatePost(name, hwstate);
-  next_->SyncInterpret(hwstate, timeout);
+  SyncInterpretNext(hwstate, timeout);
 }
 
 void MetricsFilterInterpreter::AddNewStateToBuffer(
     FingerHistory& history,
     const FingerState& data,
     const HardwareState& hwstate) {
-  // The history buffer is already full, pop one
-  if (history.size() == MState::MaxHistorySize())
-    history.pop_front();
-
-  // Push the new finger state to the back of buffer
-  (void)history.emplace_back(data, hwstate);
+  // Push the new finger state to the back of buffer. Once the buffer is full
+  // this overwrites the oldest state in place.
+  history.push_back() = MState(data, hwstate);
 }
 
 void MetricsFilterInterpreter::UpdateMouseMovementState(
@@ -141,7 +139,7 @@ void MetricsFilterInterpreter::UpdateFingerState(
   for (short i = 0; i < hwstate.finger_cnt; i++) {
     // Update the map if the contact is new
     if (!MapContainsKey(histories_, fs[i].tracking_id)) {
-      histories_[fs[i].tracking_id] = FingerHistory{};
+      histories_[fs[i].tracking_id].set_capacity(MState::MaxHistorySize());
     }
     auto& href = histories_[fs[i].tracking_id];
 
@@ -183,4 +181,14 @@ bool MetricsFilterInterpreter::DetectNoisyGround(FingerHistory& history) {
   return false;
 }
 
+void MetricsFilterInterpreter::ArchiveState(StateArchive* archive) {
+  FilterInterpreter::ArchiveState(archive);
+  archive->Archive(&histories_);
+  archive->Archive(&mouse_movement_session_index_);
+  archive->Archive(&mouse_movement_current_session_length);
+  archive->Archive(&mouse_movement_current_session_start);
+  archive->Archive(&mouse_movement_current_session_last);
+  archive->Archive(&mouse_movement_current_session_distance);
+}
+
 }  // namespace gestures
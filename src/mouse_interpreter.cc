@@ -8,6 +8,7 @@
 
 #include "include/logging.h"
 #include "include/macros.h"
+#include "include/state_archive.h"
 #include "include/tracer.h"
 
 namespace gestures {
@@ -325,4 +326,15 @@ void MouseInterpreter::InterpretMouseMotionEvent(
   }
 }
 
+void MouseInterpreter::ArchiveState(StateArchive* archive) {
+  Interpreter::ArchiveState(archive);
+  // Only the buttons and axes of prev_state_ are used; it has no fingers.
+  archive->ArchiveHardwareState(&prev_state_, nullptr, 0);
+  archive->Archive(&last_vertical_wheels_);
+  archive->Archive(&last_horizontal_wheels_);
+  archive->Archive(&wheel_emulation_accu_x_);
+  archive->Archive(&wheel_emulation_accu_y_);
+  archive->Archive(&wheel_emulation_active_);
+}
+
 }  // namespace gestures
@@ -6,6 +6,7 @@
 
 #include <algorithm>
 
+#include "include/state_archive.h"
 #include "include/tracer.h"
 #include "include/util.h"
 
@@ -38,6 +39,8 @@ MultitouchMouseInterpreter::MultitouchMouseInterpreter(
     : MouseInterpreter(prop_reg, tracer),
       state_buffer_(2),
       scroll_buffer_(15),
+      prev_gs_fingers_(&finger_slots_),
+      gs_fingers_(&finger_slots_),
       prev_gesture_type_(kGestureTypeNull),
       current_gesture_type_(kGestureTypeNull),
       should_fling_(false),
@@ -108,6 +111,7 @@ void MultitouchMouseInterpreter::SyncInterpretImpl(HardwareState& hwstate,
   state_buffer_.PushState(hwstate);
 
   // TODO(clchiou): Remove palm and thumb.
+  finger_slots_.Retain(prev_gs_fingers_.bits());
   gs_fingers_.clear();
   size_t num_fingers = std::min(kMaxGesturingFingers,
                                 (size_t)state_buffer_.Get(0).finger_cnt);
@@ -248,4 +252,23 @@ void MultitouchMouseInterpreter::InterpretMultitouchEvent() {
   prev_result_ = result;
 }
 
+void MultitouchMouseInterpreter::ArchiveState(StateArchive* archive) {
+  MouseInterpreter::ArchiveState(archive);
+  archive->Archive(&state_buffer_);
+  archive->ArchiveHardwareState(&prev_state_, nullptr, 0);
+  archive->Archive(&scroll_buffer_);
+  // The FingerMaps share finger_slots_, so it goes first.
+  archive->Archive(&finger_slots_);
+  archive->Archive(&prev_gs_fingers_);
+  archive->Archive(&gs_fingers_);
+  archive->Archive(&prev_gesture_type_);
+  archive->Archive(&current_gesture_type_);
+  archive->Archive(&should_fling_);
+  archive->Archive(&scroll_manager_);
+  archive->Archive(&prev_result_);
+  archive->Archive(&origin_);
+  archive->Archive(&start_position_);
+  archive->Archive(&moving_);
+}
+
 }  // namespace gestures
@@ -0,0 +1,443 @@
+// Copyright 2026 The ChromiumOS Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "include/non_linearity_data.h"
+
+#include <endian.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <tuple>
+
+#include "include/logging.h"
+
+namespace {
+
+const size_t kIntPackedSize = 4;
+const size_t kDoublePackedSize = 8;
+
+struct Version2Header {
+  char magic[8];
+  uint32_t version;
+  uint32_t header_size;
+  uint32_t range_len[3];
+  uint32_t reserved;
+};
+static_assert(sizeof(Version2Header) == 32, "Version 2 header must be packed");
+
+uint32_t ReadInt(const char* bytes) {
+  uint32_t val;
+  memcpy(&val, bytes, kIntPackedSize);
+  return le32toh(val);
+}
+
+double ReadDouble(const char* bytes) {
+  uint64_t bits;
+  memcpy(&bits, bytes, kDoublePackedSize);
+  bits = le64toh(bits);
+  double val;
+  memcpy(&val, &bits, kDoublePackedSize);
+  return val;
+}
+
+// Number of doubles in the range arrays and error matrix, or 0 if that would
+// overflow.
+size_t CountValues(size_t x_len, size_t y_len, size_t p_len) {
+  size_t errors, count, p_values;
+  if (__builtin_mul_overflow(p_len, 2, &p_values) ||
+      __builtin_mul_overflow(x_len, y_len, &errors) ||
+      __builtin_mul_overflow(errors, p_values, &errors) ||
+      __builtin_add_overflow(errors, x_len + y_len + p_len, &count))
+    return 0;
+  return count;
+}
+
+// Files are identified by device, inode, size and modification time, so that
+// a file rewritten in place is loaded again.
+typedef std::tuple<dev_t, ino_t, off_t, time_t, long> FileKey;
+
+}  // namespace {}
+
+namespace gestures {
+
+std::shared_ptr<const NonLinearityData> NonLinearityData::Load(
+    const char* path) {
+  // Loaded files, shared by every interpreter in the process
+  static std::mutex cache_lock;
+  static std::map<FileKey, std::weak_ptr<const NonLinearityData>> cache;
+
+  int fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    // TODO(b/329268257): make this an Err, not a Log.
+    Log("Unable to open non-linearity filter data '%s'", path);
+    return nullptr;
+  }
+  struct stat st;
+  if (fstat(fd, &st) < 0 || st.st_size <= 0) {
+    Err("Unable to read non-linearity filter data '%s'", path);
+    close(fd);
+    return nullptr;
+  }
+
+  std::lock_guard<std::mutex> lock(cache_lock);
+  FileKey key(st.st_dev, st.st_ino, st.st_size, st.st_mtim.tv_sec,
+              st.st_mtim.tv_nsec);
+  for (auto it = cache.begin(); it != cache.end();) {
+    if (it->second.expired())
+      it = cache.erase(it);
+    else
+      ++it;
+  }
+  auto it = cache.find(key);
+  if (it != cache.end()) {
+    // The last holder may have let go since the purge above, since releasing
+    // the data doesn't take cache_lock. Then load the file again.
+    if (auto data = it->second.lock()) {
+      close(fd);
+      return data;
+    }
+    cache.erase(it);
+  }
+
+  std::shared_ptr<NonLinearityData> data(new NonLinearityData());
+  data->mapping_size_ = st.st_size;
+  data->mapping_ = mmap(nullptr, data->mapping_size_, PROT_READ, MAP_PRIVATE,
+                        fd, 0);
+  close(fd);
+  if (data->mapping_ == MAP_FAILED) {
+    data->mapping_ = nullptr;
+    Err("Unable to map non-linearity filter data '%s'", path);
+    return nullptr;
+  }
+  if (!data->Parse(static_cast<const char*>(data->mapping_),
+                   data->mapping_size_)) {
+    Err("Invalid non-linearity filter data '%s'", path);
+    return nullptr;
+  }
+  // Data that was copied out doesn't need the file anymore
+  if (data->storage_) {
+    munmap(data->mapping_, data->mapping_size_);
+    data->mapping_ = nullptr;
+  }
+  data->BuildIndexes();
+  cache[key] = data;
+  return data;
+}
+
+NonLinearityData::NonLinearityData()
+    : x_range_(nullptr), y_range_(nullptr), p_range_(nullptr),
+      x_range_len_(0), y_range_len_(0), p_range_len_(0),
+      err_(nullptr), mapping_(nullptr), mapping_size_(0), indexed_(false) {}
+
+NonLinearityData::~NonLinearityData() {
+  if (mapping_)
+    munmap(mapping_, mapping_size_);
+}
+
+bool NonLinearityData::Parse(const char* bytes, size_t size) {
+  bool parsed;
+  if (size >= sizeof(kMagic) && !memcmp(bytes, kMagic, sizeof(kMagic)))
+    parsed = ParseVersion2(bytes, size);
+  else
+    parsed = ParseLegacy(bytes, size);
+  if (!parsed)
+    return false;
+  // Data used in place must end within the file, with every error entry
+  // (p_range_len_ pairs of doubles per (x, y) point) inside it.
+  if (!storage_) {
+    const char* errors = reinterpret_cast<const char*>(err_);
+    size_t points = x_range_len_ * y_range_len_ * p_range_len_;
+    if (errors < bytes || errors > bytes + size ||
+        static_cast<size_t>(bytes + size - errors) / sizeof(Error) < points)
+      return false;
+  }
+  return true;
+}
+
+bool NonLinearityData::ParseVersion2(const char* bytes, size_t size) {
+  if (size < sizeof(Version2Header))
+    return false;
+  Version2Header header;
+  memcpy(&header, bytes, sizeof(header));
+  uint32_t version = le32toh(header.version);
+  if (version != kVersion) {
+    Err("Unsupported non-linearity data version %u", version);
+    return false;
+  }
+  size_t header_size = le32toh(header.header_size);
+  if (header_size < sizeof(header) || header_size % kDoublePackedSize)
+    return false;
+  x_range_len_ = le32toh(header.range_len[0]);
+  y_range_len_ = le32toh(header.range_len[1]);
+  p_range_len_ = le32toh(header.range_len[2]);
+  size_t count = CountValues(x_range_len_, y_range_len_, p_range_len_);
+  if (!count || size < header_size ||
+      (size - header_size) / kDoublePackedSize != count ||
+      (size - header_size) % kDoublePackedSize)
+    return false;
+
+  const char* values = bytes + header_size;
+#if __BYTE_ORDER == __LITTLE_ENDIAN
+  SetArrays(reinterpret_cast<const double*>(values));
+#else
+  storage_.reset(new double[count]);
+  for (size_t i = 0; i < count; i++)
+    storage_[i] = ReadDouble(values + i * kDoublePackedSize);
+  SetArrays(storage_.get());
+#endif
+  return true;
+}
+
+bool NonLinearityData::ParseLegacy(const char* bytes, size_t size) {
+  // Each range array is preceded by its length. Find all three first.
+  size_t len[3];
+  size_t offset = 0;
+  for (size_t i = 0; i < 3; i++) {
+    if (size - offset < kIntPackedSize)
+      return false;
+    len[i] = ReadInt(bytes + offset);
+    if (len[i] > size / kDoublePackedSize)
+      return false;
+    offset += kIntPackedSize + len[i] * kDoublePackedSize;
+    if (offset > size)
+      return false;
+  }
+  size_t count = CountValues(len[0], len[1], len[2]);
+  if (!count || (size - offset) / kDoublePackedSize <
+                count - (len[0] + len[1] + len[2]))
+    return false;
+  x_range_len_ = len[0];
+  y_range_len_ = len[1];
+  p_range_len_ = len[2];
+
+  storage_.reset(new double[count]);
+  double* out = storage_.get();
+  offset = 0;
+  for (size_t i = 0; i < 3; i++) {
+    offset += kIntPackedSize;
+    for (size_t j = 0; j < len[i]; j++, offset += kDoublePackedSize)
+      *out++ = ReadDouble(bytes + offset);
+  }
+  for (; out != storage_.get() + count; offset += kDoublePackedSize)
+    *out++ = ReadDouble(bytes + offset);
+  SetArrays(storage_.get());
+  return true;
+}
+
+void NonLinearityData::SetArrays(const double* values) {
+  x_range_ = values;
+  y_range_ = x_range_ + x_range_len_;
+  p_range_ = y_range_ + y_range_len_;
+  err_ = reinterpret_cast<const Error*>(p_range_ + p_range_len_);
+}
+
+size_t NonLinearityData::ErrorIndex(size_t x_index,
+                                    size_t y_index,
+                                    size_t p_index) const {
+  size_t index = x_index * y_range_len_ * p_range_len_ +
+                 y_index * p_range_len_ + p_index;
+
+  if (index >= x_range_len_ * y_range_len_ * p_range_len_)
+    index = 0;
+  return index;
+}
+
+NonLinearityData::Error
+NonLinearityData::LinearInterpolate(const Error& p1, const Error& p2,
+                                    float percent_p1) {
+  Error ret;
+  ret.x_error = percent_p1 * p1.x_error + (1.0 - percent_p1) * p2.x_error;
+  ret.y_error = percent_p1 * p1.y_error + (1.0 - percent_p1) * p2.y_error;
+  return ret;
+}
+
+NonLinearityData::Error NonLinearityData::GetError(float finger_x,
+                                                   float finger_y,
+                                                   float finger_p) const {
+  // First, find the 6 values surrounding the point to interpolate over
+  Bounds x_bounds = FindBounds(finger_x, x_range_, x_range_len_);
+  Bounds y_bounds = FindBounds(finger_y, y_range_, y_range_len_);
+  Bounds p_bounds = FindBounds(finger_p, p_range_, p_range_len_);
+
+  if (x_bounds.lo == -1 || x_bounds.hi == -1 || y_bounds.lo == -1 ||
+    y_bounds.hi == -1 || p_bounds.lo == -1 || p_bounds.hi == -1) {
+    Error error = { 0, 0 };
+    return error;
+  }
+  return InterpolateError(finger_x, finger_y, finger_p,
+                          x_bounds, y_bounds, p_bounds);
+}
+
+NonLinearityData::Error
+NonLinearityData::InterpolateError(float finger_x, float finger_y,
+                                   float finger_p,
+                                   const Bounds& x_bounds,
+                                   const Bounds& y_bounds,
+                                   const Bounds& p_bounds) const {
+  // Interpolate along the x-axis
+  float x_hi_perc = (finger_x - x_range_[x_bounds.lo]) /
+                    (x_range_[x_bounds.hi] - x_range_[x_bounds.lo]);
+  Error e_yhi_phi = LinearInterpolate(
+                        err_[ErrorIndex(x_bounds.hi, y_bounds.hi, p_bounds.hi)],
+                        err_[ErrorIndex(x_bounds.lo, y_bounds.hi, p_bounds.hi)],
+                        x_hi_perc);
+  Error e_yhi_plo = LinearInterpolate(
+                        err_[ErrorIndex(x_bounds.hi, y_bounds.hi, p_bounds.lo)],
+                        err_[ErrorIndex(x_bounds.lo, y_bounds.hi, p_bounds.lo)],
+                        x_hi_perc);
+  Error e_ylo_phi = LinearInterpolate(
+                        err_[ErrorIndex(x_bounds.hi, y_bounds.lo, p_bounds.hi)],
+                        err_[ErrorIndex(x_bounds.lo, y_bounds.lo, p_bounds.hi)],
+                        x_hi_perc);
+  Error e_ylo_plo = LinearInterpolate(
+                        err_[ErrorIndex(x_bounds.hi, y_bounds.lo, p_bounds.lo)],
+                        err_[ErrorIndex(x_bounds.lo, y_bounds.lo, p_bounds.lo)],
+                        x_hi_perc);
+
+  // Interpolate along the y-axis
+  float y_hi_perc = (finger_y - y_range_[y_bounds.lo]) /
+                    (y_range_[y_bounds.hi] - y_range_[y_bounds.lo]);
+  Error e_plo = LinearInterpolate(e_yhi_plo, e_ylo_plo, y_hi_perc);
+  Error e_phi = LinearInterpolate(e_yhi_phi, e_ylo_phi, y_hi_perc);
+
+  // Finally, interpolate along the p-axis
+  float p_hi_perc = (finger_p - p_range_[p_bounds.lo]) /
+                    (p_range_[p_bounds.hi] - p_range_[p_bounds.lo]);
+  Error error = LinearInterpolate(e_phi, e_plo, p_hi_perc);
+
+  return error;
+}
+
+NonLinearityData::Bounds NonLinearityData::FindBounds(float value,
+                                                      const double* range,
+                                                      size_t len) {
+  Bounds bounds;
+  bounds.lo = bounds.hi = -1;
+
+  for (size_t i = 0; i < len; i++) {
+    if (range[i] <= value) {
+      bounds.lo = i;
+    } else {
+      bounds.hi = i;
+      break;
+    }
+  }
+
+  return bounds;
+}
+
+bool NonLinearityData::BuildIndex(const double* range, size_t len,
+                                  RangeIndex* index) {
+  if (len < 2)
+    return false;
+  double span = range[len - 1] - range[0];
+  double min_gap = span;
+  for (size_t i = 1; i < len; i++) {
+    double gap = range[i] - range[i - 1];
+    if (!(gap >= 0)) {
+      Err("Non-linearity range is not sorted");
+      return false;
+    }
+    if (gap > 0)
+      min_gap = std::min(min_gap, gap);
+  }
+  if (!(span > 0))
+    return false;
+
+  // Buckets no wider than the smallest cell hold at most one sample point.
+  // Capping them only means walking a little further in Locate().
+  double buckets = std::ceil(span / min_gap);
+  index->buckets = buckets < kMaxIndexBuckets ?
+      static_cast<size_t>(buckets) : kMaxIndexBuckets;
+  index->range = range;
+  index->len = len;
+  index->origin = range[0];
+  index->end = range[len - 1];
+  index->inv_width = index->buckets / span;
+  index->first_cell.reset(new uint32_t[index->buckets]);
+  size_t cell = 0;
+  for (size_t b = 0; b < index->buckets; b++) {
+    double start = index->origin + b / index->inv_width;
+    while (cell + 2 < len && range[cell + 1] <= start)
+      cell++;
+    index->first_cell[b] = cell;
+  }
+  return true;
+}
+
+void NonLinearityData::BuildIndexes() {
+  indexed_ = BuildIndex(x_range_, x_range_len_, &x_index_) &&
+             BuildIndex(y_range_, y_range_len_, &y_index_) &&
+             BuildIndex(p_range_, p_range_len_, &p_index_);
+}
+
+bool NonLinearityData::RangeIndex::Locate(float value, size_t* index,
+                                          float* frac) const {
+  if (!(value >= origin && value < end))
+    return false;
+  size_t bucket = std::min(static_cast<size_t>((value - origin) * inv_width),
+                           buckets - 1);
+  // Step to the last sample point at or below |value|, as FindBounds() does.
+  // Stepping back covers rounding in the bucket.
+  size_t cell = first_cell[bucket];
+  while (cell > 0 && range[cell] > value)
+    cell--;
+  while (cell + 2 < len && range[cell + 1] <= value)
+    cell++;
+  *index = cell;
+  *frac = (value - range[cell]) / (range[cell + 1] - range[cell]);
+  return true;
+}
+
+void NonLinearityData::CorrectFingers(FingerState* fingers,
+                                      size_t count) const {
+  if (!indexed_) {
+    for (size_t i = 0; i < count; i++) {
+      FingerState& fs = fingers[i];
+      Error error = GetError(fs.position_x, fs.position_y, fs.pressure);
+      fs.position_x -= error.x_error;
+      fs.position_y -= error.y_error;
+    }
+    return;
+  }
+  const size_t stride_y = p_range_len_;
+  const size_t stride_x = y_range_len_ * stride_y;
+  // Offsets of the cell corners with the lower x, in (y, p) order
+  const size_t corners[4] = { 0, 1, stride_y, stride_y + 1 };
+
+  for (size_t i = 0; i < count; i++) {
+    FingerState& fs = fingers[i];
+    size_t x, y, p;
+    float x_frac, y_frac, p_frac;
+    if (!x_index_.Locate(fs.position_x, &x, &x_frac) ||
+        !y_index_.Locate(fs.position_y, &y, &y_frac) ||
+        !p_index_.Locate(fs.pressure, &p, &p_frac))
+      continue;
+
+    // Interpolate along the x-axis, then the y-axis, then the p-axis
+    const Error* cell = &err_[x * stride_x + y * stride_y + p];
+    double x_err[4], y_err[4];
+    for (size_t c = 0; c < 4; c++) {
+      const Error& lo = cell[corners[c]];
+      const Error& hi = cell[corners[c] + stride_x];
+      x_err[c] = lo.x_error + x_frac * (hi.x_error - lo.x_error);
+      y_err[c] = lo.y_error + x_frac * (hi.y_error - lo.y_error);
+    }
+    double x_plo = x_err[0] + y_frac * (x_err[2] - x_err[0]);
+    double x_phi = x_err[1] + y_frac * (x_err[3] - x_err[1]);
+    double y_plo = y_err[0] + y_frac * (y_err[2] - y_err[0]);
+    double y_phi = y_err[1] + y_frac * (y_err[3] - y_err[1]);
+    fs.position_x -= x_plo + p_frac * (x_phi - x_plo);
+    fs.position_y -= y_plo + p_frac * (y_phi - y_plo);
+  }
+}
+
+}  // namespace gestures
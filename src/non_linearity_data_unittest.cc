@@ -0,0 +1,207 @@
+// Copyright 2026 The ChromiumOS Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <math.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "include/file_util.h"
+#include "include/non_linearity_data.h"
+
+namespace gestures {
+
+namespace {
+
+const char kTestNonlinearData[] =
+    "data/non_linearity_data/testing_non_linearity_data.dat";
+const char kTestNonlinearDataV2[] =
+    "data/non_linearity_data/testing_non_linearity_data_v2.dat";
+
+// Writes |contents| to a new temporary file and returns its name
+std::string WriteTempFile(const std::string& contents) {
+  // std::tmpnam is considered unsafe because another process could create the
+  // temporary file after time std::tmpnam returns the name but before the code
+  // actually opens it. Because this is just test code, we don't need to be
+  // concerned about such security holes here.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+  const char* filename = std::tmpnam(nullptr);
+#pragma GCC diagnostic pop
+  if (!filename)
+    return "";
+  WriteFile(filename, contents.data(), contents.size());
+  return filename;
+}
+
+// Returns |values| packed as doubles, in the legacy file format
+std::string PackDoubles(const std::vector<double>& values) {
+  std::string out;
+  for (double value : values)
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+  return out;
+}
+
+// Returns |range| in the legacy file format
+std::string PackRange(const std::vector<double>& range) {
+  uint32_t len = range.size();
+  return std::string(reinterpret_cast<const char*>(&len), sizeof(len)) +
+         PackDoubles(range);
+}
+
+}  // namespace {}
+
+class NonLinearityDataTest : public ::testing::Test {};
+
+TEST(NonLinearityDataTest, Version2MatchesLegacyTest) {
+  std::shared_ptr<const NonLinearityData> legacy =
+      NonLinearityData::Load(kTestNonlinearData);
+  std::shared_ptr<const NonLinearityData> v2 =
+      NonLinearityData::Load(kTestNonlinearDataV2);
+  ASSERT_NE(nullptr, legacy);
+  ASSERT_NE(nullptr, v2);
+  EXPECT_FALSE(legacy->mapped());
+  EXPECT_TRUE(v2->mapped());
+
+  const float values[] = { -0.5, 0.0, 0.1, 0.25, 0.33, 0.5, 0.61, 0.75,
+                           0.999, 1.0, 1.5 };
+  for (float x : values) {
+    for (float y : values) {
+      for (float p : values) {
+        NonLinearityData::Error expected = legacy->GetError(x, y, p);
+        NonLinearityData::Error actual = v2->GetError(x, y, p);
+        EXPECT_EQ(expected.x_error, actual.x_error);
+        EXPECT_EQ(expected.y_error, actual.y_error);
+      }
+    }
+  }
+}
+
+TEST(NonLinearityDataTest, IndexMatchesRangesTest) {
+  std::shared_ptr<const NonLinearityData> data =
+      NonLinearityData::Load(kTestNonlinearDataV2);
+  ASSERT_NE(nullptr, data);
+
+  // The indexed correction should match interpolating over the range
+  // arrays, including outside of them and on the sample points
+  const float values[] = { -0.5, 0.0, 0.1, 0.25, 0.33, 0.5, 0.61, 0.75,
+                           0.999, 1.0, 1.5 };
+  for (float x : values) {
+    for (float y : values) {
+      for (float p : values) {
+        FingerState fs = { 0, 0, 0, 0, p, 0, x, y, 1, 0 };
+        data->CorrectFingers(&fs, 1);
+        NonLinearityData::Error error = data->GetError(x, y, p);
+        EXPECT_NEAR(x - error.x_error, fs.position_x, 1e-6)
+            << x << ", " << y << ", " << p;
+        EXPECT_NEAR(y - error.y_error, fs.position_y, 1e-6)
+            << x << ", " << y << ", " << p;
+      }
+    }
+  }
+}
+
+TEST(NonLinearityDataTest, UnevenRangesTest) {
+  // Unevenly spaced sample points, a repeated one, and a range with far more
+  // room between its ends than between its closest points
+  const std::vector<double> x_range = { 0, 2, 5, 5, 9 };
+  const std::vector<double> y_range = { 0, 0.001, 1, 1000 };
+  const std::vector<double> p_range = { 0, 0.5, 2 };
+  std::vector<double> errors;
+  for (size_t x = 0; x < x_range.size(); x++) {
+    for (size_t y = 0; y < y_range.size(); y++) {
+      for (size_t p = 0; p < p_range.size(); p++) {
+        errors.push_back(0.1 * x - 0.2 * y + 0.05 * p * x);
+        errors.push_back(0.3 * y * y - 0.1 * p + 0.01 * x * y);
+      }
+    }
+  }
+  std::string file = WriteTempFile(PackRange(x_range) + PackRange(y_range) +
+                                   PackRange(p_range) + PackDoubles(errors));
+  ASSERT_NE("", file);
+  std::shared_ptr<const NonLinearityData> data =
+      NonLinearityData::Load(file.c_str());
+  remove(file.c_str());
+  ASSERT_NE(nullptr, data);
+
+  // Matches GetError() to within float rounding of the positions, relative
+  // to their size
+  const double kTolerance = 1e-6;
+  const float x_values[] = { -1, 0, 1, 1.9, 2, 3, 4.99, 5, 6.5, 8.999, 9, 10 };
+  const float y_values[] = { -1, 0, 0.0005, 0.001, 0.5, 1, 2, 499.5, 999,
+                             1000, 1001 };
+  const float p_values[] = { -1, 0, 0.25, 0.5, 1, 1.999, 2, 3 };
+  for (float x : x_values) {
+    for (float y : y_values) {
+      for (float p : p_values) {
+        FingerState fs = { 0, 0, 0, 0, p, 0, x, y, 1, 0 };
+        data->CorrectFingers(&fs, 1);
+        NonLinearityData::Error error = data->GetError(x, y, p);
+        double expected_x = x - error.x_error;
+        double expected_y = y - error.y_error;
+        EXPECT_NEAR(expected_x, fs.position_x,
+                    kTolerance * std::max(1.0, fabs(expected_x)))
+            << x << ", " << y << ", " << p;
+        EXPECT_NEAR(expected_y, fs.position_y,
+                    kTolerance * std::max(1.0, fabs(expected_y)))
+            << x << ", " << y << ", " << p;
+      }
+    }
+  }
+}
+
+TEST(NonLinearityDataTest, SharedTest) {
+  std::shared_ptr<const NonLinearityData> data1 =
+      NonLinearityData::Load(kTestNonlinearDataV2);
+  std::shared_ptr<const NonLinearityData> data2 =
+      NonLinearityData::Load(kTestNonlinearDataV2);
+  ASSERT_NE(nullptr, data1);
+  EXPECT_EQ(data1, data2);
+  EXPECT_NE(data1, NonLinearityData::Load(kTestNonlinearData));
+
+  // Once released, the file is loaded again
+  data1.reset();
+  data2.reset();
+  EXPECT_NE(nullptr, NonLinearityData::Load(kTestNonlinearDataV2));
+}
+
+TEST(NonLinearityDataTest, InvalidFileTest) {
+  EXPECT_EQ(nullptr, NonLinearityData::Load("/nonexistent/file.dat"));
+
+  std::string contents;
+  ASSERT_TRUE(ReadFileToString(kTestNonlinearDataV2, &contents));
+
+  std::string truncated =
+      WriteTempFile(contents.substr(0, contents.size() - 8));
+  ASSERT_NE("", truncated);
+  EXPECT_EQ(nullptr, NonLinearityData::Load(truncated.c_str()));
+  remove(truncated.c_str());
+
+  std::string bad_version = contents;
+  bad_version[8] = 3;
+  std::string future = WriteTempFile(bad_version);
+  ASSERT_NE("", future);
+  EXPECT_EQ(nullptr, NonLinearityData::Load(future.c_str()));
+  remove(future.c_str());
+
+  // A P range longer than the file has room for errors
+  std::string long_p = contents;
+  long_p[24]++;
+  std::string overlong = WriteTempFile(long_p);
+  ASSERT_NE("", overlong);
+  EXPECT_EQ(nullptr, NonLinearityData::Load(overlong.c_str()));
+  remove(overlong.c_str());
+
+  std::string legacy;
+  ASSERT_TRUE(ReadFileToString(kTestNonlinearData, &legacy));
+  std::string short_legacy = WriteTempFile(legacy.substr(0, 100));
+  ASSERT_NE("", short_legacy);
+  EXPECT_EQ(nullptr, NonLinearityData::Load(short_legacy.c_str()));
+  remove(short_legacy.c_str());
+}
+
+}  // namespace gestures
@@ -104,4 +104,53 @@ TEST(NonLinearityFilterInterpreterTest, HWstateNoChangesNeededTest) {
   EXPECT_FLOAT_EQ(hwstates[1].fingers[0].position_y, 0.5);
 }
 
+TEST(NonLinearityFilterInterpreterTest, MultiFingerTest) {
+  FingerState finger_states[] = {
+    { 0, 0, 0, 0, 0.2, 0, 0.1, 0.3, 1, 0 },
+    { 0, 0, 0, 0, 0.5, 0, 0.5, 0.5, 2, 0 },
+    { 0, 0, 0, 0, 0.2, 0, 0.1, 0.3, 3, 0 },
+  };
+  HardwareState hwstate = make_hwstate(200000, 0, 3, 3, finger_states);
+
+  NonLinearityFilterInterpreterTestInterpreter* base =
+                            new NonLinearityFilterInterpreterTestInterpreter;
+  NonLinearityFilterInterpreter interpreter(nullptr, base, nullptr);
+  TestInterpreterWrapper wrapper(&interpreter);
+  interpreter.enabled_.val_ = 1;
+  interpreter.multi_finger_enabled_.val_ = 1;
+  interpreter.data_location_.val_ = kTestNonlinearData;
+  interpreter.LoadData();
+
+  // Every finger is corrected, see HWstateModificationTest and
+  // HWstateNoChangesNeededTest for the errors at these points
+  EXPECT_EQ(nullptr, wrapper.SyncInterpret(hwstate, nullptr));
+  EXPECT_FLOAT_EQ(hwstate.fingers[0].position_x, 0.1 - 0.325);
+  EXPECT_FLOAT_EQ(hwstate.fingers[0].position_y, 0.3 + 0.325);
+  EXPECT_FLOAT_EQ(hwstate.fingers[1].position_x, 0.5);
+  EXPECT_FLOAT_EQ(hwstate.fingers[1].position_y, 0.5);
+  EXPECT_FLOAT_EQ(hwstate.fingers[2].position_x, 0.1 - 0.325);
+  EXPECT_FLOAT_EQ(hwstate.fingers[2].position_y, 0.3 + 0.325);
+}
+
+TEST(NonLinearityFilterInterpreterTest, SharedDataTest) {
+  NonLinearityFilterInterpreter interpreter1(
+      nullptr, new NonLinearityFilterInterpreterTestInterpreter, nullptr);
+  NonLinearityFilterInterpreter interpreter2(
+      nullptr, new NonLinearityFilterInterpreterTestInterpreter, nullptr);
+  EXPECT_EQ(nullptr, interpreter1.data_);
+
+  // Writing the property loads the data, and interpreters share it
+  interpreter1.data_location_.SetValue(Json::Value(kTestNonlinearData));
+  interpreter1.data_location_.HandleGesturesPropWritten();
+  ASSERT_NE(nullptr, interpreter1.data_);
+  interpreter2.data_location_.SetValue(Json::Value(kTestNonlinearData));
+  interpreter2.data_location_.HandleGesturesPropWritten();
+  EXPECT_EQ(interpreter1.data_, interpreter2.data_);
+
+  interpreter1.data_location_.SetValue(Json::Value(""));
+  interpreter1.data_location_.HandleGesturesPropWritten();
+  EXPECT_EQ(nullptr, interpreter1.data_);
+  EXPECT_NE(nullptr, interpreter2.data_);
+}
+
 }  // namespace gestures
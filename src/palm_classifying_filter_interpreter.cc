@@ -6,6 +6,7 @@
 
 #include "include/gestures.h"
 #include "include/interpreter.h"
+#include "include/state_archive.h"
 #include "include/tracer.h"
 #include "include/util.h"
 
@@ -15,6 +16,7 @@ PalmClassifyingFilterInterpreter::PalmClassifyingFilterInterpreter(
     PropRegistry* prop_reg, Interpreter* next,
     Tracer* tracer)
     : FilterInterpreter(nullptr, next, tracer, false),
+      prev_finger_cnt_(0),
       palm_pressure_(prop_reg, "Palm Pressure", 200.0),
       palm_width_(prop_reg, "Palm Width", 21.2),
       multi_palm_width_(prop_reg, "Multiple Palm Width", 75.0),
@@ -48,86 +50,57 @@ void PalmClassifyingFilterInterpreter::SyncInterpretImpl(
   const char name[] = "PalmClassifyingFilterInterpreter::SyncInterpretImpl";
   LogHardwareStatePre(name, hwstate);
 
-  FillOriginInfo(hwstate);
-  FillMaxPressureWidthInfo(hwstate);
-  UpdateDistanceInfo(hwstate);
+  UpdateFingerRecords(hwstate);
   UpdatePalmState(hwstate);
   UpdatePalmFlags(hwstate);
   FillPrevInfo(hwstate);
 
   LogHardwareStatePost(name, hwstate);
   if (next_.get())
-    next_->SyncInterpret(hwstate, timeout);
+    SyncInterpretNext(hwstate, timeout);
 }
 
-void PalmClassifyingFilterInterpreter::FillOriginInfo(
+void PalmClassifyingFilterInterpreter::UpdateFingerRecords(
     const HardwareState& hwstate) {
-  RemoveMissingIdsFromMap(&origin_timestamps_, hwstate);
-  RemoveMissingIdsFromMap(&origin_fingerstates_, hwstate);
+  RemoveMissingIdsFromMap(&records_, hwstate);
   for (size_t i = 0; i < hwstate.finger_cnt; i++) {
     const FingerState& fs = hwstate.fingers[i];
-    if (MapContainsKey(origin_timestamps_, fs.tracking_id))
+    FingerRecord& record = records_[fs.tracking_id];
+    if (!(record.flags & kHasPrev)) {
+      // New contact. The record starts out zeroed.
+      record.origin_timestamp = hwstate.timestamp;
+      record.origin_fs = fs;
+      record.max_pressure = fs.pressure;
+      record.max_width = fs.touch_major;
       continue;
-    origin_timestamps_[fs.tracking_id] = hwstate.timestamp;
-    origin_fingerstates_[fs.tracking_id] = fs;
-  }
-}
-
-void PalmClassifyingFilterInterpreter::FillPrevInfo(
-    const HardwareState& hwstate) {
-  RemoveMissingIdsFromMap(&prev_fingerstates_, hwstate);
-  prev_time_ = hwstate.timestamp;
-  for (size_t i = 0; i < hwstate.finger_cnt; i++) {
-    const FingerState& fs = hwstate.fingers[i];
-    prev_fingerstates_[fs.tracking_id] = fs;
-  }
-}
+    }
+    if (fs.pressure > record.max_pressure)
+      record.max_pressure = fs.pressure;
+    if (fs.touch_major > record.max_width)
+      record.max_width = fs.touch_major;
 
-void PalmClassifyingFilterInterpreter::FillMaxPressureWidthInfo(
-    const HardwareState& hwstate) {
-  RemoveMissingIdsFromMap(&max_pressure_, hwstate);
-  RemoveMissingIdsFromMap(&max_width_, hwstate);
-  for (size_t i = 0; i < hwstate.finger_cnt; i++) {
-    const FingerState& fs = hwstate.fingers[i];
-    int id = fs.tracking_id;
-    if (MapContainsKey(max_pressure_, id)) {
-      if (fs.pressure > max_pressure_[id])
-        max_pressure_[id] = fs.pressure;
-      if (fs.touch_major > max_width_[id])
-        max_width_[id] = fs.touch_major;
-    } else {
-      max_pressure_[id] = fs.pressure;
-      max_width_[id] = fs.touch_major;
+    float delta[2];
+    delta[0] = fs.position_x - record.prev_fs.position_x;
+    delta[1] = fs.position_y - record.prev_fs.position_y;
+    for (int j = 0; j < 2; j++) {
+      if (delta[j] > 0)
+        record.distance_positive[j] += delta[j];
+      else
+        record.distance_negative[j] -= delta[j];
     }
   }
 }
 
-void PalmClassifyingFilterInterpreter::UpdateDistanceInfo(
+void PalmClassifyingFilterInterpreter::FillPrevInfo(
     const HardwareState& hwstate) {
-  RemoveMissingIdsFromMap(&distance_positive_[0], hwstate);
-  RemoveMissingIdsFromMap(&distance_positive_[1], hwstate);
-  RemoveMissingIdsFromMap(&distance_negative_[0], hwstate);
-  RemoveMissingIdsFromMap(&distance_negative_[1], hwstate);
+  prev_time_ = hwstate.timestamp;
   for (size_t i = 0; i < hwstate.finger_cnt; i++) {
     const FingerState& fs = hwstate.fingers[i];
-    int id = fs.tracking_id;
-    if (MapContainsKey(prev_fingerstates_, id)) {
-      float delta[2];
-      delta[0] = fs.position_x - prev_fingerstates_[id].position_x;
-      delta[1] = fs.position_y - prev_fingerstates_[id].position_y;
-      for (int i = 0; i < 2; i++) {
-        if (delta[i] > 0)
-          distance_positive_[i][id] += delta[i];
-        else
-          distance_negative_[i][id] -= delta[i];
-      }
-    } else {
-      distance_positive_[0][id] = 0;
-      distance_positive_[1][id] = 0;
-      distance_negative_[0][id] = 0;
-      distance_negative_[1][id] = 0;
-    }
+    FingerRecord& record = records_[fs.tracking_id];
+    record.prev_fs = fs;
+    record.flags |= kHasPrev;
   }
+  prev_finger_cnt_ = records_.size();
 }
 
 bool PalmClassifyingFilterInterpreter::FingerNearOtherFinger(
@@ -140,11 +113,11 @@ bool PalmClassifyingFilterInterpreter::FingerNearOtherFinger(
       continue;
     bool close_enough_together =
         metrics_->CloseEnoughToGesture(Vector2(fs), Vector2(other_fs)) &&
-        !SetContainsValue(palm_, other_fs.tracking_id);
+        !FingerIsPalm(other_fs.tracking_id);
     bool too_close_together = DistSq(fs, other_fs) <
         palm_split_max_distance_.val_ * palm_split_max_distance_.val_;
     if (close_enough_together && !too_close_together) {
-      was_near_other_fingers_.insert(fs.tracking_id);
+      records_[fs.tracking_id].flags |= kWasNearOtherFingers;
       return true;
     }
   }
@@ -168,41 +141,31 @@ bool PalmClassifyingFilterInterpreter::FingerInBottomArea(
 
 void PalmClassifyingFilterInterpreter::UpdatePalmState(
     const HardwareState& hwstate) {
-  RemoveMissingIdsFromSet(&palm_, hwstate);
-  RemoveMissingIdsFromSet(&large_palm_, hwstate);
-  RemoveMissingIdsFromMap(&pointing_, hwstate);
-  RemoveMissingIdsFromSet(&non_stationary_palm_, hwstate);
-  RemoveMissingIdsFromSet(&fingers_not_in_edge_, hwstate);
-  RemoveMissingIdsFromSet(&was_near_other_fingers_, hwstate);
-
   // Some finger(s) just leaves, skip this update for stability
-  if (prev_fingerstates_.size() > hwstate.finger_cnt)
+  if (prev_finger_cnt_ > hwstate.finger_cnt)
     return;
 
   for (short i = 0; i < hwstate.finger_cnt; i++) {
     const FingerState& fs = hwstate.fingers[i];
+    FingerRecord& record = records_[fs.tracking_id];
     if (!(FingerInPalmEnvelope(fs) || FingerInBottomArea(fs)))
-      fingers_not_in_edge_.insert(fs.tracking_id);
+      record.flags |= kNotInEdge;
     // Mark anything over the palm thresh as a palm
     if (fs.pressure >= palm_pressure_.val_ ||
         fs.touch_major >= multi_palm_width_.val_) {
-      large_palm_.insert(fs.tracking_id);
-      palm_.insert(fs.tracking_id);
-      pointing_.erase(fs.tracking_id);
+      record.flags = (record.flags | kLargePalm | kPalm) & ~kPointingMask;
       continue;
     }
     // Mark externally reported palms
     if(fs.tool_type == FingerState::ToolType::kPalm){
-      palm_.insert(fs.tracking_id);
-      pointing_.erase(fs.tracking_id);
+      record.flags = (record.flags | kPalm) & ~kPointingMask;
     }
   }
 
   if (hwstate.finger_cnt == 1 &&
       hwstate.fingers[0].touch_major >= palm_width_.val_) {
-    large_palm_.insert(hwstate.fingers[0].tracking_id);
-    palm_.insert(hwstate.fingers[0].tracking_id);
-    pointing_.erase(hwstate.fingers[0].tracking_id);
+    FingerRecord& record = records_[hwstate.fingers[0].tracking_id];
+    record.flags = (record.flags | kLargePalm | kPalm) & ~kPointingMask;
   }
 
   const float kPalmStationaryDistSq =
@@ -216,19 +179,19 @@ void PalmClassifyingFilterInterpreter::UpdatePalmState(
 
   for (short i = 0; i < hwstate.finger_cnt; i++) {
     const FingerState& fs = hwstate.fingers[i];
-    bool prev_palm = SetContainsValue(palm_, fs.tracking_id);
-    bool prev_pointing = MapContainsKey(pointing_, fs.tracking_id);
+    FingerRecord& record = records_[fs.tracking_id];
+    bool prev_palm = record.flags & kPalm;
+    bool prev_pointing = record.flags & kPointingMask;
 
     if (prev_palm) {
       // If the finger's pressure & width are more like a fat finger
       // and it has moved a lot, it might be a fat finger and remove
       // it from palm.
-      float dist_sq = DistSq(origin_fingerstates_[fs.tracking_id], fs);
-      if (max_pressure_[fs.tracking_id] <= kFatFingerMaxPressure &&
-          max_width_[fs.tracking_id] <= kFatFingerMaxWidth &&
+      float dist_sq = DistSq(record.origin_fs, fs);
+      if (record.max_pressure <= kFatFingerMaxPressure &&
+          record.max_width <= kFatFingerMaxWidth &&
           dist_sq > kFatFingerMinDistSq) {
-        large_palm_.erase(fs.tracking_id);
-        palm_.erase(fs.tracking_id);
+        record.flags &= ~(kLargePalm | kPalm);
       } else {
         // Lock onto palm
         continue;
@@ -237,9 +200,8 @@ void PalmClassifyingFilterInterpreter::UpdatePalmState(
 
     // If the finger is recently placed, remove it from pointing/fingers.
     // If it's still looking like pointing, it'll get readded.
-    if (FingerAge(fs.tracking_id, hwstate.timestamp) <
-        palm_eval_timeout_.val_) {
-      pointing_.erase(fs.tracking_id);
+    if (FingerAge(record, hwstate.timestamp) < palm_eval_timeout_.val_) {
+      record.flags &= ~kPointingMask;
 
       prev_pointing = false;
     }
@@ -250,11 +212,10 @@ void PalmClassifyingFilterInterpreter::UpdatePalmState(
     if (!prev_pointing && (near_finger || !on_edge)) {
       unsigned reason = (near_finger ? kPointCloseToFinger : 0) |
           ((!on_edge) ? kPointNotInEdge : 0);
-      pointing_[fs.tracking_id] = reason;
+      record.flags = (record.flags & ~kPointingMask) | reason;
     }
 
     // Check if fingers that only move within palm envelope are pointing.
-    int id = fs.tracking_id;
     float min_dist = palm_pointing_min_dist_.val_;
     float max_reverse_dist = palm_pointing_max_reverse_dist_.val_;
 
@@ -262,39 +223,33 @@ void PalmClassifyingFilterInterpreter::UpdatePalmState(
     // one direction significantly without zig-zag. But due to touch sensor's
     // inaccuratcy, we make the rule to be that a finger has to move in one
     // direction significantly with little move in the opposite direction.
-    for (size_t j = 0; j < arraysize(distance_positive_); j++)
-      if ((distance_positive_[j][id] >= min_dist &&
-           distance_negative_[j][id] <= max_reverse_dist) ||
-          (distance_positive_[j][id] <= max_reverse_dist &&
-           distance_negative_[j][id] >= min_dist)) {
-        pointing_[id] |= kPointMoving;
+    for (size_t j = 0; j < arraysize(record.distance_positive); j++)
+      if ((record.distance_positive[j] >= min_dist &&
+           record.distance_negative[j] <= max_reverse_dist) ||
+          (record.distance_positive[j] <= max_reverse_dist &&
+           record.distance_negative[j] >= min_dist)) {
+        record.flags |= kPointMoving;
       }
 
     // However, if the contact has been stationary for a while since it
     // touched down, it is a palm. We track a potential palm closely for the
     // first amount of time to see if it fits this pattern.
-    if (FingerAge(fs.tracking_id, prev_time_) >
-        palm_stationary_time_.val_ ||
-        SetContainsValue(non_stationary_palm_, fs.tracking_id)) {
+    if (FingerAge(record, prev_time_) > palm_stationary_time_.val_ ||
+        (record.flags & kNonStationaryPalm)) {
       // Finger is too old to reconsider or is moving a lot
       continue;
     }
-    if (DistSq(origin_fingerstates_[fs.tracking_id], fs) >
-        kPalmStationaryDistSq || !(FingerInPalmEnvelope(fs) ||
-                                   FingerInBottomArea(fs))) {
+    if (DistSq(record.origin_fs, fs) > kPalmStationaryDistSq ||
+        !(FingerInPalmEnvelope(fs) || FingerInBottomArea(fs))) {
       // Finger moving a lot or not in palm envelope; not a stationary palm.
-      non_stationary_palm_.insert(fs.tracking_id);
+      record.flags |= kNonStationaryPalm;
       continue;
     }
-    if (FingerAge(fs.tracking_id, prev_time_) <=
-        palm_stationary_time_.val_ &&
-        FingerAge(fs.tracking_id, hwstate.timestamp) >
-        palm_stationary_time_.val_ &&
-        !SetContainsValue(non_stationary_palm_, fs.tracking_id) &&
+    if (FingerAge(record, prev_time_) <= palm_stationary_time_.val_ &&
+        FingerAge(record, hwstate.timestamp) > palm_stationary_time_.val_ &&
         !FingerNearOtherFinger(hwstate, i)) {
       // Enough time has passed. Make this stationary contact a palm.
-      palm_.insert(fs.tracking_id);
-      pointing_.erase(fs.tracking_id);
+      record.flags = (record.flags | kPalm) & ~kPointingMask;
     }
   }
 }
@@ -302,22 +257,22 @@ void PalmClassifyingFilterInterpreter::UpdatePalmState(
 void PalmClassifyingFilterInterpreter::UpdatePalmFlags(HardwareState& hwstate) {
   for (short i = 0; i < hwstate.finger_cnt; i++) {
     FingerState* fs = &hwstate.fingers[i];
-    if (SetContainsValue(large_palm_, fs->tracking_id)) {
+    unsigned flags = records_[fs->tracking_id].flags;
+    unsigned pointing = flags & kPointingMask;
+    if (flags & kLargePalm) {
       fs->flags |= GESTURES_FINGER_LARGE_PALM;
     }
-    if (SetContainsValue(palm_, fs->tracking_id)) {
+    if (flags & kPalm) {
       fs->flags |= GESTURES_FINGER_PALM;
-    } else if (!MapContainsKey(pointing_, fs->tracking_id) &&
-               !SetContainsValue(was_near_other_fingers_, fs->tracking_id)) {
+    } else if (!pointing && !(flags & kWasNearOtherFingers)) {
       if (FingerInPalmEnvelope(*fs)) {
         fs->flags |= GESTURES_FINGER_PALM;
       } else if (FingerInBottomArea(*fs)) {
         fs->flags |= (GESTURES_FINGER_WARP_X | GESTURES_FINGER_WARP_Y);
       }
-    } else if (MapContainsKey(pointing_, fs->tracking_id) &&
-               FingerInPalmEnvelope(*fs)) {
+    } else if (pointing && FingerInPalmEnvelope(*fs)) {
       fs->flags |= GESTURES_FINGER_POSSIBLE_PALM;
-      if (pointing_[fs->tracking_id] == kPointCloseToFinger &&
+      if (pointing == kPointCloseToFinger &&
           !FingerNearOtherFinger(hwstate, i)) {
         // Finger was near another finger, but it's not anymore, and it was
         // only this other finger that caused it to point. Mark it w/ warp
@@ -329,13 +284,17 @@ void PalmClassifyingFilterInterpreter::UpdatePalmFlags(HardwareState& hwstate) {
   }
 }
 
-stime_t PalmClassifyingFilterInterpreter::FingerAge(short finger_id,
-                                                    stime_t now) const {
-  if (!MapContainsKey(origin_timestamps_, finger_id)) {
-    Err("Don't have record of finger age for finger %d", finger_id);
-    return -1;
-  }
-  return now - origin_timestamps_.at(finger_id);
+bool PalmClassifyingFilterInterpreter::FingerHasFlags(short finger_id,
+                                                      unsigned flags) const {
+  auto it = records_.find(finger_id);
+  return it != records_.end() && (it->second.flags & flags);
+}
+
+void PalmClassifyingFilterInterpreter::ArchiveState(StateArchive* archive) {
+  FilterInterpreter::ArchiveState(archive);
+  archive->Archive(&records_);
+  archive->Archive(&prev_finger_cnt_);
+  archive->Archive(&prev_time_);
 }
 
 }  // namespace gestures
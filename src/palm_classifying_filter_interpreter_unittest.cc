@@ -97,24 +97,24 @@ TEST(PalmClassifyingFilterInterpreterTest, PalmTest) {
     wrapper.SyncInterpret(hardware_state[i], nullptr);
     switch (i) {
       case 0:
-        EXPECT_TRUE(SetContainsValue(pci.pointing_, 1));
-        EXPECT_FALSE(SetContainsValue(pci.palm_, 1));
-        EXPECT_TRUE(SetContainsValue(pci.pointing_, 2));
-        EXPECT_FALSE(SetContainsValue(pci.palm_, 2));
+        EXPECT_TRUE(pci.FingerIsPointing(1));
+        EXPECT_FALSE(pci.FingerIsPalm(1));
+        EXPECT_TRUE(pci.FingerIsPointing(2));
+        EXPECT_FALSE(pci.FingerIsPalm(2));
         break;
       case 1:  // fallthrough
       case 2:
-        EXPECT_TRUE(SetContainsValue(pci.pointing_, 1));
-        EXPECT_FALSE(SetContainsValue(pci.palm_, 1));
-        EXPECT_FALSE(SetContainsValue(pci.pointing_, 2));
-        EXPECT_TRUE(SetContainsValue(pci.palm_, 2));
+        EXPECT_TRUE(pci.FingerIsPointing(1));
+        EXPECT_FALSE(pci.FingerIsPalm(1));
+        EXPECT_FALSE(pci.FingerIsPointing(2));
+        EXPECT_TRUE(pci.FingerIsPalm(2));
         break;
       case 3:  // fallthrough
       case 4:
-        EXPECT_TRUE(SetContainsValue(pci.pointing_, 3)) << "i=" << i;
-        EXPECT_FALSE(SetContainsValue(pci.palm_, 3));
-        EXPECT_FALSE(SetContainsValue(pci.pointing_, 4));
-        EXPECT_TRUE(SetContainsValue(pci.palm_, 4));
+        EXPECT_TRUE(pci.FingerIsPointing(3)) << "i=" << i;
+        EXPECT_FALSE(pci.FingerIsPalm(3));
+        EXPECT_FALSE(pci.FingerIsPointing(4));
+        EXPECT_TRUE(pci.FingerIsPalm(4));
         break;
     }
   }
@@ -172,12 +172,12 @@ TEST(PalmClassifyingFilterInterpreterTest, ExternallyMarkedPalmTest) {
     wrapper.SyncInterpret(hardware_state[i], nullptr);
     if (i > 1) {
       // After the second frame finger is marked as palm
-      EXPECT_FALSE(SetContainsValue(pci.pointing_, 1));
-      EXPECT_TRUE(SetContainsValue(pci.palm_, 1));
+      EXPECT_FALSE(pci.FingerIsPointing(1));
+      EXPECT_TRUE(pci.FingerIsPalm(1));
     }
     else {
-      EXPECT_TRUE(SetContainsValue(pci.pointing_, 1));
-      EXPECT_FALSE(SetContainsValue(pci.palm_, 1));
+      EXPECT_TRUE(pci.FingerIsPointing(1));
+      EXPECT_FALSE(pci.FingerIsPalm(1));
     }
   }
 }
@@ -229,11 +229,11 @@ TEST(PalmClassifyingFilterInterpreterTest, StationaryPalmTest) {
     if (i > 0) {
       // We expect after the second input frame is processed that the palm
       // is classified
-      EXPECT_FALSE(SetContainsValue(pci.pointing_, 1));
-      EXPECT_TRUE(SetContainsValue(pci.palm_, 1));
+      EXPECT_FALSE(pci.FingerIsPointing(1));
+      EXPECT_TRUE(pci.FingerIsPalm(1));
     }
     if (hardware_state[i].finger_cnt > 1)
-      EXPECT_TRUE(SetContainsValue(pci.pointing_, 2)) << "i=" << i;
+      EXPECT_TRUE(pci.FingerIsPointing(2)) << "i=" << i;
   }
 }
 
@@ -438,7 +438,7 @@ TEST(PalmClassifyingFilterInterpreterTest, PalmReevaluateTest) {
     stime_t age = inputs[i].now_ - inputs[0].now_;
     if (age < pci.palm_eval_timeout_.val_)
       continue;
-    EXPECT_FALSE(SetContainsValue(pci.pointing_, 1));
+    EXPECT_FALSE(pci.FingerIsPointing(1));
   }
 }
 
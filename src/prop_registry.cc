@@ -184,16 +184,16 @@ void DoubleProperty::HandleGesturesPropWritten() {
 }
 
 void DoubleArrayProperty::CreatePropImpl() {
-  auto orig_vals = std::make_unique<float[]>(count_);
+  auto orig_vals = std::make_unique<double[]>(count_);
 
-  memcpy(orig_vals.get(), vals_, count_ * sizeof(float));
+  memcpy(orig_vals.get(), vals_, count_ * sizeof(double));
   gprop_ = parent_->PropProvider()->create_real_fn(
       parent_->PropProviderData(),
       name(),
       vals_,
       count_,
       vals_);
-  if (delegate_ && memcmp(orig_vals.get(), vals_, count_ * sizeof(float)))
+  if (delegate_ && memcmp(orig_vals.get(), vals_, count_ * sizeof(double)))
     delegate_->DoubleArrayWasWritten(this);
 }
 
@@ -330,6 +330,12 @@ bool StringProperty::SetValue(const Json::Value& value) {
   return true;
 }
 
+bool StringProperty::RestoreDefault() {
+  parsed_val_ = default_;
+  val_ = parsed_val_.c_str();
+  return true;
+}
+
 void StringProperty::HandleGesturesPropWritten() {
   if (delegate_)
     delegate_->StringWasWritten(this);
@@ -0,0 +1,610 @@
+// Copyright 2026 The ChromiumOS Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Gesture output differ for recorded ActivityLogs.
+//
+// Replays the hardware states of every log found under the given files and
+// directories (searched recursively) through two touchpad pipelines, "a"
+// and "b", and reports how the gestures "b" produces differ from those of
+// "a". The pipelines can differ in the library build they come from, each
+// given as a shared object loaded side by side with the other, and in
+// property values, each given as a JSON file of name/value pairs applied on
+// top of the log's own. Both default to the library this tool is built
+// with and the log's properties.
+//
+// Each pipeline runs on a VirtualClock, so timers fire exactly when it asks
+// for them rather than when the logged device's did, and the runs are
+// deterministic. Gestures are aligned by GestureDiffer as they come, so logs
+// of any length are diffed in bounded memory, and logs are spread over a
+// work-stealing thread pool.
+//
+// Usage: replay_diff [--lib_a=liba.so] [--lib_b=libb.so]
+//                    [--props_a=a.json] [--props_b=b.json]
+//                    [--only_honor=Prop1,Prop2] [--time_tolerance=S]
+//                    [--motion_tolerance=D] [--fling_tolerance=V]
+//                    [--max_diffs=N] [--threads=N] [--verbose]
+//                    path [path ...]
+//
+// Writes JSON Lines to stdout. For each log, up to --max_diffs (default 20)
+// diffs,
+//   {"diff":"changed","log":"a.json","a":"...","b":"...",
+//    "deltas":{"dx":[1.5,1.75]}}
+// where diff is "missing" (only a produced the gesture), "extra" (only b
+// did) or "changed", then the log's totals,
+//   {"changed":1,"extra":0,"log":"a.json","matched":120,"missing":0,
+//    "max_fling_delta":0,"max_motion_delta":0.25,"result":"differ",...}
+// where result is "same", "differ" or "error", and once all logs are done,
+// a summary. Exits with 0 if no log differs, 1 if one does, and 2 if a log
+// or library couldn't be loaded.
+
+#include <dlfcn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include <json/reader.h>
+#include <json/value.h>
+#include <json/writer.h>
+
+#include "include/activity_log.h"
+#include "include/activity_replay.h"
+#include "include/command_line.h"
+#include "include/file_util.h"
+#include "include/gesture_differ.h"
+#include "include/gestures.h"
+#include "include/replay_util.h"
+#include "include/virtual_clock.h"
+#include "include/work_stealing_pool.h"
+
+namespace gestures {
+
+namespace {
+
+// Gestures produced this long after the input they end at can still be
+// aligned.
+const stime_t kMaxGestureLatency = 1.0;
+
+// ActivityReplay rejects hardware states with more fingers than this.
+const unsigned short kMaxLoggedFingers = 30;
+
+// The C API of one build of the library
+struct GestureLib {
+  GestureInterpreter* (*new_interpreter)(int);
+  void (*delete_interpreter)(GestureInterpreter*);
+  void (*set_hardware_properties)(GestureInterpreter*,
+                                  const HardwareProperties*);
+  void (*push_hardware_state)(GestureInterpreter*, HardwareState*);
+  void (*set_callback)(GestureInterpreter*, GestureReadyFunction, void*);
+  void (*set_timer_provider)(GestureInterpreter*, GesturesTimerProvider*,
+                             void*);
+  void (*set_prop_provider)(GestureInterpreter*, GesturesPropProvider*,
+                            void*);
+  void (*initialize)(GestureInterpreter*, GestureInterpreterDeviceClass);
+};
+
+const GestureLib kBuiltInLib = {
+  NewGestureInterpreterImpl,
+  DeleteGestureInterpreter,
+  GestureInterpreterSetHardwareProperties,
+  GestureInterpreterPushHardwareState,
+  GestureInterpreterSetCallback,
+  GestureInterpreterSetTimerProvider,
+  GestureInterpreterSetPropProvider,
+  GestureInterpreterInitialize,
+};
+
+// Loads the library build at |path| into |lib|. Each build binds to its own
+// symbols first, so two builds can be loaded side by side. Returns true on
+// success.
+bool LoadLib(const std::string& path, GestureLib* lib) {
+  if (path.empty()) {
+    *lib = kBuiltInLib;
+    return true;
+  }
+  void* handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL | RTLD_DEEPBIND);
+  if (!handle) {
+    fprintf(stderr, "Unable to load %s: %s\n", path.c_str(), dlerror());
+    return false;
+  }
+  struct {
+    void** fn;
+    const char* name;
+  } symbols[] = {
+#define SYMBOL(field, name) { reinterpret_cast<void**>(&lib->field), #name }
+    SYMBOL(new_interpreter, NewGestureInterpreterImpl),
+    SYMBOL(delete_interpreter, DeleteGestureInterpreter),
+    SYMBOL(set_hardware_properties, GestureInterpreterSetHardwareProperties),
+    SYMBOL(push_hardware_state, GestureInterpreterPushHardwareState),
+    SYMBOL(set_callback, GestureInterpreterSetCallback),
+    SYMBOL(set_timer_provider, GestureInterpreterSetTimerProvider),
+    SYMBOL(set_prop_provider, GestureInterpreterSetPropProvider),
+    SYMBOL(initialize, GestureInterpreterInitialize),
+#undef SYMBOL
+  };
+  for (const auto& symbol : symbols) {
+    *symbol.fn = dlsym(handle, symbol.name);
+    if (!*symbol.fn) {
+      fprintf(stderr, "%s has no %s\n", path.c_str(), symbol.name);
+      return false;
+    }
+  }
+  return true;
+}
+
+// A property provider that gives each property the value named for it in a
+// JSON object, if there is one, and can change it later the way a client
+// would.
+class PropSetter {
+ public:
+  explicit PropSetter(const Json::Value* values) : values_(values) {}
+
+  static GesturesPropProvider kProvider;
+
+  // Writes a logged property change, and tells the library about it.
+  void Change(const ActivityLog::PropChangeEntry& change);
+
+ private:
+  enum Type { kInt, kBool, kReal, kString };
+
+  struct Prop {
+    std::string name;
+    void* loc = nullptr;  // Null once freed
+    size_t count = 0;
+    Type type = kInt;
+    void* handler_data = nullptr;
+    GesturesPropSetHandler setter = nullptr;
+  };
+
+  // Stores the value named |name| into |count| values at |loc|, converted by
+  // |convert|.
+  template<typename T>
+  void Apply(const char* name, T* loc, size_t count,
+             T (*convert)(const Json::Value& value));
+  Prop* Add(const char* name, void* loc, size_t count, Type type);
+
+  static GesturesProp* CreateInt(void* data, const char* name, int* loc,
+                                 size_t count, const int* init);
+  static GesturesProp* CreateBool(void* data, const char* name,
+                                  GesturesPropBool* loc, size_t count,
+                                  const GesturesPropBool* init);
+  static GesturesProp* CreateString(void* data, const char* name,
+                                    const char** loc, const char* const init);
+  static GesturesProp* CreateReal(void* data, const char* name, double* loc,
+                                  size_t count, const double* init);
+  static void RegisterHandlers(void* data, GesturesProp* prop,
+                               void* handler_data,
+                               GesturesPropGetHandler getter,
+                               GesturesPropSetHandler setter);
+  static void Free(void* data, GesturesProp* prop);
+
+  const Json::Value* values_;
+  std::deque<Prop> props_;  // Stable addresses, handed out as GesturesProp*
+  std::deque<std::string> strings_;  // Values handed out to string props
+};
+
+GesturesPropProvider PropSetter::kProvider = {
+  PropSetter::CreateInt,
+  nullptr,
+  PropSetter::CreateBool,
+  PropSetter::CreateString,
+  PropSetter::CreateReal,
+  PropSetter::RegisterHandlers,
+  PropSetter::Free,
+};
+
+int ToInt(const Json::Value& value) { return value.asInt(); }
+GesturesPropBool ToBool(const Json::Value& value) {
+  return value.isBool() ? value.asBool() : value.asInt() != 0;
+}
+double ToReal(const Json::Value& value) { return value.asDouble(); }
+
+template<typename T>
+void PropSetter::Apply(const char* name, T* loc, size_t count,
+                       T (*convert)(const Json::Value& value)) {
+  if (!values_->isMember(name))
+    return;
+  const Json::Value& value = (*values_)[name];
+  if (value.isArray() && value.size() == count) {
+    for (size_t i = 0; i < count; i++) {
+      if (!value[static_cast<Json::ArrayIndex>(i)].isNumeric() &&
+          !value[static_cast<Json::ArrayIndex>(i)].isBool())
+        return;
+    }
+    for (size_t i = 0; i < count; i++)
+      loc[i] = convert(value[static_cast<Json::ArrayIndex>(i)]);
+  } else if (count == 1 && (value.isNumeric() || value.isBool())) {
+    *loc = convert(value);
+  } else {
+    fprintf(stderr, "Ignoring bad value for property %s\n", name);
+  }
+}
+
+PropSetter::Prop* PropSetter::Add(const char* name, void* loc, size_t count,
+                                  Type type) {
+  props_.emplace_back();
+  Prop* prop = &props_.back();
+  prop->name = name;
+  prop->loc = loc;
+  prop->count = count;
+  prop->type = type;
+  return prop;
+}
+
+GesturesProp* PropSetter::CreateInt(void* data, const char* name, int* loc,
+                                    size_t count, const int* init) {
+  PropSetter* setter = static_cast<PropSetter*>(data);
+  setter->Apply(name, loc, count, ToInt);
+  return reinterpret_cast<GesturesProp*>(
+      setter->Add(name, loc, count, kInt));
+}
+
+GesturesProp* PropSetter::CreateBool(void* data, const char* name,
+                                     GesturesPropBool* loc, size_t count,
+                                     const GesturesPropBool* init) {
+  PropSetter* setter = static_cast<PropSetter*>(data);
+  setter->Apply(name, loc, count, ToBool);
+  return reinterpret_cast<GesturesProp*>(
+      setter->Add(name, loc, count, kBool));
+}
+
+GesturesProp* PropSetter::CreateString(void* data, const char* name,
+                                       const char** loc,
+                                       const char* const init) {
+  PropSetter* setter = static_cast<PropSetter*>(data);
+  if (setter->values_->isMember(name) &&
+      (*setter->values_)[name].isString()) {
+    setter->strings_.push_back((*setter->values_)[name].asString());
+    *loc = setter->strings_.back().c_str();
+  }
+  return reinterpret_cast<GesturesProp*>(
+      setter->Add(name, loc, 1, kString));
+}
+
+GesturesProp* PropSetter::CreateReal(void* data, const char* name,
+                                     double* loc, size_t count,
+                                     const double* init) {
+  PropSetter* setter = static_cast<PropSetter*>(data);
+  setter->Apply(name, loc, count, ToReal);
+  return reinterpret_cast<GesturesProp*>(
+      setter->Add(name, loc, count, kReal));
+}
+
+void PropSetter::RegisterHandlers(void* data, GesturesProp* prop,
+                                  void* handler_data,
+                                  GesturesPropGetHandler getter,
+                                  GesturesPropSetHandler setter) {
+  Prop* record = reinterpret_cast<Prop*>(prop);
+  record->handler_data = handler_data;
+  record->setter = setter;
+}
+
+void PropSetter::Free(void* data, GesturesProp* prop) {
+  reinterpret_cast<Prop*>(prop)->loc = nullptr;
+}
+
+void PropSetter::Change(const ActivityLog::PropChangeEntry& change) {
+  for (Prop& prop : props_) {
+    if (!prop.loc || prop.name != change.name || prop.count != 1)
+      continue;
+    double value = std::visit(
+        [](auto entry_value) { return static_cast<double>(entry_value); },
+        change.value);
+    switch (prop.type) {
+      case kInt:
+        *static_cast<int*>(prop.loc) = static_cast<int>(value);
+        break;
+      case kBool:
+        *static_cast<GesturesPropBool*>(prop.loc) = value != 0.0;
+        break;
+      case kReal:
+        *static_cast<double*>(prop.loc) = value;
+        break;
+      case kString:
+        continue;
+    }
+    if (prop.setter)
+      prop.setter(prop.handler_data);
+  }
+}
+
+// A touchpad GestureInterpreter from |lib|, set up with |values| as its
+// property values, that runs on a VirtualClock of its own.
+class Pipeline {
+ public:
+  Pipeline(const GestureLib& lib, const Json::Value* values,
+           const HardwareProperties& hwprops,
+           const std::function<void(const Gesture&)>& consumer)
+      : lib_(lib), props_(values), consumer_(consumer) {
+    gi_ = lib_.new_interpreter(GESTURES_VERSION);
+    lib_.set_prop_provider(gi_, &PropSetter::kProvider, &props_);
+    lib_.set_callback(gi_, ConsumeGesture, this);
+    lib_.set_timer_provider(gi_, VirtualClock::timer_provider(), &clock_);
+    lib_.initialize(gi_, GESTURES_DEVCLASS_TOUCHPAD);
+    lib_.set_hardware_properties(gi_, &hwprops);
+  }
+  ~Pipeline() {
+    // The interpreter frees its properties and timer on the way out.
+    lib_.delete_interpreter(gi_);
+  }
+
+  // |hwstate| is modified by the filters, so each pipeline needs a copy.
+  void Push(HardwareState* hwstate) {
+    clock_.AdvanceTo(hwstate->timestamp);
+    lib_.push_hardware_state(gi_, hwstate);
+  }
+  void ChangeProp(const ActivityLog::PropChangeEntry& change) {
+    props_.Change(change);
+  }
+  void Finish() { clock_.RunUntilIdle(); }
+
+  size_t gestures() const { return gestures_; }
+
+ private:
+  static void ConsumeGesture(void* data, const Gesture* gesture) {
+    Pipeline* pipeline = static_cast<Pipeline*>(data);
+    pipeline->gestures_++;
+    pipeline->consumer_(*gesture);
+  }
+
+  const GestureLib& lib_;
+  PropSetter props_;
+  VirtualClock clock_;
+  std::function<void(const Gesture&)> consumer_;
+  GestureInterpreter* gi_;
+  size_t gestures_ = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(Pipeline);
+};
+
+// What differs between the two pipelines
+struct Config {
+  GestureLib lib_a;
+  GestureLib lib_b;
+  Json::Value props_a;  // Applied on top of the log's properties
+  Json::Value props_b;
+  std::set<std::string> honor_props;
+  GestureDiffer::Tolerances tolerances;
+  size_t max_diffs = 20;
+};
+
+const char* const kDiffNames[] = { "missing", "extra", "changed" };
+
+Json::Value EncodeDiff(const std::string& log,
+                       const GestureDiffer::Diff& diff) {
+  Json::Value line(Json::objectValue);
+  line["log"] = log;
+  line["diff"] = kDiffNames[diff.kind];
+  if (diff.kind != GestureDiffer::kExtra)
+    line["a"] = diff.a.String();
+  if (diff.kind != GestureDiffer::kMissing)
+    line["b"] = diff.b.String();
+  if (!diff.deltas.empty()) {
+    Json::Value deltas(Json::objectValue);
+    for (const GestureDiffer::FieldDelta& delta : diff.deltas) {
+      Json::Value pair(Json::arrayValue);
+      pair.append(delta.a);
+      pair.append(delta.b);
+      deltas[delta.field] = pair;
+    }
+    line["deltas"] = deltas;
+  }
+  return line;
+}
+
+// Property values for one pipeline: the log's, as far as honored and not
+// ignored by ActivityReplay, then the pipeline's own.
+Json::Value MergeProps(const Json::Value& logged,
+                       const std::set<std::string>& honor_props,
+                       const Json::Value& own) {
+  Json::Value merged(Json::objectValue);
+  for (const std::string& name : logged.getMemberNames()) {
+    if (ActivityReplay::IsIgnoredProperty(name.c_str()))
+      continue;
+    if (honor_props.empty() || honor_props.count(name))
+      merged[name] = logged[name];
+  }
+  for (const std::string& name : own.getMemberNames())
+    merged[name] = own[name];
+  return merged;
+}
+
+enum Result { kSame, kDiffer, kError };
+
+// Diffs the log at |path|, appending the lines to print to |lines|.
+Result DiffLog(const std::string& path, const Config& config,
+               std::vector<Json::Value>* lines) {
+  Json::Value totals(Json::objectValue);
+  totals["log"] = path;
+  ActivityReplay replay(nullptr);
+  if (!replay.Open(path.c_str(), config.honor_props)) {
+    totals["result"] = "error";
+    lines->push_back(totals);
+    return kError;
+  }
+  Json::Value props_a =
+      MergeProps(replay.properties(), config.honor_props, config.props_a);
+  Json::Value props_b =
+      MergeProps(replay.properties(), config.honor_props, config.props_b);
+
+  size_t reported = 0;
+  GestureDiffer differ(config.tolerances,
+                       [&](const GestureDiffer::Diff& diff) {
+                         if (reported++ < config.max_diffs)
+                           lines->push_back(EncodeDiff(path, diff));
+                       });
+  Pipeline a(config.lib_a, &props_a, replay.hwprops(),
+             [&differ](const Gesture& gesture) { differ.AddA(gesture); });
+  Pipeline b(config.lib_b, &props_b, replay.hwprops(),
+             [&differ](const Gesture& gesture) { differ.AddB(gesture); });
+
+  FingerState fingers_a[kMaxLoggedFingers];
+  FingerState fingers_b[kMaxLoggedFingers];
+  ActivityLog::Entry entry;
+  while (replay.NextEntry(&entry)) {
+    std::visit(
+      Visitor {
+        [&](const HardwareState& logged) {
+          HardwareState hs_a = logged;
+          hs_a.finger_cnt = std::min<unsigned short>(
+              hs_a.finger_cnt, kMaxLoggedFingers);
+          HardwareState hs_b = hs_a;
+          std::copy(logged.fingers, logged.fingers + hs_a.finger_cnt,
+                    fingers_a);
+          std::copy(logged.fingers, logged.fingers + hs_a.finger_cnt,
+                    fingers_b);
+          hs_a.fingers = hs_a.finger_cnt ? fingers_a : nullptr;
+          hs_b.fingers = hs_b.finger_cnt ? fingers_b : nullptr;
+          a.Push(&hs_a);
+          b.Push(&hs_b);
+          differ.Advance(logged.timestamp - kMaxGestureLatency);
+        },
+        [&](const ActivityLog::PropChangeEntry& change) {
+          if (config.honor_props.empty() ||
+              config.honor_props.count(change.name)) {
+            a.ChangeProp(change);
+            b.ChangeProp(change);
+          }
+        },
+        // The pipelines' timers run on their VirtualClocks, and their
+        // gestures are compared with each other rather than the logged ones.
+        [](const auto& other) {}
+      }, entry.details);
+  }
+  a.Finish();
+  b.Finish();
+  differ.Finish();
+
+  Result result = kSame;
+  if (replay.stream_failed())
+    result = kError;
+  else if (differ.missing() || differ.extra() || differ.changed())
+    result = kDiffer;
+  static const char* const kResultNames[] = { "same", "differ", "error" };
+  totals["result"] = kResultNames[result];
+  totals["gestures_a"] = Json::Value::UInt64(a.gestures());
+  totals["gestures_b"] = Json::Value::UInt64(b.gestures());
+  totals["matched"] = Json::Value::UInt64(differ.matched());
+  totals["missing"] = Json::Value::UInt64(differ.missing());
+  totals["extra"] = Json::Value::UInt64(differ.extra());
+  totals["changed"] = Json::Value::UInt64(differ.changed());
+  totals["max_motion_delta"] = differ.max_motion_delta();
+  totals["max_fling_delta"] = differ.max_fling_delta();
+  lines->push_back(totals);
+  return result;
+}
+
+// Reads the JSON object of property values at |path| into |out|. An empty
+// path gives no values. Returns true on success.
+bool LoadProps(const std::string& path, Json::Value* out) {
+  *out = Json::Value(Json::objectValue);
+  if (path.empty())
+    return true;
+  std::string data;
+  if (!ReadFileToString(path.c_str(), &data)) {
+    fprintf(stderr, "Unable to read %s\n", path.c_str());
+    return false;
+  }
+  Json::CharReaderBuilder builder;
+  std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+  std::string error;
+  if (!reader->parse(data.data(), data.data() + data.size(), out, &error) ||
+      !out->isObject()) {
+    fprintf(stderr, "Unable to parse %s: %s\n", path.c_str(), error.c_str());
+    return false;
+  }
+  return true;
+}
+
+void PrintLine(const Json::Value& value) {
+  Json::StreamWriterBuilder builder;
+  builder["indentation"] = "";
+  printf("%s\n", Json::writeString(builder, value).c_str());
+}
+
+}  // namespace
+
+}  // namespace gestures
+
+int main(int argc, char** argv) {
+  using namespace gestures;
+  CommandLine::Init(argc, argv);
+  CommandLine* cl = CommandLine::ForCurrentProcess();
+
+  SetVerboseLogging(cl->HasSwitch("verbose"));
+  Config config;
+  if (!LoadLib(cl->GetSwitchValueASCII("lib_a"), &config.lib_a) ||
+      !LoadLib(cl->GetSwitchValueASCII("lib_b"), &config.lib_b) ||
+      !LoadProps(cl->GetSwitchValueASCII("props_a"), &config.props_a) ||
+      !LoadProps(cl->GetSwitchValueASCII("props_b"), &config.props_b))
+    return 2;
+  config.honor_props =
+      ParseHonorProps(cl->GetSwitchValueASCII("only_honor"));
+  if (cl->HasSwitch("time_tolerance"))
+    config.tolerances.time =
+        atof(cl->GetSwitchValueASCII("time_tolerance").c_str());
+  if (cl->HasSwitch("motion_tolerance"))
+    config.tolerances.motion =
+        atof(cl->GetSwitchValueASCII("motion_tolerance").c_str());
+  if (cl->HasSwitch("fling_tolerance"))
+    config.tolerances.fling =
+        atof(cl->GetSwitchValueASCII("fling_tolerance").c_str());
+  if (cl->HasSwitch("max_diffs"))
+    config.max_diffs =
+        strtoul(cl->GetSwitchValueASCII("max_diffs").c_str(), nullptr, 10);
+  size_t threads = 0;
+  if (cl->HasSwitch("threads"))
+    threads = strtoul(cl->GetSwitchValueASCII("threads").c_str(), nullptr,
+                      10);
+
+  CommandLine::StringVector paths = cl->GetArgs();
+  if (paths.empty()) {
+    fprintf(stderr, "usage: %s [--lib_a=liba.so] [--lib_b=libb.so] "
+            "[--props_a=a.json] [--props_b=b.json] "
+            "[--only_honor=Prop1,Prop2] [--time_tolerance=S] "
+            "[--motion_tolerance=D] [--fling_tolerance=V] [--max_diffs=N] "
+            "[--threads=N] [--verbose] path [path ...]\n", argv[0]);
+    return 2;
+  }
+  std::vector<std::string> logs;
+  for (const std::string& path : paths)
+    FindLogs(path, &logs);
+  std::sort(logs.begin(), logs.end());
+
+  size_t result_counts[3] = { 0, 0, 0 };
+  std::mutex output_mutex;
+  WorkStealingPool pool(threads);
+  double start = NowSeconds();
+  pool.Run(logs.size(), [&](size_t task, size_t thread) {
+    std::vector<Json::Value> lines;
+    Result result = DiffLog(logs[task], config, &lines);
+    // A log's lines are printed together, once it is done.
+    std::lock_guard<std::mutex> lock(output_mutex);
+    result_counts[result]++;
+    for (const Json::Value& line : lines)
+      PrintLine(line);
+    fflush(stdout);
+  });
+
+  Json::Value summary(Json::objectValue);
+  summary["logs"] = Json::Value::UInt64(logs.size());
+  summary["same"] = Json::Value::UInt64(result_counts[kSame]);
+  summary["differ"] = Json::Value::UInt64(result_counts[kDiffer]);
+  summary["error"] = Json::Value::UInt64(result_counts[kError]);
+  summary["seconds"] = NowSeconds() - start;
+  summary["threads"] = Json::Value::UInt64(pool.threads());
+  PrintLine(summary);
+  if (result_counts[kError])
+    return 2;
+  return result_counts[kDiffer] ? 1 : 0;
+}
@@ -0,0 +1,287 @@
+// Copyright 2026 The ChromiumOS Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// End-to-end frame-latency benchmark.
+//
+// Streams one or more ActivityLog JSON files with ActivityReplay, pushing
+// every logged hardware state and timer callback through a GestureInterpreter
+// built exactly like a real touchpad (GestureInterpreter::Initialize), timing
+// each PushHardwareState and TimerCallback call. Reports p50/p99/p99.9/max
+// per call type, plus the slowest frames with their log timestamps.
+//
+// Usage: replay_bench [--iterations=N] [--worst=N] [--stack_version=1|2]
+//                     [--only_honor=Prop1,Prop2] [--virtual_clock]
+//                     [--verbose] log.json [log.json ...]
+//
+// By default all properties recorded in the log are applied; --only_honor
+// restricts that to the listed ones.
+//
+// With --virtual_clock the logged timer callbacks are ignored, and the
+// interpreter is driven by a VirtualClock instead, which calls it back at
+// exactly the deadlines it asks for, as if the logged hardware states were
+// a raw input trace.
+
+#include <float.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <algorithm>
+#include <memory>
+#include <set>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include "include/activity_log.h"
+#include "include/activity_replay.h"
+#include "include/command_line.h"
+#include "include/gestures.h"
+#include "include/prop_registry.h"
+#include "include/replay_util.h"
+#include "include/virtual_clock.h"
+
+namespace gestures {
+
+namespace {
+
+// Whether timers are simulated by a VirtualClock rather than replayed from
+// the log.
+bool g_virtual_clock = false;
+
+// Value to force onto the "Touchpad Stack Version" property, or 0 to keep the
+// library default.
+int g_stack_version = 0;
+
+// A property provider that accepts every property at its default value,
+// except that it can select the touchpad stack version. Setting it is the
+// only way to pick InitializeTouchpad vs. InitializeTouchpad2 from outside,
+// since the choice is made while the chain is being built.
+GesturesProp* DummyProp() {
+  static char dummy;
+  return reinterpret_cast<GesturesProp*>(&dummy);
+}
+
+GesturesProp* CreateInt(void* data, const char* name, int* loc,
+                        size_t count, const int* init) {
+  if (g_stack_version && !strcmp(name, "Touchpad Stack Version"))
+    *loc = g_stack_version;
+  return DummyProp();
+}
+
+GesturesProp* CreateBool(void* data, const char* name, GesturesPropBool* loc,
+                         size_t count, const GesturesPropBool* init) {
+  return DummyProp();
+}
+
+GesturesProp* CreateString(void* data, const char* name, const char** loc,
+                           const char* const init) {
+  return DummyProp();
+}
+
+GesturesProp* CreateReal(void* data, const char* name, double* loc,
+                         size_t count, const double* init) {
+  return DummyProp();
+}
+
+void RegisterHandlers(void* data, GesturesProp* prop, void* handler_data,
+                      GesturesPropGetHandler getter,
+                      GesturesPropSetHandler setter) {}
+
+void FreeProp(void* data, GesturesProp* prop) {}
+
+GesturesPropProvider kPropProvider = {
+  CreateInt,
+  nullptr,
+  CreateBool,
+  CreateString,
+  CreateReal,
+  RegisterHandlers,
+  FreeProp,
+};
+
+void CountGesture(void* client_data, const Gesture* gesture) {
+  ++*static_cast<size_t*>(client_data);
+}
+
+// ActivityReplay rejects hardware states with more fingers than this.
+const unsigned short kMaxLoggedFingers = 30;
+
+uint64_t NowNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+struct Sample {
+  uint64_t ns;
+  stime_t timestamp;  // Log time of the frame or timer callback
+  bool is_timer;
+  size_t log_idx;  // Index into the list of logs
+};
+
+// Replays the log at |path| once, appending one Sample per
+// PushHardwareState/TimerCallback to |samples|. Entries are parsed as they
+// are replayed, so logs longer than an ActivityLog replay in full. Returns
+// false if the log can't be parsed.
+bool ReplayOnce(const char* path, const std::set<std::string>& honor_props,
+                size_t log_idx, std::vector<Sample>* samples,
+                size_t* gesture_cnt) {
+  GestureInterpreter* gi = NewGestureInterpreter();
+  gi->SetPropProvider(&kPropProvider, nullptr);
+  gi->SetCallback(CountGesture, gesture_cnt);
+  gi->Initialize(GESTURES_DEVCLASS_TOUCHPAD);
+
+  std::unique_ptr<ActivityReplay> replay(new ActivityReplay(gi->prop_reg()));
+  if (!replay->Open(path, honor_props)) {
+    DeleteGestureInterpreter(gi);
+    return false;
+  }
+  gi->SetHardwareProperties(replay->hwprops());
+
+  std::unique_ptr<VirtualClock> clock;
+  if (g_virtual_clock)
+    clock.reset(new VirtualClock(gi));
+  // Fires the simulated timers due by |limit|, timing each callback.
+  auto fire_timers = [&](stime_t limit) {
+    uint64_t start = NowNs();
+    while (clock->FireNextTimer(limit)) {
+      samples->push_back({ NowNs() - start, clock->now(), true, log_idx });
+      start = NowNs();
+    }
+  };
+
+  FingerState fingers[kMaxLoggedFingers];
+  ActivityLog::Entry entry;
+  while (replay->NextEntry(&entry)) {
+    std::visit(
+      Visitor {
+        [&](const HardwareState& logged) {
+          // Filters modify the state in place, so hand them a copy.
+          HardwareState hs = logged;
+          hs.finger_cnt = std::min<unsigned short>(
+              hs.finger_cnt, kMaxLoggedFingers);
+          if (hs.finger_cnt)
+            std::copy(logged.fingers, logged.fingers + hs.finger_cnt,
+                      fingers);
+          hs.fingers = hs.finger_cnt ? fingers : nullptr;
+          if (clock)
+            fire_timers(hs.timestamp);
+          uint64_t start = NowNs();
+          if (clock)
+            clock->PushHardwareState(&hs);
+          else
+            gi->PushHardwareState(&hs);
+          samples->push_back(
+              { NowNs() - start, logged.timestamp, false, log_idx });
+        },
+        [&](const ActivityLog::TimerCallbackEntry& callback) {
+          if (clock)
+            return;
+          stime_t timeout = NO_DEADLINE;
+          uint64_t start = NowNs();
+          gi->TimerCallback(callback.timestamp, &timeout);
+          samples->push_back(
+              { NowNs() - start, callback.timestamp, true, log_idx });
+        },
+        [&](const ActivityLog::PropChangeEntry& prop_change) {
+          replay->ReplayPropChange(prop_change);
+        },
+        [](const auto& other) {}
+      }, entry.details);
+  }
+  if (clock) {
+    fire_timers(DBL_MAX);
+    clock.reset();
+  }
+  DeleteGestureInterpreter(gi);
+  return !replay->stream_failed();
+}
+
+void PrintPercentiles(const char* label, std::vector<uint64_t>* ns) {
+  if (ns->empty()) {
+    printf("%-18s %9s\n", label, "-");
+    return;
+  }
+  std::sort(ns->begin(), ns->end());
+  auto percentile = [ns](double p) {
+    size_t idx = static_cast<size_t>(p * (ns->size() - 1) + 0.5);
+    return (*ns)[idx];
+  };
+  printf("%-18s %9zu %10" PRIu64 " %10" PRIu64 " %10" PRIu64 " %10" PRIu64
+         "\n", label, ns->size(), percentile(0.5), percentile(0.99),
+         percentile(0.999), ns->back());
+}
+
+}  // namespace
+
+}  // namespace gestures
+
+int main(int argc, char** argv) {
+  using namespace gestures;
+  CommandLine::Init(argc, argv);
+  CommandLine* cl = CommandLine::ForCurrentProcess();
+
+  size_t iterations = 1;
+  if (cl->HasSwitch("iterations"))
+    iterations = strtoul(cl->GetSwitchValueASCII("iterations").c_str(),
+                         nullptr, 10);
+  size_t worst = 10;
+  if (cl->HasSwitch("worst"))
+    worst = strtoul(cl->GetSwitchValueASCII("worst").c_str(), nullptr, 10);
+  if (cl->HasSwitch("stack_version"))
+    g_stack_version = atoi(cl->GetSwitchValueASCII("stack_version").c_str());
+  SetVerboseLogging(cl->HasSwitch("verbose"));
+  g_virtual_clock = cl->HasSwitch("virtual_clock");
+  std::set<std::string> honor_props =
+      ParseHonorProps(cl->GetSwitchValueASCII("only_honor"));
+  CommandLine::StringVector logs = cl->GetArgs();
+  if (logs.empty() || iterations == 0) {
+    fprintf(stderr, "usage: %s [--iterations=N] [--worst=N] "
+            "[--stack_version=1|2] [--only_honor=Prop1,Prop2] "
+            "[--virtual_clock] [--verbose] log.json [log.json ...]\n",
+            argv[0]);
+    return 1;
+  }
+
+  std::vector<Sample> samples;
+  size_t gesture_cnt = 0;
+  for (size_t log_idx = 0; log_idx < logs.size(); ++log_idx) {
+    for (size_t i = 0; i < iterations; ++i) {
+      if (!ReplayOnce(logs[log_idx].c_str(), honor_props, log_idx, &samples,
+                      &gesture_cnt)) {
+        fprintf(stderr, "Unable to parse %s\n", logs[log_idx].c_str());
+        return 1;
+      }
+    }
+  }
+
+  std::vector<uint64_t> push_ns;
+  std::vector<uint64_t> timer_ns;
+  for (const Sample& sample : samples)
+    (sample.is_timer ? timer_ns : push_ns).push_back(sample.ns);
+  printf("%zu gestures produced\n\n", gesture_cnt);
+  printf("%-18s %9s %10s %10s %10s %10s\n", "latency (ns)", "count", "p50",
+         "p99", "p99.9", "max");
+  PrintPercentiles("PushHardwareState", &push_ns);
+  PrintPercentiles("TimerCallback", &timer_ns);
+
+  worst = std::min(worst, samples.size());
+  std::partial_sort(samples.begin(), samples.begin() + worst, samples.end(),
+                    [](const Sample& a, const Sample& b) {
+                      return a.ns > b.ns;
+                    });
+  if (worst)
+    printf("\nSlowest calls:\n%10s  %-17s %16s  %s\n", "ns", "call",
+           "log timestamp", "log");
+  for (size_t i = 0; i < worst; ++i) {
+    const Sample& sample = samples[i];
+    printf("%10" PRIu64 "  %-17s %16.6f  %s\n", sample.ns,
+           sample.is_timer ? "TimerCallback" : "PushHardwareState",
+           sample.timestamp, logs[sample.log_idx].c_str());
+  }
+  return 0;
+}
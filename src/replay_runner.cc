@@ -0,0 +1,139 @@
+// Copyright 2026 The ChromiumOS Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Batch regression runner for recorded ActivityLogs.
+//
+// Replays every log found under the given files and directories (searched
+// recursively) through a touchpad GestureInterpreter of its own, with its own
+// PropRegistry, and checks that the gestures produced match the logged ones,
+// as ActivityReplay::Replay() does. Logs are spread over a work-stealing
+// thread pool, so a corpus run scales with the number of cores.
+//
+// Usage: replay_runner [--threads=N] [--only_honor=Prop1,Prop2] [--verbose]
+//                      path [path ...]
+//
+// Writes one JSON object per line to stdout: one per log as it finishes,
+//   {"failures":0,"log":"a.json","result":"pass","seconds":0.012,"thread":3}
+// where result is "pass", "fail" (the gestures didn't match) or "error" (the
+// log couldn't be read), then a summary,
+//   {"error":0,"fail":1,"logs":2,"pass":1,"seconds":0.02,"threads":8}
+// Exits with 0 if every log passed.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <json/value.h>
+#include <json/writer.h>
+
+#include "include/activity_replay.h"
+#include "include/command_line.h"
+#include "include/finger_metrics.h"
+#include "include/gestures.h"
+#include "include/interpreter.h"
+#include "include/replay_util.h"
+#include "include/work_stealing_pool.h"
+
+namespace gestures {
+
+namespace {
+
+enum Result { kPass, kFail, kError };
+
+// Replays the log at |path| on a new interpreter. Returns the number of
+// mismatches in |failures|.
+Result ReplayLog(const std::string& path,
+                 const std::set<std::string>& honor_props,
+                 size_t* failures) {
+  GestureInterpreter* gi = NewGestureInterpreter();
+  gi->Initialize(GESTURES_DEVCLASS_TOUCHPAD);
+  Result result = kError;
+  {
+    MetricsProperties mprops(gi->prop_reg());
+    ActivityReplay replay(gi->prop_reg());
+    if (replay.Open(path.c_str(), honor_props)) {
+      replay.Replay(gi->interpreter(), &mprops);
+      *failures = replay.failures();
+      result = *failures ? kFail : kPass;
+    }
+  }
+  DeleteGestureInterpreter(gi);
+  return result;
+}
+
+void PrintLine(const Json::Value& value) {
+  Json::StreamWriterBuilder builder;
+  builder["indentation"] = "";
+  printf("%s\n", Json::writeString(builder, value).c_str());
+  fflush(stdout);
+}
+
+}  // namespace
+
+}  // namespace gestures
+
+int main(int argc, char** argv) {
+  using namespace gestures;
+  CommandLine::Init(argc, argv);
+  CommandLine* cl = CommandLine::ForCurrentProcess();
+
+  size_t threads = 0;
+  if (cl->HasSwitch("threads"))
+    threads = strtoul(cl->GetSwitchValueASCII("threads").c_str(), nullptr,
+                      10);
+  SetVerboseLogging(cl->HasSwitch("verbose"));
+  std::set<std::string> honor_props =
+      ParseHonorProps(cl->GetSwitchValueASCII("only_honor"));
+  CommandLine::StringVector paths = cl->GetArgs();
+  if (paths.empty()) {
+    fprintf(stderr, "usage: %s [--threads=N] [--only_honor=Prop1,Prop2] "
+            "[--verbose] path [path ...]\n", argv[0]);
+    return 1;
+  }
+  std::vector<std::string> logs;
+  for (const std::string& path : paths)
+    FindLogs(path, &logs);
+  std::sort(logs.begin(), logs.end());
+
+  // ActivityReplay reports mismatches through gtest, which would print them
+  // among the results; they are counted instead.
+  ::testing::TestEventListeners& listeners =
+      ::testing::UnitTest::GetInstance()->listeners();
+  delete listeners.Release(listeners.default_result_printer());
+
+  static const char* const kResultNames[] = { "pass", "fail", "error" };
+  size_t result_counts[3] = { 0, 0, 0 };
+  std::mutex output_mutex;
+  WorkStealingPool pool(threads);
+  double start = NowSeconds();
+  pool.Run(logs.size(), [&](size_t task, size_t thread) {
+    double log_start = NowSeconds();
+    size_t failures = 0;
+    Result result = ReplayLog(logs[task], honor_props, &failures);
+    Json::Value line(Json::objectValue);
+    line["log"] = logs[task];
+    line["result"] = kResultNames[result];
+    line["failures"] = Json::Value::UInt64(failures);
+    line["seconds"] = NowSeconds() - log_start;
+    line["thread"] = Json::Value::UInt64(thread);
+    std::lock_guard<std::mutex> lock(output_mutex);
+    result_counts[result]++;
+    PrintLine(line);
+  });
+
+  Json::Value summary(Json::objectValue);
+  summary["logs"] = Json::Value::UInt64(logs.size());
+  for (size_t i = 0; i < 3; i++)
+    summary[kResultNames[i]] = Json::Value::UInt64(result_counts[i]);
+  summary["seconds"] = NowSeconds() - start;
+  summary["threads"] = Json::Value::UInt64(pool.threads());
+  PrintLine(summary);
+  return result_counts[kPass] == logs.size() ? 0 : 1;
+}
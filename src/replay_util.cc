@@ -0,0 +1,87 @@
+// Copyright 2026 The ChromiumOS Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "include/replay_util.h"
+
+#include <dirent.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#include "include/gestures.h"
+
+namespace gestures {
+
+namespace {
+
+bool g_verbose = false;
+
+}  // namespace
+
+std::set<std::string> ParseHonorProps(const std::string& only_honor) {
+  std::set<std::string> honor_props;
+  for (size_t start = 0; start < only_honor.size();) {
+    size_t end = only_honor.find(',', start);
+    if (end == std::string::npos)
+      end = only_honor.size();
+    if (end > start)
+      honor_props.insert(only_honor.substr(start, end - start));
+    start = end + 1;
+  }
+  return honor_props;
+}
+
+void FindLogs(const std::string& path, std::vector<std::string>* out) {
+  struct stat st;
+  if (stat(path.c_str(), &st) < 0) {
+    fprintf(stderr, "Unable to find %s\n", path.c_str());
+    return;
+  }
+  if (S_ISREG(st.st_mode)) {
+    out->push_back(path);
+    return;
+  }
+  if (!S_ISDIR(st.st_mode))
+    return;
+  DIR* dir = opendir(path.c_str());
+  if (!dir) {
+    fprintf(stderr, "Unable to open %s\n", path.c_str());
+    return;
+  }
+  while (struct dirent* entry = readdir(dir)) {
+    std::string name = entry->d_name;
+    if (name == "." || name == "..")
+      continue;
+    FindLogs(path + "/" + name, out);
+  }
+  closedir(dir);
+}
+
+double NowSeconds() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+void SetVerboseLogging(bool verbose) {
+  g_verbose = verbose;
+}
+
+}  // namespace gestures
+
+extern "C" {
+
+// Weak, so that the unittests, which link this file too, print messages
+// with their own handler.
+__attribute__((weak)) void gestures_log(int verb, const char* fmt, ...) {
+  if (!gestures::g_verbose)
+    return;
+  va_list args;
+  va_start(args, fmt);
+  vfprintf(stderr, fmt, args);
+  va_end(args);
+}
+
+}
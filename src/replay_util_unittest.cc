@@ -0,0 +1,59 @@
+// Copyright 2026 The ChromiumOS Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "include/replay_util.h"
+
+namespace gestures {
+
+class ReplayUtilTest : public ::testing::Test {};
+
+TEST(ReplayUtilTest, ParseHonorPropsTest) {
+  EXPECT_TRUE(ParseHonorProps("").empty());
+  EXPECT_TRUE(ParseHonorProps(",,").empty());
+  std::set<std::string> expected = { "Prop A", "Prop B" };
+  EXPECT_EQ(expected, ParseHonorProps("Prop A,Prop B"));
+  EXPECT_EQ(expected, ParseHonorProps(",Prop B,,Prop A,"));
+}
+
+TEST(ReplayUtilTest, FindLogsTest) {
+  char dir_template[] = "/tmp/replay_util_unittest.XXXXXX";
+  ASSERT_NE(nullptr, mkdtemp(dir_template));
+  std::string dir = dir_template;
+  std::string sub = dir + "/sub";
+  ASSERT_EQ(0, mkdir(sub.c_str(), 0700));
+  std::vector<std::string> files = { dir + "/a.json", sub + "/b.json" };
+  for (const std::string& file : files) {
+    FILE* fp = fopen(file.c_str(), "w");
+    ASSERT_NE(nullptr, fp);
+    fclose(fp);
+  }
+
+  // Directories are searched recursively, and files are taken as they are.
+  std::vector<std::string> logs;
+  FindLogs(dir, &logs);
+  FindLogs(files[0], &logs);
+  FindLogs(dir + "/missing.json", &logs);
+  std::sort(logs.begin(), logs.end());
+  std::vector<std::string> expected = { files[0], files[0], files[1] };
+  EXPECT_EQ(expected, logs);
+
+  for (const std::string& file : files)
+    unlink(file.c_str());
+  rmdir(sub.c_str());
+  rmdir(dir.c_str());
+}
+
+}  // namespace gestures
@@ -0,0 +1,83 @@
+// Copyright 2026 The ChromiumOS Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <gtest/gtest.h>
+
+#include "include/ring_buffer.h"
+
+namespace gestures {
+
+class RingBufferTest : public ::testing::Test {};
+
+TEST(RingBufferTest, PushPopTest) {
+  RingBuffer<int> buffer(3);
+  EXPECT_TRUE(buffer.empty());
+  EXPECT_EQ(3, buffer.capacity());
+  for (int i = 0; i < 3; i++)
+    buffer.push_back() = i;
+  EXPECT_TRUE(buffer.full());
+  EXPECT_EQ(0, buffer.front());
+  EXPECT_EQ(2, buffer.back());
+  EXPECT_EQ(1, buffer.at(1));
+  EXPECT_EQ(1, buffer.at(-2));
+
+  buffer.pop_front();
+  buffer.push_back() = 3;
+  int expected = 1;
+  for (int value : buffer)
+    EXPECT_EQ(expected++, value);
+  EXPECT_EQ(4, expected);
+
+  buffer.pop_back();
+  EXPECT_EQ(2, buffer.back());
+  buffer.clear();
+  EXPECT_TRUE(buffer.empty());
+}
+
+TEST(RingBufferTest, PushOntoFullDropsFrontTest) {
+  RingBuffer<int> buffer(2);
+  buffer.push_back() = 1;
+  buffer.push_back() = 2;
+  buffer.push_back() = 3;
+  EXPECT_EQ(2, buffer.size());
+  EXPECT_EQ(2, buffer.front());
+  EXPECT_EQ(3, buffer.back());
+}
+
+TEST(RingBufferTest, SlotsAreReusedTest) {
+  RingBuffer<int> buffer(2);
+  buffer.push_back() = 1;
+  buffer.push_back() = 2;
+  buffer.clear();
+  // push_back() doesn't reset the slot it hands out.
+  EXPECT_EQ(1, buffer.push_back());
+}
+
+TEST(RingBufferTest, SetCapacityTest) {
+  RingBuffer<int> buffer(3);
+  for (int i = 0; i < 5; i++)
+    buffer.push_back() = i;
+  buffer.set_capacity(5);
+  EXPECT_EQ(3, buffer.size());
+  buffer.push_back() = 5;
+  buffer.push_back() = 6;
+  int expected = 2;
+  for (int value : buffer)
+    EXPECT_EQ(expected++, value);
+  EXPECT_EQ(7, expected);
+
+  buffer.set_capacity(2);
+  EXPECT_EQ(2, buffer.size());
+  EXPECT_EQ(5, buffer.front());
+  EXPECT_EQ(6, buffer.back());
+}
+
+TEST(RingBufferTest, AtDeathTest) {
+  RingBuffer<int> buffer(2);
+  buffer.push_back() = 1;
+  EXPECT_DEATH(buffer.at(1), "");
+  EXPECT_DEATH(buffer.at(-2), "");
+}
+
+}  // namespace gestures
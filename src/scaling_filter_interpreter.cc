@@ -61,7 +61,7 @@ void ScalingFilterInterpreter::SyncInterpretImpl(HardwareState& hwstate,
   ScaleHardwareState(hwstate);
 
   LogHardwareStatePost(name, hwstate);
-  next_->SyncInterpret(hwstate, timeout);
+  SyncInterpretNext(hwstate, timeout);
 }
 
 // Ignore the finger events with low pressure values especially for the SEMI_MT
@@ -4,6 +4,7 @@
 
 #include "include/sensor_jump_filter_interpreter.h"
 
+#include "include/state_archive.h"
 #include "include/tracer.h"
 #include "include/util.h"
 
@@ -28,6 +29,12 @@ SensorJumpFilterInterpreter::SensorJumpFilterInterpreter(PropRegistry* prop_reg,
                              "Sensor Jump No Warp Min Dist Move",
                              0.21) {
   InitName();
+  enabled_.SetDelegate(this);
+}
+
+void SensorJumpFilterInterpreter::BoolWasWritten(BoolProperty* prop) {
+  if (prop == &enabled_)
+    UpdateRoute();
 }
 
 void SensorJumpFilterInterpreter::SyncInterpretImpl(HardwareState& hwstate,
@@ -36,7 +43,7 @@ void SensorJumpFilterInterpreter::SyncInterpretImpl(HardwareState& hwstate,
   LogHardwareStatePre(name, hwstate);
 
   if (!enabled_.val_) {
-    next_->SyncInterpret(hwstate, timeout);
+    SyncInterpretNext(hwstate, timeout);
     return;
   }
 
@@ -47,7 +54,7 @@ void SensorJumpFilterInterpreter::SyncInterpretImpl(HardwareState& hwstate,
   RemoveMissingIdsFromSet(&first_flag_[2], hwstate);
   RemoveMissingIdsFromSet(&first_flag_[3], hwstate);
 
-  std::map<short, FingerState> current_input;
+  TrackingIdMap<FingerState> current_input;
 
   for (size_t i = 0; i < hwstate.finger_cnt; i++)
     current_input[hwstate.fingers[i].tracking_id] = hwstate.fingers[i];
@@ -134,7 +141,13 @@ void SensorJumpFilterInterpreter::SyncInterpretImpl(HardwareState& hwstate,
   previous_input_[0] = current_input;
 
   LogHardwareStatePost(name, hwstate);
-  next_->SyncInterpret(hwstate, timeout);
+  SyncInterpretNext(hwstate, timeout);
+}
+
+void SensorJumpFilterInterpreter::ArchiveState(StateArchive* archive) {
+  FilterInterpreter::ArchiveState(archive);
+  archive->Archive(&previous_input_);
+  archive->Archive(&first_flag_);
 }
 
 }  // namespace gestures
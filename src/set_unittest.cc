@@ -0,0 +1,67 @@
+// Copyright 2026 The ChromiumOS Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <algorithm>
+#include <iterator>
+
+#include <gtest/gtest.h>
+
+#include "include/set.h"
+
+namespace gestures {
+
+typedef set<short, 4> test_set;
+
+class SetTest : public ::testing::Test {};
+
+TEST(SetTest, InsertKeepsSortedTest) {
+  test_set the_set;
+  EXPECT_TRUE(the_set.empty());
+  EXPECT_TRUE(the_set.insert(3).second);
+  EXPECT_TRUE(the_set.insert(1).second);
+  EXPECT_TRUE(the_set.insert(2).second);
+  EXPECT_FALSE(the_set.insert(2).second);
+  EXPECT_EQ(3, the_set.size());
+  short expected = 1;
+  for (short value : the_set)
+    EXPECT_EQ(expected++, value);
+  EXPECT_EQ(1, the_set.count(3));
+  EXPECT_EQ(0, the_set.count(4));
+  EXPECT_TRUE(the_set.find(4) == the_set.end());
+}
+
+TEST(SetTest, OutOfSpaceTest) {
+  test_set the_set = { 1, 2, 3, 4 };
+  EXPECT_EQ(4, the_set.size());
+  EXPECT_TRUE(the_set.insert(5).first == the_set.end());
+  EXPECT_EQ(4, the_set.size());
+  EXPECT_EQ(0, the_set.count(5));
+  // Inserting a present value still works on a full set.
+  EXPECT_TRUE(the_set.insert(3).first == the_set.find(3));
+}
+
+TEST(SetTest, EraseTest) {
+  test_set the_set = { 4, 2, 3 };
+  EXPECT_EQ(1, the_set.erase(3));
+  EXPECT_EQ(0, the_set.erase(3));
+  EXPECT_TRUE(the_set == test_set({ 2, 4 }));
+  test_set::iterator it = the_set.erase(the_set.begin());
+  EXPECT_EQ(4, *it);
+  the_set.clear();
+  EXPECT_TRUE(the_set.empty());
+}
+
+TEST(SetTest, SetAlgorithmsTest) {
+  test_set a = { 1, 2, 3 };
+  test_set b = { 2, 4 };
+  test_set difference;
+  std::set_difference(a.begin(), a.end(), b.begin(), b.end(),
+                      std::inserter(difference, difference.begin()));
+  EXPECT_TRUE(difference == test_set({ 1, 3 }));
+  EXPECT_TRUE(difference != a);
+  a = difference;
+  EXPECT_TRUE(difference == a);
+}
+
+}  // namespace gestures
@@ -6,6 +6,7 @@
 
 #include <math.h>
 
+#include "include/state_archive.h"
 #include "include/tracer.h"
 #include "include/util.h"
 
@@ -20,6 +21,12 @@ SplitCorrectingFilterInterpreter::SplitCorrectingFilterInterpreter(
       merge_max_movement_(prop_reg, "Split Merge Max Movement", 3.0),
       merge_max_ratio_(prop_reg, "Merge Max Ratio", sinf(DegToRad(19.0))) {
   InitName();
+  enabled_.SetDelegate(this);
+}
+
+void SplitCorrectingFilterInterpreter::BoolWasWritten(BoolProperty* prop) {
+  if (prop == &enabled_)
+    UpdateRoute();
 }
 
 void SplitCorrectingFilterInterpreter::SyncInterpretImpl(
@@ -40,7 +47,7 @@ void SplitCorrectingFilterInterpreter::SyncInterpretImpl(
     UpdateHwState(hwstate);
   }
   LogHardwareStatePost(name, hwstate);
-  next_->SyncInterpret(hwstate, timeout);
+  SyncInterpretNext(hwstate, timeout);
 }
 
 void SplitCorrectingFilterInterpreter::RemoveMissingUnmergedContacts(
@@ -378,4 +385,11 @@ void SplitCorrectingFilterInterpreter::Dump(
     Log("  %d", hwstate.fingers[i].tracking_id);
 }
 
+void SplitCorrectingFilterInterpreter::ArchiveState(StateArchive* archive) {
+  FilterInterpreter::ArchiveState(archive);
+  archive->Archive(&last_tracking_ids_);
+  archive->Archive(&unmerged_);
+  archive->Archive(&merged_);
+}
+
 };  // namespace gestures
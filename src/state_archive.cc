@@ -0,0 +1,220 @@
+// Copyright 2026 The ChromiumOS Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "include/state_archive.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include <json/reader.h>
+#include <json/value.h>
+#include <json/writer.h>
+
+#include "include/interpreter.h"
+#include "include/logging.h"
+#include "include/logging_filter_interpreter.h"
+#include "include/prop_registry.h"
+
+using std::string;
+
+namespace gestures {
+
+namespace {
+
+const char kCheckpointMagic[4] = { 'G', 'C', 'K', 'P' };
+const uint32_t kCheckpointVersion = 2;
+
+}  // namespace
+
+StateArchive::StateArchive(string* out)
+    : out_(out), data_(nullptr), size_(0), pos_(0), ok_(true) {}
+
+StateArchive::StateArchive(const char* data, size_t size)
+    : out_(nullptr), data_(data), size_(size), pos_(0), ok_(true) {}
+
+void StateArchive::Bytes(void* data, size_t size) {
+  if (!size)
+    return;
+  if (saving()) {
+    out_->append(static_cast<const char*>(data), size);
+    return;
+  }
+  if (!ok_ || size > size_ - pos_) {
+    ok_ = false;
+    return;
+  }
+  memcpy(data, data_ + pos_, size);
+  pos_ += size;
+}
+
+void StateArchive::Tag(const char* tag) {
+  string value = tag ? tag : "";
+  string saved = value;
+  Archive(&saved);
+  if (saved != value)
+    Fail();
+}
+
+void StateArchive::Count(size_t* count) {
+  uint32_t value = *count;
+  Bytes(&value, sizeof(value));
+  if (saving())
+    return;
+  if (value > size_ - pos_) {
+    Fail();
+    return;
+  }
+  if (ok_)
+    *count = value;
+}
+
+void StateArchive::Archive(string* value) {
+  size_t size = value->size();
+  Count(&size);
+  if (saving()) {
+    out_->append(*value);
+    return;
+  }
+  if (!ok_)
+    return;
+  value->assign(data_ + pos_, size);
+  pos_ += size;
+}
+
+void StateArchive::ArchiveHardwareState(HardwareState* hwstate,
+                                        FingerState* fingers,
+                                        size_t max_fingers) {
+  FingerState* saved_fingers = hwstate->fingers;
+  hwstate->fingers = nullptr;
+  Bytes(hwstate, sizeof(*hwstate));
+  hwstate->fingers = saved_fingers;
+  if (saving()) {
+    Bytes(hwstate->fingers, hwstate->finger_cnt * sizeof(FingerState));
+    return;
+  }
+  if (hwstate->finger_cnt > max_fingers) {
+    Fail();
+    hwstate->finger_cnt = 0;
+  }
+  hwstate->fingers = fingers;
+  Bytes(fingers, hwstate->finger_cnt * sizeof(FingerState));
+}
+
+void StateArchive::SaveCheckpoint(Interpreter* interpreter,
+                                  PropRegistry* prop_reg,
+                                  stime_t time, stime_t deadline,
+                                  string* out) {
+  StateArchive archive(out);
+  char magic[sizeof(kCheckpointMagic)];
+  memcpy(magic, kCheckpointMagic, sizeof(magic));
+  uint32_t version = kCheckpointVersion;
+  archive.Archive(&magic);
+  archive.Archive(&version);
+  archive.Archive(&time);
+  archive.Archive(&deadline);
+
+  // Properties at their defaults are left out, and restored to them. The
+  // rest are sorted by name, so that equal chains save equal checkpoints.
+  std::vector<Property*> changed;
+  if (prop_reg) {
+    for (Property* prop : prop_reg->props())
+      if (!prop->IsDefault())
+        changed.push_back(prop);
+  }
+  std::sort(changed.begin(), changed.end(),
+            [](Property* a, Property* b) {
+              return strcmp(a->name(), b->name()) < 0;
+            });
+  size_t count = changed.size();
+  archive.Count(&count);
+  if (!changed.empty()) {
+    Json::StreamWriterBuilder builder;
+    builder["indentation"] = "";
+    for (Property* prop : changed) {
+      string name = prop->name();
+      string value = Json::writeString(builder, prop->NewValue());
+      archive.Archive(&name);
+      archive.Archive(&value);
+    }
+  }
+  interpreter->ArchiveState(&archive);
+}
+
+bool StateArchive::RestoreCheckpoint(const string& data,
+                                     Interpreter* interpreter,
+                                     PropRegistry* prop_reg,
+                                     stime_t* time, stime_t* deadline) {
+  StateArchive archive(data.data(), data.size());
+  char magic[sizeof(kCheckpointMagic)] = {};
+  uint32_t version = 0;
+  archive.Archive(&magic);
+  archive.Archive(&version);
+  if (!archive.ok() || memcmp(magic, kCheckpointMagic, sizeof(magic)) ||
+      version != kCheckpointVersion) {
+    Err("Not a checkpoint of a known version");
+    return false;
+  }
+  archive.Archive(time);
+  archive.Archive(deadline);
+
+  size_t count = 0;
+  archive.Count(&count);
+  std::map<string, Property*> props;
+  if (prop_reg)
+    for (Property* prop : prop_reg->props())
+      props[prop->name()] = prop;
+  Json::StreamWriterBuilder writer;
+  writer["indentation"] = "";
+  Json::CharReaderBuilder builder;
+  std::unique_ptr<Json::CharReader> const reader(builder.newCharReader());
+  for (size_t i = 0; i < count && archive.ok(); i++) {
+    string name;
+    string encoded;
+    archive.Archive(&name);
+    archive.Archive(&encoded);
+    auto it = props.find(name);
+    if (it == props.end())
+      continue;
+    Property* prop = it->second;
+    props.erase(it);
+    if (LoggingFilterInterpreter::IsLoggingProperty(name.c_str()))
+      continue;
+    // Only write properties that changed, so that delegates don't redo work
+    // for values they already have.
+    if (encoded == Json::writeString(writer, prop->NewValue()))
+      continue;
+    Json::Value value;
+    string error_msg;
+    if (!reader->parse(encoded.data(), encoded.data() + encoded.size(),
+                       &value, &error_msg)) {
+      Err("Bad checkpoint value for property %s: %s", name.c_str(),
+          error_msg.c_str());
+      return false;
+    }
+    if (!prop->SetValue(value)) {
+      Err("Unable to restore value for property %s", name.c_str());
+      return false;
+    }
+    prop->HandleGesturesPropWritten();
+  }
+  // The rest were at their defaults.
+  for (auto& [name, prop] : props) {
+    if (!archive.ok() || prop->IsDefault() ||
+        LoggingFilterInterpreter::IsLoggingProperty(name.c_str()))
+      continue;
+    if (prop->RestoreDefault())
+      prop->HandleGesturesPropWritten();
+  }
+  interpreter->ArchiveState(&archive);
+  if (!archive.ok() || !archive.AtEnd()) {
+    Err("Checkpoint doesn't match the interpreter chain");
+    return false;
+  }
+  return true;
+}
+
+}  // namespace gestures
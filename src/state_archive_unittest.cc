@@ -0,0 +1,316 @@
+// Copyright 2026 The ChromiumOS Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <json/value.h>
+
+#include "include/activity_replay.h"
+#include "include/file_util.h"
+#include "include/finger_metrics.h"
+#include "include/gestures.h"
+#include "include/interpreter.h"
+#include "include/logging_filter_interpreter.h"
+#include "include/prop_registry.h"
+#include "include/state_archive.h"
+#include "include/unittest_util.h"
+
+using std::string;
+
+namespace gestures {
+
+class StateArchiveTest : public ::testing::Test {};
+
+namespace {
+
+const HardwareProperties kHwprops = {
+  .right = 100, .bottom = 60,
+  .res_x = 1, .res_y = 1,
+  .orientation_minimum = -1, .orientation_maximum = 2,
+  .max_finger_cnt = 5, .max_touch_cnt = 5,
+  .supports_t5r2 = 0, .support_semi_mt = 0, .is_button_pad = 1,
+  .has_wheel = 0, .wheel_is_hi_res = 0, .is_haptic_pad = 0,
+};
+
+const size_t kFrames = 120;
+
+// Fills |fingers| with frame |i| of a one finger move, a pause, then a two
+// finger scroll, and returns the frame.
+HardwareState MakeFrame(size_t i, FingerState* fingers) {
+  stime_t time = 1.0 + i * 0.0125;
+  memset(fingers, 0, 2 * sizeof(*fingers));
+  unsigned short finger_cnt = 0;
+  if (i < 40) {
+    fingers[0].pressure = 50;
+    fingers[0].position_x = 20 + i;
+    fingers[0].position_y = 30;
+    fingers[0].tracking_id = 1;
+    finger_cnt = 1;
+  } else if (i >= 50 && i < 100) {
+    for (int j = 0; j < 2; j++) {
+      fingers[j].pressure = 50;
+      fingers[j].position_x = 30 + 20 * j;
+      fingers[j].position_y = 5 + (i - 50) * 0.8;
+      fingers[j].tracking_id = 2 + j;
+    }
+    finger_cnt = 2;
+  }
+  return make_hwstate(time, 0, finger_cnt, finger_cnt, fingers);
+}
+
+void SetProperty(PropRegistry* prop_reg, const char* name,
+                 const Json::Value& value) {
+  for (Property* prop : prop_reg->props()) {
+    if (strcmp(prop->name(), name))
+      continue;
+    EXPECT_TRUE(prop->SetValue(value));
+    prop->HandleGesturesPropWritten();
+    return;
+  }
+  ADD_FAILURE() << "No property " << name;
+}
+
+// A touchpad interpreter chain, driven with its timer the way a client
+// would drive it
+class ChainRunner : public GestureConsumer {
+ public:
+  explicit ChainRunner(GestureInterpreterDeviceClass type =
+                           GESTURES_DEVCLASS_TOUCHPAD)
+      : gi_(NewGestureInterpreter()), deadline_(NO_DEADLINE) {
+    gi_->Initialize(type);
+    mprops_.reset(new MetricsProperties(gi_->prop_reg()));
+    interpreter()->Initialize(&kHwprops, nullptr, mprops_.get(), this);
+  }
+  ~ChainRunner() {
+    mprops_.reset();
+    DeleteGestureInterpreter(gi_);
+  }
+
+  Interpreter* interpreter() { return gi_->interpreter(); }
+  PropRegistry* prop_reg() { return gi_->prop_reg(); }
+  MetricsProperties* mprops() { return mprops_.get(); }
+  const std::vector<Gesture>& gestures() const { return gestures_; }
+
+  void Run(size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      FingerState fingers[2];
+      HardwareState hwstate = MakeFrame(i, fingers);
+      while (deadline_ != NO_DEADLINE && deadline_ <= hwstate.timestamp) {
+        stime_t now = deadline_;
+        stime_t timeout = NO_DEADLINE;
+        interpreter()->HandleTimer(now, &timeout);
+        deadline_ = timeout == NO_DEADLINE ? NO_DEADLINE : now + timeout;
+      }
+      stime_t timeout = NO_DEADLINE;
+      interpreter()->SyncInterpret(hwstate, &timeout);
+      deadline_ =
+          timeout == NO_DEADLINE ? NO_DEADLINE : hwstate.timestamp + timeout;
+    }
+  }
+
+  string Save(stime_t time) {
+    string state;
+    StateArchive::SaveCheckpoint(interpreter(), prop_reg(), time, deadline_,
+                                 &state);
+    return state;
+  }
+
+  bool Restore(const string& state) {
+    stime_t time = 0.0;
+    return StateArchive::RestoreCheckpoint(state, interpreter(), prop_reg(),
+                                           &time, &deadline_);
+  }
+
+  virtual void ConsumeGesture(const Gesture& gesture) {
+    gestures_.push_back(gesture);
+  }
+
+ private:
+  GestureInterpreter* gi_;
+  std::unique_ptr<MetricsProperties> mprops_;
+  stime_t deadline_;
+  std::vector<Gesture> gestures_;
+};
+
+string WriteTempFile(const string& contents) {
+  // As in activity_replay_unittest.cc, tmpnam is good enough for a test.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+  const char* filename = std::tmpnam(nullptr);
+#pragma GCC diagnostic pop
+  if (!filename)
+    return "";
+  WriteFile(filename, contents.data(), contents.size());
+  return filename;
+}
+
+}  // namespace
+
+TEST(StateArchiveTest, RoundTripTest) {
+  int number = 7;
+  std::vector<string> strings = { "a", "", "bcd" };
+  std::map<short, float> map = { { 1, 2.5 }, { 3, -1 } };
+  set<short, 4> small_set;
+  small_set.insert(9);
+  small_set.insert(2);
+  FingerState fingers[2] = {};
+  fingers[1].tracking_id = 5;
+  HardwareState hwstate = make_hwstate(2.5, 1, 2, 2, fingers);
+
+  string data;
+  StateArchive saver(&data);
+  EXPECT_TRUE(saver.saving());
+  saver.Tag("test");
+  saver.Archive(&number);
+  saver.Archive(&strings);
+  saver.Archive(&map);
+  saver.Archive(&small_set);
+  saver.ArchiveHardwareState(&hwstate, nullptr, 0);
+  EXPECT_TRUE(saver.ok());
+
+  int restored_number = 0;
+  std::vector<string> restored_strings = { "x" };
+  std::map<short, float> restored_map = { { 4, 4 } };
+  set<short, 4> restored_set;
+  FingerState restored_fingers[2] = {};
+  HardwareState restored_hwstate = {};
+  StateArchive restorer(data.data(), data.size());
+  EXPECT_FALSE(restorer.saving());
+  restorer.Tag("test");
+  restorer.Archive(&restored_number);
+  restorer.Archive(&restored_strings);
+  restorer.Archive(&restored_map);
+  restorer.Archive(&restored_set);
+  restorer.ArchiveHardwareState(&restored_hwstate, restored_fingers, 2);
+  EXPECT_TRUE(restorer.ok());
+  EXPECT_TRUE(restorer.AtEnd());
+  EXPECT_EQ(number, restored_number);
+  EXPECT_EQ(strings, restored_strings);
+  EXPECT_EQ(map, restored_map);
+  EXPECT_TRUE(small_set == restored_set);
+  EXPECT_EQ(restored_fingers, restored_hwstate.fingers);
+  EXPECT_TRUE(hwstate.SameFingersAs(restored_hwstate));
+  EXPECT_EQ(hwstate.timestamp, restored_hwstate.timestamp);
+
+  // Different tags, and running out of data, fail.
+  StateArchive wrong_tag(data.data(), data.size());
+  wrong_tag.Tag("other");
+  EXPECT_FALSE(wrong_tag.ok());
+  StateArchive truncated(data.data(), 10);
+  truncated.Tag("test");
+  truncated.Archive(&restored_number);
+  truncated.Archive(&restored_strings);
+  EXPECT_FALSE(truncated.ok());
+}
+
+TEST(StateArchiveTest, CheckpointResumesChainTest) {
+  for (size_t split : { size_t{20}, size_t{45}, size_t{75}, size_t{105} }) {
+    ChainRunner original;
+    original.Run(0, split);
+    string checkpoint = original.Save(1.0 + split * 0.0125);
+    size_t gestures_before = original.gestures().size();
+    original.Run(split, kFrames);
+
+    // A property that differs from the checkpoint is restored.
+    ChainRunner resumed;
+    SetProperty(resumed.prop_reg(), "Vertical Scroll Snap Slope",
+                Json::Value(123.0));
+    ASSERT_TRUE(resumed.Restore(checkpoint)) << split;
+    resumed.Run(split, kFrames);
+
+    std::vector<Gesture> expected(original.gestures().begin() +
+                                      gestures_before,
+                                  original.gestures().end());
+    EXPECT_EQ(expected, resumed.gestures()) << split;
+  }
+  // All of the input produced gestures.
+  ChainRunner full;
+  full.Run(0, kFrames);
+  EXPECT_FALSE(full.gestures().empty());
+}
+
+TEST(StateArchiveTest, DefaultPropertiesTest) {
+  // Properties at their defaults are left out of checkpoints.
+  ChainRunner original;
+  original.Run(0, 10);
+  string defaults = original.Save(1.2);
+  EXPECT_EQ(string::npos, defaults.find("Vertical Scroll Snap Slope"));
+  SetProperty(original.prop_reg(), "Vertical Scroll Snap Slope",
+              Json::Value(123.0));
+  string changed = original.Save(1.2);
+  EXPECT_NE(string::npos, changed.find("Vertical Scroll Snap Slope"));
+
+  // and are set back to their defaults when restoring.
+  ChainRunner resumed;
+  ASSERT_TRUE(resumed.Restore(changed));
+  ChainRunner reset;
+  SetProperty(reset.prop_reg(), "Vertical Scroll Snap Slope",
+              Json::Value(123.0));
+  ASSERT_TRUE(reset.Restore(defaults));
+  EXPECT_EQ(changed, resumed.Save(1.2));
+  EXPECT_EQ(defaults, reset.Save(1.2));
+}
+
+TEST(StateArchiveTest, MismatchedChainTest) {
+  ChainRunner touchpad;
+  touchpad.Run(0, 10);
+  string checkpoint = touchpad.Save(2.0);
+
+  ChainRunner mouse(GESTURES_DEVCLASS_MOUSE);
+  EXPECT_FALSE(mouse.Restore(checkpoint));
+  EXPECT_FALSE(mouse.Restore("not a checkpoint"));
+  // Cut short
+  ChainRunner other_touchpad;
+  EXPECT_FALSE(other_touchpad.Restore(
+      checkpoint.substr(0, checkpoint.size() - 1)));
+}
+
+TEST(StateArchiveTest, SeekToCheckpointTest) {
+  ChainRunner logged;
+  SetProperty(logged.prop_reg(), "Event Logging Enable", Json::Value(true));
+  SetProperty(logged.prop_reg(), "Checkpoint Interval", Json::Value(0.5));
+  logged.Run(0, kFrames);
+  string json =
+      static_cast<LoggingFilterInterpreter*>(logged.interpreter())
+          ->EncodeActivityLog();
+  ASSERT_NE(string::npos, json.find(ActivityLog::kKeySeekIndex));
+  string filename = WriteTempFile(json);
+  ASSERT_FALSE(filename.empty());
+
+  // Checkpoints were logged every half second from 1.0 seconds on.
+  for (stime_t time : { 1.2, 1.7, 2.4 }) {
+    ChainRunner streamed;
+    ActivityReplay stream_replay(streamed.prop_reg());
+    ASSERT_TRUE(stream_replay.Open(filename.c_str(), std::set<string>()));
+    EXPECT_TRUE(stream_replay.SeekToCheckpoint(time)) << time;
+    stream_replay.Replay(streamed.interpreter(), streamed.mprops());
+    EXPECT_EQ(0, stream_replay.failures()) << time;
+    EXPECT_FALSE(stream_replay.stream_failed());
+
+    ChainRunner parsed;
+    ActivityReplay parse_replay(parsed.prop_reg());
+    ASSERT_TRUE(parse_replay.Parse(json));
+    EXPECT_TRUE(parse_replay.SeekToCheckpoint(time)) << time;
+    parse_replay.Replay(parsed.interpreter(), parsed.mprops());
+    EXPECT_EQ(0, parse_replay.failures()) << time;
+  }
+
+  // There is nothing to seek to before the first checkpoint.
+  ChainRunner early;
+  ActivityReplay replay(early.prop_reg());
+  ASSERT_TRUE(replay.Open(filename.c_str(), std::set<string>()));
+  EXPECT_FALSE(replay.SeekToCheckpoint(0.5));
+  unlink(filename.c_str());
+}
+
+}  // namespace gestures
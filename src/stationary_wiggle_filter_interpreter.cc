@@ -8,6 +8,7 @@
 
 #include "include/gestures.h"
 #include "include/interpreter.h"
+#include "include/state_archive.h"
 #include "include/tracer.h"
 #include "include/util.h"
 
@@ -106,6 +107,12 @@ StationaryWiggleFilterInterpreter::StationaryWiggleFilterInterpreter(
       threshold_(prop_reg, "Finger Moving Energy", 0.012),
       hysteresis_(prop_reg, "Finger Moving Hysteresis", 0.006) {
   InitName();
+  enabled_.SetDelegate(this);
+}
+
+void StationaryWiggleFilterInterpreter::BoolWasWritten(BoolProperty* prop) {
+  if (prop == &enabled_)
+    UpdateRoute();
 }
 
 void StationaryWiggleFilterInterpreter::SyncInterpretImpl(
@@ -117,7 +124,7 @@ void StationaryWiggleFilterInterpreter::SyncInterpretImpl(
     UpdateStationaryFlags(hwstate);
 
   LogHardwareStatePost(name, hwstate);
-  next_->SyncInterpret(hwstate, timeout);
+  SyncInterpretNext(hwstate, timeout);
 }
 
 void StationaryWiggleFilterInterpreter::UpdateStationaryFlags(
@@ -148,4 +155,9 @@ void StationaryWiggleFilterInterpreter::UpdateStationaryFlags(
   }
 }
 
+void StationaryWiggleFilterInterpreter::ArchiveState(StateArchive* archive) {
+  FilterInterpreter::ArchiveState(archive);
+  archive->Archive(&histories_);
+}
+
 }  // namespace gestures
@@ -85,6 +85,24 @@ static void StringAppendVT(std::string* dst,
   }
 }
 
+const char kBase64Chars[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// Returns the 6-bit value of a base64 digit, or -1 if |c| isn't one.
+int Base64Value(char c) {
+  if (c >= 'A' && c <= 'Z')
+    return c - 'A';
+  if (c >= 'a' && c <= 'z')
+    return c - 'a' + 26;
+  if (c >= '0' && c <= '9')
+    return c - '0' + 52;
+  if (c == '+')
+    return 62;
+  if (c == '/')
+    return 63;
+  return -1;
+}
+
 template<typename STR>
 STR TrimStringT(const STR& input, const typename STR::value_type trim_chars[]) {
   if (input.empty()) {
@@ -124,4 +142,62 @@ std::string TrimWhitespaceASCII(const std::string& input) {
   return TrimStringT(input, kWhitespaceASCII);
 }
 
+std::string Base64Encode(const std::string& input) {
+  std::string output;
+  output.reserve((input.size() + 2) / 3 * 4);
+  size_t i = 0;
+  for (; i + 2 < input.size(); i += 3) {
+    unsigned bits = static_cast<unsigned char>(input[i]) << 16 |
+                    static_cast<unsigned char>(input[i + 1]) << 8 |
+                    static_cast<unsigned char>(input[i + 2]);
+    output += kBase64Chars[bits >> 18];
+    output += kBase64Chars[(bits >> 12) & 0x3f];
+    output += kBase64Chars[(bits >> 6) & 0x3f];
+    output += kBase64Chars[bits & 0x3f];
+  }
+  if (i < input.size()) {
+    unsigned bits = static_cast<unsigned char>(input[i]) << 16;
+    if (i + 1 < input.size())
+      bits |= static_cast<unsigned char>(input[i + 1]) << 8;
+    output += kBase64Chars[bits >> 18];
+    output += kBase64Chars[(bits >> 12) & 0x3f];
+    output += i + 1 < input.size() ? kBase64Chars[(bits >> 6) & 0x3f] : '=';
+    output += '=';
+  }
+  return output;
+}
+
+bool Base64Decode(const std::string& input, std::string* output) {
+  output->clear();
+  if (input.size() % 4)
+    return false;
+  output->reserve(input.size() / 4 * 3);
+  for (size_t i = 0; i < input.size(); i += 4) {
+    int values[4];
+    size_t padding = 0;
+    for (size_t j = 0; j < 4; j++) {
+      char c = input[i + j];
+      // Padding may only appear in the last two positions of the last quad.
+      if (c == '=' && i + 4 == input.size() && j >= 2) {
+        values[j] = 0;
+        padding++;
+        continue;
+      }
+      if (padding)
+        return false;
+      values[j] = Base64Value(c);
+      if (values[j] < 0)
+        return false;
+    }
+    unsigned bits = values[0] << 18 | values[1] << 12 | values[2] << 6 |
+                    values[3];
+    output->push_back(static_cast<char>(bits >> 16));
+    if (padding < 2)
+      output->push_back(static_cast<char>((bits >> 8) & 0xff));
+    if (padding < 1)
+      output->push_back(static_cast<char>(bits & 0xff));
+  }
+  return true;
+}
+
 }  // namespace gestures
@@ -36,4 +36,26 @@ TEST(StringUtilTest, TrimWhitespaceASCIITest) {
   EXPECT_EQ(TrimWhitespaceASCII("   Bees and ponies     "), "Bees and ponies");
 }
 
+TEST(StringUtilTest, Base64Test) {
+  EXPECT_EQ(Base64Encode(""), "");
+  EXPECT_EQ(Base64Encode("f"), "Zg==");
+  EXPECT_EQ(Base64Encode("fo"), "Zm8=");
+  EXPECT_EQ(Base64Encode("foo"), "Zm9v");
+  EXPECT_EQ(Base64Encode("foobar"), "Zm9vYmFy");
+
+  std::string binary;
+  for (int i = 0; i < 256; i++)
+    binary.push_back(static_cast<char>(i));
+  std::string decoded;
+  EXPECT_TRUE(Base64Decode(Base64Encode(binary), &decoded));
+  EXPECT_EQ(decoded, binary);
+  EXPECT_TRUE(Base64Decode("Zm8=", &decoded));
+  EXPECT_EQ(decoded, "fo");
+
+  EXPECT_FALSE(Base64Decode("Zm8", &decoded));
+  EXPECT_FALSE(Base64Decode("Z=8=", &decoded));
+  EXPECT_FALSE(Base64Decode("Zm8*", &decoded));
+  EXPECT_FALSE(Base64Decode("Zg==Zg==", &decoded));
+}
+
 }  // namespace gestures
@@ -5,6 +5,7 @@
 #include "include/stuck_button_inhibitor_filter_interpreter.h"
 
 #include "include/logging.h"
+#include "include/state_archive.h"
 #include "include/tracer.h"
 
 namespace gestures {
@@ -28,7 +29,7 @@ void StuckButtonInhibitorFilterInterpreter::SyncInterpretImpl(
 
   stime_t next_timeout = NO_DEADLINE;
   LogHardwareStatePost(name, hwstate);
-  next_->SyncInterpret(hwstate, &next_timeout);
+  SyncInterpretNext(hwstate, &next_timeout);
   HandleTimeouts(next_timeout, timeout);
 }
 
@@ -39,7 +40,7 @@ void StuckButtonInhibitorFilterInterpreter::HandleTimerImpl(
 
   stime_t next_timeout = NO_DEADLINE;
   if (next_expects_timer_) {
-    next_->HandleTimer(now, &next_timeout);
+    HandleTimerNext(now, &next_timeout);
   } else {
     if (!sent_buttons_down_) {
       Err("Bug: got callback, but no gesture to send.");
@@ -112,4 +113,12 @@ void StuckButtonInhibitorFilterInterpreter::HandleTimeouts(
   }
 }
 
+void StuckButtonInhibitorFilterInterpreter::ArchiveState(
+    StateArchive* archive) {
+  FilterInterpreter::ArchiveState(archive);
+  archive->Archive(&incoming_button_must_be_up_);
+  archive->Archive(&sent_buttons_down_);
+  archive->Archive(&next_expects_timer_);
+}
+
 }  // namespace gestures
@@ -2,6 +2,7 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include "include/state_archive.h"
 #include "include/t5r2_correcting_filter_interpreter.h"
 
 namespace gestures {
@@ -32,7 +33,13 @@ void T5R2CorrectingFilterInterpreter::SyncInterpretImpl(
   last_finger_cnt_ = hwstate.finger_cnt;
 
   LogHardwareStatePost(name, hwstate);
-  next_->SyncInterpret(hwstate, timeout);
+  SyncInterpretNext(hwstate, timeout);
+}
+
+void T5R2CorrectingFilterInterpreter::ArchiveState(StateArchive* archive) {
+  FilterInterpreter::ArchiveState(archive);
+  archive->Archive(&last_finger_cnt_);
+  archive->Archive(&last_touch_cnt_);
 }
 
 };  // namespace gestures
@@ -7,6 +7,7 @@
 #include <math.h>
 
 #include "include/logging.h"
+#include "include/state_archive.h"
 #include "include/tracer.h"
 
 namespace gestures {
@@ -37,7 +38,7 @@ void TimestampFilterInterpreter::SyncInterpretImpl(
 
   LogDebugData(debug_data);
   LogHardwareStatePost(name, hwstate);
-  next_->SyncInterpret(hwstate, timeout);
+  SyncInterpretNext(hwstate, timeout);
 }
 
 void TimestampFilterInterpreter::ChangeTimestampDefault(
@@ -95,7 +96,7 @@ void TimestampFilterInterpreter::HandleTimerImpl(stime_t now,
   // Adjust the timestamp by the largest skew_ since reset. This ensures that
   // the callback isn't ignored because it looks like it's coming too early.
   now += max_skew_;
-  next_->HandleTimer(now, timeout);
+  HandleTimerNext(now, timeout);
 
   LogHandleTimerPost(name, now, timeout);
 }
@@ -115,4 +116,14 @@ void TimestampFilterInterpreter::ConsumeGesture(const Gesture& gs) {
   ProduceGesture(copy);
 }
 
+void TimestampFilterInterpreter::ArchiveState(StateArchive* archive) {
+  FilterInterpreter::ArchiveState(archive);
+  archive->Archive(&prev_msc_timestamp_);
+  archive->Archive(&msc_timestamp_offset_);
+  archive->Archive(&fake_timestamp_);
+  archive->Archive(&fake_timestamp_max_divergence_);
+  archive->Archive(&skew_);
+  archive->Archive(&max_skew_);
+}
+
 }  // namespace gestures
@@ -4,6 +4,7 @@
 
 #include "include/trend_classifying_filter_interpreter.h"
 
+#include <algorithm>
 #include <cmath>
 
 #include "include/filter_interpreter.h"
@@ -11,6 +12,7 @@
 #include "include/gestures.h"
 #include "include/logging.h"
 #include "include/prop_registry.h"
+#include "include/state_archive.h"
 #include "include/tracer.h"
 #include "include/util.h"
 
@@ -52,7 +54,7 @@ void TrendClassifyingFilterInterpreter::SyncInterpretImpl(
     UpdateFingerState(hwstate);
 
   LogHardwareStatePost(name, hwstate);
-  next_->SyncInterpret(hwstate, timeout);
+  SyncInterpretNext(hwstate, timeout);
 }
 
 double TrendClassifyingFilterInterpreter::ComputeKTVariance(const int tie_n2,
@@ -74,33 +76,72 @@ void TrendClassifyingFilterInterpreter::InterpretTestResult(
     *flags |= flag_decreasing;
 }
 
+void TrendClassifyingFilterInterpreter::PopOldestState(
+    FingerHistory& history) {
+  auto& states = history.states;
+  for (size_t i = 0; i < KState::n_axes_; i++)
+    if (!KState::IsDelta(i))
+      RemoveKTValue(states.front().axes_[i], &history.totals[i]);
+  states.pop_front();
+  // The delta axes of the new oldest state drop out of the window too
+  if (states.empty())
+    return;
+  for (size_t i = 0; i < KState::n_axes_; i++)
+    if (KState::IsDelta(i))
+      RemoveKTValue(states.front().axes_[i], &history.totals[i]);
+}
+
+void TrendClassifyingFilterInterpreter::RecomputeTotals(
+    FingerHistory& history) {
+  for (size_t i = 0; i < KState::n_axes_; i++)
+    history.totals[i] = KTotals{ 0, 0, 0 };
+  for (auto it = history.states.begin(); it != history.states.end(); ++it)
+    for (size_t i = 0; i < KState::n_axes_; i++)
+      if (it != history.states.begin() || !KState::IsDelta(i)) {
+        const KState::KAxis& axis = it->axes_[i];
+        KTotals& totals = history.totals[i];
+        totals.score += axis.sum;
+        totals.tie_n2 += axis.ties;
+        totals.tie_n3 += (axis.ties * (axis.ties - 1)) >> 1;
+      }
+}
+
 void TrendClassifyingFilterInterpreter::AddNewStateToBuffer(
     FingerHistory& history, const FingerState& fs) {
-  // The history buffer is already full, pop one
-  if (history.size() == static_cast<size_t>(num_of_samples_.val_))
-    history.pop_front();
+  auto& states = history.states;
+  // Follow changes to the number of samples desired
+  size_t num_of_samples = std::max(num_of_samples_.val_, 1);
+  if (states.capacity() != num_of_samples) {
+    states.set_capacity(num_of_samples);
+    RecomputeTotals(history);
+  }
+  if (states.full())
+    PopOldestState(history);
+  states.push_back().Init(fs);
 
-  // Push the new finger state to the back of buffer
-  auto& current = history.emplace_back(fs);
-  if (history.size() == 1)
+  // The new finger state is at the back of buffer
+  auto& current = states.back();
+  if (states.size() == 1) {
+    for (size_t i = 0; i < KState::n_axes_; i++)
+      history.totals[i] = KTotals{ 0, 0, 0 };
     return;
-  auto& previous_end = history.at(-2);
+  }
+  auto& previous_end = states.at(-2);
 
   current.DxAxis()->val = current.XAxis()->val - previous_end.XAxis()->val;
   current.DyAxis()->val = current.YAxis()->val - previous_end.YAxis()->val;
-  // Update the nodes already in the buffer and compute the Kendall score/
-  // variance along the way. Complexity is O(|buffer|) per finger.
-  int tie_n2[KState::n_axes_] = { 0, 0, 0, 0, 0, 0 };
-  int tie_n3[KState::n_axes_] = { 0, 0, 0, 0, 0, 0 };
-  for (auto it = history.begin(); it != history.end(); ++it)
+  // Pair the new state with every state in the buffer, itself included, to
+  // bring the totals up to date. Complexity is O(|buffer|) per finger.
+  for (auto it = states.begin(); it != states.end(); ++it)
     for (size_t i = 0; i < KState::n_axes_; i++)
-      if (it != history.begin() || !KState::IsDelta(i)) {
-        UpdateKTValuePair(&it->axes_[i], &current.axes_[i],
-            &tie_n2[i], &tie_n3[i]);
-      }
-  size_t n_samples = history.size();
+      if (it != states.begin() || !KState::IsDelta(i))
+        UpdateKTValuePair(&it->axes_[i], current.axes_[i],
+                          &history.totals[i]);
+  size_t n_samples = states.size();
   for (size_t i = 0; i < KState::n_axes_; i++) {
-    current.axes_[i].var = ComputeKTVariance(tie_n2[i], tie_n3[i],
+    const KTotals& totals = history.totals[i];
+    current.axes_[i].score = totals.score;
+    current.axes_[i].var = ComputeKTVariance(totals.tie_n2, totals.tie_n3,
         KState::IsDelta(i) ? n_samples - 1 : n_samples);
   }
 }
@@ -134,16 +175,13 @@ void TrendClassifyingFilterInterpreter::UpdateFingerState(
 
   FingerState* fs = hwstate.fingers;
   for (short i = 0; i < hwstate.finger_cnt; i++) {
-    // Update the map if the contact is new
-    if (!MapContainsKey(histories_, fs[i].tracking_id)) {
-      histories_[fs[i].tracking_id] = FingerHistory{};
-    }
+    // A new contact starts with an empty history
     auto& history = histories_[fs[i].tracking_id];
 
     // Check if the score demonstrates statistical significance
     AddNewStateToBuffer(history, fs[i]);
-    const auto& current = history.back();
-    const size_t n_samples = history.size();
+    const auto& current = history.states.back();
+    const size_t n_samples = history.states.size();
     for (size_t idx = 0; idx < KState::n_axes_; idx++)
       if (second_order_enable_.val_ || !KState::IsDelta(idx)) {
         TrendType result = RunKTTest(&current.axes_[idx],
@@ -166,4 +204,15 @@ void TrendClassifyingFilterInterpreter::KState::Init(const FingerState& fs) {
   TouchMajorAxis()->val = fs.touch_major;
 }
 
+void TrendClassifyingFilterInterpreter::FingerHistory::ArchiveState(
+    StateArchive* archive) {
+  archive->Archive(&states);
+  archive->Archive(&totals);
+}
+
+void TrendClassifyingFilterInterpreter::ArchiveState(StateArchive* archive) {
+  FilterInterpreter::ArchiveState(archive);
+  archive->Archive(&histories_);
+}
+
 }
@@ -116,4 +116,74 @@ TEST(TrendClassifyingFilterInterpreterTest, SimpleTest) {
   EXPECT_EQ(interpreter.z_threshold_.val_, 2.5758293035489004);
 }
 
+// Checks the running totals against S and Var(S) computed from scratch over
+// the window, while the window slides and gets resized.
+TEST(TrendClassifyingFilterInterpreterTest, IncrementalScoreTest) {
+  TrendClassifyingFilterInterpreterTestInterpreter* base_interpreter =
+      new TrendClassifyingFilterInterpreterTestInterpreter;
+  TrendClassifyingFilterInterpreter interpreter(
+      nullptr, base_interpreter, nullptr);
+  typedef TrendClassifyingFilterInterpreter::KState KState;
+
+  HardwareProperties hwprops = {
+    .right = 100, .bottom = 100,
+    .res_x = 1, .res_y = 1,
+    .orientation_minimum = -1,
+    .orientation_maximum = 2,
+    .max_finger_cnt = 5, .max_touch_cnt = 5,
+    .supports_t5r2 = 0, .support_semi_mt = 0, .is_button_pad = 1,
+    .has_wheel = 0, .wheel_is_hi_res = 0,
+    .is_haptic_pad = 0,
+  };
+  TestInterpreterWrapper wrapper(&interpreter, &hwprops);
+
+  // Values from a small range so that there are plenty of ties
+  unsigned seed = 1;
+  auto next_value = [&seed]() {
+    seed = seed * 1103515245 + 12345;
+    return static_cast<float>((seed >> 16) % 5);
+  };
+
+  for (int frame = 0; frame < 60; frame++) {
+    if (frame == 30)
+      interpreter.num_of_samples_.val_ = 7;
+    else if (frame == 45)
+      interpreter.num_of_samples_.val_ = 12;
+
+    FingerState fs = {0, 0, 0, 0, next_value(), 0, next_value(),
+                      next_value(), 1, 0};
+    HardwareState hwstate = make_hwstate(1.0 + frame * 0.01, 0, 1, 1, &fs);
+    wrapper.SyncInterpret(hwstate, nullptr);
+
+    const auto& states = interpreter.histories_[1].states;
+    const KState& current = states.back();
+    for (size_t i = 0; i < KState::n_axes_; i++) {
+      if (states.size() == 1)
+        break;
+      size_t first = KState::IsDelta(i) ? 1 : 0;
+      size_t n = states.size();
+      int score = 0, tie_n2 = 0, tie_n3 = 0;
+      for (size_t j = first; j < n; j++) {
+        int ties = 0;
+        for (size_t k = j; k < n; k++) {
+          float vj = states.at(j).axes_[i].val;
+          float vk = states.at(k).axes_[i].val;
+          if (k > j)
+            score += (vj < vk) - (vj > vk);
+          ties += vj == vk;
+        }
+        // The finger's first state is never paired with itself
+        if (j == 0 && n == static_cast<size_t>(frame + 1))
+          ties--;
+        tie_n2 += ties;
+        tie_n3 += ties * (ties - 1) / 2;
+      }
+      EXPECT_EQ(score, current.axes_[i].score) << frame << " " << i;
+      EXPECT_DOUBLE_EQ(
+          interpreter.ComputeKTVariance(tie_n2, tie_n3, n - first),
+          current.axes_[i].var) << frame << " " << i;
+    }
+  }
+}
+
 }  // namespace gestures
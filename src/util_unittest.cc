@@ -5,6 +5,7 @@
 #include <gtest/gtest.h>
 
 #include "include/macros.h"
+#include "include/unittest_util.h"
 #include "include/util.h"
 
 namespace gestures {
@@ -21,51 +22,78 @@ TEST(UtilTest, DistSqTest) {
   EXPECT_FLOAT_EQ(DistSqXY(fs[0], 4, 6), 25);
 }
 
-TEST(UtilTest, ListAtTest) {
-  const int kMaxElements = 3;
-  struct element {
-    int x;
-  };
-
-  List<element> list;
-
-  for (auto i = 0; i < kMaxElements; ++i) {
-    auto& elem = list.emplace_back();
-    elem.x = i;
-  }
-  EXPECT_EQ(list.at(-1).x, list.at(list.size() - 1).x);
-
-  for (auto i = 0; i < kMaxElements; ++i) {
-    for (auto j = 0; j < kMaxElements; ++j) {
-      if (i == j) {
-        EXPECT_EQ(list.at(i).x, list.at(j).x);
-        EXPECT_EQ(&(list.at(i)), &(list.at(j)));
-      } else {
-        EXPECT_NE(list.at(i).x, list.at(j).x);
-        EXPECT_NE(&(list.at(i)), &(list.at(j)));
-      }
-    }
+TEST(UtilTest, TrackingIdMapTest) {
+  TrackingIdMap<float> map;
+  EXPECT_TRUE(map.empty());
+  map[5] = 5.0;
+  map[1] = 1.0;
+  map[3] = 3.0;
+  map[3] += 1.0;
+  EXPECT_EQ(3, map.size());
+  short expected_ids[] = { 1, 3, 5 };
+  float expected_values[] = { 1.0, 4.0, 5.0 };
+  size_t i = 0;
+  for (const auto& [id, value] : map) {
+    EXPECT_EQ(expected_ids[i], id);
+    EXPECT_FLOAT_EQ(expected_values[i], value);
+    ++i;
   }
+  EXPECT_FLOAT_EQ(4.0, map.at(3));
+  EXPECT_EQ(1, map.count(5));
+  EXPECT_TRUE(map.find(2) == map.end());
+  EXPECT_EQ(1, map.erase(3));
+  EXPECT_EQ(0, map.erase(3));
+  EXPECT_EQ(2, map.size());
+  map.clear();
+  EXPECT_TRUE(map.empty());
 }
 
-TEST(UtilTest, ListAtDeathForwardTest) {
-  List<int> list;
-  const int kMaxElements = 3;
-
-  for (auto i = 0; i < kMaxElements; ++i) {
-    list.emplace_back(i);
-  }
-  EXPECT_DEATH(list.at(kMaxElements+1), "");
+TEST(UtilTest, TrackingIdMapOutOfSpaceTest) {
+  TrackingIdMap<int> map;
+  for (short id = 0; id < static_cast<short>(kMaxFingers); ++id)
+    map[id] = id;
+  map[kMaxFingers] = 100;
+  EXPECT_EQ(kMaxFingers, map.size());
+  EXPECT_EQ(0, map.count(kMaxFingers));
+  EXPECT_EQ(1, map.at(1));
 }
 
-TEST(UtilTest, ListAtDeathBackwardTest) {
-  List<int> list;
-  const int kMaxElements = 3;
+TEST(UtilTest, TrackingIdMapConstTest) {
+  TrackingIdMap<int> map;
+  map[1] = 1;
+  const TrackingIdMap<int>& const_map = map;
+  EXPECT_EQ(1, const_map.at(1));
+  EXPECT_TRUE(const_map.find(1) == const_map.begin());
+  EXPECT_TRUE(const_map.find(2) == const_map.end());
+  // A missing id gives the same default value each time, without touching
+  // the map.
+  const int& missing = const_map.at(2);
+  EXPECT_EQ(0, missing);
+  EXPECT_EQ(&missing, &const_map.at(3));
+  EXPECT_EQ(1, map.size());
+  // Scratch entries handed out by the non-const at() don't change it.
+  map.at(2) = 7;
+  EXPECT_EQ(0, const_map.at(2));
+  EXPECT_EQ(0, map.count(2));
+}
 
-  for (auto i = 0; i < kMaxElements; ++i) {
-    list.emplace_back(i);
-  }
-  EXPECT_DEATH(list.at(-(kMaxElements+1)), "");
+TEST(UtilTest, RemoveMissingIdsTest) {
+  FingerState fs[] = {
+    // TM, Tm, WM, Wm, Press, Orientation, X, Y, TrID
+    {0, 0, 0, 0, 1, 0, 1, 2, 2, 0},
+    {0, 0, 0, 0, 1, 0, 4, 6, 4, 0}
+  };
+  HardwareState hs = make_hwstate(0, 0, 2, 2, fs);
+  TrackingIdMap<int> map;
+  TrackingIdSet set = { 1, 2, 3, 4 };
+  for (short id : set)
+    map[id] = id;
+  RemoveMissingIdsFromMap(&map, hs);
+  RemoveMissingIdsFromSet(&set, hs);
+  EXPECT_EQ(2, map.size());
+  EXPECT_EQ(1, map.count(2));
+  EXPECT_EQ(1, map.count(4));
+  EXPECT_TRUE(set == TrackingIdSet({ 2, 4 }));
 }
 
 }  // namespace gestures
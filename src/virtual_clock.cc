@@ -0,0 +1,127 @@
+// Copyright 2026 The ChromiumOS Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "include/virtual_clock.h"
+
+#include <float.h>
+
+#include "include/logging.h"
+
+namespace gestures {
+
+GesturesTimerProvider VirtualClock::kTimerProvider = {
+  VirtualClock::CreateTimer,
+  VirtualClock::SetTimer,
+  VirtualClock::CancelTimer,
+  VirtualClock::FreeTimer,
+};
+
+VirtualClock::VirtualClock(GestureInterpreter* gi)
+    : gi_(gi),
+      now_(0.0),
+      next_order_(0),
+      timer_callbacks_(0) {
+  gi_->SetTimerProvider(&kTimerProvider, this);
+}
+
+VirtualClock::VirtualClock()
+    : gi_(nullptr),
+      now_(0.0),
+      next_order_(0),
+      timer_callbacks_(0) {}
+
+VirtualClock::~VirtualClock() {
+  if (gi_)
+    gi_->SetTimerProvider(nullptr, nullptr);
+}
+
+void VirtualClock::PushHardwareState(HardwareState* hwstate) {
+  if (!gi_) {
+    Err("No interpreter to push to");
+    return;
+  }
+  AdvanceTo(hwstate->timestamp);
+  gi_->PushHardwareState(hwstate);
+}
+
+void VirtualClock::AdvanceTo(stime_t time) {
+  while (FireNextTimer(time)) {}
+  now_ = time;
+}
+
+bool VirtualClock::FireNextTimer(stime_t limit) {
+  Timer* timer = NextTimer();
+  if (!timer || timer->deadline > limit)
+    return false;
+  now_ = timer->deadline;
+  timer->set = false;
+  timer_callbacks_++;
+  stime_t delay = timer->callback(now_, timer->callback_data);
+  if (delay >= 0.0) {
+    timer->set = true;
+    timer->deadline = now_ + delay;
+    timer->order = next_order_++;
+  }
+  return true;
+}
+
+void VirtualClock::RunUntilIdle() {
+  while (FireNextTimer(DBL_MAX)) {}
+}
+
+stime_t VirtualClock::NextDeadline() const {
+  Timer* timer = NextTimer();
+  return timer ? timer->deadline : NO_DEADLINE;
+}
+
+VirtualClock::Timer* VirtualClock::NextTimer() const {
+  Timer* next = nullptr;
+  for (const std::unique_ptr<Timer>& timer : timers_) {
+    if (!timer->set)
+      continue;
+    if (!next || timer->deadline < next->deadline ||
+        (timer->deadline == next->deadline && timer->order < next->order))
+      next = timer.get();
+  }
+  return next;
+}
+
+GesturesTimer* VirtualClock::CreateTimer(void* data) {
+  VirtualClock* clock = static_cast<VirtualClock*>(data);
+  clock->timers_.emplace_back(new Timer());
+  return reinterpret_cast<GesturesTimer*>(clock->timers_.back().get());
+}
+
+void VirtualClock::SetTimer(void* data, GesturesTimer* timer, stime_t delay,
+                            GesturesTimerCallback callback,
+                            void* callback_data) {
+  VirtualClock* clock = static_cast<VirtualClock*>(data);
+  Timer* virtual_timer = reinterpret_cast<Timer*>(timer);
+  if (delay < 0.0) {
+    Err("Negative timer delay %f", delay);
+    delay = 0.0;
+  }
+  virtual_timer->set = true;
+  virtual_timer->deadline = clock->now_ + delay;
+  virtual_timer->order = clock->next_order_++;
+  virtual_timer->callback = callback;
+  virtual_timer->callback_data = callback_data;
+}
+
+void VirtualClock::CancelTimer(void* data, GesturesTimer* timer) {
+  reinterpret_cast<Timer*>(timer)->set = false;
+}
+
+void VirtualClock::FreeTimer(void* data, GesturesTimer* timer) {
+  VirtualClock* clock = static_cast<VirtualClock*>(data);
+  for (auto it = clock->timers_.begin(); it != clock->timers_.end(); ++it) {
+    if (it->get() == reinterpret_cast<Timer*>(timer)) {
+      clock->timers_.erase(it);
+      return;
+    }
+  }
+  Err("Freeing unknown timer");
+}
+
+}  // namespace gestures
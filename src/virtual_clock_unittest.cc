@@ -0,0 +1,189 @@
+// Copyright 2026 The ChromiumOS Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "include/gestures.h"
+#include "include/unittest_util.h"
+#include "include/virtual_clock.h"
+
+namespace gestures {
+
+class VirtualClockTest : public ::testing::Test {};
+
+namespace {
+
+struct FiredTimer {
+  const char* name;
+  stime_t now;
+};
+
+std::vector<FiredTimer> g_fired;
+
+stime_t FireA(stime_t now, void* data) {
+  g_fired.push_back({ "a", now });
+  return NO_DEADLINE;
+}
+
+stime_t FireB(stime_t now, void* data) {
+  g_fired.push_back({ "b", now });
+  // Rearm once
+  int* rearms = static_cast<int*>(data);
+  return (*rearms)-- > 0 ? 0.15 : NO_DEADLINE;
+}
+
+stime_t FireC(stime_t now, void* data) {
+  g_fired.push_back({ "c", now });
+  return NO_DEADLINE;
+}
+
+void RecordGesture(void* data, const Gesture* gesture) {
+  static_cast<std::vector<std::string>*>(data)->push_back(gesture->String());
+}
+
+}  // namespace
+
+TEST(VirtualClockTest, DeadlineOrderTest) {
+  GestureInterpreter* gi = NewGestureInterpreter();
+  {
+    VirtualClock clock(gi);
+    GesturesTimerProvider* tp = &VirtualClock::kTimerProvider;
+    GesturesTimer* a = tp->create_fn(&clock);
+    GesturesTimer* b = tp->create_fn(&clock);
+    GesturesTimer* c = tp->create_fn(&clock);
+    int rearms = 1;
+    g_fired.clear();
+
+    clock.AdvanceTo(1.0);
+    tp->set_fn(&clock, a, 0.3, FireA, nullptr);
+    tp->set_fn(&clock, b, 0.1, FireB, &rearms);
+    tp->set_fn(&clock, c, 0.1, FireC, nullptr);
+    EXPECT_DOUBLE_EQ(1.1, clock.NextDeadline());
+
+    // b and c are due at the same time, and fire in the order they were set
+    clock.AdvanceTo(1.2);
+    EXPECT_EQ(2, g_fired.size());
+    EXPECT_DOUBLE_EQ(1.2, clock.now());
+
+    clock.AdvanceTo(2.0);
+    std::vector<FiredTimer> expected = {
+      { "b", 1.1 }, { "c", 1.1 }, { "b", 1.1 + 0.15 }, { "a", 1.3 }
+    };
+    ASSERT_EQ(expected.size(), g_fired.size());
+    for (size_t i = 0; i < expected.size(); i++) {
+      EXPECT_STREQ(expected[i].name, g_fired[i].name) << i;
+      EXPECT_DOUBLE_EQ(expected[i].now, g_fired[i].now) << i;
+    }
+    EXPECT_EQ(4, clock.timer_callbacks());
+    EXPECT_EQ(NO_DEADLINE, clock.NextDeadline());
+
+    // A cancelled timer doesn't fire
+    tp->set_fn(&clock, a, 0.1, FireA, nullptr);
+    tp->cancel_fn(&clock, a);
+    clock.RunUntilIdle();
+    EXPECT_EQ(4, clock.timer_callbacks());
+
+    tp->free_fn(&clock, a);
+    tp->free_fn(&clock, b);
+    tp->free_fn(&clock, c);
+  }
+  DeleteGestureInterpreter(gi);
+}
+
+// Drives a touchpad pipeline with one finger moving across the pad and
+// lifting, and returns the gestures it produced. With |c_api|, the clock is
+// installed and the frames pushed through the C API, with the clock
+// outliving the interpreter.
+static std::vector<std::string> RunTouchpad(bool c_api,
+                                            size_t* timer_callbacks) {
+  HardwareProperties hwprops = {
+    .right = 1000, .bottom = 600,
+    .res_x = 10, .res_y = 10,
+    .orientation_minimum = -1,
+    .orientation_maximum = 2,
+    .max_finger_cnt = 5, .max_touch_cnt = 5,
+    .supports_t5r2 = 0, .support_semi_mt = 0, .is_button_pad = 1,
+    .has_wheel = 0, .wheel_is_hi_res = 0,
+    .is_haptic_pad = 0,
+  };
+  std::vector<std::string> gestures;
+  std::unique_ptr<VirtualClock> c_api_clock;
+  if (c_api)
+    c_api_clock.reset(new VirtualClock());
+  GestureInterpreter* gi = NewGestureInterpreter();
+  gi->SetCallback(RecordGesture, &gestures);
+  gi->Initialize(GESTURES_DEVCLASS_TOUCHPAD);
+  gi->SetHardwareProperties(hwprops);
+  {
+    std::unique_ptr<VirtualClock> clock;
+    if (c_api) {
+      GestureInterpreterSetTimerProvider(gi, VirtualClock::timer_provider(),
+                                         c_api_clock.get());
+    } else {
+      clock.reset(new VirtualClock(gi));
+    }
+    VirtualClock* active = c_api ? c_api_clock.get() : clock.get();
+    for (size_t frame = 0; frame <= 60; frame++) {
+      FingerState finger = FingerState();
+      finger.touch_major = 10;
+      finger.touch_minor = 8;
+      finger.pressure = 40;
+      finger.position_x = 200 + 4.0f * frame;
+      finger.position_y = 300;
+      finger.tracking_id = 1;
+      // The last frame lifts the finger.
+      size_t count = frame < 60 ? 1 : 0;
+      HardwareState hs = make_hwstate(1.0 + frame * 0.0125, 0, count, count,
+                                      count ? &finger : nullptr);
+      if (c_api) {
+        active->AdvanceTo(hs.timestamp);
+        GestureInterpreterPushHardwareState(gi, &hs);
+      } else {
+        active->PushHardwareState(&hs);
+      }
+    }
+    active->RunUntilIdle();
+    EXPECT_EQ(NO_DEADLINE, active->NextDeadline());
+    *timer_callbacks = active->timer_callbacks();
+  }
+  DeleteGestureInterpreter(gi);
+  return gestures;
+}
+
+TEST(VirtualClockTest, TouchpadTest) {
+  size_t timer_callbacks = 0;
+  std::vector<std::string> gestures = RunTouchpad(false, &timer_callbacks);
+  // The lookahead filter holds frames back and releases them from timers
+  EXPECT_LT(0, timer_callbacks);
+  size_t moves = 0;
+  for (const std::string& gesture : gestures)
+    moves += gesture.find("type: move") != std::string::npos;
+  EXPECT_LT(0, moves);
+
+  size_t rerun_timer_callbacks = 0;
+  EXPECT_EQ(gestures, RunTouchpad(false, &rerun_timer_callbacks));
+  EXPECT_EQ(timer_callbacks, rerun_timer_callbacks);
+}
+
+TEST(VirtualClockTest, CApiTest) {
+  // A clock made without an interpreter drives it the same way through the
+  // C API.
+  size_t timer_callbacks = 0;
+  std::vector<std::string> gestures = RunTouchpad(false, &timer_callbacks);
+  size_t c_api_timer_callbacks = 0;
+  EXPECT_EQ(gestures, RunTouchpad(true, &c_api_timer_callbacks));
+  EXPECT_EQ(timer_callbacks, c_api_timer_callbacks);
+
+  // It has no interpreter of its own to push to.
+  VirtualClock clock;
+  HardwareState hs = make_hwstate(1.0, 0, 0, 0, nullptr);
+  clock.PushHardwareState(&hs);
+  EXPECT_EQ(0.0, clock.now());
+}
+
+}  // namespace gestures
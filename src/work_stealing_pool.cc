@@ -0,0 +1,72 @@
+// Copyright 2026 The ChromiumOS Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "include/work_stealing_pool.h"
+
+#include <algorithm>
+#include <thread>
+
+namespace gestures {
+
+WorkStealingPool::WorkStealingPool(size_t threads) : threads_(threads) {
+  if (!threads_)
+    threads_ = std::max(1u, std::thread::hardware_concurrency());
+  for (size_t i = 0; i < threads_; i++)
+    queues_.emplace_back(new Queue());
+}
+
+void WorkStealingPool::Run(
+    size_t count,
+    const std::function<void(size_t task, size_t thread)>& task) {
+  // Deal out runs of neighbouring tasks, so that until stealing starts each
+  // thread works through its own part of the list.
+  for (size_t i = 0; i < threads_; i++) {
+    size_t begin = count * i / threads_;
+    size_t end = count * (i + 1) / threads_;
+    std::lock_guard<std::mutex> lock(queues_[i]->mutex);
+    // Taken from the back, so stored last first
+    for (size_t j = end; j > begin; j--)
+      queues_[i]->tasks.push_back(j - 1);
+  }
+  std::vector<std::thread> workers;
+  for (size_t i = 1; i < threads_; i++)
+    workers.emplace_back(&WorkStealingPool::Work, this, i, std::cref(task));
+  Work(0, task);
+  for (std::thread& worker : workers)
+    worker.join();
+}
+
+bool WorkStealingPool::Take(size_t thread, size_t* task) {
+  {
+    Queue* own = queues_[thread].get();
+    std::lock_guard<std::mutex> lock(own->mutex);
+    if (!own->tasks.empty()) {
+      *task = own->tasks.back();
+      own->tasks.pop_back();
+      return true;
+    }
+  }
+  // Tasks don't add tasks, so once every queue has been seen empty there is
+  // nothing left to steal.
+  for (size_t i = 1; i < threads_; i++) {
+    Queue* victim = queues_[(thread + i) % threads_].get();
+    std::lock_guard<std::mutex> lock(victim->mutex);
+    if (!victim->tasks.empty()) {
+      *task = victim->tasks.front();
+      victim->tasks.pop_front();
+      return true;
+    }
+  }
+  return false;
+}
+
+void WorkStealingPool::Work(
+    size_t thread,
+    const std::function<void(size_t task, size_t thread)>& task) {
+  size_t number;
+  while (Take(thread, &number))
+    task(number, thread);
+}
+
+}  // namespace gestures
@@ -0,0 +1,61 @@
+// Copyright 2026 The ChromiumOS Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "include/work_stealing_pool.h"
+
+namespace gestures {
+
+class WorkStealingPoolTest : public ::testing::Test {};
+
+TEST(WorkStealingPoolTest, RunsEveryTaskOnceTest) {
+  WorkStealingPool pool(4);
+  EXPECT_EQ(4, pool.threads());
+  for (size_t count : { 0, 1, 3, 1000 }) {
+    std::vector<std::atomic<int>> runs(count);
+    std::atomic<bool> bad_thread(false);
+    pool.Run(count, [&](size_t task, size_t thread) {
+      runs[task]++;
+      if (thread >= 4)
+        bad_thread = true;
+    });
+    for (size_t i = 0; i < count; i++)
+      EXPECT_EQ(1, runs[i]) << "task " << i << " of " << count;
+    EXPECT_FALSE(bad_thread);
+  }
+}
+
+TEST(WorkStealingPoolTest, StealTest) {
+  // Task 0 is dealt to thread 0 with tasks 1-4, and holds it until all the
+  // other tasks are done, which needs thread 1 to steal them.
+  WorkStealingPool pool(2);
+  const size_t kTasks = 10;
+  std::atomic<size_t> done(0);
+  bool others_done = false;
+  pool.Run(kTasks, [&](size_t task, size_t thread) {
+    if (task == 0) {
+      auto deadline = std::chrono::steady_clock::now() +
+                      std::chrono::seconds(10);
+      while (done < kTasks - 1 && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      others_done = done == kTasks - 1;
+    }
+    done++;
+  });
+  EXPECT_TRUE(others_done);
+  EXPECT_EQ(kTasks, done);
+}
+
+TEST(WorkStealingPoolTest, DefaultThreadsTest) {
+  WorkStealingPool pool(0);
+  EXPECT_LE(1, pool.threads());
+}
+
+}  // namespace gestures
@@ -0,0 +1,64 @@
+#!/usr/bin/env python3
+#
+# Copyright 2026 The ChromiumOS Authors
+# Use of this source code is governed by a BSD-style license that can be
+# found in the LICENSE file.
+
+"""Convert legacy non-linearity data files to the version 2 format.
+
+The version 2 format is described in include/non_linearity_data.h. It holds
+the same range arrays and error matrix behind a fixed-size header, aligned so
+that the library can map the file and use it in place.
+
+Usage: convert_non_linearity_data.py <legacy input> <version 2 output>
+"""
+
+
+import struct
+import sys
+
+
+MAGIC = b'GSNLDAT\0'
+VERSION = 2
+HEADER = struct.Struct('<8sII3II')
+
+
+def read_legacy(data):
+  """Return the three range arrays and the error values of a legacy file."""
+  offset = 0
+  ranges = []
+  for _ in range(3):
+    (length,) = struct.unpack_from('<i', data, offset)
+    offset += 4
+    ranges.append(struct.unpack_from('<%dd' % length, data, offset))
+    offset += 8 * length
+  num_errors = 2 * len(ranges[0]) * len(ranges[1]) * len(ranges[2])
+  errors = struct.unpack_from('<%dd' % num_errors, data, offset)
+  return ranges, errors
+
+
+def write_version2(ranges, errors):
+  """Return the contents of a version 2 file."""
+  header = HEADER.pack(MAGIC, VERSION, HEADER.size,
+                       *[len(r) for r in ranges], 0)
+  values = [v for r in ranges for v in r] + list(errors)
+  return header + struct.pack('<%dd' % len(values), *values)
+
+
+def main(argv):
+  if len(argv) != 3:
+    sys.stderr.write(__doc__)
+    return 1
+  with open(argv[1], 'rb') as f:
+    data = f.read()
+  if data.startswith(MAGIC):
+    sys.stderr.write('%s is already in the version 2 format\n' % argv[1])
+    return 1
+  ranges, errors = read_legacy(data)
+  with open(argv[2], 'wb') as f:
+    f.write(write_version2(ranges, errors))
+  return 0
+
+
+if __name__ == '__main__':
+  sys.exit(main(sys.argv))